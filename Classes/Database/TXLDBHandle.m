@@ -116,6 +116,24 @@
         [self raiseSQLiteException:@"Failed to open database with message '%'."];
     }
     sqlite3_busy_timeout(handle, 60 * 1000);
+    
+    // Each thread has its own connection. With write-ahead logging the
+    // connections reading (e.g., evaluating queries) see a snapshot
+    // of the database and do not block the connection writing.
+    //
+    // The pragma returns the journal mode in effect, which is not WAL,
+    // if the database does not support it (e.g., an in-memory database).
+    sqlite3_stmt *st = NULL;
+    if (sqlite3_prepare_v2(handle, "PRAGMA journal_mode=WAL", -1, &st, NULL) != SQLITE_OK ||
+        sqlite3_step(st) != SQLITE_ROW) {
+        sqlite3_finalize(st);
+        [self raiseSQLiteException:@"Failed to enable write-ahead logging with message '%s'."];
+    }
+    const char *mode = (const char *)sqlite3_column_text(st, 0);
+    if (mode == NULL || strcasecmp(mode, "wal") != 0) {
+        NSLog(@"Write-ahead logging is not used for the database '%@' (journal mode '%s'), reading connections block the connection writing.", path, mode != NULL ? mode : "");
+    }
+    sqlite3_finalize(st);
 }
 
 - (void)close {
@@ -22,6 +22,7 @@
 //
 
 #import <Foundation/Foundation.h>
+#import <spatialite/sqlite3.h>
 
 extern NSString * const TXLDatabaseErrorDomain;
 extern NSString * const SQLiteErrorDomain;
@@ -75,6 +76,22 @@ extern NSString * const SQLiteErrorDomain;
              error:(NSError **)error
      resultHandler:(void(^)(NSDictionary *row, BOOL *stop))block;
 
+/*!
+    Execute the statement once for each of count rows, e.g., to insert
+    a large number of rows. The block is called before each execution
+    and binds the parameters of the row with the functions sqlite3_bind_*,
+    so that no objects are created for the parameters. The statement
+    should not return a result.
+ 
+    If rowids is not NULL, the rowid of the row inserted by each execution
+    is stored in it. It must have room for count values.
+*/
+- (BOOL)executeSQL:(NSString *)sql
+      numberOfRows:(NSUInteger)count
+    insertedRowids:(sqlite3_int64 *)rowids
+             error:(NSError **)error
+       bindHandler:(void(^)(sqlite3_stmt *statement, NSUInteger row))block;
+
 #pragma mark -
 #pragma mark Transactions
 
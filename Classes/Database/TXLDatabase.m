@@ -310,6 +310,65 @@ int sqlite3_blocking_step(sqlite3_stmt *pStmt);
 }
 
 
+- (BOOL)executeSQL:(NSString *)sql
+      numberOfRows:(NSUInteger)count
+    insertedRowids:(sqlite3_int64 *)rowids
+             error:(NSError **)error
+       bindHandler:(void(^)(sqlite3_stmt *statement, NSUInteger row))block {
+    
+    sqlite3_stmt *statement = [self.dbHandle dequeueReusableStatementForSQL:sql];
+	
+	if (statement == nil) {
+        int err_no = sqlite3_blocking_prepare_v2(self.dbHandle.handle,
+                                                 [sql UTF8String],
+                                                 -1,
+                                                 &statement,
+                                                 NULL);
+		if (err_no != SQLITE_OK) {
+			sqlite3_finalize(statement);
+            if (error != nil) {
+                *error = [self errorFromSQLiteError:err_no
+                                      withStatement:sql
+                                         parameters:nil];
+            }
+            return NO;
+		}
+	}
+    
+    int err_no = SQLITE_DONE;
+    
+    for (NSUInteger row = 0; row < count; row++) {
+        block(statement, row);
+        
+        err_no = sqlite3_blocking_step(statement);
+        if (err_no != SQLITE_DONE) {
+            break;
+        }
+        
+        if (rowids != NULL) {
+            rowids[row] = sqlite3_last_insert_rowid(self.dbHandle.handle);
+        }
+        
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+    }
+    
+    sqlite3_clear_bindings(statement);
+    [self.dbHandle enqueueReusableStatement:statement
+                                      forSQL:sql];
+    
+    if (err_no != SQLITE_DONE) {
+        if (error != nil) {
+            *error = [self errorFromSQLiteError:err_no
+                                  withStatement:sql
+                                     parameters:nil];
+        }
+        return NO;
+    } else {
+        return YES;
+    }
+}
+
 - (NSArray *)columnTypesForStatement:(sqlite3_stmt *)statement {
     int columnCount = sqlite3_column_count(statement);
     NSMutableArray *columnTypes = [NSMutableArray arrayWithCapacity:columnCount];
@@ -48,6 +48,14 @@
 
 - (TXLContext *)childWithName:(NSString *)name;
 
+/*! Children of this context with the given names.
+ *
+ *  The missing children are created in one transaction. Returns
+ *  a dictionary with the name (as given) as key and the context
+ *  as value.
+ */
+- (NSDictionary *)childrenWithNames:(NSArray *)names;
+
 #pragma mark -
 #pragma mark Update Context
 
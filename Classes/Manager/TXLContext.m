@@ -125,6 +125,81 @@
     return result;
 }
 
+- (NSDictionary *)childrenWithNames:(NSArray *)names {
+    
+    TXLDatabase *database = [[TXLManager sharedManager] database];
+    NSError *error;
+    
+    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+    if ([names count] == 0) {
+        return result;
+    }
+    
+    NSMutableArray *fullNames = [NSMutableArray arrayWithCapacity:[names count]];
+    for (NSString *n in names) {
+        [fullNames addObject:[NSString stringWithFormat:@"%@/%@", name, n]];
+    }
+    
+    // Create the missing children
+    
+    if (![database beginTransaction:&error]) {
+        [[NSException exceptionWithName:@"TXLContextException"
+                                 reason:[error localizedDescription]
+                               userInfo:nil] raise];
+    }
+    
+    for (NSString *fullName in fullNames) {
+        if ([database executeSQLWithParameters:@"INSERT OR IGNORE INTO txl_context (name) VALUES (?)"
+                                         error:&error,
+             fullName, nil] == nil) {
+            [database rollback:nil];
+            [[NSException exceptionWithName:@"TXLContextException"
+                                     reason:[error localizedDescription]
+                                   userInfo:nil] raise];
+        }
+    }
+    
+    if (![database commit:&error]) {
+        [[NSException exceptionWithName:@"TXLContextException"
+                                 reason:[error localizedDescription]
+                               userInfo:nil] raise];
+    }
+    
+    // Fetch all children, in chunks to stay below the
+    // maximum number of parameters of a statement
+    
+    NSUInteger prefixLength = [name length] + 1;
+    
+    for (NSUInteger offset = 0; offset < [fullNames count]; offset += 500) {
+        NSArray *chunk = [fullNames subarrayWithRange:NSMakeRange(offset, MIN(500, [fullNames count] - offset))];
+        
+        NSMutableArray *placeholders = [NSMutableArray arrayWithCapacity:[chunk count]];
+        for (NSUInteger i = 0; i < [chunk count]; i++) {
+            [placeholders addObject:@"?"];
+        }
+        
+        NSString *sql = [NSString stringWithFormat:@"SELECT id, name FROM txl_context WHERE name IN (%@)", [placeholders componentsJoinedByString:@", "]];
+        
+        BOOL success = [database executeSQL:sql
+                             withParameters:chunk
+                                      error:&error
+                              resultHandler:^(NSDictionary *row, BOOL *stop){
+                                  NSUInteger pk = [[row objectForKey:@"id"] integerValue];
+                                  NSString *n = [row objectForKey:@"name"];
+                                  [result setObject:[[[TXLContext alloc] initContextWithPrimaryKey:pk
+                                                                                              name:n] autorelease]
+                                             forKey:[n substringFromIndex:prefixLength]];
+                              }];
+        if (!success) {
+            [[NSException exceptionWithName:@"TXLContextException"
+                                     reason:[error localizedDescription]
+                                   userInfo:nil] raise];
+        }
+    }
+    
+    return result;
+}
+
 #pragma mark -
 #pragma mark Update Context
 
@@ -22,8 +22,10 @@
 //
 
 #import "TXLManager.h"
+#import "TXLMovingObject.h"
 
 @class TXLRevision;
+@class TXLContext;
 
 @interface TXLManager (Importer)
 
@@ -60,4 +62,42 @@
                                    error:(NSError **)error
                          completionBlock:(void(^)(TXLRevision *, NSError *))block __attribute__ ((deprecated));
 
+#pragma mark -
+#pragma mark Bulk Ingest
+
+/*!
+ * Import Spatial Situations from files in bulk
+ * 
+ * This method imports the spatial situations of all files in one revision
+ * (see ingestOperations:withCompletionBlock:). It is intended for the initial
+ * load of large data sets. If one of the files can not be read or compiled,
+ * nothing is imported and the error is passed to the completion block.
+ */
+- (void)ingestSpatialSituationsFromFilesAtPaths:(NSArray *)paths
+                                 inIntervalFrom:(NSDate *)from
+                                             to:(NSDate *)to
+                                completionBlock:(void(^)(TXLRevision *, NSError *))block;
+
+#pragma mark -
+#pragma mark Trajectories
+
+/*!
+ * Ingest a trajectory
+ * 
+ * This method updates the context with the statements, which are valid along the
+ * trajectory given by the packed array of samples (see TXLTrajectorySample). The
+ * samples must have ascending timestamps and are copied before the method returns.
+ * The moving object of the situation and its snapshots are created and stored
+ * directly from the samples (see +[TXLMovingObject movingObjectWithSamples:count:]),
+ * no object is created for a single sample.
+ * 
+ * The statements in the context are replaced in the interval from the first to the
+ * last sample. The update is scheduled with the priority TXLSchedulerPriorityContinuous.
+ */
+- (void)ingestTrajectoryWithSamples:(const TXLTrajectorySample *)samples
+                              count:(NSUInteger)count
+                         statements:(NSArray *)statements
+                          inContext:(TXLContext *)context
+                    completionBlock:(void(^)(TXLRevision *, NSError *))block;
+
 @end
@@ -50,6 +50,7 @@
                                                                               to:to];
     
     [[TXLManager sharedManager] applyOperations:[NSArray arrayWithObject:op]
+                                       priority:TXLSchedulerPriorityBackfill
                             withCompletionBlock:block];
     return YES;
 }
@@ -88,4 +89,55 @@
 	}
 }
 
+#pragma mark -
+#pragma mark Bulk Ingest
+
+- (void)ingestSpatialSituationsFromFilesAtPaths:(NSArray *)paths
+                                 inIntervalFrom:(NSDate *)from
+                                             to:(NSDate *)to
+                                completionBlock:(void(^)(TXLRevision *, NSError *))block {
+    
+    NSMutableArray *operations = [NSMutableArray arrayWithCapacity:[paths count]];
+    for (NSString *path in paths) {
+        [operations addObject:[TXLManagerImportOperation operationWithPath:path
+                                                              intervalFrom:from
+                                                                        to:to]];
+    }
+    
+    [self ingestOperations:operations
+       withCompletionBlock:block];
+}
+
+#pragma mark -
+#pragma mark Trajectories
+
+- (void)ingestTrajectoryWithSamples:(const TXLTrajectorySample *)samples
+                              count:(NSUInteger)count
+                         statements:(NSArray *)statements
+                          inContext:(TXLContext *)context
+                    completionBlock:(void(^)(TXLRevision *, NSError *))block {
+    
+    if (count == 0) {
+        [NSException raise:NSInvalidArgumentException
+                    format:@"A trajectory needs at least one sample."];
+    }
+    
+    TXLMovingObject *mo = [TXLMovingObject movingObjectWithSamples:samples
+                                                             count:count];
+    
+    TXLSituation *situation = [TXLSituation situationWithStatements:statements
+                                               movingObjectSequence:[TXLMovingObjectSequence sequenceWithMovingObject:mo]];
+    
+    // The moving object lies completely in the interval of the update
+    // and is therefore not masked (copied) by the writer.
+    TXLManagerUpdateOperation *op = [TXLManagerUpdateOperation operationForContext:context
+                                                                     withSituation:situation
+                                                                    inIntervalFrom:mo.begin
+                                                                                to:mo.end];
+    
+    [self applyOperations:[NSArray arrayWithObject:op]
+                 priority:TXLSchedulerPriorityContinuous
+      withCompletionBlock:block];
+}
+
 @end
@@ -24,6 +24,8 @@
 #import <Foundation/Foundation.h>
 #import <dispatch/dispatch.h>
 
+#import "TXLScheduler.h"
+
 extern NSString * const TXLManagerErrorDomain;
 
 #define TXL_MANAGER_ERROR_NOT_IMPLEMENTED 1
@@ -31,13 +33,18 @@ extern NSString * const TXLManagerErrorDomain;
 #define TXL_MANAGER_ERROR_REMOTE_BINDING 3
 #define TXL_MANAGER_ERROR_EXISTS 4
 #define TXL_MANAGER_ERROR_NOT_EXISTS 5
+#define TXL_MANAGER_ERROR_OUT_OF_ORDER 6
 
 @class TXLManager;
 @class TXLRevision;
 @class TXLContext;
 @class TXLMovingObject;
+@class TXLGeometryCollection;
 @class TXLQueryHandle;
 @class TXLDatabase;
+@class TXLMatchNetwork;
+@class TXLSubscriptionIndex;
+@class TXLQueryPlan;
 
 
 #pragma mark -
@@ -55,6 +62,25 @@ extern NSString * const TXLManagerErrorDomain;
     int processing_counter;
     dispatch_queue_t manager_queue;
     dispatch_group_t manager_group;
+    TXLScheduler *scheduler;
+    
+    TXLMatchNetwork *matchNetwork;
+    TXLSubscriptionIndex *subscriptionIndex;
+    
+    // query primary key -> compiled plan of the query
+    NSMutableDictionary *queryPlans;
+    
+    // query primary key -> serial queue for the evaluations of the query
+    NSMutableDictionary *queryQueues;
+    
+    // query primary key -> evaluation of the query, which has been
+    // scheduled but not yet started (revision, activation, skipped revisions)
+    NSMutableDictionary *pendingEvaluations;
+    NSUInteger skipped_evaluations;
+    
+    // query primary key -> level of the situation definition in the
+    // dependency graph of the definitions (nil if not yet computed)
+    NSDictionary *definitionLevels;
 }
 
 #pragma mark -
@@ -76,6 +102,42 @@ extern NSString * const TXLManagerErrorDomain;
  */
 @property (readonly, getter=isProcessing) BOOL processing;
 
+/*! Number of query evaluations, which have been scheduled
+ *  but not yet started.
+ *
+ *  At most one evaluation per query is pending. If the query
+ *  has to be evaluated for a newer revision before the pending
+ *  evaluation has been started, the pending evaluation is moved
+ *  forward to the newer revision.
+ */
+@property (readonly) NSUInteger numberOfPendingEvaluations;
+
+/*! Number of query evaluations, which have been skipped,
+ *  because they were coalesced with the evaluation of a
+ *  later revision or the query had already been evaluated
+ *  in a later revision.
+ *
+ *  The result set of a query in a skipped revision is the result
+ *  set of the preceding evaluated revision (see TXLResultSet).
+ */
+@property (readonly) NSUInteger numberOfSkippedEvaluations;
+
+#pragma mark -
+#pragma mark Scheduling
+
+/*! Scheduler of the manager.
+ *
+ *  The updates of the contexts are executed one after another by
+ *  this scheduler in the order of their priority classes (see TXLScheduler).
+ *  The evaluations of the queries are executed concurrently, the first
+ *  evaluations with a lower priority than the continuous evaluations.
+ *
+ *  The scheduler provides the number of waiting tasks and the wait time
+ *  for each priority class (updates and evaluations) and the deadlines of
+ *  the priority classes can be adjusted.
+ */
+@property (readonly) TXLScheduler *scheduler;
+
 #pragma mark -
 #pragma mark -
 #pragma mark Accessing Contexts
@@ -149,9 +211,61 @@ extern NSString * const TXLManagerErrorDomain;
                    to:(NSDate *)to
       completionBlock:(void(^)(TXLRevision *, NSError *))block;
 
+/*! Extend the trajectories of statements.
+ *
+ *  This method advances the statements by one position, e.g., a live
+ *  track by a new position report. A snapshot is appended to the
+ *  open-ended moving object (without end) of each statement in the
+ *  context, so that the statement is valid in the geometry from the
+ *  timestamp on. If the statement has no open-ended moving object yet,
+ *  it is created. If the geometry did not change, the statement is not
+ *  changed at all.
+ *
+ *  In contrast to updateContext:withStatements:movingObject:inIntervalFrom:to:completionBlock:
+ *  other statements in the context are not removed, and the statements
+ *  are neither removed nor created again. The revision only records the
+ *  extended statements with the timestamp (txl_statement_extended). If
+ *  the moving object is also used by other statements, it is closed at
+ *  the timestamp and the statement is created again instead.
+ *
+ *  The timestamp must be after the last position of the statement,
+ *  otherwise the completion block is called with an error
+ *  (TXL_MANAGER_ERROR_OUT_OF_ORDER) and nothing is changed.
+ *
+ *  The operation is executed with the priority TXLSchedulerPriorityContinuous.
+ */
+- (void)extendContext:(TXLContext *)ctx
+       withStatements:(NSArray *)statements
+           toGeometry:(TXLGeometryCollection *)geometry
+          atTimestamp:(NSDate *)timestamp
+      completionBlock:(void(^)(TXLRevision *, NSError *))block;
+
+/*! Apply the update operations in one revision with the
+ *  priority TXLSchedulerPriorityInteractive.
+ */
 - (void)applyOperations:(NSArray *)operations
     withCompletionBlock:(void(^)(TXLRevision *, NSError *))block;
 
+/*! Apply the update operations in one revision with the given priority.
+ */
+- (void)applyOperations:(NSArray *)operations
+               priority:(TXLSchedulerPriority)priority
+    withCompletionBlock:(void(^)(TXLRevision *, NSError *))block;
+
+/*! Bulk ingest.
+ *
+ *  This method applies the update operations in one revision like
+ *  applyOperations:withCompletionBlock:, but is intended for the
+ *  initial load of large data sets. All changes are written in one
+ *  transaction, the indexes of the statements only used by the
+ *  queries are rebuilt once at the end, and the continuous queries
+ *  are evaluated once for the new revision.
+ *
+ *  The operations are executed with the priority TXLSchedulerPriorityBackfill.
+ */
+- (void)ingestOperations:(NSArray *)operations
+     withCompletionBlock:(void(^)(TXLRevision *, NSError *))block;
+
 #pragma mark -
 #pragma mark Situation Definition
 
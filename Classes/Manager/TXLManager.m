@@ -37,13 +37,20 @@
 
 #import "TXLManagerUpdateOperation.h"
 #import "TXLManagerImportOperation.h"
+#import "TXLManagerExtendOperation.h"
 #import "TXLSpatialSituationImporter.h"
+#import "TXLManagerImportCompilation.h"
 
 #import "TXLSPARQLCompiler.h"
 #import "TXLQuery.h"
 #import "TXLQueryHandle.h"
 #import "TXLResultSet.h"
 #import "TXLGraphPattern.h"
+#import "TXLMatchNetwork.h"
+#import "TXLSubscriptionIndex.h"
+#import "TXLQueryPlan.h"
+#import "TXLBindingArena.h"
+#import "TXLSituationCascade.h"
 
 #import "TXLManagerDelegateProtocol.h"
 #import <spatialite/sqlite3.h>
@@ -57,6 +64,17 @@ NSString * const TXLManagerErrorDomain = @"org.opentxl.TXLManagerErrorDomain";
 
 static TXLManager *sharedTXLManager = nil;
 
+// Value of a term of the construct template for a row of the resultset.
+static TXLTerm * TXLTemplateTermValue(TXLTemplateTerm t, NSDictionary *row, NSArray *blankNodes) {
+    if (t.term > 0) {
+        return [TXLTerm termWithPrimaryKey:t.term];
+    }
+    if (t.blankNode >= 0) {
+        return [blankNodes objectAtIndex:t.blankNode];
+    }
+    return [TXLTerm termWithPrimaryKey:[[row objectForKey:[NSString stringWithFormat:@"var_%d", t.variable]] integerValue]];
+}
+
 #pragma mark -
 #pragma mark -
 
@@ -84,14 +102,57 @@ static TXLManager *sharedTXLManager = nil;
 #pragma mark Evaluate Queries
 
 - (void)evaluateQuery:(TXLQuery *)query
-           atRevision:(TXLRevision *)rev;
+           atRevision:(TXLRevision *)rev
+             priority:(TXLSchedulerPriority)priority;
+
+- (void)evaluateQuery:(TXLQuery *)query
+           atRevision:(TXLRevision *)rev
+           activation:(NSDictionary *)activation
+             priority:(TXLSchedulerPriority)priority;
+
+- (void)evaluateQuery:(TXLQuery *)query
+           atRevision:(TXLRevision *)rev
+           activation:(NSDictionary *)activation
+             priority:(TXLSchedulerPriority)priority
+              cascade:(TXLSituationCascade *)cascade;
 
 - (void)evaluateQueriesForContexts:(NSSet *)ctxs
-                        atRevision:(TXLRevision *)rev;
+                   withActivations:(NSDictionary *)activations
+                        atRevision:(TXLRevision *)rev
+                           cascade:(TXLSituationCascade *)cascade;
 
 - (void)evaluateQueriesForContext:(TXLContext *)ctx
                        atRevision:(TXLRevision *)rev;
 
+- (TXLQueryPlan *)planForQuery:(TXLQuery *)query;
+- (void)discardPlanForQuery:(TXLQuery *)query;
+
+- (dispatch_queue_t)queueForQuery:(TXLQuery *)query;
+- (void)discardQueueForQuery:(TXLQuery *)query;
+
+- (void)markRevisions:(NSArray *)revisions asSkippedForQuery:(TXLQuery *)query;
+
+#pragma mark -
+#pragma mark Cascading Situation Definitions
+
+- (NSDictionary *)levelsOfSituationDefinitions;
+- (void)discardLevelsOfSituationDefinitions;
+
+- (void)propagateCascade:(TXLSituationCascade *)cascade
+              atRevision:(TXLRevision *)rev;
+
+- (void)applyOperations:(NSArray *)operations
+               priority:(TXLSchedulerPriority)priority
+                cascade:(TXLSituationCascade *)cascade
+                   bulk:(BOOL)bulk
+    withCompletionBlock:(void(^)(TXLRevision *, NSError *))block;
+
+#pragma mark -
+#pragma mark Bulk Ingest
+
+- (NSArray *)dropIndexesForBulkIngest:(NSError **)error;
+- (BOOL)createIndexes:(NSArray *)statements error:(NSError **)error;
+
 
 #pragma mark -
 #pragma mark Updating Context
@@ -110,6 +171,12 @@ static TXLManager *sharedTXLManager = nil;
                              inContext:(TXLContext *)ctx
                             applyBlock:(void(^)(TXLInteger *pk, TXLTerm *subject, TXLTerm *predicate, TXLTerm *object))block;
 
+- (BOOL)extendStatementsWithOperation:(TXLManagerExtendOperation *)op
+                    createdStatements:(NSMutableSet *)created
+                    removedStatements:(NSMutableSet *)removed
+                   extendedStatements:(NSMutableArray *)extended
+                                error:(NSError **)error;
+
 - (BOOL)statement:(TXLStatement *)stmnt
  withMovingObject:(TXLMovingObject *)mo
    isInStatements:(NSArray *)stmnts
@@ -136,6 +203,7 @@ isEqualToStatement:(TXLStatement *)stmnt2
 @synthesize delegate;
 @synthesize database;
 @synthesize processing;
+@synthesize scheduler;
 
 #pragma mark -
 #pragma mark Shared Manager
@@ -215,14 +283,32 @@ isEqualToStatement:(TXLStatement *)stmnt2
         
         manager_queue = dispatch_queue_create("org.opentxl.manager", NULL);
         manager_group = dispatch_group_create();
+        scheduler = [[TXLScheduler alloc] initWithQueue:manager_queue
+                                                  group:manager_group];
+        
+        matchNetwork = [[TXLMatchNetwork alloc] init];
+        subscriptionIndex = [[TXLSubscriptionIndex alloc] init];
+        queryPlans = [[NSMutableDictionary alloc] init];
+        queryQueues = [[NSMutableDictionary alloc] init];
+        pendingEvaluations = [[NSMutableDictionary alloc] init];
     }
     return self;
 }
 
 - (void)dealloc {
     dispatch_group_wait(manager_group, DISPATCH_TIME_FOREVER);
+    [scheduler release];
     dispatch_release(manager_queue);
     dispatch_release(manager_group);
+    [matchNetwork release];
+    [subscriptionIndex release];
+    [queryPlans release];
+    for (NSValue *queue in [queryQueues allValues]) {
+        dispatch_release([queue pointerValue]);
+    }
+    [queryQueues release];
+    [pendingEvaluations release];
+    [definitionLevels release];
     [database release];
     [super dealloc];
 }
@@ -364,6 +450,9 @@ isEqualToStatement:(TXLStatement *)stmnt2
         return nil;
     }
     
+    [matchNetwork addQuery:query];
+    [subscriptionIndex addQuery:query];
+    
     
     // Trigger first evaluation for this query
     // --------------------------------------------------------------
@@ -373,7 +462,8 @@ isEqualToStatement:(TXLStatement *)stmnt2
     if (head != nil) {
         dispatch_async(dispatch_get_global_queue(0, 0), ^{
             [self evaluateQuery:query
-                     atRevision:head];
+                     atRevision:head
+                       priority:TXLSchedulerPriorityBackfill];
         }); 
     }
     
@@ -396,10 +486,28 @@ isEqualToStatement:(TXLStatement *)stmnt2
     
     NSError *error;
     
+    __block NSUInteger pk = 0;
+    
+    [self.database executeSQL:@"SELECT query_id FROM txl_query_name WHERE name = ?"
+               withParameters:[NSArray arrayWithObject:name]
+                        error:&error
+                resultHandler:^(NSDictionary *row, BOOL *stop){
+                    pk = [[row objectForKey:@"query_id"] integerValue];
+                    *stop = YES;
+                }];
+    
     [self.database executeSQL:@"DELETE FROM txl_query_name WHERE name = ?"
                withParameters:[NSArray arrayWithObject:name]
                         error:&error
                 resultHandler:^(NSDictionary *row, BOOL *stop){}];
+    
+    if (pk != 0) {
+        TXLQuery *query = [TXLQuery queryWithPrimaryKey:pk];
+        [matchNetwork removeQuery:query];
+        [subscriptionIndex removeQuery:query];
+        [self discardPlanForQuery:query];
+        [self discardQueueForQuery:query];
+    }
 }
 
 - (TXLQueryHandle *)queryWithName:(NSString *)name
@@ -496,18 +604,77 @@ isEqualToStatement:(TXLStatement *)stmnt2
     
 }
 
+- (void)extendContext:(TXLContext *)ctx
+       withStatements:(NSArray *)statements
+           toGeometry:(TXLGeometryCollection *)geometry
+          atTimestamp:(NSDate *)timestamp
+      completionBlock:(void(^)(TXLRevision *, NSError *))block {
+    
+    TXLManagerExtendOperation *op = [TXLManagerExtendOperation operationForContext:ctx
+                                                                    withStatements:statements
+                                                                         timestamp:timestamp
+                                                                          geometry:geometry];
+    
+    [self applyOperations:[NSArray arrayWithObject:op]
+                 priority:TXLSchedulerPriorityContinuous
+      withCompletionBlock:block];
+}
+
+- (void)applyOperations:(NSArray *)operations
+    withCompletionBlock:(void(^)(TXLRevision *, NSError *))block {
+    [self applyOperations:operations
+                 priority:TXLSchedulerPriorityInteractive
+      withCompletionBlock:block];
+}
+
+- (void)applyOperations:(NSArray *)operations
+               priority:(TXLSchedulerPriority)priority
+    withCompletionBlock:(void(^)(TXLRevision *, NSError *))block {
+    [self applyOperations:operations
+                 priority:priority
+                  cascade:nil
+                     bulk:NO
+      withCompletionBlock:block];
+}
+
+- (void)ingestOperations:(NSArray *)operations
+     withCompletionBlock:(void(^)(TXLRevision *, NSError *))block {
+    [self applyOperations:operations
+                 priority:TXLSchedulerPriorityBackfill
+                  cascade:nil
+                     bulk:YES
+      withCompletionBlock:block];
+}
+
 - (void)applyOperations:(NSArray *)operations
+               priority:(TXLSchedulerPriority)priority
+                cascade:(TXLSituationCascade *)cascade
+                   bulk:(BOOL)bulk
     withCompletionBlock:(void(^)(TXLRevision *, NSError *))block {
-    // Dispatch the operation to update the context on the
-    // global concurrent queue.
+    // Schedule the operations to update the contexts. The
+    // updates are executed one after another in the order
+    // of their priority (see TXLScheduler). Updates of the
+    // same context are not reordered. The contexts of an
+    // import are not known before the file is compiled, it
+    // is not reordered with any other update.
     //NSLog(@"Scheduling update for context: %@", ctx);
     
+    NSMutableSet *contexts = [NSMutableSet setWithCapacity:[operations count]];
+    for (id _op in operations) {
+        if ([_op isKindOfClass:[TXLManagerImportOperation class]]) {
+            contexts = nil;
+            break;
+        }
+        TXLContext *ctx = [_op isKindOfClass:[TXLManagerExtendOperation class]] ? [(TXLManagerExtendOperation *)_op context] : [(TXLManagerUpdateOperation *)_op context];
+        [contexts addObject:[TXLInteger integerWithValue:ctx.primaryKey]];
+    }
+    
     // ------------------------------------------------
     // Notify the delegate that the processing starts
     
     [self increaseProcessingCounter];
     
-    dispatch_group_async(manager_group, manager_queue, ^{
+    [scheduler scheduleBlock:^{
         
         NSError *error = nil;
         TXLRevision *revision = nil;
@@ -516,8 +683,96 @@ isEqualToStatement:(TXLStatement *)stmnt2
         NSMutableSet *removedStatements = [NSMutableSet set];
         NSMutableSet *updatedContexts = [NSMutableSet set];
         
+        // The snapshots appended by the extend operations are written
+        // in the transaction of the revision (see below).
+        NSMutableArray *extendedStatements = [NSMutableArray array];
+        
+        // In bulk mode all changes including the new revision are
+        // written in one transaction. The indexes only used by the
+        // evaluation of the queries are dropped at the beginning and
+        // rebuilt before the transaction is committed. A rollback
+        // restores them.
+        
+        NSArray *deferredIndexes = nil;
+        
+        // The files of the import operations are compiled concurrently.
+        // The compilations are taken below in the order of the operations,
+        // so that the changes are written in the same order as before.
+        // Each compilation is applied as soon as it has finished and its
+        // result is released afterwards. The compilations do not write
+        // to the database, the contexts are created by the writer (in
+        // bulk mode in the transaction).
+        
+        NSMutableArray *compilations = [NSMutableArray array];
+        for (id _op in operations) {
+            if ([_op isKindOfClass:[TXLManagerImportOperation class]]) {
+                [compilations addObject:[TXLManagerImportCompilation compilationOfFileAtPath:[(TXLManagerImportOperation *)_op path]]];
+            }
+        }
+        NSUInteger nextCompilation = 0;
+        
+        if (bulk) {
+            if ([self.database beginTransaction:&error] == NO) {
+                block(nil, error);
+                [self decreaseProcessingCounter];
+                return;
+            }
+            deferredIndexes = [self dropIndexesForBulkIngest:&error];
+            if (deferredIndexes == nil) {
+                [self.database rollback:&error];
+                block(nil, error);
+                [self decreaseProcessingCounter];
+                return;
+            }
+        }
+        
         for (id _op in operations) {
             
+            if ([_op isKindOfClass:[TXLManagerExtendOperation class]]) {
+                
+                // Extend the trajectories of the statements. Only the
+                // open-ended moving objects of these statements are
+                // extended, the rest of the context is not touched.
+                
+                NSAutoreleasePool *pool = [NSAutoreleasePool new];
+                
+                NSMutableSet *_createdStatements = [NSMutableSet set];
+                NSMutableSet *_removedStatements = [NSMutableSet set];
+                NSUInteger numberOfExtendedStatements = [extendedStatements count];
+                
+                TXLManagerExtendOperation *eop = _op;
+                if (![self extendStatementsWithOperation:eop
+                                       createdStatements:_createdStatements
+                                       removedStatements:_removedStatements
+                                      extendedStatements:extendedStatements
+                                                   error:&error]) {
+                    if (bulk) {
+                        [self.database rollback:nil];
+                    }
+                    block(nil, error);
+                    [pool drain];
+                    [self decreaseProcessingCounter];
+                    return;
+                }
+                
+                if ([_createdStatements count] > 0 ||
+                    [_removedStatements count] > 0 ||
+                    [extendedStatements count] > numberOfExtendedStatements) {
+                    [updatedContexts addObject:eop.context];
+                }
+                
+                [createdStatements unionSet:_createdStatements];
+                [removedStatements unionSet:_removedStatements];
+                
+                [pool drain];
+                continue;
+            }
+            
+            // The pool also releases the result of a compilation,
+            // when the import operation has been applied.
+            
+            NSAutoreleasePool *pool = [NSAutoreleasePool new];
+            
             TXLManagerUpdateOperation *op = nil;
             
             if ([_op isKindOfClass:[TXLManagerUpdateOperation class]]) {
@@ -526,27 +781,27 @@ isEqualToStatement:(TXLStatement *)stmnt2
                 
                 TXLManagerImportOperation *iop = _op;
                 
-                NSString *expression = [NSString stringWithContentsOfFile:iop.path 
-                                                                 encoding:NSUTF8StringEncoding
+                TXLManagerImportCompilation *compilation = [compilations objectAtIndex:nextCompilation];
+                nextCompilation++;
+                
+                NSDictionary *result = [compilation takeResult:&error];
+                
+                TXLContext *context = nil;
+                if (result != nil) {
+                    context = [TXLSpatialSituationImporter contextWithURL:[result objectForKey:@"context_url"]
                                                                     error:&error];
-                if (expression == nil) {
-                    block(revision, error);
-                    [self decreaseProcessingCounter];
-                    return;
                 }
                 
-                NSDictionary *result = [TXLSpatialSituationImporter compileSpatialSituationWithExpression:expression 
-                                                                                               parameters:nil
-                                                                                                  options:nil
-                                                                                                    error:&error];
-                
-                if (result == nil) {
+                if (context == nil) {
+                    if (bulk) {
+                        [self.database rollback:nil];
+                    }
                     block(revision, error);
+                    [pool drain];
                     [self decreaseProcessingCounter];
                     return;
                 } else {
 
-                    TXLContext *context = [result objectForKey:@"context"];
                     TXLMovingObject *mo = [result objectForKey:@"moving_object"];
                     NSArray *statements = [result objectForKey:@"statement_list"];
                     
@@ -562,8 +817,6 @@ isEqualToStatement:(TXLStatement *)stmnt2
                 }
             }
             
-            NSAutoreleasePool *pool = [NSAutoreleasePool new];
-            
             NSMutableSet *_createdStatements = [NSMutableSet set];
             NSMutableSet *_removedStatements = [NSMutableSet set];
             
@@ -602,6 +855,9 @@ isEqualToStatement:(TXLStatement *)stmnt2
             }
             
             if ([mos_ save:&error] == nil) {
+                if (bulk) {
+                    [self.database rollback:nil];
+                }
                 block(nil, error);
                 [pool drain];
                 [self decreaseProcessingCounter];
@@ -755,10 +1011,11 @@ isEqualToStatement:(TXLStatement *)stmnt2
         // Do the actual modification of the contexts state, 
 		// if there is a change to apply.
         if(([createdStatements count] > 0) || 
-           ([removedStatements count] > 0) ){
+           ([removedStatements count] > 0) ||
+           ([extendedStatements count] > 0) ){
             
-			// Start a transaction.
-			if ([self.database beginTransaction:&error] == NO) {
+			// Start a transaction (in bulk mode already started).
+			if (!bulk && [self.database beginTransaction:&error] == NO) {
 				block(nil, error);
                 [self decreaseProcessingCounter];
 				return;
@@ -800,6 +1057,31 @@ isEqualToStatement:(TXLStatement *)stmnt2
                 }
             }
             
+            // Append the snapshots of the extended statements and
+            // record the statements as extended in the new revision.
+            
+            for (NSDictionary *extension in extendedStatements) {
+                NSDate *timestamp = [extension objectForKey:@"timestamp"];
+                if (![[extension objectForKey:@"moving_object"] appendSnapshotWithTimestamp:timestamp
+                                                                                   geometry:[extension objectForKey:@"geometry"]
+                                                                                      error:&error] ||
+                    [self.database executeSQLWithParameters:@"INSERT INTO txl_statement_extended (statement_id, revision_id, timestamp) VALUES (?, ?, ?)" error:&error,
+                     [extension objectForKey:@"statement_id"], revPk, [NSNumber numberWithDouble:[timestamp timeIntervalSince1970]], nil] == nil) {
+                    [self.database rollback:nil];
+                    block(nil, error);
+                    [self decreaseProcessingCounter];
+                    return;
+                }
+            }
+            
+            // Rebuild the indexes dropped for the bulk ingest.
+            if (bulk && [self createIndexes:deferredIndexes error:&error] == NO) {
+                [self.database rollback:nil];
+                block(nil, error);
+                [self decreaseProcessingCounter];
+                return;
+            }
+            
 			// Commit the transaction.
 			if ([self.database commit:&error] == NO) {
 				block(nil, error);
@@ -814,13 +1096,20 @@ isEqualToStatement:(TXLStatement *)stmnt2
 			
 			// ----------------------------------------
 			
+			// Propagate the changed statements through the match
+			// network, to find the queries affected by this revision.
+			
+			NSDictionary *activations = [matchNetwork activationsForRevision:revision];
+			
 			// Notify the internal function who's responsible
 			// for the evaluation of the continuous queries.
 			
             //NSLog(@"Updated contexts (rev=%@): %@", revision, updatedContexts);
             
 			[self evaluateQueriesForContexts:updatedContexts
-								  atRevision:revision];
+			                 withActivations:activations
+								  atRevision:revision
+									 cascade:cascade];
 			
 			// Call the delegate method to notify about the change.
 			
@@ -829,9 +1118,20 @@ isEqualToStatement:(TXLStatement *)stmnt2
 			}	
             
         } else {
+            // Nothing changed, the rollback restores the dropped indexes.
+            if (bulk) {
+                [self.database rollback:nil];
+            }
+            
             if(revision == nil){
 				revision = [[TXLManager sharedManager] headRevision];
 			}
+            
+            // Nothing changed, continue with the next level
+            // of the cascade in the current revision.
+            if (cascade != nil) {
+                [self propagateCascade:cascade atRevision:revision];
+            }
         }
         
         // ----------------------------------------
@@ -839,7 +1139,43 @@ isEqualToStatement:(TXLStatement *)stmnt2
         
         block(revision, error);
         [self decreaseProcessingCounter];
-    });
+    } withPriority:priority
+            contexts:contexts];
+}
+
+#pragma mark -
+#pragma mark Bulk Ingest
+
+- (NSArray *)dropIndexesForBulkIngest:(NSError **)error {
+    
+    // The indexes of the statements by subject, predicate and object
+    // are only used by the evaluation of the queries, which takes place
+    // after the bulk ingest. The index by context is used to find the
+    // existing statements of a context and is kept.
+    
+    NSArray *indexes = [self.database executeSQL:@"SELECT name, sql FROM sqlite_master WHERE type = 'index' AND name IN ('txl_statement_subject_id', 'txl_statement_predicate_id', 'txl_statement_object_id')"
+                                           error:error];
+    if (indexes == nil) {
+        return nil;
+    }
+    
+    for (NSDictionary *index in indexes) {
+        if ([self.database executeSQL:[NSString stringWithFormat:@"DROP INDEX %@", [index objectForKey:@"name"]]
+                                error:error] == nil) {
+            return nil;
+        }
+    }
+    
+    return [indexes valueForKey:@"sql"];
+}
+
+- (BOOL)createIndexes:(NSArray *)statements error:(NSError **)error {
+    for (NSString *sql in statements) {
+        if ([self.database executeSQL:sql error:error] == nil) {
+            return NO;
+        }
+    }
+    return YES;
 }
 
 #pragma mark -
@@ -878,6 +1214,10 @@ isEqualToStatement:(TXLStatement *)stmnt2
     if (!success)
         return NO;
     
+    [matchNetwork addQuery:query];
+    [subscriptionIndex addQuery:query];
+    [self discardLevelsOfSituationDefinitions];
+    
     
     // Trigger the first evaluation of this query
     // ----------------------------------------------------
@@ -887,7 +1227,8 @@ isEqualToStatement:(TXLStatement *)stmnt2
     if (head != nil) {
         dispatch_async(dispatch_get_global_queue(0, 0), ^{
             [self evaluateQuery:query
-                     atRevision:head];
+                     atRevision:head
+                       priority:TXLSchedulerPriorityBackfill];
         }); 
     }
     
@@ -900,7 +1241,30 @@ isEqualToStatement:(TXLStatement *)stmnt2
     // ----------------------------------------------------
     
     NSError *error;
-    BOOL success = [self.database executeSQL:@"DELETE FROM txl_context_query WHERE context_id = ?"
+    
+    __block NSUInteger pk = 0;
+    BOOL success = [self.database executeSQL:@"SELECT query_id FROM txl_context_query WHERE context_id = ?"
+                              withParameters:[NSArray arrayWithObject:[TXLInteger integerWithValue:context.primaryKey]]
+                                       error:&error
+                               resultHandler:^(NSDictionary *row, BOOL *stop){
+                                   pk = [[row objectForKey:@"query_id"] integerValue];
+                                   *stop = YES;
+                               }];
+    if (!success) {
+        [[NSException exceptionWithName:@"TXLContextException"
+                                 reason:[error localizedDescription]
+                               userInfo:nil] raise];
+    }
+    
+    if (pk != 0) {
+        TXLQuery *query = [TXLQuery queryWithPrimaryKey:pk];
+        [matchNetwork removeQuery:query];
+        [subscriptionIndex removeQuery:query];
+        [self discardPlanForQuery:query];
+        [self discardQueueForQuery:query];
+    }
+    
+    success = [self.database executeSQL:@"DELETE FROM txl_context_query WHERE context_id = ?"
                               withParameters:[NSArray arrayWithObject:[TXLInteger integerWithValue:context.primaryKey]]
                                        error:&error
                                resultHandler:^(NSDictionary *row, BOOL *stop){}];
@@ -910,18 +1274,35 @@ isEqualToStatement:(TXLStatement *)stmnt2
                                userInfo:nil] raise];
     }  
     
+    [self discardLevelsOfSituationDefinitions];
+    
     // Clear all sub contexts which are created via an evaluation
-    // of the current situation definition
+    // of the current situation definition. This is done with
+    // the priority TXLSchedulerPriorityMaintenance. If the definition
+    // is set again, the updates of these contexts by the new definition
+    // are executed after the clear (see TXLScheduler).
     // ----------------------------------------------------
     
-    for (TXLContext *ctx in [context subcontextsMatchingPattern:@"#"]) {
-        [ctx clear:^(TXLRevision *rev, NSError *error){
-            if (rev == nil) {
-                [[NSException exceptionWithName:@"TXLContextException"
-                                         reason:[error localizedDescription]
-                                       userInfo:nil] raise];
-            }
-        }];        
+    NSMutableArray *operations = [NSMutableArray array];
+    for (TXLContext *ctx in [context subcontextsMatchingPattern:@"#*"]) {
+        TXLSituation *situation = [TXLSituation situationWithStatements:nil
+                                                   movingObjectSequence:[TXLMovingObjectSequence sequenceWithMovingObject:[TXLMovingObject omnipresentMovingObject]]];
+        [operations addObject:[TXLManagerUpdateOperation operationForContext:ctx
+                                                               withSituation:situation
+                                                              inIntervalFrom:nil
+                                                                          to:nil]];
+    }
+    
+    if ([operations count] > 0) {
+        [self applyOperations:operations
+                     priority:TXLSchedulerPriorityMaintenance
+          withCompletionBlock:^(TXLRevision *rev, NSError *error){
+              if (rev == nil) {
+                  [[NSException exceptionWithName:@"TXLContextException"
+                                           reason:[error localizedDescription]
+                                         userInfo:nil] raise];
+              }
+          }];
     }
 }
 
@@ -1097,6 +1478,13 @@ isEqualToStatement:(TXLStatement *)stmnt2
     SQL_ON_ERROR_RETURN(@"CREATE INDEX IF NOT EXISTS txl_statement_removed_statement_id ON txl_statement_removed (statement_id)");
     SQL_ON_ERROR_RETURN(@"CREATE INDEX IF NOT EXISTS txl_statement_removed_revision_id ON txl_statement_removed (revision_id)");
     
+    // Statements, whose moving object has been extended in a revision
+    // (see extendContext:...), with the timestamp of the new snapshot.
+    SQL_ON_ERROR_RETURN(@"CREATE TABLE IF NOT EXISTS txl_statement_extended ( id integer NOT NULL PRIMARY KEY, statement_id integer NOT NULL REFERENCES txl_statement (id), revision_id integer NOT NULL REFERENCES txl_revision (id), timestamp)");
+    
+    SQL_ON_ERROR_RETURN(@"CREATE INDEX IF NOT EXISTS txl_statement_extended_statement_id ON txl_statement_extended (statement_id)");
+    SQL_ON_ERROR_RETURN(@"CREATE INDEX IF NOT EXISTS txl_statement_extended_revision_id ON txl_statement_extended (revision_id)");
+    
     return YES;
 }
 
@@ -1119,6 +1507,15 @@ isEqualToStatement:(TXLStatement *)stmnt2
     SQL_ON_ERROR_RETURN(@"CREATE INDEX IF NOT EXISTS txl_query_first_evaluation ON txl_query (first_evaluation)");
     SQL_ON_ERROR_RETURN(@"CREATE INDEX IF NOT EXISTS txl_query_last_evaluation ON txl_query (last_evaluation)");
     
+    // Skipped Evaluations
+    // ----------------------------
+    
+    SQL_ON_ERROR_RETURN(@"CREATE TABLE IF NOT EXISTS txl_query_skipped ( \
+                        query_id integer NOT NULL REFERENCES txl_query (id), \
+                        revision_id integer NOT NULL REFERENCES txl_revision (id), \
+                        PRIMARY KEY (query_id, revision_id) \
+                        )");
+    
     // Contexts
     // ----------------------------
     
@@ -1357,18 +1754,123 @@ isEqualToStatement:(TXLStatement *)stmnt2
     }
 }
 
+- (NSUInteger)numberOfPendingEvaluations {
+    @synchronized (pendingEvaluations) {
+        return [pendingEvaluations count];
+    }
+}
+
+- (NSUInteger)numberOfSkippedEvaluations {
+    @synchronized (pendingEvaluations) {
+        return skipped_evaluations;
+    }
+}
+
 #pragma mark -
 #pragma mark Evaluate Queries
 
 - (void)evaluateQuery:(TXLQuery *)query
-           atRevision:(TXLRevision *)rev {
+           atRevision:(TXLRevision *)rev
+             priority:(TXLSchedulerPriority)priority {
+    [self evaluateQuery:query
+             atRevision:rev
+             activation:nil
+               priority:priority];
+}
+
+- (void)evaluateQuery:(TXLQuery *)query
+           atRevision:(TXLRevision *)rev
+           activation:(NSDictionary *)activation
+             priority:(TXLSchedulerPriority)priority {
+    [self evaluateQuery:query
+             atRevision:rev
+             activation:activation
+               priority:priority
+                cascade:nil];
+}
+
+- (void)evaluateQuery:(TXLQuery *)query
+           atRevision:(TXLRevision *)revision
+           activation:(NSDictionary *)revisionActivation
+             priority:(TXLSchedulerPriority)priority
+              cascade:(TXLSituationCascade *)cascade {
+    
+    TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+    
+    // The queue of the query is processed with the dispatch
+    // priority of the most urgent pending evaluation.
+    
+    long queuePriority = priority < TXLSchedulerPriorityBackfill ? DISPATCH_QUEUE_PRIORITY_DEFAULT : DISPATCH_QUEUE_PRIORITY_LOW;
+    
+    // The evaluation is part of the current level of the cascade,
+    // until the evaluation is finished.
+    
+    if (cascade != nil) {
+        dispatch_group_enter(cascade.group);
+    }
+    
+    // ------------------------------------------------
+    // Coalesce the evaluations of the query. If an evaluation
+    // of this query has already been scheduled, but not yet
+    // started, it is moved forward to the newer revision instead
+    // of scheduling another evaluation. The activation is dropped
+    // in this case, because the seeds of the match network only
+    // cover the statements changed in one revision. The evaluation
+    // uses the statements changed since the last evaluation instead.
+    //
+    // The revisions dropped this way are collected in the pending
+    // evaluation and marked as skipped, when the evaluation runs
+    // (see -markRevisions:asSkippedForQuery:).
+    
+    @synchronized (pendingEvaluations) {
+        NSMutableDictionary *pending = [pendingEvaluations objectForKey:queryPk];
+        if (pending != nil) {
+            TXLRevision *scheduledRevision = [pending objectForKey:@"revision"];
+            if ([scheduledRevision primaryKey] < [revision primaryKey]) {
+                [[pending objectForKey:@"skipped"] addObject:scheduledRevision];
+                [pending setObject:revision forKey:@"revision"];
+                [pending removeObjectForKey:@"activation"];
+            } else if ([scheduledRevision primaryKey] > [revision primaryKey]) {
+                [[pending objectForKey:@"skipped"] addObject:revision];
+            }
+            if (priority < [[pending objectForKey:@"priority"] intValue]) {
+                [pending setObject:[NSNumber numberWithInt:priority] forKey:@"priority"];
+                dispatch_set_target_queue([self queueForQuery:query], dispatch_get_global_queue(queuePriority, 0));
+            }
+            if (cascade != nil) {
+                [[pending objectForKey:@"cascades"] addObject:cascade];
+            }
+            return;
+        }
+        
+        pending = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                   revision, @"revision",
+                   [NSMutableArray array], @"skipped",
+                   [NSMutableArray arrayWithObjects:cascade, nil], @"cascades",
+                   [NSNumber numberWithInt:priority], @"priority",
+                   [NSDate date], @"date",
+                   nil];
+        if (revisionActivation != nil) {
+            [pending setObject:revisionActivation forKey:@"activation"];
+        }
+        [pendingEvaluations setObject:pending forKey:queryPk];
+        
+        dispatch_set_target_queue([self queueForQuery:query], dispatch_get_global_queue(queuePriority, 0));
+    }
+    
+    [scheduler taskScheduledWithPriority:priority];
     
     // ------------------------------------------------
     // Notify the delegate that the processing starts
     
     [self increaseProcessingCounter];
     
-    dispatch_group_async(manager_group, manager_queue, ^{
+    // The queries are evaluated in parallel. The evaluations of
+    // one query are serialized by the queue of the query, since
+    // the resultset of a revision depends on the resultset of the
+    // previous revision.
+    
+    dispatch_group_async(manager_group, [self queueForQuery:query], ^{
 		
         NSAutoreleasePool *pool = [NSAutoreleasePool new];
         
@@ -1380,66 +1882,223 @@ isEqualToStatement:(TXLStatement *)stmnt2
         __block NSError *error;
         BOOL success;
         
+        // ------------------------------------------------
+        // Take the pending evaluation. From now on, an evaluation
+        // for a newer revision is scheduled separately.
+        
+        NSDictionary *pending;
+        @synchronized (pendingEvaluations) {
+            pending = [[pendingEvaluations objectForKey:queryPk] retain];
+            [pendingEvaluations removeObjectForKey:queryPk];
+        }
+        [pending autorelease];
+        
+        TXLRevision *rev = [pending objectForKey:@"revision"];
+        NSDictionary *activation = [pending objectForKey:@"activation"];
+        NSArray *skippedRevisions = [pending objectForKey:@"skipped"];
+        NSArray *cascades = [pending objectForKey:@"cascades"];
+        
+        [scheduler taskStartedWithPriority:[[pending objectForKey:@"priority"] intValue]
+                               scheduledAt:[pending objectForKey:@"date"]];
+        
         // ------------------------------------------------
         // get contexts <ctxs> that are defined in the from clause
         // of this query
         
-        NSArray *ctxs = query.contexts;
+        TXLQueryPlan *plan = [self planForQuery:query];
+        
+        NSArray *ctxs = plan.contexts;
         
         // ------------------------------------------------
         // get all variables of this query,
         // that should be contained in the
         // resultset
         
-        NSArray *varsOfResultset = [query variablesOfResultset];
+        NSArray *varsOfResultset = plan.variablesOfResultset;
+
+        TXLGraphPattern *queryPattern = plan.queryPattern;
+
+        // ------------------------------------------------
+        // Check if the resultset can be maintained incrementally.
+        // This is possible, if the query has already been evaluated
+        // for a previous revision and the query pattern can be
+        // evaluated with delta rules. In this case only the results
+        // affected by the statements created or removed since the
+        // last evaluation are evaluated again.
+
+        TXLRevision *lastRevision = nil;
+        BOOL useActivation = NO;
+
+        NSArray *lastEvaluation = [self.database executeSQLWithParameters:@"SELECT last_evaluation FROM txl_query WHERE id = ?"
+                                                                    error:&error,
+                                   [TXLInteger integerWithValue:[query primaryKey]],
+                                   nil];
+        if (lastEvaluation == nil) {
+            [[NSException exceptionWithName:@"TXLManagerException"
+                                     reason:[error localizedDescription]
+                                   userInfo:nil] raise];
+        }
+
+        if ([lastEvaluation count] == 1) {
+            NSUInteger lastRevisionPk = [[[lastEvaluation objectAtIndex:0] objectForKey:@"last_evaluation"] unsignedIntegerValue];
+            
+            if (lastRevisionPk >= [rev primaryKey]) {
+                // The query has already been evaluated in this or in a
+                // later revision (e.g., the first evaluation of a newly
+                // registered query has been scheduled after the evaluation
+                // for a new revision). The resultset is up to date.
+                if (lastRevisionPk > [rev primaryKey]) {
+                    skippedRevisions = [skippedRevisions arrayByAddingObject:rev];
+                }
+                [self markRevisions:skippedRevisions asSkippedForQuery:query];
+                for (TXLSituationCascade *c in cascades) {
+                    dispatch_group_leave(c.group);
+                }
+                [pool drain];
+                [self decreaseProcessingCounter];
+                return;
+            }
+            
+            if (lastRevisionPk > 0 && lastRevisionPk < [rev primaryKey] && [queryPattern isIncrementallyEvaluable]) {
+                lastRevision = [TXLRevision revisionWithPrimaryKey:lastRevisionPk];
+                
+                // The seeds of the match network are derived from the
+                // statements changed in revision <rev>. They can only be
+                // used, if the query has been evaluated in the revision
+                // directly preceding <rev>.
+                useActivation = activation != nil && [[rev precursor] primaryKey] == lastRevisionPk;
+            }
+        }
+
+        // ------------------------------------------------
+        // The matches of the query pattern are binding vectors
+        // with one slot for each variable of the pattern. A result
+        // is a binding vector with one slot for each variable of the
+        // resultset (in the order of <varsOfResultset>). All binding
+        // vectors of this evaluation are allocated from one arena.
+
+        TXLBindingArena *arena = [TXLBindingArena arena];
+
+        NSUInteger numberOfSlots = [plan.variables count];
+        NSUInteger numberOfResultVars = [varsOfResultset count];
+        const NSUInteger *slotsOfResultset = plan.slotsOfResultset;
+
+        // binding vector used to look up a result
+        TXLBinding *key = [arena bindingsWithNumberOfSlots:numberOfResultVars];
+
+        // ------------------------------------------------
+        // reduce the variables of a match to the variables
+        // of the resultset
+
+        void (^reduceBindings)(const TXLBinding *) = ^(const TXLBinding *bindings) {
+            for (NSUInteger k = 0; k < numberOfResultVars; k++) {
+                key[k] = slotsOfResultset[k] != NSNotFound ? bindings[slotsOfResultset[k]] : 0;
+            }
+        };
+
+        // ------------------------------------------------
+        // collect the results affected by the changes since
+        // the last evaluation
+
+        CFMutableSetRef affectedResults = NULL;
+
+        if (useActivation || lastRevision != nil) {
+            
+            affectedResults = CFSetCreateMutable(NULL, 0, &kTXLBindingsSetCallBacks);
+            
+            void (^addAffectedResult)(const TXLBinding *) = ^(const TXLBinding *bindings) {
+                reduceBindings(bindings);
+                if (!CFSetContainsValue(affectedResults, key)) {
+                    CFSetAddValue(affectedResults, [arena copyOfBindings:key]);
+                }
+            };
+            
+            if (useActivation) {
+                for (NSString *k in [NSArray arrayWithObjects:@"created", @"removed", nil]) {
+                    TXLRevision *seedRevision = [k isEqual:@"created"] ? rev : lastRevision;
+                    for (NSDictionary *seed in [activation objectForKey:k]) {
+                        [queryPattern evaluatePatternWithBindings:[arena bindingsWithVariables:seed slots:plan.variables]
+                                                       inContexts:ctxs
+                                                           window:nil
+                                                      forRevision:seedRevision
+                                                    resultHandler:^(const TXLBinding *bindings, TXLMovingObjectSequence *mos) {
+                                                        addAffectedResult(bindings);
+                                                    }];
+                    }
+                }
+            } else {
+                [queryPattern evaluateDeltaInContexts:ctxs
+                                         fromRevision:lastRevision
+                                           toRevision:rev
+                                        resultHandler:addAffectedResult];
+            }
+        }
         
+        NSUInteger numberOfAffectedResults = 0;
+        const TXLBinding **affected = NULL;
+        
+        if (affectedResults != NULL) {
+            numberOfAffectedResults = CFSetGetCount(affectedResults);
+            NSMutableData *affectedList = [NSMutableData dataWithLength:numberOfAffectedResults * sizeof(TXLBinding *)];
+            affected = (const TXLBinding **)[affectedList mutableBytes];
+            CFSetGetValues(affectedResults, (const void **)affected);
+        }
+
         // ------------------------------------------------
         // evaluate query pattern of this query in revision <rev>
         // in contexts <ctxs>
-        
-        __block NSMutableDictionary *resultSet = [NSMutableDictionary dictionary];
-        
-        [[query queryPattern] evaluatePatternWithVariables:[NSDictionary dictionary]
-                                                inContexts:ctxs 
-                                                    window:nil
-                                               forRevision:rev 
-                                             resultHandler:^(NSDictionary *vars, TXLMovingObjectSequence *mos) {
-                                                 
-                                                 // collect the results, so that each result
-                                                 // will be contained only once in the resulting
-                                                 // resultset
-                                                 
-                                                 NSMutableDictionary *reducedVars = [NSMutableDictionary dictionary];
-                                                 for (NSString *varName in [vars allKeys]) {
-                                                     if ([varsOfResultset containsObject:varName]) {
-                                                         [reducedVars setObject:[vars objectForKey:varName]
-                                                                         forKey:varName];
-                                                     }
-                                                 }
-												 
-												 TXLMovingObjectSequence *sequence = [resultSet objectForKey:reducedVars];
-                                                 if (sequence == nil) {
-                                                     if (mos == nil) {
-                                                         [resultSet setObject:[NSNull null]
-                                                                       forKey:reducedVars];
-                                                     } else {
-                                                         [resultSet setObject:mos
-                                                                       forKey:reducedVars];
-                                                     }
-                                                 } else {
-                                                     if ([sequence isKindOfClass:[TXLMovingObjectSequence class]]) {
-                                                         if (mos == nil) {
-                                                             [resultSet setObject:[NSNull null]
-                                                                           forKey:reducedVars];
-                                                             
-                                                         } else {
-                                                             [resultSet setObject:[sequence unionWithMovingObjectSequence:mos]
-                                                                           forKey:reducedVars];
-                                                         }
-                                                     }
-                                                 }
-                                             }];
-        
+
+        CFMutableDictionaryRef resultSet = CFDictionaryCreateMutable(NULL, 0, &kTXLBindingsDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+
+        void (^collectResult)(const TXLBinding *, TXLMovingObjectSequence *) = ^(const TXLBinding *bindings, TXLMovingObjectSequence *mos) {
+
+            // collect the results, so that each result
+            // will be contained only once in the resulting
+            // resultset
+
+            reduceBindings(bindings);
+
+            const void *storedKey;
+            if (!CFDictionaryGetKeyIfPresent(resultSet, key, &storedKey)) {
+                CFDictionarySetValue(resultSet,
+                                     [arena copyOfBindings:key],
+                                     mos == nil ? (id)[NSNull null] : (id)mos);
+            } else {
+                id sequence = (id)CFDictionaryGetValue(resultSet, storedKey);
+                if ([sequence isKindOfClass:[TXLMovingObjectSequence class]]) {
+                    if (mos == nil) {
+                        CFDictionarySetValue(resultSet, storedKey, [NSNull null]);
+                    } else {
+                        CFDictionarySetValue(resultSet, storedKey, [sequence unionWithMovingObjectSequence:mos]);
+                    }
+                }
+            }
+        };
+
+        if (affectedResults == NULL) {
+            [queryPattern evaluatePatternWithBindings:[arena bindingsWithNumberOfSlots:numberOfSlots]
+                                           inContexts:ctxs
+                                               window:nil
+                                          forRevision:rev
+                                        resultHandler:collectResult];
+        } else {
+            // evaluate the pattern only for the affected results,
+            // by using the values of the result as bound variables
+            for (NSUInteger i = 0; i < numberOfAffectedResults; i++) {
+                TXLBinding *bindings = [arena bindingsWithNumberOfSlots:numberOfSlots];
+                for (NSUInteger k = 0; k < numberOfResultVars; k++) {
+                    if (slotsOfResultset[k] != NSNotFound) {
+                        bindings[slotsOfResultset[k]] = affected[i][k];
+                    }
+                }
+                [queryPattern evaluatePatternWithBindings:bindings
+                                               inContexts:ctxs
+                                                   window:nil
+                                              forRevision:rev
+                                            resultHandler:collectResult];
+            }
+        }
+
 		// TODO: here it must be checked whether all the results
 		// in the resultset contain values for all variables 
 		// which should be in the resultset. 
@@ -1455,7 +2114,7 @@ isEqualToStatement:(TXLStatement *)stmnt2
         NSMutableSet *createdRows = [NSMutableSet set];
         
 		// Initially the whole evaluated resultset is set to be actually new.
-	    NSMutableDictionary *resultSetToUpdate = resultSet;
+	    CFMutableDictionaryRef resultSetToUpdate = resultSet;
         
         //NSLog(@"New Result Set: %@", resultSetToUpdate);
         
@@ -1468,37 +2127,65 @@ isEqualToStatement:(TXLStatement *)stmnt2
         // Only the rows which have changed are replaced.
 		// Simultaneously, the results which are new are found
 		// so that only these results are afterwards updated.
-		
-        success = [self.database executeSQL:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE NOT id IN (SELECT resultset_id FROM %@)", 
-                                             resultsetTableName, removedTableName]
-                             withParameters:[NSArray array]
-                                      error:&error
-                              resultHandler:^(NSDictionary *row, BOOL *stop){
-								  
-								  NSMutableDictionary *varsInOldResult = [NSMutableDictionary dictionary];
-                                  
-								  for (NSString *column in [row allKeys]) {
-									  if ([column hasPrefix:@"var_"]) {
-										  [varsInOldResult setObject:[row objectForKey:column] forKey:[TXLInteger integerWithValue:[[column substringFromIndex:4] integerValue]]];
-									  }
-								  }
-								  TXLMovingObjectSequence *oldSequence = [TXLMovingObjectSequence sequenceWithPrimaryKey:[[row objectForKey:@"mos_id"] unsignedIntegerValue]];
-								  
-                                  //NSLog(@"Checking if new result set contains row: %@ with moving object: %@", varsInOldResult, oldSequence);
-                                  
-								  // Check if this combination of variables values is contained in the old resultset.
-								  TXLMovingObjectSequence *sequence = [resultSet objectForKey:varsInOldResult];
-								  
-  								  // If this combination of variables values is contained in the old resultset
-								  // then compare the moving object sequence attached to the old result set with the new one.
-								  
-								  if((sequence != nil) && [sequence isEqual:oldSequence]) {
-                                      //NSLog(@"Row already in result set: %@, %@", varsInOldResult, sequence);
-									  [resultSetToUpdate removeObjectForKey:varsInOldResult];							  
-                                  } else {
-									  [removedRows addObject:[row objectForKey:@"id"]];								  
-								  }
-                              }];
+
+        NSMutableArray *resultColumns = [NSMutableArray array];
+        for (TXLInteger *v in varsOfResultset) {
+            [resultColumns addObject:[NSString stringWithFormat:@"var_%d", [v integerValue]]];
+        }
+
+        void (^compareRow)(NSDictionary *, BOOL *) = ^(NSDictionary *row, BOOL *stop){
+
+            for (NSUInteger k = 0; k < numberOfResultVars; k++) {
+                key[k] = [[row objectForKey:[resultColumns objectAtIndex:k]] int64Value];
+            }
+            TXLMovingObjectSequence *oldSequence = [TXLMovingObjectSequence sequenceWithPrimaryKey:[[row objectForKey:@"mos_id"] unsignedIntegerValue]];
+
+            // Check if this combination of variables values is contained in the old resultset.
+            id sequence = (id)CFDictionaryGetValue(resultSet, key);
+
+            // If this combination of variables values is contained in the old resultset
+            // then compare the moving object sequence attached to the old result set with the new one.
+
+            if((sequence != nil) && [sequence isEqual:oldSequence]) {
+                CFDictionaryRemoveValue(resultSetToUpdate, key);
+            } else {
+                [removedRows addObject:[row objectForKey:@"id"]];
+            }
+        };
+
+        if (affectedResults == NULL) {
+            success = [self.database executeSQL:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE NOT id IN (SELECT resultset_id FROM %@)",
+                                                 resultsetTableName, removedTableName]
+                                 withParameters:[NSArray array]
+                                          error:&error
+                                  resultHandler:compareRow];
+        } else {
+            // only the rows of the affected results have to be compared,
+            // all other rows are not changed by this revision
+            NSMutableString *sql = [NSMutableString stringWithFormat:@"SELECT * FROM %@ WHERE NOT id IN (SELECT resultset_id FROM %@)",
+                                    resultsetTableName, removedTableName];
+            for (NSString *column in resultColumns) {
+                [sql appendFormat:@" AND %@ = ?", column];
+            }
+
+            success = YES;
+            for (NSUInteger i = 0; i < numberOfAffectedResults; i++) {
+                NSMutableArray *sqlParams = [NSMutableArray array];
+                for (NSUInteger k = 0; k < numberOfResultVars; k++) {
+                    [sqlParams addObject:[TXLInteger integerWithValue:affected[i][k]]];
+                }
+
+                success = [self.database executeSQL:sql
+                                     withParameters:sqlParams
+                                              error:&error
+                                      resultHandler:compareRow];
+                if (!success) {
+                    break;
+                }
+            }
+            
+            CFRelease(affectedResults);
+        }
         if (!success) {
             [[NSException exceptionWithName:@"TXLManagerException"
                                      reason:[error localizedDescription]
@@ -1522,13 +2209,20 @@ isEqualToStatement:(TXLStatement *)stmnt2
         
         
 		// If there are actual new results then the resultset should be updated.
-		for (NSDictionary *vars in resultSetToUpdate) {
+        NSUInteger numberOfResultsToUpdate = CFDictionaryGetCount(resultSetToUpdate);
+        NSMutableData *keyList = [NSMutableData dataWithLength:numberOfResultsToUpdate * sizeof(void *)];
+        NSMutableData *valueList = [NSMutableData dataWithLength:numberOfResultsToUpdate * sizeof(void *)];
+        CFDictionaryGetKeysAndValues(resultSetToUpdate, (const void **)[keyList mutableBytes], (const void **)[valueList mutableBytes]);
+        
+		for (NSUInteger i = 0; i < numberOfResultsToUpdate; i++) {
+            
+            const TXLBinding *vars = ((const TXLBinding **)[keyList mutableBytes])[i];
             
             NSMutableArray *sqlParams = [NSMutableArray array];
             
             // save the moving object sequence
             
-            TXLMovingObjectSequence *mos = [resultSetToUpdate objectForKey:vars];
+            TXLMovingObjectSequence *mos = ((id *)[valueList mutableBytes])[i];
             if ([mos isKindOfClass:[TXLMovingObjectSequence class]]) {
                 mos = [mos save:&error];
                 if (mos == nil) {
@@ -1541,8 +2235,8 @@ isEqualToStatement:(TXLStatement *)stmnt2
                 [sqlParams addObject:[TXLInteger integerWithValue:0]];
             }
             
-            for (NSString *v in varsOfResultset) {
-                [sqlParams addObject:[vars objectForKey:v]];
+            for (NSUInteger k = 0; k < numberOfResultVars; k++) {
+                [sqlParams addObject:[TXLInteger integerWithValue:vars[k]]];
             }
             
             if ([self.database executeSQL:sqlExpr
@@ -1555,6 +2249,8 @@ isEqualToStatement:(TXLStatement *)stmnt2
             [createdRows addObject:[TXLInteger integerWithValue:self.database.lastInsertRowid]];
         }
         
+        CFRelease(resultSet);
+        
         // ------------------------------------------------
         
 		// Apply the changes by inserting the removed and created rows in
@@ -1610,7 +2306,7 @@ isEqualToStatement:(TXLStatement *)stmnt2
 			// The update of the statements of a construct query
 			// is done only if there was an update in the resultset of the query.
             
-			if (query.constructQuery) {
+			if (plan.constructQuery) {
 				// query is of type construct.
 				// update context with the results.
 				
@@ -1646,36 +2342,13 @@ isEqualToStatement:(TXLStatement *)stmnt2
 					NSString *tableName_created = [NSString stringWithFormat:@"txl_resultset_%d_created", query.primaryKey]; 
 					NSString *tableName_removed = [NSString stringWithFormat:@"txl_resultset_%d_removed", query.primaryKey]; 
 					
-					// clear context for rows which have been removed
+					// rows which have been removed or created
 					// ----------------------------------------------
 					
-					if (![self.database executeSQL:[NSString stringWithFormat:@"SELECT resultset_id FROM %@ WHERE revision_id = ?", tableName_removed]
-									withParameters:[NSArray arrayWithObject:[TXLInteger integerWithValue:rev.primaryKey]]
-											 error:&error
-									 resultHandler:^(NSDictionary *row, BOOL *stop){
-										 TXLContext *ctx = [queryContext childWithName:[NSString stringWithFormat:@"#%d", [[row objectForKey:@"resultset_id"] integerValue]]];
-										 //NSLog(@"Clearing context: %@", ctx);
-                                         
-                                         TXLManagerUpdateOperation *op = [[TXLManagerUpdateOperation alloc] initWithContext:ctx
-                                                                                                                  situation:nil
-                                                                                                               intervalFrom:nil
-                                                                                                                         to:nil];
-                                         [operations addObject:op];
-                                         [op release];
-                                         
-									 }]) {
-										 [[NSException exceptionWithName:@"TXLManagerException"
-																  reason:[error localizedDescription]
-																userInfo:nil] raise];
-									 }
-					
-					// create new context for rows which have been added
-					// -------------------------------------------------
-					
-					NSArray *pattern = [self.database executeSQL:@"SELECT txl_query_pattern_triple.* FROM txl_query_pattern_triple, txl_query WHERE txl_query_pattern_triple.in_pattern_id = txl_query.construct_template_pattern_id AND txl_query.id = ?"
-												  withParameters:[NSArray arrayWithObject:[TXLInteger integerWithValue:query.primaryKey]]
-														   error:&error];
-					if (pattern == nil) {
+					NSArray *removedResults = [self.database executeSQL:[NSString stringWithFormat:@"SELECT resultset_id FROM %@ WHERE revision_id = ?", tableName_removed]
+														 withParameters:[NSArray arrayWithObject:[TXLInteger integerWithValue:rev.primaryKey]]
+																  error:&error];
+					if (removedResults == nil) {
 						[[NSException exceptionWithName:@"TXLManagerException"
 												 reason:[error localizedDescription]
 											   userInfo:nil] raise];
@@ -1689,159 +2362,113 @@ isEqualToStatement:(TXLStatement *)stmnt2
 									 tableName_created,
 									 tableName];
 					
-					success = [self.database executeSQL:sql
-										 withParameters:[NSArray arrayWithObject:[TXLInteger integerWithValue:rev.primaryKey]]
-												  error:&error
-										  resultHandler:^(NSDictionary *row, BOOL *stop){
-											  TXLContext *ctx = [queryContext childWithName:[NSString stringWithFormat:@"#%d", [[row objectForKey:@"id"] integerValue]]];
-											  //NSLog(@"Creating context: %@", ctx);
-											  
-											  NSMutableArray *statements = [NSMutableArray array];
-											  NSMutableDictionary *blankNodes = [NSMutableDictionary dictionary];
-											  
-											  for (NSDictionary *triple in pattern) {
-												  
-												  TXLTerm *subject;
-												  TXLTerm *predicate;
-												  TXLTerm *object;
-												  
-												  TXLInteger *subject_id = [triple objectForKey:@"subject_id"];
-												  TXLInteger *subject_var_id = [triple objectForKey:@"subject_var_id"];
-												  if ([subject_id isKindOfClass:[TXLInteger class]] && [subject_id integerValue] > 0) {
-													  subject = [TXLTerm termWithPrimaryKey:[subject_id integerValue]];
-												  } else {
-													  
-													  NSArray *subject_var = [self.database executeSQL:@"SELECT * FROM txl_query_variable WHERE id = ?"
-																						withParameters:[NSArray arrayWithObject:subject_var_id]
-																								 error:&error];
-													  if (!subject_var) {
-														  [[NSException exceptionWithName:@"TXLManagerException"
-																				   reason:[error localizedDescription]
-																				 userInfo:nil] raise];
-													  }
-													  
-													  if ([subject_var count] != 1) {
-														  [[NSException exceptionWithName:@"TXLManagerException"
-																				   reason:[NSString stringWithFormat:@"Expecting values for var with id %@", subject_var_id]
-																				 userInfo:nil] raise];
-													  }
-													  
-													  if ([[[subject_var objectAtIndex:0] objectForKey:@"is_blanknode"] integerValue]) {
-														  NSString *bnName = [[subject_var objectAtIndex:0] objectForKey:@"name"];
-														  TXLTerm *bn = [blankNodes objectForKey:bnName];
-														  if (bn) {
-															  subject = bn;
-														  } else {
-															  subject = [TXLTerm termWithBlankNode:nil];
-															  [blankNodes setObject:subject forKey:bnName];
-														  }
-													  } else {
-														  subject = [TXLTerm termWithPrimaryKey:
-																	 [
-																	  [row objectForKey:
-																	   [NSString stringWithFormat:@"var_%d", subject_var_id.integerValue]
-																	   ]
-																	  integerValue
-																	  ]
-																	 ];
-													  }
-												  }
-												  
-												  TXLInteger *predicate_id = [triple objectForKey:@"predicate_id"];
-												  TXLInteger *predicate_var_id = [triple objectForKey:@"predicate_var_id"];
-												  if ([predicate_id isKindOfClass:[TXLInteger class]] && [predicate_id integerValue] > 0) {
-													  predicate = [TXLTerm termWithPrimaryKey:[predicate_id integerValue]];
-												  } else {
-													  predicate = [TXLTerm termWithPrimaryKey:
-																   [
-																	[row objectForKey:
-																	 [NSString stringWithFormat:@"var_%d", predicate_var_id.integerValue]
-																	 ]
-																	integerValue
-																	]
-																   ];
-												  }
-												  
-												  TXLInteger *object_id = [triple objectForKey:@"object_id"];
-												  TXLInteger *object_var_id = [triple objectForKey:@"object_var_id"];
-												  if ([object_id isKindOfClass:[TXLInteger class]] && [object_id integerValue] > 0) {
-													  object = [TXLTerm termWithPrimaryKey:[object_id integerValue]];
-												  } else {
-													  
-													  NSArray *object_var = [self.database executeSQL:@"SELECT * FROM txl_query_variable WHERE id = ?"
-																					   withParameters:[NSArray arrayWithObject:object_var_id]
-																								error:&error];
-													  if (!object_var) {
-														  [[NSException exceptionWithName:@"TXLManagerException"
-																				   reason:[error localizedDescription]
-																				 userInfo:nil] raise];
-													  }
-													  
-													  if ([object_var count] != 1) {
-														  [[NSException exceptionWithName:@"TXLManagerException"
-																				   reason:[NSString stringWithFormat:@"Expecting values for var with id %@", object_var_id]
-																				 userInfo:nil] raise];
-													  }
-													  
-													  if ([[[object_var objectAtIndex:0] objectForKey:@"is_blanknode"] integerValue]) {
-														  NSString *bnName = [[object_var objectAtIndex:0] objectForKey:@"name"];
-														  TXLTerm *bn = [blankNodes objectForKey:bnName];
-														  if (bn) {
-															  object = bn;
-														  } else {
-															  object = [TXLTerm termWithBlankNode:nil];
-															  [blankNodes setObject:object forKey:bnName];
-														  }
-													  } else {
-														  object = [TXLTerm termWithPrimaryKey:
-																	[
-																	 [row objectForKey:
-																	  [NSString stringWithFormat:@"var_%d", object_var_id.integerValue]
-																	  ]
-																	 integerValue
-																	 ]
-																	];
-													  }
-												  }
-												  
-												  
-												  TXLStatement *st = [TXLStatement statementWithSubject:subject
-																							  predicate:predicate
-																								 object:object];
-												  [statements addObject:st];
-											  }
-                                              
-                                              TXLMovingObjectSequence *mos = [TXLMovingObjectSequence sequenceWithPrimaryKey:[[row objectForKey:@"mos_id"] integerValue]];
-                                              
-                                              TXLSituation *situation = [[TXLSituation alloc] initWithStatements:statements
-                                                                                            movingObjectSequence:mos];
-                                              
-                                              TXLManagerUpdateOperation *op = [[TXLManagerUpdateOperation alloc] initWithContext:ctx
-                                                                                                                       situation:situation
-                                                                                                                    intervalFrom:nil
-                                                                                                                              to:nil];
-                                              
-                                              [operations addObject:op];
-                                              
-                                              [op release];
-                                              [situation release];
-										  }];
+					NSArray *createdResults = [self.database executeSQL:sql
+														 withParameters:[NSArray arrayWithObject:[TXLInteger integerWithValue:rev.primaryKey]]
+																  error:&error];
+					if (createdResults == nil) {
+						[[NSException exceptionWithName:@"TXLManagerException"
+												 reason:[error localizedDescription]
+											   userInfo:nil] raise];
+					}
+					
+					// get (or create) the contexts of all these rows at once
+					// ----------------------------------------------
 					
-                    if (!success) {
-                        [[NSException exceptionWithName:@"TXLManagerException"
-                                                 reason:[error localizedDescription]
-                                               userInfo:nil] raise];
-                    }
+					NSMutableArray *childNames = [NSMutableArray arrayWithCapacity:[removedResults count] + [createdResults count]];
+					for (NSDictionary *row in removedResults) {
+						[childNames addObject:[NSString stringWithFormat:@"#%d", [[row objectForKey:@"resultset_id"] integerValue]]];
+					}
+					for (NSDictionary *row in createdResults) {
+						[childNames addObject:[NSString stringWithFormat:@"#%d", [[row objectForKey:@"id"] integerValue]]];
+					}
+					
+					NSDictionary *children = [queryContext childrenWithNames:childNames];
+					
+					// clear context for rows which have been removed
+					// ----------------------------------------------
+					
+					for (NSDictionary *row in removedResults) {
+						TXLContext *ctx = [children objectForKey:[NSString stringWithFormat:@"#%d", [[row objectForKey:@"resultset_id"] integerValue]]];
+						//NSLog(@"Clearing context: %@", ctx);
+						
+						TXLManagerUpdateOperation *op = [[TXLManagerUpdateOperation alloc] initWithContext:ctx
+																								 situation:nil
+																							  intervalFrom:nil
+																										to:nil];
+						[operations addObject:op];
+						[op release];
+					}
+					
+					// create new context for rows which have been added
+					// -------------------------------------------------
+					
+					// The template has been resolved by the plan, only the
+					// values of the variables are taken from the rows.
+					
+					const TXLTemplateTriple *templateTriples = plan.templateTriples;
+					NSUInteger numberOfTemplateTriples = [plan.constructTemplate count];
+					NSUInteger numberOfBlankNodes = plan.numberOfTemplateBlankNodes;
+					
+					NSMutableArray *blankNodes = [NSMutableArray arrayWithCapacity:numberOfBlankNodes];
+					
+					for (NSDictionary *row in createdResults) {
+						TXLContext *ctx = [children objectForKey:[NSString stringWithFormat:@"#%d", [[row objectForKey:@"id"] integerValue]]];
+						//NSLog(@"Creating context: %@", ctx);
+						
+						// the blank nodes are created for each result
+						[blankNodes removeAllObjects];
+						for (NSUInteger i = 0; i < numberOfBlankNodes; i++) {
+							[blankNodes addObject:[TXLTerm termWithBlankNode:nil]];
+						}
+						
+						NSMutableArray *statements = [NSMutableArray arrayWithCapacity:numberOfTemplateTriples];
+						for (NSUInteger i = 0; i < numberOfTemplateTriples; i++) {
+							TXLStatement *st = [TXLStatement statementWithSubject:TXLTemplateTermValue(templateTriples[i].subject, row, blankNodes)
+																		predicate:TXLTemplateTermValue(templateTriples[i].predicate, row, blankNodes)
+																		   object:TXLTemplateTermValue(templateTriples[i].object, row, blankNodes)];
+							[statements addObject:st];
+						}
+						
+						TXLMovingObjectSequence *mos = [TXLMovingObjectSequence sequenceWithPrimaryKey:[[row objectForKey:@"mos_id"] integerValue]];
+						
+						TXLSituation *situation = [[TXLSituation alloc] initWithStatements:statements
+																	  movingObjectSequence:mos];
+						
+						TXLManagerUpdateOperation *op = [[TXLManagerUpdateOperation alloc] initWithContext:ctx
+																								 situation:situation
+																							  intervalFrom:nil
+																										to:nil];
+						
+						[operations addObject:op];
+						
+						[op release];
+						[situation release];
+					}
                     
-                    [self applyOperations:operations
-                      withCompletionBlock:^(TXLRevision *rev, NSError *error){
-                          if (rev) {
-                              //NSLog(@"Context '%@' updated by construct expression.", queryContext);
-                          } else {
-                              //NSLog(@"Error updating context '%@' by construct expression: %@", queryContext, [error localizedDescription]);
-                          }
-                          [queryContext release];
-                      }];
+                    if ([cascades count] > 0) {
+                        // The operations are applied together with the
+                        // operations of the other definitions of this level.
+                        // If evaluations of several cascades have been
+                        // coalesced, each cascade applies the operations,
+                        // so that the definitions depending on this one are
+                        // evaluated in every cascade. Applying them again
+                        // leaves the context unchanged.
+                        for (TXLSituationCascade *c in cascades) {
+                            [c addOperations:operations];
+                        }
+                        [queryContext release];
+                    } else {
+                        [self applyOperations:operations
+                                     priority:TXLSchedulerPriorityContinuous
+                          withCompletionBlock:^(TXLRevision *rev, NSError *error){
+                              if (rev) {
+                                  //NSLog(@"Context '%@' updated by construct expression.", queryContext);
+                              } else {
+                                  //NSLog(@"Error updating context '%@' by construct expression: %@", queryContext, [error localizedDescription]);
+                              }
+                              [queryContext release];
+                          }];
+                    }
 				}
 			}
 			
@@ -1900,6 +2527,15 @@ isEqualToStatement:(TXLStatement *)stmnt2
 										   reason:[error localizedDescription]
 										 userInfo:nil];
 		}
+		
+		// Mark the revisions, which have been coalesced with this
+		// evaluation.
+		
+		[self markRevisions:skippedRevisions asSkippedForQuery:query];
+        
+        for (TXLSituationCascade *c in cascades) {
+            dispatch_group_leave(c.group);
+        }
         
         [pool drain];
         [self decreaseProcessingCounter];
@@ -1907,83 +2543,108 @@ isEqualToStatement:(TXLStatement *)stmnt2
 }
 
 - (void)evaluateQueriesForContexts:(NSSet *)ctxs
-                        atRevision:(TXLRevision *)rev {
-    
-    // TODO: this function has to be synchronized for every query, since
-    // one can call the updateContext function twice in parallel
-    // and it must be ensured that the smaller revision id
-    // has to be evaluated before the newer resp. higher revision
-    // id will be evaluated, because the resultset of the
-    // newer revision id depends on the resultset of the previous
-    // revision id. Since there is only a conflict between resultsets,
-    // the synchronization per query is sufficient, since a resultset
-    // is directly related to a query.
+                   withActivations:(NSDictionary *)activations
+                        atRevision:(TXLRevision *)rev
+                           cascade:(TXLSituationCascade *)cascade {
+    
+    // The queries are evaluated in parallel, each query in its own
+    // serial queue (see queueForQuery:). The resultset of a newer
+    // revision depends on the resultset of the previous revision,
+    // so the evaluations of one query are processed in the order of
+    // the revisions. This function is called in the order of the
+    // revisions, and an evaluation for an older revision, which is
+    // scheduled after the evaluation of a newer revision, is skipped.
+    // Evaluations, which are scheduled while an evaluation of the
+    // query is still pending, are coalesced (see evaluateQuery:atRevision:activation:).
     
     // TODO: maybe better error handling, since the evaluation would
     // be called async, currently there are only exceptions
     // that would be thrown, when an error occurs.
     
-    NSError *error;
-    
     // Only this function should modify the tables holding
     // the result sets for the continuous queries.
     
     // Find all queries containing a context in the FROM clause
     // which is equal to ctx or where ctx is a child context.
     
-    NSArray *queries = [[TXLQuery queriesForContexts:ctxs
-                                               error:&error] retain];
+    NSArray *queries = [[subscriptionIndex queriesForContexts:ctxs] retain];
     
-    if (queries == nil) {
-        [[NSException exceptionWithName:@"TXLManagerException"
-                                 reason:[error localizedDescription]
-                               userInfo:nil] raise];
-    }
+    // Situation definitions with a level in the dependency graph
+    // are evaluated by the cascade of this change, after the
+    // definitions they depend on (see propagateCascade:atRevision:).
+    // The cascade is started by the update of the application.
+    
+    NSDictionary *levels = [self levelsOfSituationDefinitions];
     
     // Trigger the evaluation of all found queries
-    // at revision rev
+    // at revision rev. Queries without an activation in the
+    // match network are not affected by this revision. For these
+    // queries only the revision of the last evaluation is moved
+    // forward, if the query has been evaluated in the previous
+    // revision.
     
     for (TXLQuery *query in queries) {
-        [self evaluateQuery:query atRevision:rev];
+        
+        TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+        NSDictionary *activation = [activations objectForKey:queryPk];
+        NSNumber *level = [levels objectForKey:queryPk];
+        
+        if (activation != nil && level != nil) {
+            if (cascade == nil) {
+                cascade = [TXLSituationCascade cascade];
+            }
+            [cascade addDefinition:query
+                         withLevel:[level unsignedIntegerValue]
+                          revision:rev
+                        activation:activation];
+        } else if (activation == nil) {
+            [self increaseProcessingCounter];
+            dispatch_group_async(manager_group, [self queueForQuery:query], ^{
+                NSError *error;
+                if ([self.database executeSQLWithParameters:@"UPDATE txl_query SET last_evaluation = ? WHERE id = ? AND last_evaluation = (SELECT previous FROM txl_revision WHERE id = ?)"
+                                                      error:&error,
+                     [TXLInteger integerWithValue:[rev primaryKey]],
+                     [TXLInteger integerWithValue:[query primaryKey]],
+                     [TXLInteger integerWithValue:[rev primaryKey]],
+                     nil] == nil) {
+                    [[NSException exceptionWithName:@"TXLManagerException"
+                                             reason:[error localizedDescription]
+                                           userInfo:nil] raise];
+                }
+                [self decreaseProcessingCounter];
+            });
+        } else {
+            [self evaluateQuery:query
+                     atRevision:rev
+                     activation:activation
+                       priority:TXLSchedulerPriorityContinuous];
+        }
     }
     
     [queries release];
+    
+    if (cascade != nil) {
+        [self propagateCascade:cascade atRevision:rev];
+    }
 }
 
 - (void)evaluateQueriesForContext:(TXLContext *)ctx
                        atRevision:(TXLRevision *)rev {
     
-    // TODO: this function has to be synchronized for every query, since
-    // one can call the updateContext function twice in parallel
-    // and it must be ensured that the smaller revision id
-    // has to be evaluated before the newer resp. higher revision
-    // id will be evaluated, because the resultset of the
-    // newer revision id depends on the resultset of the previous
-    // revision id. Since there is only a conflict between resultsets,
-    // the synchronization per query is sufficient, since a resultset
-    // is directly related to a query.
+    // The evaluations of a query are serialized by the queue
+    // of the query (see evaluateQueriesForContexts:withActivations:atRevision:cascade:).
     
     // TODO: maybe better error handling, since the evaluation would
     // be called async, currently there are only exceptions
     // that would be thrown, when an error occurs.
     
-    NSError *error;
-    
     // Only this function should modify the tables holding
     // the result sets for the continuous queries.
     
     // Find all queries containing a context in the FROM clause
     // which is equal to ctx or where ctx is a child context.
     
-    NSArray *queries = [TXLQuery queriesForContext:ctx
-                                             error:&error];
-    
-    if (queries == nil) {
-        @throw [NSException exceptionWithName:@"TXLManagerException"
-                                       reason:[error localizedDescription]
-                                     userInfo:nil];
-        NSLog(@"Could not load queries for context (%lu): %@", ctx.primaryKey, [error localizedDescription]);
-    }
+    NSArray *queries = [subscriptionIndex queriesForContexts:[NSSet setWithObject:ctx]];
     
     // Trigger the evaluation of all found queries
     // at revision rev
@@ -1991,8 +2652,253 @@ isEqualToStatement:(TXLStatement *)stmnt2
     for (TXLQuery *query in queries) {
         //NSLog(@"Query () evaluated ");
         [self evaluateQuery:query
-                 atRevision:rev];
+                 atRevision:rev
+                   priority:TXLSchedulerPriorityContinuous];
+    }
+}
+
+- (TXLQueryPlan *)planForQuery:(TXLQuery *)query {
+    
+    // The plan of a query is compiled on the first evaluation
+    // and used until the query is unregistered or redefined.
+    
+    TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+    
+    @synchronized (queryPlans) {
+        TXLQueryPlan *plan = [queryPlans objectForKey:queryPk];
+        if (plan == nil) {
+            plan = [TXLQueryPlan planForQuery:query];
+            [queryPlans setObject:plan forKey:queryPk];
+        }
+        return [[plan retain] autorelease];
+    }
+}
+
+- (void)discardPlanForQuery:(TXLQuery *)query {
+    @synchronized (queryPlans) {
+        [queryPlans removeObjectForKey:[TXLInteger integerWithValue:query.primaryKey]];
+    }
+}
+
+- (dispatch_queue_t)queueForQuery:(TXLQuery *)query {
+    
+    // Each query has a serial queue for its evaluations. The queues
+    // of different queries run concurrently on the global queues.
+    // Each thread uses its own connection to the database (see TXLDatabase).
+    // Each thread also uses its own GEOS context (see TXLGEOSContext).
+    
+    TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+    
+    @synchronized (queryQueues) {
+        NSValue *queue = [queryQueues objectForKey:queryPk];
+        if (queue == nil) {
+            NSString *label = [NSString stringWithFormat:@"org.opentxl.manager.query.%d", query.primaryKey];
+            dispatch_queue_t q = dispatch_queue_create([label UTF8String], NULL);
+            queue = [NSValue valueWithPointer:q];
+            [queryQueues setObject:queue forKey:queryPk];
+        }
+        return [queue pointerValue];
+    }
+}
+
+- (void)markRevisions:(NSArray *)revisions asSkippedForQuery:(TXLQuery *)query {
+    
+    // Every revision dropped for a query (coalesced with the evaluation
+    // of a later revision or older than the last evaluation) is marked
+    // here. The resultset of the query in these revisions is the
+    // resultset of the preceding evaluated revision.
+    
+    NSError *error;
+    
+    for (TXLRevision *skippedRevision in revisions) {
+        if ([self.database executeSQLWithParameters:@"INSERT OR IGNORE INTO txl_query_skipped (query_id, revision_id) VALUES (?, ?)"
+                                              error:&error,
+             [TXLInteger integerWithValue:[query primaryKey]],
+             [TXLInteger integerWithValue:[skippedRevision primaryKey]],
+             nil] == nil) {
+            @throw [NSException exceptionWithName:@"TXLManagerException"
+                                           reason:[error localizedDescription]
+                                         userInfo:nil];
+        }
+    }
+    
+    @synchronized (pendingEvaluations) {
+        skipped_evaluations += [revisions count];
+    }
+}
+
+- (void)discardQueueForQuery:(TXLQuery *)query {
+    
+    // Evaluations already scheduled in the queue are still
+    // processed, since the queue is retained by its blocks.
+    
+    TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+    
+    @synchronized (queryQueues) {
+        NSValue *queue = [queryQueues objectForKey:queryPk];
+        if (queue != nil) {
+            dispatch_release([queue pointerValue]);
+            [queryQueues removeObjectForKey:queryPk];
+        }
+    }
+}
+
+#pragma mark -
+#pragma mark Cascading Situation Definitions
+
+- (NSDictionary *)levelsOfSituationDefinitions {
+    
+    // A situation definition depends on another definition,
+    // if it reads the context populated by the other definition.
+    // The level of a definition is the length of the longest path
+    // to this definition in the dependency graph. Definitions which
+    // are part of a cycle get no level; they are evaluated for each
+    // revision as other queries.
+    
+    @synchronized (self) {
+        if (definitionLevels != nil) {
+            return [[definitionLevels retain] autorelease];
+        }
+    }
+    
+    NSError *error;
+    NSArray *rows = [self.database executeSQL:@"SELECT context_id, query_id FROM txl_context_query"
+                                        error:&error];
+    if (rows == nil) {
+        [[NSException exceptionWithName:@"TXLManagerException"
+                                 reason:[error localizedDescription]
+                               userInfo:nil] raise];
+    }
+    
+    NSMutableDictionary *outputs = [NSMutableDictionary dictionary];
+    for (NSDictionary *row in rows) {
+        [outputs setObject:[row objectForKey:@"context_id"]
+                    forKey:[TXLInteger integerWithValue:[[row objectForKey:@"query_id"] integerValue]]];
+    }
+    
+    // definition -> definitions reading its context
+    NSMutableDictionary *dependents = [NSMutableDictionary dictionary];
+    // definition -> number of definitions it depends on
+    NSMutableDictionary *indegree = [NSMutableDictionary dictionary];
+    
+    for (TXLInteger *queryPk in outputs) {
+        [indegree setObject:[NSNumber numberWithUnsignedInteger:0] forKey:queryPk];
+    }
+    
+    for (TXLInteger *queryPk in outputs) {
+        TXLContext *ctx = [TXLContext contextWithPrimaryKey:[[outputs objectForKey:queryPk] integerValue]];
+        NSMutableArray *list = [NSMutableArray array];
+        for (TXLQuery *query in [subscriptionIndex queriesForContexts:[NSSet setWithObject:ctx]]) {
+            TXLInteger *pk = [TXLInteger integerWithValue:query.primaryKey];
+            if ([outputs objectForKey:pk] != nil) {
+                [list addObject:pk];
+                [indegree setObject:[NSNumber numberWithUnsignedInteger:[[indegree objectForKey:pk] unsignedIntegerValue] + 1]
+                             forKey:pk];
+            }
+        }
+        [dependents setObject:list forKey:queryPk];
+    }
+    
+    NSMutableDictionary *levels = [NSMutableDictionary dictionary];
+    NSMutableArray *ready = [NSMutableArray array];
+    
+    for (TXLInteger *queryPk in indegree) {
+        if ([[indegree objectForKey:queryPk] unsignedIntegerValue] == 0) {
+            [levels setObject:[NSNumber numberWithUnsignedInteger:0] forKey:queryPk];
+            [ready addObject:queryPk];
+        }
+    }
+    
+    while ([ready count] > 0) {
+        TXLInteger *queryPk = [ready lastObject];
+        [ready removeLastObject];
+        
+        NSUInteger level = [[levels objectForKey:queryPk] unsignedIntegerValue];
+        
+        for (TXLInteger *pk in [dependents objectForKey:queryPk]) {
+            NSUInteger dependentLevel = [[levels objectForKey:pk] unsignedIntegerValue];
+            if ([levels objectForKey:pk] == nil || dependentLevel < level + 1) {
+                [levels setObject:[NSNumber numberWithUnsignedInteger:level + 1] forKey:pk];
+            }
+            NSUInteger n = [[indegree objectForKey:pk] unsignedIntegerValue] - 1;
+            [indegree setObject:[NSNumber numberWithUnsignedInteger:n] forKey:pk];
+            if (n == 0) {
+                [ready addObject:pk];
+            }
+        }
+    }
+    
+    // Remove the definitions, which are part of or depend on a cycle.
+    for (TXLInteger *queryPk in indegree) {
+        if ([[indegree objectForKey:queryPk] unsignedIntegerValue] > 0) {
+            [levels removeObjectForKey:queryPk];
+        }
+    }
+    
+    @synchronized (self) {
+        if (definitionLevels == nil) {
+            definitionLevels = [levels copy];
+        }
+        return [[definitionLevels retain] autorelease];
+    }
+}
+
+- (void)discardLevelsOfSituationDefinitions {
+    @synchronized (self) {
+        [definitionLevels release];
+        definitionLevels = nil;
+    }
+}
+
+- (void)propagateCascade:(TXLSituationCascade *)cascade
+              atRevision:(TXLRevision *)rev {
+    
+    // Evaluate the definitions of the lowest level in the cascade.
+    // After all evaluations are finished, the resulting updates are
+    // applied in one revision. The definitions affected by this
+    // revision are added to the cascade (see evaluateQueriesForContexts:
+    // withActivations:atRevision:cascade:), and the next level is
+    // evaluated in this revision. Definitions of a higher level,
+    // which have been added earlier, are evaluated with all changes
+    // since their last evaluation.
+    
+    NSArray *definitions = [cascade takeDefinitionsOfLowestLevel];
+    if ([definitions count] == 0) {
+        return;
+    }
+    
+    [self increaseProcessingCounter];
+    
+    for (NSDictionary *definition in definitions) {
+        
+        // The activation can only be used, if it has been
+        // derived from the changes in this revision.
+        
+        NSDictionary *activation = nil;
+        if ([[definition objectForKey:@"revision"] primaryKey] == [rev primaryKey]) {
+            activation = [definition objectForKey:@"activation"];
+        }
+        
+        [self evaluateQuery:[definition objectForKey:@"query"]
+                 atRevision:rev
+                 activation:activation
+                   priority:TXLSchedulerPriorityContinuous
+                    cascade:cascade];
     }
+    
+    dispatch_group_notify(cascade.group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSArray *operations = [cascade takeOperations];
+        if ([operations count] > 0) {
+            [self applyOperations:operations
+                         priority:TXLSchedulerPriorityContinuous
+                          cascade:cascade
+                             bulk:NO
+              withCompletionBlock:^(TXLRevision *r, NSError *error){}];
+        } else {
+            [self propagateCascade:cascade atRevision:rev];
+        }
+        [self decreaseProcessingCounter];
+    });
 }
 
 #pragma mark -
@@ -2232,6 +3138,158 @@ isEqualToStatement:(TXLStatement *)stmnt2
     
 }
 
+- (BOOL)extendStatementsWithOperation:(TXLManagerExtendOperation *)op
+                    createdStatements:(NSMutableSet *)created
+                    removedStatements:(NSMutableSet *)removed
+                   extendedStatements:(NSMutableArray *)extended
+                                error:(NSError **)error {
+    
+    NSTimeInterval time = [op.timestamp timeIntervalSince1970];
+    
+    for (TXLStatement *st in op.statements) {
+        
+        [st.subject save:error];
+        [st.predicate save:error];
+        [st.object save:error];
+        
+        // Find the open-ended moving objects (without end)
+        // of this statement in the context and the number of
+        // other statements using the same moving object.
+        // ----------------------------------------
+        
+        NSString *sqlStatement = @"\
+            SELECT txl_statement.id AS id, txl_statement.mo_id AS mo_id, \
+                (SELECT count(*) FROM txl_statement AS other WHERE other.mo_id = txl_statement.mo_id AND other.id != txl_statement.id) AS shared \
+            FROM txl_statement, txl_movingobject \
+            WHERE \
+                txl_statement.context_id = ? \
+                AND txl_statement.subject_id = ? \
+                AND txl_statement.predicate_id = ? \
+                AND txl_statement.object_id = ? \
+                AND txl_movingobject.id = txl_statement.mo_id \
+                AND txl_movingobject.end IS NULL \
+                AND NOT txl_statement.id IN (SELECT statement_id FROM txl_statement_removed)";
+        
+        NSArray *result = [self.database executeSQLWithParameters:sqlStatement error:error,
+                           [TXLInteger integerWithValue:op.context.primaryKey],
+                           [TXLInteger integerWithValue:st.subject.primaryKey],
+                           [TXLInteger integerWithValue:st.predicate.primaryKey],
+                           [TXLInteger integerWithValue:st.object.primaryKey],
+                           nil];
+        if (result == nil) {
+            return NO;
+        }
+        
+        for (NSDictionary *row in result) {
+            
+            TXLInteger *statementPk = [row objectForKey:@"id"];
+            
+            // The last position of the statement is the last snapshot
+            // with a timestamp, or the position appended by a previous
+            // extend operation of this revision (not yet written).
+            
+            NSDictionary *pending = nil;
+            for (NSDictionary *extension in extended) {
+                if ([[extension objectForKey:@"statement_id"] isEqual:statementPk]) {
+                    pending = extension;
+                }
+            }
+            
+            TXLMovingObject *mo;
+            NSTimeInterval last;
+            TXLGeometryCollection *current;
+            
+            if (pending != nil) {
+                mo = [pending objectForKey:@"moving_object"];
+                last = [[pending objectForKey:@"timestamp"] timeIntervalSince1970];
+                current = [pending objectForKey:@"geometry"];
+            } else {
+                mo = [TXLMovingObject movingObjectWithPrimaryKey:[[row objectForKey:@"mo_id"] integerValue]];
+                const NSTimeInterval *timestamps;
+                NSUInteger count = [mo getTimestamps:&timestamps geometries:NULL boundingBoxes:NULL];
+                last = count > 1 ? timestamps[count - 2] : timestamps[0];
+                current = [mo boundsAtDate:op.timestamp];
+            }
+            
+            // If the statement is already valid in the geometry
+            // at the timestamp, nothing has to be changed.
+            
+            BOOL unchanged = time >= last && [current isEqual:op.geometry];
+            if (unchanged) {
+                continue;
+            }
+            
+            // A position before the last position would replace
+            // the later positions and is rejected.
+            
+            if (time <= last) {
+                if (error != nil) {
+                    NSDictionary *error_dict = [NSDictionary dictionaryWithObject:[NSString stringWithFormat:NSLocalizedString(@"The position at %@ is not after the last position of the statement %@.", nil), op.timestamp, st]
+                                                                           forKey:NSLocalizedDescriptionKey];
+                    *error = [NSError errorWithDomain:TXLManagerErrorDomain
+                                                 code:TXL_MANAGER_ERROR_OUT_OF_ORDER
+                                             userInfo:error_dict];
+                }
+                return NO;
+            }
+            
+            if ([[row objectForKey:@"shared"] integerValue] == 0 || pending != nil) {
+                
+                // Append the position to the moving object. The statement
+                // itself is neither removed nor created again.
+                
+                [extended addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                                     statementPk, @"statement_id",
+                                     mo, @"moving_object",
+                                     op.timestamp, @"timestamp",
+                                     op.geometry, @"geometry",
+                                     nil]];
+                
+            } else {
+                
+                // The moving object is also used by other statements,
+                // which must not be extended. The statement is removed
+                // and created again with a copy of the moving object up
+                // to the timestamp and a new open-ended moving object.
+                
+                [removed addObject:statementPk];
+                
+                for (TXLMovingObject *mo_ in [mo movingObjectNotInIntervalFrom:op.timestamp
+                                                                            to:nil].movingObjects) {
+                    [created addObject:[self setSubject:st.subject
+                                              predicate:st.predicate
+                                                 object:st.object
+                                              inContext:op.context
+                                        forMovingObject:mo_]];
+                }
+                
+                [created addObject:[self setSubject:st.subject
+                                          predicate:st.predicate
+                                             object:st.object
+                                          inContext:op.context
+                                    forMovingObject:[TXLMovingObject movingObjectWithGeometry:op.geometry
+                                                                                         begin:op.timestamp
+                                                                                           end:nil]]];
+            }
+        }
+        
+        // Without an open-ended moving object, the statement
+        // is valid in the geometry from the timestamp on.
+        
+        if ([result count] == 0) {
+            [created addObject:[self setSubject:st.subject
+                                      predicate:st.predicate
+                                         object:st.object
+                                      inContext:op.context
+                                forMovingObject:[TXLMovingObject movingObjectWithGeometry:op.geometry
+                                                                                     begin:op.timestamp
+                                                                                       end:nil]]];
+        }
+    }
+    
+    return YES;
+}
+
 - (BOOL)statement:(TXLStatement *)stmnt
  withMovingObject:(TXLMovingObject *)mo
    isInStatements:(NSArray *)stmnts
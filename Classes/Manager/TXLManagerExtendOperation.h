@@ -0,0 +1,61 @@
+//
+//  TXLManagerExtendOperation.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 28.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import <Foundation/Foundation.h>
+
+@class TXLContext;
+@class TXLGeometryCollection;
+
+/*! Operation to extend the trajectories of statements by one position.
+ *
+ *  In contrast to an update operation, the context is not cleared in
+ *  an interval. Only the statements of the operation are changed: a
+ *  snapshot is appended to the open-ended moving object (without end)
+ *  of each statement, so that the statement is valid in the geometry
+ *  from the timestamp on. Other statements in the context are not changed.
+ */
+@interface TXLManagerExtendOperation : NSObject {
+
+@private
+    TXLContext *context_;
+    NSArray *statements_;
+    NSDate *timestamp_;
+    TXLGeometryCollection *geometry_;
+}
+
+@property (readonly) TXLContext *context;
+@property (readonly) NSArray *statements;
+@property (readonly) NSDate *timestamp;
+@property (readonly) TXLGeometryCollection *geometry;
+
++ (TXLManagerExtendOperation *)operationForContext:(TXLContext *)ctx
+                                    withStatements:(NSArray *)statements
+                                         timestamp:(NSDate *)timestamp
+                                          geometry:(TXLGeometryCollection *)geometry;
+
+- (id)initWithContext:(TXLContext *)ctx
+           statements:(NSArray *)statements
+            timestamp:(NSDate *)timestamp
+             geometry:(TXLGeometryCollection *)geometry;
+
+@end
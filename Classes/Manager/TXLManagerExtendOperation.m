@@ -0,0 +1,65 @@
+//
+//  TXLManagerExtendOperation.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 28.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import "TXLManagerExtendOperation.h"
+
+
+@implementation TXLManagerExtendOperation
+
+@synthesize context = context_;
+@synthesize statements = statements_;
+@synthesize timestamp = timestamp_;
+@synthesize geometry = geometry_;
+
++ (TXLManagerExtendOperation *)operationForContext:(TXLContext *)ctx
+                                    withStatements:(NSArray *)statements
+                                         timestamp:(NSDate *)timestamp
+                                          geometry:(TXLGeometryCollection *)geometry {
+    return [[[self alloc] initWithContext:ctx
+                               statements:statements
+                                timestamp:timestamp
+                                 geometry:geometry] autorelease];
+}
+
+- (id)initWithContext:(TXLContext *)ctx
+           statements:(NSArray *)statements
+            timestamp:(NSDate *)timestamp
+             geometry:(TXLGeometryCollection *)geometry {
+    if ((self = [super init])) {
+        context_ = [ctx retain];
+        statements_ = [statements copy];
+        timestamp_ = [timestamp retain];
+        geometry_ = [geometry retain];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [context_ release];
+    [statements_ release];
+    [timestamp_ release];
+    [geometry_ release];
+    [super dealloc];
+}
+
+@end
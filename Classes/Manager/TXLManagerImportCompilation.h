@@ -0,0 +1,77 @@
+//
+//  TXLManagerImportCompilation.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 25.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import <Foundation/Foundation.h>
+#import <dispatch/dispatch.h>
+
+
+/*! Compilation of the spatial situation stored in a file.
+ *
+ *  The compilation is started on a concurrent queue when the object
+ *  is created, so that the files of several import operations are
+ *  parsed in parallel. The writer of the manager takes the results
+ *  one after another in the order of the operations; taking the
+ *  result waits until the compilation of this file has finished.
+ *
+ *  The compilation does not write to the database. The result contains
+ *  the URL of the context instead of the context (see
+ *  TXLSpatialSituationImporterDeferContextOption), which is created by
+ *  the writer in the transaction of the import.
+ */
+@interface TXLManagerImportCompilation : NSObject {
+
+@private
+    NSString *path;
+    dispatch_semaphore_t done;
+    NSDictionary *result;
+    NSError *error;
+}
+
+#pragma mark -
+#pragma mark Autorelease Constructor
+
+/*! Start the compilation of the file at path.
+ */
++ (TXLManagerImportCompilation *)compilationOfFileAtPath:(NSString *)path;
+
+#pragma mark -
+#pragma mark Initialization
+
+- (id)initWithPath:(NSString *)path;
+
+#pragma mark -
+#pragma mark Result
+
+@property (readonly) NSString *path;
+
+/*! Wait for the compilation and return its result (see
+ *  +[TXLSpatialSituationImporter compileSpatialSituationWithExpression:...]).
+ *  The compilation releases the result, so that it can only be taken once.
+ *
+ *  If the compilation failed, nil is returned and the error is stored
+ *  in the error input variable. The user info of the error contains the
+ *  path of the file (NSFilePathErrorKey).
+ */
+- (NSDictionary *)takeResult:(NSError **)error;
+
+@end
@@ -0,0 +1,102 @@
+//
+//  TXLManagerImportCompilation.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 25.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import "TXLManagerImportCompilation.h"
+
+#import "TXLSpatialSituationImporter.h"
+
+
+@implementation TXLManagerImportCompilation
+
+@synthesize path;
+
+#pragma mark -
+#pragma mark Memory Management
+
++ (TXLManagerImportCompilation *)compilationOfFileAtPath:(NSString *)path {
+    return [[[self alloc] initWithPath:path] autorelease];
+}
+
+- (id)initWithPath:(NSString *)p {
+    if ((self = [super init])) {
+        path = [p copy];
+        done = dispatch_semaphore_create(0);
+        
+        // The parser is reentrant (see spatialsituation.ym), each
+        // compilation uses its own instance of the importer. The
+        // context is not created by the compilation, it would wait
+        // for the transaction of the writer.
+        
+        NSDictionary *options = [NSDictionary dictionaryWithObject:[NSNumber numberWithBool:YES]
+                                                            forKey:TXLSpatialSituationImporterDeferContextOption];
+        
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            NSAutoreleasePool *pool = [NSAutoreleasePool new];
+            NSError *e = nil;
+            result = [[TXLSpatialSituationImporter compileSpatialSituationWithContentsOfFile:path
+                                                                                  parameters:nil
+                                                                                     options:options
+                                                                                       error:&e] retain];
+            if (result == nil) {
+                
+                // The error names the file of this compilation, so
+                // that it can be assigned to the failed operation.
+                
+                NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:[e userInfo]];
+                [userInfo setObject:path forKey:NSFilePathErrorKey];
+                error = [[NSError alloc] initWithDomain:(e != nil ? [e domain] : TXLSpatialSituationImporterErrorDomain)
+                                                   code:(e != nil ? [e code] : SPATIAL_SITUATION_COMPILER_ERROR_SYNTAX_ERROR)
+                                               userInfo:userInfo];
+            }
+            [pool drain];
+            dispatch_semaphore_signal(done);
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    dispatch_release(done);
+    [path release];
+    [result release];
+    [error release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Result
+
+- (NSDictionary *)takeResult:(NSError **)_error {
+    dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+    dispatch_semaphore_signal(done);
+    
+    NSDictionary *r = [result autorelease];
+    result = nil;
+    
+    if (r == nil && _error != nil) {
+        *_error = [[error retain] autorelease];
+    }
+    return r;
+}
+
+@end
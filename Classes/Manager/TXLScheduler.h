@@ -0,0 +1,141 @@
+//
+//  TXLScheduler.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 23.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import <Foundation/Foundation.h>
+#import <dispatch/dispatch.h>
+
+/*! Priority classes of the work done by the manager.
+ *
+ *  TXLSchedulerPriorityInteractive - updates of contexts by the application
+ *  TXLSchedulerPriorityContinuous  - evaluations of continuous queries and
+ *                                    the updates caused by situation definitions
+ *  TXLSchedulerPriorityBackfill    - first evaluations of queries and imports
+ *  TXLSchedulerPriorityMaintenance - clearing contexts of removed situation definitions
+ */
+typedef enum {
+    TXLSchedulerPriorityInteractive = 0,
+    TXLSchedulerPriorityContinuous,
+    TXLSchedulerPriorityBackfill,
+    TXLSchedulerPriorityMaintenance
+} TXLSchedulerPriority;
+
+#define TXL_SCHEDULER_NUMBER_OF_PRIORITIES 4
+
+
+/*! Scheduler for the blocks of a serial queue.
+ *
+ *  The blocks are executed one after another on the queue. The
+ *  next block is taken from the highest priority class with a
+ *  scheduled block, in the order they have been scheduled. To avoid
+ *  starvation each class has a deadline. A block, which waits longer
+ *  than the deadline of its class, is executed before all blocks
+ *  not exceeding their deadline (the block with the earliest deadline
+ *  first).
+ *
+ *  Blocks changing the same context are never reordered: a block is
+ *  only executed if no block scheduled before it changes one of its
+ *  contexts. A block waiting for such a block passes its priority and
+ *  deadline on to it.
+ *
+ *  The scheduler also keeps the statistics (number of waiting tasks
+ *  and wait time) for each priority class. Tasks executed on other
+ *  queues can be included in the statistics with the methods
+ *  taskScheduledWithPriority: and taskStartedWithPriority:scheduledAt:.
+ */
+@interface TXLScheduler : NSObject {
+
+@private
+    dispatch_queue_t queue;
+    dispatch_group_t group;
+    
+    // scheduled blocks (block, priority, contexts, date, deadline)
+    // in the order they have been scheduled
+    NSMutableArray *scheduledBlocks;
+    
+    NSTimeInterval deadline[TXL_SCHEDULER_NUMBER_OF_PRIORITIES];
+    
+    NSUInteger waiting[TXL_SCHEDULER_NUMBER_OF_PRIORITIES];
+    NSUInteger started[TXL_SCHEDULER_NUMBER_OF_PRIORITIES];
+    NSTimeInterval totalWaitTime[TXL_SCHEDULER_NUMBER_OF_PRIORITIES];
+    NSTimeInterval maximumWaitTime[TXL_SCHEDULER_NUMBER_OF_PRIORITIES];
+}
+
+#pragma mark -
+#pragma mark Initialization
+
+/*! Initialize the scheduler with a serial queue and a group.
+ *  Each scheduled block is associated with the group.
+ */
+- (id)initWithQueue:(dispatch_queue_t)queue
+              group:(dispatch_group_t)group;
+
+#pragma mark -
+#pragma mark Scheduling Blocks
+
+/*! Schedule a block for the execution on the queue of the scheduler.
+ *
+ *  contexts - The keys of the contexts changed by the block (e.g., their
+ *             primary keys as TXLInteger). The block is executed after
+ *             all blocks scheduled before, which change one of these
+ *             contexts. If the contexts are not known in advance (nil),
+ *             the block is executed after all blocks scheduled before
+ *             and before all blocks scheduled after it.
+ */
+- (void)scheduleBlock:(dispatch_block_t)block
+         withPriority:(TXLSchedulerPriority)priority
+             contexts:(NSSet *)contexts;
+
+/*! Maximum wait time of a block in this priority class, before it
+ *  is preferred to blocks of higher priority classes.
+ *
+ *  Defaults: interactive 0s, continuous 1s, backfill 10s,
+ *  maintenance 60s.
+ */
+- (NSTimeInterval)deadlineForPriority:(TXLSchedulerPriority)priority;
+- (void)setDeadline:(NSTimeInterval)deadline
+        forPriority:(TXLSchedulerPriority)priority;
+
+#pragma mark -
+#pragma mark Statistics
+
+/*! Note a task scheduled on another queue.
+ */
+- (void)taskScheduledWithPriority:(TXLSchedulerPriority)priority;
+
+/*! Note the start of a task scheduled on another queue at the given date.
+ */
+- (void)taskStartedWithPriority:(TXLSchedulerPriority)priority
+                    scheduledAt:(NSDate *)date;
+
+/*! Number of tasks of this priority class, which are scheduled but
+ *  not yet started.
+ */
+- (NSUInteger)numberOfWaitingTasksWithPriority:(TXLSchedulerPriority)priority;
+
+/*! Average and maximum time between scheduling and the start
+ *  of the tasks of this priority class.
+ */
+- (NSTimeInterval)averageWaitTimeForPriority:(TXLSchedulerPriority)priority;
+- (NSTimeInterval)maximumWaitTimeForPriority:(TXLSchedulerPriority)priority;
+
+@end
@@ -0,0 +1,248 @@
+//
+//  TXLScheduler.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 23.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import "TXLScheduler.h"
+
+@interface TXLScheduler ()
+
+- (void)executeNextBlock;
+
+@end
+
+// YES, if the block scheduled later has to wait for the block
+// scheduled before (see scheduleBlock:withPriority:contexts:).
+static BOOL TXLSchedulerBlocksConflict(NSDictionary *before, NSDictionary *later) {
+    id contexts1 = [before objectForKey:@"contexts"];
+    id contexts2 = [later objectForKey:@"contexts"];
+    if (contexts1 == [NSNull null] || contexts2 == [NSNull null]) {
+        return YES;
+    }
+    return [contexts1 intersectsSet:contexts2];
+}
+
+
+@implementation TXLScheduler
+
+#pragma mark -
+#pragma mark Memory Management
+
+- (id)initWithQueue:(dispatch_queue_t)q
+              group:(dispatch_group_t)g {
+    if ((self = [super init])) {
+        queue = q;
+        dispatch_retain(queue);
+        group = g;
+        dispatch_retain(group);
+        
+        scheduledBlocks = [[NSMutableArray alloc] init];
+        
+        deadline[TXLSchedulerPriorityInteractive] = 0;
+        deadline[TXLSchedulerPriorityContinuous] = 1;
+        deadline[TXLSchedulerPriorityBackfill] = 10;
+        deadline[TXLSchedulerPriorityMaintenance] = 60;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [scheduledBlocks release];
+    dispatch_release(queue);
+    dispatch_release(group);
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Scheduling Blocks
+
+- (void)scheduleBlock:(dispatch_block_t)block
+         withPriority:(TXLSchedulerPriority)priority
+             contexts:(NSSet *)contexts {
+    
+    NSDate *date = [NSDate date];
+    
+    @synchronized (self) {
+        NSDictionary *entry = [NSDictionary dictionaryWithObjectsAndKeys:
+                               [[block copy] autorelease], @"block",
+                               [NSNumber numberWithInt:priority], @"priority",
+                               contexts != nil ? (id)[[contexts copy] autorelease] : (id)[NSNull null], @"contexts",
+                               date, @"date",
+                               [date dateByAddingTimeInterval:deadline[priority]], @"deadline",
+                               nil];
+        [scheduledBlocks addObject:entry];
+        waiting[priority]++;
+    }
+    
+    // Each scheduled block dispatches one call of executeNextBlock
+    // to the queue. This call executes the next block by priority,
+    // which is not necessarily the block scheduled here.
+    
+    dispatch_group_async(group, queue, ^{
+        [self executeNextBlock];
+    });
+}
+
+- (NSTimeInterval)deadlineForPriority:(TXLSchedulerPriority)priority {
+    @synchronized (self) {
+        return deadline[priority];
+    }
+}
+
+- (void)setDeadline:(NSTimeInterval)interval
+        forPriority:(TXLSchedulerPriority)priority {
+    @synchronized (self) {
+        deadline[priority] = interval;
+    }
+}
+
+#pragma mark -
+#pragma mark Statistics
+
+- (void)taskScheduledWithPriority:(TXLSchedulerPriority)priority {
+    @synchronized (self) {
+        waiting[priority]++;
+    }
+}
+
+- (void)taskStartedWithPriority:(TXLSchedulerPriority)priority
+                    scheduledAt:(NSDate *)date {
+    NSTimeInterval wait = -[date timeIntervalSinceNow];
+    @synchronized (self) {
+        waiting[priority]--;
+        started[priority]++;
+        totalWaitTime[priority] += wait;
+        if (wait > maximumWaitTime[priority]) {
+            maximumWaitTime[priority] = wait;
+        }
+    }
+}
+
+- (NSUInteger)numberOfWaitingTasksWithPriority:(TXLSchedulerPriority)priority {
+    @synchronized (self) {
+        return waiting[priority];
+    }
+}
+
+- (NSTimeInterval)averageWaitTimeForPriority:(TXLSchedulerPriority)priority {
+    @synchronized (self) {
+        if (started[priority] == 0) {
+            return 0;
+        }
+        return totalWaitTime[priority] / started[priority];
+    }
+}
+
+- (NSTimeInterval)maximumWaitTimeForPriority:(TXLSchedulerPriority)priority {
+    @synchronized (self) {
+        return maximumWaitTime[priority];
+    }
+}
+
+#pragma mark -
+#pragma mark Executing Blocks
+
+- (void)executeNextBlock {
+    
+    NSAutoreleasePool *pool = [NSAutoreleasePool new];
+    
+    NSDictionary *entry = nil;
+    
+    @synchronized (self) {
+        
+        NSUInteger n = [scheduledBlocks count];
+        
+        // There is at least one block for each call of this method.
+        assert(n > 0);
+        
+        // A block is ready, if no block scheduled before changes one
+        // of its contexts. A waiting block passes its priority and its
+        // deadline on to the blocks it waits for. The blocks are visited
+        // from the last one, so that they are passed on along a chain
+        // of waiting blocks. The number of scheduled blocks is small
+        // (the evaluations of the queries are not scheduled here).
+        
+        int *priorities = malloc(n * sizeof(int));
+        NSTimeInterval *deadlines = malloc(n * sizeof(NSTimeInterval));
+        BOOL *ready = malloc(n * sizeof(BOOL));
+        
+        for (NSUInteger i = 0; i < n; i++) {
+            NSDictionary *e = [scheduledBlocks objectAtIndex:i];
+            priorities[i] = [[e objectForKey:@"priority"] intValue];
+            deadlines[i] = [[e objectForKey:@"deadline"] timeIntervalSinceReferenceDate];
+            ready[i] = YES;
+        }
+        
+        for (NSUInteger i = n; i-- > 0;) {
+            NSDictionary *later = [scheduledBlocks objectAtIndex:i];
+            for (NSUInteger j = 0; j < i; j++) {
+                if (TXLSchedulerBlocksConflict([scheduledBlocks objectAtIndex:j], later)) {
+                    ready[i] = NO;
+                    priorities[j] = MIN(priorities[j], priorities[i]);
+                    deadlines[j] = MIN(deadlines[j], deadlines[i]);
+                }
+            }
+        }
+        
+        NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+        NSInteger next = -1;
+        
+        // Blocks exceeding their deadline, the earliest deadline first.
+        
+        for (NSUInteger i = 0; i < n; i++) {
+            if (ready[i] && deadlines[i] <= now &&
+                (next < 0 || deadlines[i] < deadlines[next])) {
+                next = i;
+            }
+        }
+        
+        // Otherwise the block with the highest priority.
+        
+        if (next < 0) {
+            for (NSUInteger i = 0; i < n; i++) {
+                if (ready[i] && (next < 0 || priorities[i] < priorities[next])) {
+                    next = i;
+                }
+            }
+        }
+        
+        free(priorities);
+        free(deadlines);
+        free(ready);
+        
+        // The first scheduled block is always ready.
+        assert(next >= 0);
+        
+        entry = [[scheduledBlocks objectAtIndex:next] retain];
+        [scheduledBlocks removeObjectAtIndex:next];
+        
+        [self taskStartedWithPriority:[[entry objectForKey:@"priority"] intValue]
+                          scheduledAt:[entry objectForKey:@"date"]];
+    }
+    
+    dispatch_block_t block = [entry objectForKey:@"block"];
+    block();
+    
+    [entry release];
+    [pool drain];
+}
+
+@end
@@ -0,0 +1,96 @@
+//
+//  TXLSituationCascade.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 24.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import <Foundation/Foundation.h>
+#import <dispatch/dispatch.h>
+
+@class TXLQuery;
+@class TXLRevision;
+
+
+/*! Propagation of a change through the situation definitions.
+ *
+ *  The situation definitions are ordered by their dependencies: a
+ *  definition reading the context of another definition has a higher
+ *  level than this definition. The definitions affected by a change are
+ *  evaluated level by level. The updates of all definitions of a level
+ *  are applied in one revision, and a definition is evaluated once,
+ *  after all definitions it depends on have been evaluated.
+ *
+ *  The cascade only holds the state of the propagation. The evaluation
+ *  is done by the manager.
+ */
+@interface TXLSituationCascade : NSObject {
+
+@private
+    dispatch_group_t group;
+    
+    // query primary key -> definition (query, level, revision, activation)
+    NSMutableDictionary *definitions;
+    
+    NSMutableArray *operations;
+}
+
+#pragma mark -
+#pragma mark Autorelease Constructor
+
++ (TXLSituationCascade *)cascade;
+
+#pragma mark -
+#pragma mark Evaluations
+
+/*! Group of the evaluations of the current level. Each evaluation
+ *  enters the group when it is scheduled and leaves it when it is
+ *  finished.
+ */
+@property (readonly) dispatch_group_t group;
+
+/*! Add a situation definition, which is affected by the changes in the
+ *  revision. If the definition is already part of the cascade, the
+ *  revision and activation are replaced.
+ */
+- (void)addDefinition:(TXLQuery *)query
+            withLevel:(NSUInteger)level
+             revision:(TXLRevision *)rev
+           activation:(NSDictionary *)activation;
+
+/*! Remove and return the definitions with the lowest level.
+ *
+ *  Returns a list of dictionaries with the keys "query", "revision"
+ *  and "activation" (optional).
+ */
+- (NSArray *)takeDefinitionsOfLowestLevel;
+
+#pragma mark -
+#pragma mark Update Operations
+
+/*! Add the update operations (TXLManagerUpdateOperation)
+ *  resulting from the evaluation of a definition.
+ */
+- (void)addOperations:(NSArray *)ops;
+
+/*! Remove and return the update operations of the current level.
+ */
+- (NSArray *)takeOperations;
+
+@end
@@ -0,0 +1,118 @@
+//
+//  TXLSituationCascade.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 24.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import "TXLSituationCascade.h"
+
+#import "TXLQuery.h"
+#import "TXLRevision.h"
+#import "TXLInteger.h"
+
+
+@implementation TXLSituationCascade
+
+@synthesize group;
+
+#pragma mark -
+#pragma mark Memory Management
+
++ (TXLSituationCascade *)cascade {
+    return [[[self alloc] init] autorelease];
+}
+
+- (id)init {
+    if ((self = [super init])) {
+        group = dispatch_group_create();
+        definitions = [[NSMutableDictionary alloc] init];
+        operations = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    dispatch_release(group);
+    [definitions release];
+    [operations release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Evaluations
+
+- (void)addDefinition:(TXLQuery *)query
+            withLevel:(NSUInteger)level
+             revision:(TXLRevision *)rev
+           activation:(NSDictionary *)activation {
+    
+    NSMutableDictionary *definition = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                                       query, @"query",
+                                       [NSNumber numberWithUnsignedInteger:level], @"level",
+                                       rev, @"revision",
+                                       nil];
+    if (activation != nil) {
+        [definition setObject:activation forKey:@"activation"];
+    }
+    
+    @synchronized (self) {
+        [definitions setObject:definition
+                        forKey:[TXLInteger integerWithValue:query.primaryKey]];
+    }
+}
+
+- (NSArray *)takeDefinitionsOfLowestLevel {
+    @synchronized (self) {
+        
+        NSUInteger lowestLevel = NSNotFound;
+        for (NSDictionary *definition in [definitions allValues]) {
+            lowestLevel = MIN(lowestLevel, [[definition objectForKey:@"level"] unsignedIntegerValue]);
+        }
+        
+        NSMutableArray *result = [NSMutableArray array];
+        for (TXLInteger *queryPk in [definitions allKeys]) {
+            NSDictionary *definition = [definitions objectForKey:queryPk];
+            if ([[definition objectForKey:@"level"] unsignedIntegerValue] == lowestLevel) {
+                [result addObject:definition];
+                [definitions removeObjectForKey:queryPk];
+            }
+        }
+        return result;
+    }
+}
+
+#pragma mark -
+#pragma mark Update Operations
+
+- (void)addOperations:(NSArray *)ops {
+    @synchronized (self) {
+        [operations addObjectsFromArray:ops];
+    }
+}
+
+- (NSArray *)takeOperations {
+    @synchronized (self) {
+        NSArray *result = [[operations copy] autorelease];
+        [operations removeAllObjects];
+        return result;
+    }
+}
+
+@end
@@ -33,14 +33,31 @@
 @private
     NSUInteger primaryKey;
     void * _collection;
+    
+    // cached with the collection
+    TXLBoundingBox _boundingBox;
+    BOOL _rectangle;
+    NSUInteger _numberOfPoints;
+    
+    // spatialite blob, identifying the content
+    NSData *_contentKey;
 }
 
 + (TXLGeometryCollection *)geometryFromWKT:(NSString *)wkt;
 
+/*! Create a geometry from a NUL-terminated UTF-8 WKT string (e.g., the
+ *  buffer of a scanner) without creating an NSString first. The parsed
+ *  geometry is used as it is and not copied.
+ */
++ (TXLGeometryCollection *)geometryFromWKTCString:(const char *)wkt;
+
 + (TXLGeometryCollection *)geometryWithPoints:(NSArray *)points
                                   linestrings:(NSArray *)linestrings
                                      polygons:(NSArray *)polygons;
 
++ (TXLGeometryCollection *)geometryWithCoordinates:(const TXLCoordinate *)coordinates
+                                             count:(NSUInteger)count;
+
 + (TXLGeometryCollection *)geometryForEntireWorld;
 
 #pragma mark -
@@ -61,6 +78,12 @@
 
 @property (readonly, getter=isEmpty) BOOL empty;
 
+/*! YES, if the geometry is the polygon covering the entire
+ *  world (see +geometryForEntireWorld), regardless of the
+ *  orientation and the first vertex of the ring.
+ */
+@property (readonly, getter=isEntireWorld) BOOL entireWorld;
+
 #pragma mark -
 #pragma mark Relations
 
@@ -80,6 +103,30 @@
 - (TXLGeometryCollection *)difference:(TXLGeometryCollection *)other;
 - (TXLGeometryCollection *)symDifference:(TXLGeometryCollection *)other;
 
+/*! The union of the geometries in the array (nil, if the array contains
+ *  no geometry). The geometries are united pairwise in a balanced tree
+ *  (cascaded union) instead of adding one geometry after the other to
+ *  a growing result. Consecutive entries with the same geometry object
+ *  and nil entries are skipped.
+ */
++ (TXLGeometryCollection *)unionOfGeometries:(TXLGeometryCollection * const *)geometries
+                                       count:(NSUInteger)count;
+
+#pragma mark -
+#pragma mark Statistics
+
+/*! Number of relations (contains, disjoint, intersects, within) and
+ *  intersections, which have been tested with the bounding boxes of
+ *  the geometries, and the number of these tests, which decided the
+ *  result without calling GEOS (e.g., disjoint bounding boxes or a
+ *  rectangle containing the bounding box of the other geometry).
+ *
+ *  The tests of the operations on moving objects are included
+ *  (see TXLMovingObjectSequence).
+ */
++ (NSUInteger)numberOfBoundingBoxTests;
++ (NSUInteger)numberOfBoundingBoxRejections;
+
 #pragma mark -
 #pragma mark Database Management
 
@@ -90,4 +137,46 @@
 
 - (TXLGeometryCollection *)save:(NSError **)error;
 
+/*! Store one point geometry for each coordinate, without creating
+ *  a geometry object for it. The primary keys of the stored geometries
+ *  are written to primaryKeys, which must have room for count values.
+ */
++ (BOOL)savePointsWithCoordinates:(const TXLCoordinate *)coordinates
+                            count:(NSUInteger)count
+                      primaryKeys:(NSUInteger *)primaryKeys
+                            error:(NSError **)error;
+
+#pragma mark -
+#pragma mark Private Framework Methods
+
+/*! Note a test of two bounding boxes done outside of this
+ *  class (see +numberOfBoundingBoxTests).
+ */
++ (void)noteBoundingBoxTestRejected:(BOOL)rejected;
+
+/*! Number of vertices of all points, linestrings and rings.
+ */
+@property (readonly) NSUInteger numberOfPoints;
+
+/*! The spatialite blob of the geometry, which identifies equal
+ *  geometries in the TXLPreparedGeometryCache.
+ */
+@property (readonly) NSData *contentKey;
+
+/*! Create a GEOS geometry (GEOSGeometry) of this geometry in the
+ *  GEOS context of the current thread (see TXLGEOSContext). The caller
+ *  is responsible to destroy it with GEOSGeom_destroy_r.
+ */
+- (void *)createGEOSGeometry;
+
 @end
+
+/*! The GEOS context (GEOSContextHandle_t) of the current thread.
+ *
+ *  Since queries are evaluated concurrently, GEOS is only called with
+ *  the reentrant functions (GEOS..._r) and the context of the calling
+ *  thread. The context is created on first use and finished with the
+ *  thread. A GEOS geometry can be used in another context, but not by
+ *  several threads at once.
+ */
+void *TXLGEOSContext(void);
@@ -26,6 +26,8 @@
 #import "TXLPoint.h"
 #import "TXLLinestring.h"
 #import "TXLPolygon.h"
+#import "TXLPreparedGeometryCache.h"
+#import "TXLPointKernels.h"
 
 #import "TXLDatabase.h"
 #import "TXLInteger.h"
@@ -37,6 +39,21 @@
 
 #import <geos_c.h>
 
+#import <libkern/OSAtomic.h>
+
+static volatile int64_t numberOfBoundingBoxTests = 0;
+static volatile int64_t numberOfBoundingBoxRejections = 0;
+
+static void TXLNoteBoundingBoxTest(BOOL rejected) {
+    OSAtomicIncrement64(&numberOfBoundingBoxTests);
+    if (rejected) {
+        OSAtomicIncrement64(&numberOfBoundingBoxRejections);
+    }
+}
+
+#pragma mark -
+#pragma mark GEOS
+
 static void _geos_error (const char *fmt, ...)
 {
     // TODO: Better error reporting
@@ -50,12 +67,174 @@ static void _geos_error (const char *fmt, ...)
     fprintf (stdout, "\n");
 }
 
+// Each thread uses its own GEOS context, like each thread uses its
+// own connection to the database (see TXLDatabase). The context is
+// kept in the thread dictionary and finished with the thread.
+
+@interface TXLGEOSContextHandle : NSObject {
+@public
+    GEOSContextHandle_t handle;
+}
+@end
+
+@implementation TXLGEOSContextHandle
+
+- (id)init {
+    if ((self = [super init])) {
+        handle = initGEOS_r(_geos_error, _geos_error);
+        if (handle == NULL) {
+            [self release];
+            [NSException raise:@"TXLGEOSException" format:@"Could not initialize a GEOS context."];
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    finishGEOS_r(handle);
+    [super dealloc];
+}
+
+@end
+
+void *TXLGEOSContext(void) {
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    TXLGEOSContextHandle *context = [threadDictionary objectForKey:@"org.opentxl.TXLGEOSContext"];
+    if (context == nil) {
+        context = [[[TXLGEOSContextHandle alloc] init] autorelease];
+        [threadDictionary setObject:context forKey:@"org.opentxl.TXLGEOSContext"];
+    }
+    return context->handle;
+}
+
+// The gaia functions of spatialite use the global context of GEOS
+// (see initGEOS). Instead the geometries are converted with WKB and
+// passed to the reentrant functions of GEOS.
+
+static GEOSGeometry *TXLGEOSGeometryFromGaia(GEOSContextHandle_t handle, gaiaGeomCollPtr geometry) {
+    if (gaiaIsEmpty(geometry)) {
+        return GEOSGeom_createCollection_r(handle, GEOS_GEOMETRYCOLLECTION, NULL, 0);
+    }
+    
+    unsigned char *wkb = NULL;
+    int size = 0;
+    gaiaToWkb(geometry, &wkb, &size);
+    if (wkb == NULL) {
+        return NULL;
+    }
+    
+    GEOSGeometry *result = GEOSGeomFromWKB_buf_r(handle, wkb, size);
+    free(wkb);
+    return result;
+}
+
+static gaiaGeomCollPtr TXLGaiaFromGEOSGeometry(GEOSContextHandle_t handle, const GEOSGeometry *geometry) {
+    gaiaGeomCollPtr result;
+    if (GEOSisEmpty_r(handle, geometry) == 1) {
+        result = gaiaAllocGeomColl();
+    } else {
+        size_t size = 0;
+        unsigned char *wkb = GEOSGeomToWKB_buf_r(handle, geometry, &size);
+        if (wkb == NULL) {
+            return NULL;
+        }
+        result = gaiaFromWkb(wkb, (unsigned int)size);
+        GEOSFree_r(handle, wkb);
+    }
+    if (result) {
+        result->Srid = 4326;
+    }
+    return result;
+}
+
+static int TXLGEOSIsValid(gaiaGeomCollPtr geometry) {
+    GEOSContextHandle_t handle = TXLGEOSContext();
+    GEOSGeometry *g = TXLGEOSGeometryFromGaia(handle, geometry);
+    if (g == NULL) {
+        return 0;
+    }
+    char result = GEOSisValid_r(handle, g);
+    GEOSGeom_destroy_r(handle, g);
+    return result == 1;
+}
+
+static int TXLGEOSPredicate(char (*predicate)(GEOSContextHandle_t, const GEOSGeometry *, const GEOSGeometry *),
+                            gaiaGeomCollPtr geometry1, gaiaGeomCollPtr geometry2) {
+    GEOSContextHandle_t handle = TXLGEOSContext();
+    GEOSGeometry *g1 = TXLGEOSGeometryFromGaia(handle, geometry1);
+    GEOSGeometry *g2 = TXLGEOSGeometryFromGaia(handle, geometry2);
+    
+    // GEOS reports an exception with the value 2.
+    char result = 2;
+    if (g1 && g2) {
+        result = predicate(handle, g1, g2);
+    }
+    if (g1) {
+        GEOSGeom_destroy_r(handle, g1);
+    }
+    if (g2) {
+        GEOSGeom_destroy_r(handle, g2);
+    }
+    return result == 1;
+}
+
+static gaiaGeomCollPtr TXLGEOSOperation(GEOSGeometry *(*operation)(GEOSContextHandle_t, const GEOSGeometry *, const GEOSGeometry *),
+                                        gaiaGeomCollPtr geometry1, gaiaGeomCollPtr geometry2) {
+    GEOSContextHandle_t handle = TXLGEOSContext();
+    GEOSGeometry *g1 = TXLGEOSGeometryFromGaia(handle, geometry1);
+    GEOSGeometry *g2 = TXLGEOSGeometryFromGaia(handle, geometry2);
+    
+    gaiaGeomCollPtr result = NULL;
+    if (g1 && g2) {
+        GEOSGeometry *g3 = operation(handle, g1, g2);
+        if (g3) {
+            result = TXLGaiaFromGEOSGeometry(handle, g3);
+            GEOSGeom_destroy_r(handle, g3);
+        }
+    }
+    if (g1) {
+        GEOSGeom_destroy_r(handle, g1);
+    }
+    if (g2) {
+        GEOSGeom_destroy_r(handle, g2);
+    }
+    return result;
+}
+
+#pragma mark -
+#pragma mark Bounding Boxes
+
+static BOOL TXLBoundingBoxesDisjoint(TXLBoundingBox a, TXLBoundingBox b) {
+    return a.maxLongitude < b.minLongitude || b.maxLongitude < a.minLongitude ||
+           a.maxLatitude < b.minLatitude || b.maxLatitude < a.minLatitude;
+}
+
+// YES, if the box b lies in the box a (including the boundary of a).
+static BOOL TXLBoundingBoxContainsBox(TXLBoundingBox a, TXLBoundingBox b) {
+    return b.minLongitude >= a.minLongitude && b.maxLongitude <= a.maxLongitude &&
+           b.minLatitude >= a.minLatitude && b.maxLatitude <= a.maxLatitude;
+}
+
+// YES, if the box b lies in the interior of the box a.
+static BOOL TXLBoundingBoxContainsBoxProperly(TXLBoundingBox a, TXLBoundingBox b) {
+    return b.minLongitude > a.minLongitude && b.maxLongitude < a.maxLongitude &&
+           b.minLatitude > a.minLatitude && b.maxLatitude < a.maxLatitude;
+}
+
+static TXLGeometryCollection *TXLEmptyGeometry() {
+    gaiaGeomCollPtr empty = gaiaAllocGeomColl();
+    empty->Srid = 4326;
+    return [[[TXLGeometryCollection alloc] initWithGaiaGeomCollNoCopy:empty] autorelease];
+}
+
 @interface TXLGeometryCollection ()
 - (id)initWithPrimaryKey:(NSUInteger)pk;
 - (id)initWithPoints:(NSArray *)points
          linestrings:(NSArray *)linestrings
             polygons:(NSArray *)polygons;
 - (id)initWithGaiaGeomColl:(gaiaGeomCollPtr)ptr;
+- (id)initWithGaiaGeomCollNoCopy:(gaiaGeomCollPtr)ptr;
+- (void)cacheBoundingBox;
 @property (readonly) gaiaGeomCollPtr _collection;
 @end
 
@@ -67,19 +246,23 @@ static void _geos_error (const char *fmt, ...)
 + (void)load {
     // Initialize the GEOS library on start. This has to be
     // done before any function of spatialite (gaia...) is
-    // called, which uses that library.
+    // called, which uses that library. The framework itself
+    // uses the context of the thread (see TXLGEOSContext).
     initGEOS (_geos_error, _geos_error);
 }
 
 + (TXLGeometryCollection *)geometryFromWKT:(NSString *)wkt {
-    gaiaGeomCollPtr geom = gaiaParseWkt((const unsigned char *)[wkt cStringUsingEncoding:NSUTF8StringEncoding], -1);
+    return [self geometryFromWKTCString:[wkt UTF8String]];
+}
+
++ (TXLGeometryCollection *)geometryFromWKTCString:(const char *)wkt {
+    gaiaGeomCollPtr geom = gaiaParseWkt((const unsigned char *)wkt, -1);
     if (geom) {
         geom->Srid = 4326;
-
-		TXLGeometryCollection *gc = [[[self alloc] initWithGaiaGeomColl:geom] autorelease];
-		gaiaFreeGeomColl(geom);
-		
-        return gc;
+        
+        // The geometry has been created by the parser and is
+        // not shared, it is not necessary to clone it.
+        return [[[self alloc] initWithGaiaGeomCollNoCopy:geom] autorelease];
     } else {
         return nil;
     }
@@ -93,6 +276,16 @@ static void _geos_error (const char *fmt, ...)
                                                  polygons:polygons] autorelease];
 }
 
++ (TXLGeometryCollection *)geometryWithCoordinates:(const TXLCoordinate *)coordinates
+                                             count:(NSUInteger)count {
+    gaiaGeomCollPtr geom = gaiaAllocGeomColl();
+    geom->Srid = 4326;
+    for (NSUInteger i = 0; i < count; i++) {
+        gaiaAddPointToGeomColl(geom, coordinates[i].longitude, coordinates[i].latitude);
+    }
+    return [[[self alloc] initWithGaiaGeomCollNoCopy:geom] autorelease];
+}
+
 + (TXLGeometryCollection *)geometryForEntireWorld {
     return [self geometryFromWKT:@"POLYGON((-180 -90, 180 -90, 180 90, -180 90, -180 -90))"];
 }
@@ -131,11 +324,11 @@ static void _geos_error (const char *fmt, ...)
             }
         }
         
-        gaiaMbrGeometry(_collection);
+        [self cacheBoundingBox];
         
         // TODO: Find out, which checks are needed
         // TODO: Better error handling
-        assert(gaiaIsValid(_collection));
+        assert(TXLGEOSIsValid(_collection));
     }
     return self;
 }
@@ -145,7 +338,21 @@ static void _geos_error (const char *fmt, ...)
         _collection = gaiaCloneGeomColl(ptr);
         // TODO: Better error handling
         assert(_collection);
-        assert(gaiaIsEmpty(_collection) || gaiaIsValid(_collection));
+        [self cacheBoundingBox];
+        assert(gaiaIsEmpty(_collection) || TXLGEOSIsValid(_collection));
+    }
+    return self;
+}
+
+- (id)initWithGaiaGeomCollNoCopy:(gaiaGeomCollPtr)ptr {
+    if ((self = [super init])) {
+        _collection = ptr;
+        assert(_collection);
+        
+        [self cacheBoundingBox];
+        
+        // TODO: Better error handling
+        assert(gaiaIsEmpty(_collection) || TXLGEOSIsValid(_collection));
     }
     return self;
 }
@@ -154,6 +361,7 @@ static void _geos_error (const char *fmt, ...)
     if (_collection) {
         gaiaFreeGeomColl(_collection);
     }
+    [_contentKey release];
     [super dealloc];
 }
 
@@ -161,15 +369,9 @@ static void _geos_error (const char *fmt, ...)
 #pragma mark Accessing Details
 
 - (TXLBoundingBox)boundingBox {
-    TXLBoundingBox bbox;
-    
-    gaiaGeomCollPtr c = self._collection;
-    
-    bbox.minLongitude = c->MinX;
-    bbox.maxLongitude = c->MaxX;
-    bbox.minLatitude = c->MinY;
-    bbox.maxLatitude = c->MaxY;
-    return bbox;
+    // The bounding box is cached, if the collection is set.
+    [self _collection];
+    return _boundingBox;
 }
 
 - (void)iterateOverPoints:(void(^)(TXLCoordinate coordinate, BOOL *stop))iterator {
@@ -264,42 +466,160 @@ static void _geos_error (const char *fmt, ...)
     return gaiaIsEmpty(self._collection) == 1;
 }
 
+- (BOOL)isEntireWorld {
+    TXLBoundingBox bbox = self.boundingBox;
+    return _rectangle &&
+           bbox.minLongitude == -180 && bbox.maxLongitude == 180 &&
+           bbox.minLatitude == -90 && bbox.maxLatitude == 90;
+}
+
 #pragma mark -
 #pragma mark Relations
 
 - (BOOL)contains:(TXLGeometryCollection *)other {
-    return gaiaGeomCollContains(self._collection, other._collection);
+    TXLBoundingBox a = self.boundingBox;
+    TXLBoundingBox b = other.boundingBox;
+    
+    // An empty geometry (with an empty box) is not contained.
+    if (b.minLongitude > b.maxLongitude || !TXLBoundingBoxContainsBox(a, b)) {
+        TXLNoteBoundingBoxTest(YES);
+        return NO;
+    }
+    
+    if (_rectangle && TXLBoundingBoxContainsBoxProperly(a, b)) {
+        TXLNoteBoundingBoxTest(YES);
+        return YES;
+    }
+    
+    TXLNoteBoundingBoxTest(NO);
+    
+    int kernel = TXLPointKernelContains(self._collection, _rectangle, other._collection);
+    if (kernel >= 0) {
+#ifdef DEBUG
+        assert(kernel == TXLGEOSPredicate(GEOSContains_r, self._collection, other._collection));
+#endif
+        return kernel;
+    }
+    
+    int prepared = [[TXLPreparedGeometryCache sharedCache] evaluatePredicate:kTXLPreparedGeometryContains
+                                                                withPrepared:self
+                                                                    geometry:other];
+    if (prepared >= 0) {
+        return prepared;
+    }
+    
+    return TXLGEOSPredicate(GEOSContains_r, self._collection, other._collection);
 }
 
 - (BOOL)disjoint:(TXLGeometryCollection *)other {
-    return gaiaGeomCollDisjoint(self._collection, other._collection);
+    return ![self intersects:other];
 }
 
 - (BOOL)intersects:(TXLGeometryCollection *)other {
-    return gaiaGeomCollIntersects(self._collection, other._collection);
+    TXLBoundingBox a = self.boundingBox;
+    TXLBoundingBox b = other.boundingBox;
+    
+    if (TXLBoundingBoxesDisjoint(a, b)) {
+        TXLNoteBoundingBoxTest(YES);
+        return NO;
+    }
+    
+    // The other geometry is not empty (the boxes are not disjoint).
+    if ((_rectangle && TXLBoundingBoxContainsBox(a, b)) ||
+        (other->_rectangle && TXLBoundingBoxContainsBox(b, a))) {
+        TXLNoteBoundingBoxTest(YES);
+        return YES;
+    }
+    
+    TXLNoteBoundingBoxTest(NO);
+    
+    int kernel = TXLPointKernelIntersects(self._collection, _rectangle,
+                                          other._collection, other->_rectangle);
+    if (kernel >= 0) {
+#ifdef DEBUG
+        assert(kernel == TXLGEOSPredicate(GEOSIntersects_r, self._collection, other._collection));
+#endif
+        return kernel;
+    }
+    
+    // The larger geometry is prepared (e.g., the polygon
+    // of a region tested against many points).
+    BOOL selfIsLarger = _numberOfPoints >= other->_numberOfPoints;
+    int prepared = [[TXLPreparedGeometryCache sharedCache] evaluatePredicate:kTXLPreparedGeometryIntersects
+                                                                withPrepared:selfIsLarger ? self : other
+                                                                    geometry:selfIsLarger ? other : self];
+    if (prepared >= 0) {
+        return prepared;
+    }
+    
+    return TXLGEOSPredicate(GEOSIntersects_r, self._collection, other._collection);
 }
 
 - (BOOL)overlaps:(TXLGeometryCollection *)other {
-    return gaiaGeomCollOverlaps(self._collection, other._collection);
+    return TXLGEOSPredicate(GEOSOverlaps_r, self._collection, other._collection);
 }
 
 - (BOOL)crosses:(TXLGeometryCollection *)other {
-    return gaiaGeomCollCrosses(self._collection, other._collection);
+    return TXLGEOSPredicate(GEOSCrosses_r, self._collection, other._collection);
 }
 
 - (BOOL)touches:(TXLGeometryCollection *)other {
-    return gaiaGeomCollTouches(self._collection, other._collection);
+    return TXLGEOSPredicate(GEOSTouches_r, self._collection, other._collection);
 }
 
 - (BOOL)within:(TXLGeometryCollection *)other {
-    return gaiaGeomCollWithin(self._collection, other._collection);
+    return [other contains:self];
 }
 
 #pragma mark -
 #pragma mark Operations
 
 - (TXLGeometryCollection *)intersection:(TXLGeometryCollection *)other {
-    gaiaGeomCollPtr result = gaiaGeometryIntersection(self._collection, other._collection);
+    TXLBoundingBox a = self.boundingBox;
+    TXLBoundingBox b = other.boundingBox;
+    
+    if (TXLBoundingBoxesDisjoint(a, b)) {
+        TXLNoteBoundingBoxTest(YES);
+        return TXLEmptyGeometry();
+    }
+    
+    if (_rectangle && TXLBoundingBoxContainsBox(a, b)) {
+        TXLNoteBoundingBoxTest(YES);
+        return other;
+    }
+    
+    if (other->_rectangle && TXLBoundingBoxContainsBox(b, a)) {
+        TXLNoteBoundingBoxTest(YES);
+        return self;
+    }
+    
+    TXLNoteBoundingBoxTest(NO);
+    
+    gaiaGeomCollPtr points = TXLPointKernelIntersection(self._collection, _rectangle,
+                                                        other._collection, other->_rectangle);
+    if (points) {
+        return [[[TXLGeometryCollection alloc] initWithGaiaGeomCollNoCopy:points] autorelease];
+    }
+    
+    // With the prepared larger geometry the intersection is
+    // empty or the smaller geometry in most cases (e.g., the
+    // position of a moving point and the polygon of a region).
+    TXLGeometryCollection *larger = _numberOfPoints >= other->_numberOfPoints ? self : other;
+    TXLGeometryCollection *smaller = larger == self ? other : self;
+    TXLPreparedGeometryCache *cache = [TXLPreparedGeometryCache sharedCache];
+    int prepared = [cache evaluatePredicate:kTXLPreparedGeometryIntersects
+                               withPrepared:larger
+                                   geometry:smaller];
+    if (prepared == 0) {
+        return TXLEmptyGeometry();
+    }
+    if (prepared == 1 && [cache evaluatePredicate:kTXLPreparedGeometryContains
+                                     withPrepared:larger
+                                         geometry:smaller] == 1) {
+        return smaller;
+    }
+    
+    gaiaGeomCollPtr result = TXLGEOSOperation(GEOSIntersection_r, self._collection, other._collection);
     
     assert(result);
     // TODO: Better error handling
@@ -311,7 +631,22 @@ static void _geos_error (const char *fmt, ...)
 }
 
 - (TXLGeometryCollection *)union:(TXLGeometryCollection *)other {
-    gaiaGeomCollPtr result = gaiaGeometryUnion(self._collection, other._collection);
+    if (other == self) {
+        return self;
+    }
+    
+    // A rectangle absorbs a geometry (or an empty
+    // geometry) within its bounding box.
+    TXLBoundingBox a = self.boundingBox;
+    TXLBoundingBox b = other.boundingBox;
+    if (_rectangle && TXLBoundingBoxContainsBox(a, b)) {
+        return self;
+    }
+    if (other->_rectangle && TXLBoundingBoxContainsBox(b, a)) {
+        return other;
+    }
+    
+    gaiaGeomCollPtr result = TXLGEOSOperation(GEOSUnion_r, self._collection, other._collection);
     
     assert(result);
     // TODO: Better error handling
@@ -323,7 +658,7 @@ static void _geos_error (const char *fmt, ...)
 }
 
 - (TXLGeometryCollection *)difference:(TXLGeometryCollection *)other {
-    gaiaGeomCollPtr result = gaiaGeometryDifference(self._collection, other._collection);
+    gaiaGeomCollPtr result = TXLGEOSOperation(GEOSDifference_r, self._collection, other._collection);
     
     assert(result);
     // TODO: Better error handling
@@ -335,7 +670,7 @@ static void _geos_error (const char *fmt, ...)
 }
 
 - (TXLGeometryCollection *)symDifference:(TXLGeometryCollection *)other {
-    gaiaGeomCollPtr result = gaiaGeometrySymDifference(self._collection, other._collection);
+    gaiaGeomCollPtr result = TXLGEOSOperation(GEOSSymDifference_r, self._collection, other._collection);
     
     assert(result);
     // TODO: Better error handling
@@ -346,13 +681,90 @@ static void _geos_error (const char *fmt, ...)
     return gc;
 }
 
++ (TXLGeometryCollection *)unionOfGeometries:(TXLGeometryCollection * const *)geometries
+                                       count:(NSUInteger)count {
+    NSMutableArray *level = [NSMutableArray arrayWithCapacity:count];
+    TXLGeometryCollection *previous = nil;
+    for (NSUInteger idx = 0; idx < count; idx++) {
+        if (geometries[idx] != nil && geometries[idx] != previous) {
+            [level addObject:geometries[idx]];
+            previous = geometries[idx];
+        }
+    }
+    
+    // Unite neighbouring pairs until one geometry is left. The
+    // geometries passed to GEOS stay small compared to adding
+    // each geometry to the union of all previous ones.
+    while ([level count] > 1) {
+        NSUInteger n = [level count];
+        NSMutableArray *next = [NSMutableArray arrayWithCapacity:(n + 1) / 2];
+        for (NSUInteger idx = 0; idx + 1 < n; idx += 2) {
+            [next addObject:[[level objectAtIndex:idx] union:[level objectAtIndex:idx + 1]]];
+        }
+        if (n % 2 == 1) {
+            [next addObject:[level lastObject]];
+        }
+        level = next;
+    }
+    
+    return [level count] > 0 ? [level objectAtIndex:0] : nil;
+}
+
+#pragma mark -
+#pragma mark Statistics
+
++ (NSUInteger)numberOfBoundingBoxTests {
+    return (NSUInteger)numberOfBoundingBoxTests;
+}
+
++ (NSUInteger)numberOfBoundingBoxRejections {
+    return (NSUInteger)numberOfBoundingBoxRejections;
+}
+
++ (void)noteBoundingBoxTestRejected:(BOOL)rejected {
+    TXLNoteBoundingBoxTest(rejected);
+}
+
+- (NSUInteger)numberOfPoints {
+    // The number of points is cached, if the collection is set.
+    [self _collection];
+    return _numberOfPoints;
+}
+
+- (NSData *)contentKey {
+    gaiaGeomCollPtr c = self._collection;
+    @synchronized (self) {
+        if (_contentKey == nil) {
+            unsigned char *data;
+            int size;
+            
+            // See -save: for the declared type. The collection is
+            // shared by other threads, the type is set on a copy.
+            gaiaGeomCollPtr copy = gaiaCloneGeomColl(c);
+            copy->DeclaredType = GAIA_GEOMETRYCOLLECTION;
+            gaiaToSpatiaLiteBlobWkb(copy, &data, &size);
+            gaiaFreeGeomColl(copy);
+            
+            assert(data);
+            // TODO: Better error handling
+            
+            _contentKey = [[NSData alloc] initWithBytesNoCopy:data length:size freeWhenDone:YES];
+        }
+    }
+    return _contentKey;
+}
+
+- (void *)createGEOSGeometry {
+    return TXLGEOSGeometryFromGaia(TXLGEOSContext(), self._collection);
+}
+
 #pragma mark -
 #pragma mark Operations
 
 - (BOOL)isEqual:(id)object {
     if ([object isKindOfClass:[TXLGeometryCollection class]]) {
         TXLGeometryCollection *other = object;
-        return gaiaGeomCollEquals(self._collection, other._collection);
+        return TXLGEOSPredicate(GEOSEquals_r, self._collection, other._collection);
     }
     return NO;
 }
@@ -372,23 +784,15 @@ static void _geos_error (const char *fmt, ...)
     @synchronized (self) {
         if (primaryKey == 0) {
             
-            unsigned char *data;
-            int size;
-            
             // We have to set the type of this collection explicit,
             // because the column in the database does only accept a
             // GEOMETRYCOLLECTION and if we have only points in _collection
-            // the function would create a MULTIPOINT
-            ((gaiaGeomCollPtr)_collection)->DeclaredType = GAIA_GEOMETRYCOLLECTION;
-            
-            gaiaToSpatiaLiteBlobWkb(_collection, &data, &size);
-            
-            assert(data);
-            // TODO: Better error handling
+            // the function would create a MULTIPOINT. The content key
+            // is serialized with this type (see -contentKey).
             
             TXLDatabase *database = [[TXLManager sharedManager] database];
             if ([database executeSQLWithParameters:@"INSERT INTO txl_geometry (geometry) VALUES (?)" error:error,
-                 [NSData dataWithBytesNoCopy:data length:size freeWhenDone:YES],
+                 self.contentKey,
                  nil] == nil) {
                 return nil;
             };
@@ -398,6 +802,109 @@ static void _geos_error (const char *fmt, ...)
     return self;
 }
 
++ (BOOL)savePointsWithCoordinates:(const TXLCoordinate *)coordinates
+                            count:(NSUInteger)count
+                      primaryKeys:(NSUInteger *)primaryKeys
+                            error:(NSError **)error {
+    
+    if (count == 0) {
+        return YES;
+    }
+    
+    sqlite3_int64 *rowids = malloc(count * sizeof(sqlite3_int64));
+    
+    TXLDatabase *database = [[TXLManager sharedManager] database];
+    BOOL success = [database executeSQL:@"INSERT INTO txl_geometry (geometry) VALUES (?)"
+                           numberOfRows:count
+                         insertedRowids:rowids
+                                  error:error
+                            bindHandler:^(sqlite3_stmt *statement, NSUInteger row){
+                                
+                                // See -save: for the declared type.
+                                gaiaGeomCollPtr geom = gaiaAllocGeomColl();
+                                geom->Srid = 4326;
+                                geom->DeclaredType = GAIA_GEOMETRYCOLLECTION;
+                                gaiaAddPointToGeomColl(geom, coordinates[row].longitude, coordinates[row].latitude);
+                                gaiaMbrGeometry(geom);
+                                
+                                unsigned char *data;
+                                int size;
+                                gaiaToSpatiaLiteBlobWkb(geom, &data, &size);
+                                gaiaFreeGeomColl(geom);
+                                
+                                sqlite3_bind_blob(statement, 1, data, size, free);
+                            }];
+    
+    if (success) {
+        for (NSUInteger i = 0; i < count; i++) {
+            primaryKeys[i] = rowids[i];
+        }
+    }
+    
+    free(rowids);
+    return success;
+}
+
+// Calculate the bounding box of the collection and check, if the
+// collection is one axis-aligned rectangle, which is used to decide
+// relations without calling GEOS. The number of vertices decides,
+// which geometry of a relation is prepared.
+- (void)cacheBoundingBox {
+    gaiaGeomCollPtr c = _collection;
+    
+    _rectangle = NO;
+    
+    _numberOfPoints = 0;
+    for (gaiaPointPtr p = c->FirstPoint; p; p = p->Next) {
+        _numberOfPoints++;
+    }
+    for (gaiaLinestringPtr l = c->FirstLinestring; l; l = l->Next) {
+        _numberOfPoints += l->Points;
+    }
+    for (gaiaPolygonPtr p = c->FirstPolygon; p; p = p->Next) {
+        _numberOfPoints += p->Exterior->Points;
+        for (int i = 0; i < p->NumInteriors; i++) {
+            _numberOfPoints += p->Interiors[i].Points;
+        }
+    }
+    
+    if (gaiaIsEmpty(c)) {
+        _boundingBox.minLongitude = INFINITY;
+        _boundingBox.maxLongitude = -INFINITY;
+        _boundingBox.minLatitude = INFINITY;
+        _boundingBox.maxLatitude = -INFINITY;
+        return;
+    }
+    
+    gaiaMbrGeometry(c);
+    
+    _boundingBox.minLongitude = c->MinX;
+    _boundingBox.maxLongitude = c->MaxX;
+    _boundingBox.minLatitude = c->MinY;
+    _boundingBox.maxLatitude = c->MaxY;
+    
+    if (c->FirstPoint != NULL || c->FirstLinestring != NULL ||
+        c->FirstPolygon == NULL || c->FirstPolygon != c->LastPolygon)
+        return;
+    
+    gaiaPolygonPtr polygon = c->FirstPolygon;
+    gaiaRingPtr ring = polygon->Exterior;
+    if (polygon->NumInteriors != 0 || ring->DimensionModel != GAIA_XY || ring->Points != 5)
+        return;
+    
+    // Each of the four corners of the bounding
+    // box is a vertex of the ring.
+    int corners = 0;
+    for (int i = 0; i < 4; i++) {
+        double x, y;
+        gaiaGetPoint(ring->Coords, i, &x, &y);
+        if ((x != c->MinX && x != c->MaxX) || (y != c->MinY && y != c->MaxY))
+            return;
+        corners |= 1 << ((x == c->MaxX ? 2 : 0) + (y == c->MaxY ? 1 : 0));
+    }
+    _rectangle = corners == 0xF && c->MinX < c->MaxX && c->MinY < c->MaxY;
+}
+
 - (gaiaGeomCollPtr)_collection {
     @synchronized (self) {
         if (_collection == 0) {
@@ -419,9 +926,15 @@ static void _geos_error (const char *fmt, ...)
             
             NSData *data = [[result objectAtIndex:0] objectForKey:@"geometry"];
             
+            // The stored blob identifies the content (see -contentKey).
+            [_contentKey release];
+            _contentKey = [data copy];
+            
             _collection = gaiaFromSpatiaLiteBlobWkb([data bytes], [data length]);
             // TODO: Better error handling
             assert(_collection);
+            
+            [self cacheBoundingBox];
         }
     }
     return _collection;
@@ -0,0 +1,85 @@
+//
+//  TXLPointKernels.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 04.04.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import <Foundation/Foundation.h>
+
+#import <spatialite/sqlite3.h>
+#import <spatialite/gaiageo.h>
+#import <spatialite.h>
+
+#import "TXLGeometryTypes.h"
+
+/*! Relations of points (POINT or MULTIPOINT) with points or polygons,
+ *  decided without GEOS.
+ *
+ *  The location of a point in a polygon is found by counting the
+ *  crossings of a ray with the segments of the rings (the same rule
+ *  as used by GEOS). The orientation of the point and a segment is
+ *  computed in double precision with an error bound. If the sign of
+ *  the orientation is not certain, the point is not located and the
+ *  relation has to be decided by GEOS. Otherwise the result is the
+ *  same as the result of GEOS.
+ *
+ *  The functions below return -1 (or NULL), if the geometries are not
+ *  handled by the kernels (e.g., linestrings) or a point could not be
+ *  located.
+ */
+
+typedef enum {
+    kTXLPointLocationUndecided = -1,
+    kTXLPointLocationExterior = 0,
+    kTXLPointLocationBoundary,
+    kTXLPointLocationInterior
+} TXLPointLocation;
+
+/*! Location of a point in the box (a rectangle polygon).
+ */
+TXLPointLocation TXLLocatePointInBox(TXLBoundingBox box, double x, double y);
+
+/*! Location of a point in the closed ring with count vertices
+ *  (x and y of each vertex) and in the polygon.
+ */
+TXLPointLocation TXLLocatePointInRing(const double *coords, int count, double x, double y);
+TXLPointLocation TXLLocatePointInPolygon(gaiaPolygonPtr polygon, double x, double y);
+
+/*! YES, if the geometry consists only of points (2D).
+ */
+BOOL TXLGeometryIsPointSet(gaiaGeomCollPtr geometry);
+
+/*! Relations of the geometries, if one of them is a point set and the
+ *  other one a point set or consists only of polygons. The rectangle
+ *  flags tell, if the geometry is one axis-aligned rectangle, which is
+ *  tested with its bounding box.
+ */
+int TXLPointKernelIntersects(gaiaGeomCollPtr geometry1, BOOL rectangle1,
+                             gaiaGeomCollPtr geometry2, BOOL rectangle2);
+int TXLPointKernelContains(gaiaGeomCollPtr container, BOOL rectangle,
+                           gaiaGeomCollPtr contained);
+
+/*! The intersection of the geometries (the points of the point set
+ *  located in the other geometry) or NULL. The caller is responsible
+ *  to free the result.
+ */
+gaiaGeomCollPtr TXLPointKernelIntersection(gaiaGeomCollPtr geometry1, BOOL rectangle1,
+                                           gaiaGeomCollPtr geometry2, BOOL rectangle2);
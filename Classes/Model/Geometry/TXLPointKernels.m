@@ -0,0 +1,274 @@
+//
+//  TXLPointKernels.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 04.04.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import "TXLPointKernels.h"
+
+#import <math.h>
+
+// Error bound of the orientation computed in double precision
+// (see Shewchuk, "Adaptive Precision Floating-Point Arithmetic and
+// Fast Robust Geometric Predicates"). If the absolute value of the
+// determinant is larger than the bound times the sum of the absolute
+// values of both products, its sign is the sign of the exact value.
+#define TXL_ORIENTATION_ERROR_BOUND 3.3306690738754716e-16
+
+#pragma mark -
+#pragma mark Locating Points
+
+TXLPointLocation TXLLocatePointInBox(TXLBoundingBox box, double x, double y) {
+    if (x < box.minLongitude || x > box.maxLongitude ||
+        y < box.minLatitude || y > box.maxLatitude) {
+        return kTXLPointLocationExterior;
+    }
+    if (x == box.minLongitude || x == box.maxLongitude ||
+        y == box.minLatitude || y == box.maxLatitude) {
+        return kTXLPointLocationBoundary;
+    }
+    return kTXLPointLocationInterior;
+}
+
+TXLPointLocation TXLLocatePointInRing(const double *coords, int count, double x, double y) {
+    
+    // Count the segments crossing the ray from the point to the right
+    // (see RayCrossingCounter of GEOS). The loop is free of branches,
+    // the cases are accumulated and evaluated after the loop.
+    
+    int crossings = 0;
+    int uncertain = 0;
+    int boundary = 0;
+    
+    for (int i = 1; i < count; i++) {
+        double x1 = coords[2 * i - 2];
+        double y1 = coords[2 * i - 1];
+        double x2 = coords[2 * i];
+        double y2 = coords[2 * i + 1];
+        
+        // the point is a vertex or lies on a horizontal segment
+        boundary |= (x2 == x) & (y2 == y);
+        boundary |= (y1 == y) & (y2 == y) & (x >= fmin(x1, x2)) & (x <= fmax(x1, x2));
+        
+        // the segment crosses the horizontal line through the point
+        // and does not lie left of the point
+        int straddles = ((y1 > y) != (y2 > y)) & !((x1 < x) & (x2 < x));
+        
+        // orientation of the point relative to the segment
+        double a = (x2 - x1) * (y - y1);
+        double b = (y2 - y1) * (x - x1);
+        double det = a - b;
+        double bound = TXL_ORIENTATION_ERROR_BOUND * (fabs(a) + fabs(b));
+        
+        int left = y2 > y1 ? det > bound : det < -bound;
+        crossings += straddles & left;
+        uncertain |= straddles & (fabs(det) <= bound);
+    }
+    
+    if (boundary) {
+        return kTXLPointLocationBoundary;
+    }
+    if (uncertain) {
+        // On a segment or too close to it
+        return kTXLPointLocationUndecided;
+    }
+    return (crossings & 1) ? kTXLPointLocationInterior : kTXLPointLocationExterior;
+}
+
+TXLPointLocation TXLLocatePointInPolygon(gaiaPolygonPtr polygon, double x, double y) {
+    gaiaRingPtr exterior = polygon->Exterior;
+    TXLPointLocation location = TXLLocatePointInRing(exterior->Coords, exterior->Points, x, y);
+    if (location != kTXLPointLocationInterior) {
+        return location;
+    }
+    
+    for (int i = 0; i < polygon->NumInteriors; i++) {
+        gaiaRingPtr hole = polygon->Interiors + i;
+        switch (TXLLocatePointInRing(hole->Coords, hole->Points, x, y)) {
+            case kTXLPointLocationInterior:
+                return kTXLPointLocationExterior;
+            case kTXLPointLocationBoundary:
+                return kTXLPointLocationBoundary;
+            case kTXLPointLocationUndecided:
+                return kTXLPointLocationUndecided;
+            default:
+                break;
+        }
+    }
+    return kTXLPointLocationInterior;
+}
+
+#pragma mark -
+#pragma mark Relations
+
+BOOL TXLGeometryIsPointSet(gaiaGeomCollPtr geometry) {
+    return geometry->DimensionModel == GAIA_XY &&
+           geometry->FirstPoint != NULL &&
+           geometry->FirstLinestring == NULL &&
+           geometry->FirstPolygon == NULL;
+}
+
+static BOOL TXLGeometryIsPolygonSet(gaiaGeomCollPtr geometry) {
+    return geometry->DimensionModel == GAIA_XY &&
+           geometry->FirstPoint == NULL &&
+           geometry->FirstLinestring == NULL &&
+           geometry->FirstPolygon != NULL;
+}
+
+// Location of the point in a point set or a polygon set. The interior
+// of a point is the point itself, it has no boundary.
+static TXLPointLocation TXLLocatePointInGeometry(gaiaGeomCollPtr geometry, BOOL rectangle, double x, double y) {
+    if (geometry->FirstPoint) {
+        for (gaiaPointPtr p = geometry->FirstPoint; p; p = p->Next) {
+            if (p->X == x && p->Y == y) {
+                return kTXLPointLocationInterior;
+            }
+        }
+        return kTXLPointLocationExterior;
+    }
+    
+    if (rectangle) {
+        TXLBoundingBox box;
+        box.minLongitude = geometry->MinX;
+        box.maxLongitude = geometry->MaxX;
+        box.minLatitude = geometry->MinY;
+        box.maxLatitude = geometry->MaxY;
+        return TXLLocatePointInBox(box, x, y);
+    }
+    
+    BOOL boundary = NO;
+    BOOL undecided = NO;
+    for (gaiaPolygonPtr p = geometry->FirstPolygon; p; p = p->Next) {
+        switch (TXLLocatePointInPolygon(p, x, y)) {
+            case kTXLPointLocationInterior:
+                return kTXLPointLocationInterior;
+            case kTXLPointLocationBoundary:
+                boundary = YES;
+                break;
+            case kTXLPointLocationUndecided:
+                undecided = YES;
+                break;
+            default:
+                break;
+        }
+    }
+    
+    if (undecided) {
+        return kTXLPointLocationUndecided;
+    }
+    return boundary ? kTXLPointLocationBoundary : kTXLPointLocationExterior;
+}
+
+// Order the geometries, so that the first one is the point set and
+// the second one a point set or a polygon set. Returns NO, if the
+// geometries are not handled by the kernels.
+static BOOL TXLOrderPointSet(gaiaGeomCollPtr *geometry1, BOOL *rectangle1,
+                             gaiaGeomCollPtr *geometry2, BOOL *rectangle2) {
+    if (!TXLGeometryIsPointSet(*geometry1)) {
+        gaiaGeomCollPtr g = *geometry1;
+        BOOL r = *rectangle1;
+        *geometry1 = *geometry2;
+        *rectangle1 = *rectangle2;
+        *geometry2 = g;
+        *rectangle2 = r;
+        if (!TXLGeometryIsPointSet(*geometry1)) {
+            return NO;
+        }
+    }
+    return TXLGeometryIsPointSet(*geometry2) || TXLGeometryIsPolygonSet(*geometry2);
+}
+
+int TXLPointKernelIntersects(gaiaGeomCollPtr geometry1, BOOL rectangle1,
+                             gaiaGeomCollPtr geometry2, BOOL rectangle2) {
+    if (!TXLOrderPointSet(&geometry1, &rectangle1, &geometry2, &rectangle2)) {
+        return -1;
+    }
+    
+    BOOL undecided = NO;
+    for (gaiaPointPtr p = geometry1->FirstPoint; p; p = p->Next) {
+        TXLPointLocation location = TXLLocatePointInGeometry(geometry2, rectangle2, p->X, p->Y);
+        if (location == kTXLPointLocationUndecided) {
+            undecided = YES;
+        } else if (location != kTXLPointLocationExterior) {
+            return 1;
+        }
+    }
+    return undecided ? -1 : 0;
+}
+
+int TXLPointKernelContains(gaiaGeomCollPtr container, BOOL rectangle,
+                           gaiaGeomCollPtr contained) {
+    if (TXLGeometryIsPointSet(contained)) {
+        if (!TXLGeometryIsPointSet(container) && !TXLGeometryIsPolygonSet(container)) {
+            return -1;
+        }
+        
+        // No point in the exterior and at least
+        // one point in the interior of the container.
+        BOOL interior = NO;
+        BOOL undecided = NO;
+        for (gaiaPointPtr p = contained->FirstPoint; p; p = p->Next) {
+            switch (TXLLocatePointInGeometry(container, rectangle, p->X, p->Y)) {
+                case kTXLPointLocationExterior:
+                    return 0;
+                case kTXLPointLocationInterior:
+                    interior = YES;
+                    break;
+                case kTXLPointLocationUndecided:
+                    undecided = YES;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return undecided ? -1 : interior;
+    }
+    
+    // A point set does not contain an area.
+    if (TXLGeometryIsPointSet(container) && TXLGeometryIsPolygonSet(contained)) {
+        return 0;
+    }
+    
+    return -1;
+}
+
+gaiaGeomCollPtr TXLPointKernelIntersection(gaiaGeomCollPtr geometry1, BOOL rectangle1,
+                                           gaiaGeomCollPtr geometry2, BOOL rectangle2) {
+    if (!TXLOrderPointSet(&geometry1, &rectangle1, &geometry2, &rectangle2)) {
+        return NULL;
+    }
+    
+    gaiaGeomCollPtr result = gaiaAllocGeomColl();
+    result->Srid = geometry1->Srid;
+    
+    for (gaiaPointPtr p = geometry1->FirstPoint; p; p = p->Next) {
+        TXLPointLocation location = TXLLocatePointInGeometry(geometry2, rectangle2, p->X, p->Y);
+        if (location == kTXLPointLocationUndecided) {
+            gaiaFreeGeomColl(result);
+            return NULL;
+        }
+        if (location != kTXLPointLocationExterior &&
+            TXLLocatePointInGeometry(result, NO, p->X, p->Y) == kTXLPointLocationExterior) {
+            gaiaAddPointToGeomColl(result, p->X, p->Y);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,96 @@
+//
+//  TXLPreparedGeometryCache.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 01.04.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import <Foundation/Foundation.h>
+
+@class TXLGeometryCollection;
+
+typedef enum {
+    kTXLPreparedGeometryIntersects,
+    kTXLPreparedGeometryContains
+} TXLPreparedGeometryPredicate;
+
+/*! Cache of prepared GEOS geometries.
+ *
+ *  Situation definitions often test many small geometries (e.g., the
+ *  positions of moving points) against the same few large polygons
+ *  (e.g., cities or regions). The predicates of TXLGeometryCollection
+ *  evaluate such tests with a prepared geometry of the larger operand,
+ *  which is created once and kept in this cache.
+ *
+ *  The prepared geometries are identified by the content of the
+ *  geometry (the spatialite blob) and not by the primary key, so that
+ *  equal geometries loaded several times from the database share one
+ *  prepared geometry. If the estimated memory of the prepared geometries
+ *  exceeds the memory budget, the least recently used are removed.
+ */
+@interface TXLPreparedGeometryCache : NSObject {
+
+@private
+    // content key (NSData) -> prepared geometry
+    NSMutableDictionary *entries;
+    
+    NSUInteger memoryBudget;
+    NSUInteger usedMemory;
+    NSUInteger clock;
+    
+    NSUInteger numberOfHits;
+    NSUInteger numberOfMisses;
+}
+
++ (TXLPreparedGeometryCache *)sharedCache;
+
+/*! Estimated memory in bytes, which may be used by the prepared
+ *  geometries (default: 16 MB). A budget of 0 disables the cache.
+ */
+@property (assign) NSUInteger memoryBudget;
+
+@property (readonly) NSUInteger usedMemory;
+@property (readonly) NSUInteger numberOfPreparedGeometries;
+
+/*! Number of evaluations, which found the prepared geometry in the
+ *  cache, and number of evaluations, which had to prepare it first.
+ */
+@property (readonly) NSUInteger numberOfHits;
+@property (readonly) NSUInteger numberOfMisses;
+
+- (void)removeAllPreparedGeometries;
+
+#pragma mark -
+#pragma mark Private Framework Methods
+
+/*! Evaluate the predicate with the prepared geometry of the first
+ *  geometry and the second geometry (e.g., the first geometry
+ *  contains the second one).
+ *
+ *  Returns 1 or 0 as the result of the predicate, or -1, if the first
+ *  geometry is not prepared (the cache is disabled, the geometry has
+ *  too few vertices or GEOS failed). In this case the predicate has
+ *  to be evaluated without the cache.
+ */
+- (int)evaluatePredicate:(TXLPreparedGeometryPredicate)predicate
+           withPrepared:(TXLGeometryCollection *)prepared
+               geometry:(TXLGeometryCollection *)geometry;
+
+@end
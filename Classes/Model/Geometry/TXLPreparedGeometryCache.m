@@ -0,0 +1,249 @@
+//
+//  TXLPreparedGeometryCache.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 01.04.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import "TXLPreparedGeometryCache.h"
+#import "TXLGeometryCollection.h"
+
+#import <geos_c.h>
+
+// Geometries with fewer vertices are tested without
+// preparing them, the prepared geometry would not pay off.
+#define TXL_PREPARED_GEOMETRY_MIN_POINTS 16
+
+// Rough estimate of the memory used by GEOS for one vertex
+// of the geometry and its prepared geometry (coordinates,
+// segments and the index of the segments).
+#define TXL_PREPARED_GEOMETRY_BYTES_PER_POINT 96
+#define TXL_PREPARED_GEOMETRY_BYTES_OVERHEAD 1024
+
+static TXLPreparedGeometryCache *sharedTXLPreparedGeometryCache = nil;
+
+#pragma mark -
+#pragma mark Prepared Geometry
+
+@interface TXLPreparedGeometry : NSObject {
+@public
+    GEOSGeometry *geometry;
+    const GEOSPreparedGeometry *prepared;
+    NSUInteger size;
+    NSUInteger lastUse;
+}
+- (id)initWithGeometry:(TXLGeometryCollection *)geometry;
+@end
+
+@implementation TXLPreparedGeometry
+
+- (id)initWithGeometry:(TXLGeometryCollection *)g {
+    if ((self = [super init])) {
+        geometry = [g createGEOSGeometry];
+        if (geometry) {
+            prepared = GEOSPrepare_r(TXLGEOSContext(), geometry);
+        }
+        if (prepared == NULL) {
+            [self release];
+            return nil;
+        }
+        size = TXL_PREPARED_GEOMETRY_BYTES_OVERHEAD +
+               TXL_PREPARED_GEOMETRY_BYTES_PER_POINT * g.numberOfPoints;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    
+    // The entry is destroyed in the context of the thread
+    // releasing it, which is not the one that created it.
+    
+    GEOSContextHandle_t handle = TXLGEOSContext();
+    if (prepared) {
+        GEOSPreparedGeom_destroy_r(handle, prepared);
+    }
+    if (geometry) {
+        GEOSGeom_destroy_r(handle, geometry);
+    }
+    [super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Prepared Geometry Cache
+
+@interface TXLPreparedGeometryCache ()
+- (void)removeLeastRecentlyUsed;
+@end
+
+@implementation TXLPreparedGeometryCache
+
+@synthesize memoryBudget;
+@synthesize usedMemory;
+@synthesize numberOfHits;
+@synthesize numberOfMisses;
+
++ (TXLPreparedGeometryCache *)sharedCache {
+    @synchronized(self) {
+        if (sharedTXLPreparedGeometryCache == nil) {
+            sharedTXLPreparedGeometryCache = [TXLPreparedGeometryCache new];
+        }
+    }
+    return sharedTXLPreparedGeometryCache;
+}
+
+- (id)init {
+    if ((self = [super init])) {
+        entries = [[NSMutableDictionary alloc] init];
+        memoryBudget = 16 * 1024 * 1024;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [entries release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Memory Budget
+
+- (void)setMemoryBudget:(NSUInteger)budget {
+    @synchronized(self) {
+        memoryBudget = budget;
+        while (usedMemory > memoryBudget) {
+            [self removeLeastRecentlyUsed];
+        }
+    }
+}
+
+- (NSUInteger)numberOfPreparedGeometries {
+    @synchronized(self) {
+        return [entries count];
+    }
+}
+
+- (void)removeAllPreparedGeometries {
+    @synchronized(self) {
+        [entries removeAllObjects];
+        usedMemory = 0;
+    }
+}
+
+// Has to be called in a block synchronized with the cache.
+- (void)removeLeastRecentlyUsed {
+    id oldestKey = nil;
+    TXLPreparedGeometry *oldest = nil;
+    for (id key in entries) {
+        TXLPreparedGeometry *entry = [entries objectForKey:key];
+        if (oldest == nil || entry->lastUse < oldest->lastUse) {
+            oldestKey = key;
+            oldest = entry;
+        }
+    }
+    if (oldest) {
+        usedMemory -= oldest->size;
+        [entries removeObjectForKey:oldestKey];
+    } else {
+        usedMemory = 0;
+    }
+}
+
+#pragma mark -
+#pragma mark Private Framework Methods
+
+- (int)evaluatePredicate:(TXLPreparedGeometryPredicate)predicate
+           withPrepared:(TXLGeometryCollection *)prepared
+               geometry:(TXLGeometryCollection *)geometry {
+    
+    if (prepared.numberOfPoints < TXL_PREPARED_GEOMETRY_MIN_POINTS) {
+        return -1;
+    }
+    
+    @synchronized(self) {
+        if (memoryBudget == 0) {
+            return -1;
+        }
+    }
+    
+    NSData *key = prepared.contentKey;
+    TXLPreparedGeometry *entry;
+    
+    @synchronized(self) {
+        entry = [[entries objectForKey:key] retain];
+        if (entry) {
+            numberOfHits++;
+            entry->lastUse = ++clock;
+        }
+    }
+    
+    if (entry == nil) {
+        // The geometry is prepared outside of the synchronized
+        // block. If it has been prepared concurrently by another
+        // thread in the meantime, the one in the cache is used.
+        TXLPreparedGeometry *created = [[TXLPreparedGeometry alloc] initWithGeometry:prepared];
+        if (created == nil) {
+            return -1;
+        }
+        
+        @synchronized(self) {
+            numberOfMisses++;
+            entry = [[entries objectForKey:key] retain];
+            if (entry == nil && created->size <= memoryBudget) {
+                while (usedMemory + created->size > memoryBudget) {
+                    [self removeLeastRecentlyUsed];
+                }
+                [entries setObject:created forKey:key];
+                usedMemory += created->size;
+            }
+            if (entry == nil) {
+                entry = [created retain];
+            }
+            entry->lastUse = ++clock;
+        }
+        [created release];
+    }
+    
+    GEOSGeometry *other = [geometry createGEOSGeometry];
+    char result = 2;
+    if (other) {
+        // The prepared geometry builds its index on the first
+        // use and can not be used by several threads at once.
+        GEOSContextHandle_t handle = TXLGEOSContext();
+        @synchronized(entry) {
+            switch (predicate) {
+                case kTXLPreparedGeometryIntersects:
+                    result = GEOSPreparedIntersects_r(handle, entry->prepared, other);
+                    break;
+                case kTXLPreparedGeometryContains:
+                    result = GEOSPreparedContains_r(handle, entry->prepared, other);
+                    break;
+            }
+        }
+        GEOSGeom_destroy_r(handle, other);
+    }
+    [entry release];
+    
+    // GEOS reports an exception with the value 2.
+    return (result == 0 || result == 1) ? result : -1;
+}
+
+@end
@@ -23,6 +23,8 @@
 
 #import <Foundation/Foundation.h>
 
+#import "TXLGeometryTypes.h"
+
 extern NSString * const TXLMovingObjectErrorDomain;
 
 #define TXL_MOVING_OBJECT_ERROR_EMPTY 1
@@ -31,6 +33,20 @@ extern NSString * const TXLMovingObjectErrorDomain;
 @class TXLGeometryCollection;
 @class TXLSnapshot;
 
+/*! Position of a moving object at a point in time, e.g., a position
+ *  reported by a vehicle (see +movingObjectWithSamples:count:).
+ *
+ *  timestamp  - Seconds since 1970 (UTC).
+ *  coordinate - The position, used if geometry is 0.
+ *  geometry   - Primary key of a stored geometry (TXLGeometryCollection)
+ *               or 0.
+ */
+typedef struct TXLTrajectorySample_s {
+    NSTimeInterval timestamp;
+    TXLCoordinate coordinate;
+    NSUInteger geometry;
+} TXLTrajectorySample;
+
 @interface TXLMovingObject : NSObject {
     
 @private
@@ -42,6 +58,26 @@ extern NSString * const TXLMovingObjectErrorDomain;
     TXLGeometryCollection *_bounds;
     NSArray *_snapshots;
     
+    // packed samples (TXLTrajectorySample), if created from samples
+    NSData *_samples;
+    
+    // snapshots as struct of arrays: timestamps (seconds since 1970, a
+    // missing timestamp is -INFINITY (first) or INFINITY), geometries
+    // (retained) and their bounding boxes (created on demand)
+    NSUInteger _count;
+    NSTimeInterval *_timestamps;
+    TXLGeometryCollection **_geometries;
+    TXLBoundingBox *_boxes;
+    
+    // all geometries cover the entire world (set with the boxes)
+    BOOL _unbounded;
+    
+    // the bounds are calculated on first access, the
+    // bounding box of the bounds without any union
+    BOOL _lazyBounds;
+    BOOL _hasBoundingBox;
+    TXLBoundingBox _boundingBox;
+    
     BOOL _loaded;
 }
 
@@ -97,6 +133,17 @@ extern NSString * const TXLMovingObjectErrorDomain;
  */
 + (TXLMovingObject *)movingObjectWithSnapshots:(NSArray *)snapshots;
 
+/*! Create a moving object from a packed array of samples.
+ *
+ *  The samples are copied and must have ascending timestamps. Each
+ *  sample corresponds to one snapshot, but the snapshots are only
+ *  created if they are accessed. Begin, end and bounds are calculated
+ *  directly from the samples (like +movingObjectWithSnapshots:), and
+ *  -save: writes the samples without creating snapshots or geometries.
+ */
++ (TXLMovingObject *)movingObjectWithSamples:(const TXLTrajectorySample *)samples
+                                       count:(NSUInteger)count;
+
 #pragma mark -
 #pragma mark Predicates
 
@@ -106,6 +153,16 @@ extern NSString * const TXLMovingObjectErrorDomain;
 @property (readonly, getter=isAlways) BOOL always;
 @property (readonly, getter=isConstant) BOOL constant;
 
+/*! YES, if the moving object has at least two snapshots and the
+ *  geometry of each snapshot is the entire world, e.g., a moving
+ *  object created with +movingObjectWithBegin:end:.
+ *
+ *  Operations between spatially unbounded moving objects are
+ *  calculated on the time intervals only, without a geometric
+ *  operation (see TXLMovingObjectSequence).
+ */
+@property (readonly, getter=isSpatiallyUnbounded) BOOL spatiallyUnbounded;
+
 #pragma mark -
 #pragma mark Begin & End
 
@@ -115,7 +172,19 @@ extern NSString * const TXLMovingObjectErrorDomain;
 #pragma mark -
 #pragma mark Bounds
 
+/*! The union of the geometries of all snapshots except of the last one.
+ *
+ *  The bounds of a moving object created from snapshots, samples or by
+ *  the operations on moving objects are calculated on first access.
+ */
 @property (readonly) TXLGeometryCollection *bounds;
+
+/*! The bounding box of the bounds, calculated from the bounding
+ *  boxes of the geometries without creating the bounds. The box of
+ *  an empty moving object is empty (minimum larger than maximum).
+ */
+@property (readonly) TXLBoundingBox boundingBox;
+
 - (TXLGeometryCollection *)boundsAtDate:(NSDate *)date;
 - (TXLGeometryCollection *)boundsInIntervalFrom:(NSDate *)from
                                              to:(NSDate *)to;
@@ -150,10 +219,47 @@ extern NSString * const TXLMovingObjectErrorDomain;
 
 + (TXLMovingObject *)movingObjectWithPrimaryKey:(NSUInteger)pk;
 
+/*! Create a moving object from the arrays of timestamps and geometries.
+ *
+ *  The arrays are copied. A timestamp of -INFINITY (first) or INFINITY
+ *  (last) is used for a moving object without begin or end (see
+ *  +movingObjectWithSnapshots:). The snapshots are only created if they
+ *  are accessed.
+ */
++ (TXLMovingObject *)movingObjectWithTimestamps:(const NSTimeInterval *)timestamps
+                                     geometries:(TXLGeometryCollection * const *)geometries
+                                          count:(NSUInteger)count;
+
+#pragma mark -
+#pragma mark Snapshot Arrays
+
+/*! Get the snapshots as struct of arrays.
+ *
+ *  Returns the number of snapshots and sets the pointers (if not NULL)
+ *  to the arrays of the timestamps, geometries and bounding boxes of the
+ *  geometries (an empty box for a snapshot without geometry). The arrays
+ *  belong to the moving object and must not be modified.
+ */
+- (NSUInteger)getTimestamps:(const NSTimeInterval **)timestamps
+                 geometries:(TXLGeometryCollection * const **)geometries
+              boundingBoxes:(const TXLBoundingBox **)boxes;
+
 #pragma mark -
 #pragma mark Database Management
 
 @property (readonly) NSUInteger primaryKey;
 - (TXLMovingObject *)save:(NSError **)error;
 
+/*! Append a snapshot to the stored open-ended moving object (without end).
+ *
+ *  From the timestamp on, the moving object is valid in the geometry. The
+ *  last snapshot is changed and a new last snapshot is inserted, all other
+ *  snapshots are kept. The timestamp must be after the timestamps of all
+ *  snapshots. The moving object is changed in place: it is also changed
+ *  for statements of earlier revisions using it.
+ */
+- (BOOL)appendSnapshotWithTimestamp:(NSDate *)timestamp
+                           geometry:(TXLGeometryCollection *)geometry
+                              error:(NSError **)error;
+
 @end
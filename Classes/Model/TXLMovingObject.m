@@ -32,11 +32,49 @@
 
 NSString * const TXLMovingObjectErrorDomain = @"org.opentxl.TXLMovingObjectErrorDomain";
 
-typedef enum {
-	kTXLMovingObjectOperationTypeUNION, 
-	kTXLMovingObjectOperationTypeINTERSECT, 
-	kTXLMovingObjectOperationTypeDIFFERENCE
-} kTXLMovingObjectOperationType;
+// Returns the index of the last timestamp before (strict) or not after
+// the time in the sorted list of timestamps, or NSNotFound.
+static NSUInteger TXLLastTimestampIndex(const NSTimeInterval *timestamps,
+                                        NSUInteger count,
+                                        NSTimeInterval time,
+                                        BOOL strict) {
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high) {
+        NSUInteger mid = low + (high - low) / 2;
+        if (timestamps[mid] < time || (!strict && timestamps[mid] == time)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low == 0 ? NSNotFound : low - 1;
+}
+
+// Check if the timestamp is before (-2), at the beginning (-1), in (0),
+// at the end (1) or after (2) the interval (from, to). An open interval
+// is passed as -INFINITY or INFINITY, as the missing timestamps of the
+// first and the last snapshot.
+static int TXLCheckTimestamp(NSTimeInterval timestamp,
+                             NSTimeInterval from,
+                             NSTimeInterval to) {
+    if (from > timestamp)
+        return -2;
+    if (from == timestamp && from != -INFINITY)
+        return -1;
+    if (to < timestamp)
+        return 2;
+    if (to == timestamp && to != INFINITY)
+        return 1;
+    return 0;
+}
+
+static void TXLExtendBoundingBox(TXLBoundingBox *box, TXLBoundingBox other) {
+    box->minLatitude = fmin(box->minLatitude, other.minLatitude);
+    box->maxLatitude = fmax(box->maxLatitude, other.maxLatitude);
+    box->minLongitude = fmin(box->minLongitude, other.minLongitude);
+    box->maxLongitude = fmax(box->maxLongitude, other.maxLongitude);
+}
 
 @interface TXLMovingObject ()
 
@@ -51,6 +89,11 @@ typedef enum {
                  begin:(NSDate *)begin
                    end:(NSDate *)end;
 - (id)initWithSnapshots:(NSArray *)snapshots;
+- (id)initWithSamples:(const TXLTrajectorySample *)samples
+                count:(NSUInteger)count;
+- (id)initWithTimestamps:(const NSTimeInterval *)timestamps
+              geometries:(TXLGeometryCollection * const *)geometries
+                   count:(NSUInteger)count;
 
 - (id)initWithPrimaryKey:(NSUInteger)pk;
 
@@ -58,6 +101,16 @@ typedef enum {
 #pragma mark Database Management
 
 - (void)load;
+- (void)loadSnapshots;
+- (void)loadSnapshotArrays;
+- (BOOL)saveSamples:(NSError **)error;
+
+#pragma mark -
+#pragma mark Bounds
+
+- (NSArray *)sampleGeometries;
+- (void)calculateBounds;
+- (void)calculateBoundingBox;
 
 @end
 
@@ -96,6 +149,14 @@ typedef enum {
     return [[[TXLMovingObject alloc] initWithSnapshots:snapshots] autorelease];
 }
 
++ (TXLMovingObject *)movingObjectWithSamples:(const TXLTrajectorySample *)samples
+                                       count:(NSUInteger)count {
+    if (count == 0) {
+        return [self emptyMovingObject];
+    }
+    return [[[TXLMovingObject alloc] initWithSamples:samples count:count] autorelease];
+}
+
 #pragma mark -
 #pragma mark Empty or Omnipresent
 
@@ -109,13 +170,13 @@ typedef enum {
     return  (_is_empty == NO) &&
             (_begin == nil) &&
             (_end == nil) &&
-            [_bounds isEqual:[TXLGeometryCollection geometryFromWKT:@"POLYGON((-180 -90, -180 90, 180 90, 180 -90, -180 -90))"]];
+            [self.bounds isEqual:[TXLGeometryCollection geometryFromWKT:@"POLYGON((-180 -90, -180 90, 180 90, 180 -90, -180 -90))"]];
 }
 
 - (BOOL)isEverywhere {
     [self load];
     return  (_is_empty == NO) &&
-            [_bounds isEqual:[TXLGeometryCollection geometryFromWKT:@"POLYGON((-180 -90, -180 90, 180 90, 180 -90, -180 -90))"]];
+            [self.bounds isEqual:[TXLGeometryCollection geometryFromWKT:@"POLYGON((-180 -90, -180 90, 180 90, 180 -90, -180 -90))"]];
 }
 
 - (BOOL)isAlways {
@@ -125,10 +186,16 @@ typedef enum {
             (_end == nil);
 }
 
+- (BOOL)isSpatiallyUnbounded {
+    const TXLBoundingBox *boxes;
+    [self getTimestamps:NULL geometries:NULL boundingBoxes:&boxes];
+    return _unbounded;
+}
+
 - (BOOL)isConstant {
-    [self load];
+    [self loadSnapshots];
     for (TXLSnapshot *s in _snapshots) {
-        if (![_snapshots isEqual:_bounds])
+        if (![_snapshots isEqual:self.bounds])
             return NO;
     }
     return YES;
@@ -152,15 +219,31 @@ typedef enum {
 
 - (TXLGeometryCollection *)bounds {
     [self load];
+    @synchronized (self) {
+        if (_lazyBounds) {
+            [self calculateBounds];
+            _lazyBounds = NO;
+        }
+    }
     return _bounds;
 }
 
+- (TXLBoundingBox)boundingBox {
+    [self load];
+    @synchronized (self) {
+        if (!_hasBoundingBox) {
+            [self calculateBoundingBox];
+        }
+    }
+    return _boundingBox;
+}
+
 - (TXLGeometryCollection *)boundsAtDate:(NSDate *)date {
     
     if (date == nil)
         return nil;
     
-    [self load];
+    [self loadSnapshotArrays];
     
     if (_is_empty == NO) {
         
@@ -169,53 +252,29 @@ typedef enum {
             return nil;
         }
         
-        if ([_snapshots count] == 1) {
-            TXLSnapshot *snap = [_snapshots objectAtIndex:0];
-            if (snap.timestamp == nil || [snap.timestamp compare:date] == NSOrderedSame) {
-                return snap.geometry;
+        NSTimeInterval time = [date timeIntervalSince1970];
+        
+        if (_count == 1) {
+            if (isinf(_timestamps[0]) || _timestamps[0] == time) {
+                return _geometries[0];
             }
         }
         
-        __block TXLGeometryCollection *b = nil;
-        
-        NSUInteger idx = [_snapshots indexOfObjectWithOptions:NSEnumerationReverse passingTest:^(id obj, NSUInteger idx, BOOL *stop){
-            TXLSnapshot *snapshot = obj;
-                
-            if (snapshot.timestamp == nil) {
-                if (idx == 0) {
-                    // first snapshot in list
-                    b = snapshot.geometry;
-                    *stop = YES;
-                    return YES;
-                } else {
-                    // last snapshot in list
-                    return NO;
-                }
-            }
-
-            if ([snapshot.timestamp earlierDate:date] == snapshot.timestamp) {
-                b = snapshot.geometry;
-                *stop = YES;
-                return YES;
-            } else {
-                return NO;
-            }
-        }];
+        // find the last snapshot not after the date
+        NSUInteger idx = TXLLastTimestampIndex(_timestamps, _count, time, NO);
         
-        if (idx == NSNotFound || ([_snapshots count] - 1 == idx &&
-                                 [[_snapshots objectAtIndex:idx] timestamp] &&
-                                  [[(TXLSnapshot *)[_snapshots objectAtIndex:idx] timestamp] compare:date] == NSOrderedSame)) {
+        if (idx == NSNotFound || (_count - 1 == idx && _timestamps[idx] == time)) {
             return nil;
         }
         
-        return b;
+        return _geometries[idx];
     }
     return nil;
 }
 
 - (TXLGeometryCollection *)boundsInIntervalFrom:(NSDate *)from
                                              to:(NSDate *)to {
-    [self load];
+    [self loadSnapshotArrays];
     
     if (_is_empty == NO) {
         
@@ -228,76 +287,26 @@ typedef enum {
             return nil;
         }
         
-        NSUInteger firstSnapshotIdx;
-        NSUInteger lastSnapshotIdx;
-        
-        
-        // find first snapshot after begin
-        firstSnapshotIdx = [_snapshots indexOfObjectWithOptions:NSEnumerationReverse passingTest:^(id obj, NSUInteger idx, BOOL *stop){
-            TXLSnapshot *snapshot = obj;
-            
-            if (snapshot.timestamp == nil) {
-                if (idx == 0) {
-                    // first snapshot in list
-                    *stop = YES;
-                    return YES;
-                } else {
-                    // last snapshot in list
-                    return NO;
-                }
-            }
-            
-            if ([snapshot.timestamp laterDate:from] == from) {
-                *stop = YES;
-                return YES;
-            } else {
-                return NO;
-            }
-        }];
-        
-        // find first snapshot before end
-        lastSnapshotIdx = [_snapshots indexOfObjectWithOptions:NSEnumerationReverse passingTest:^(id obj, NSUInteger idx, BOOL *stop){
-            TXLSnapshot *snapshot = obj;
-            
-            if (snapshot.timestamp == nil) {
-                if (idx == 0) {
-                    // first snapshot in list
-                    *stop = YES;
-                    return YES;
-                } else {
-                    // last snapshot in list
-                    return NO;
-                }
-            }
-            
-            if ([snapshot.timestamp laterDate:to] == to) {
-                *stop = YES;
-                return YES;
-            } else {
-                return NO;
-            }                                  
-        }];
+        NSUInteger count = _count;
+        NSUInteger firstSnapshotIdx = 0;
+        NSUInteger lastSnapshotIdx = count - 1;
         
-        NSRange range;
-        range.location = firstSnapshotIdx;
-        range.length = lastSnapshotIdx - firstSnapshotIdx + 1;
-                
-        TXLGeometryCollection *b = nil;
+        // find the last snapshot not after begin
+        if (from != nil) {
+            firstSnapshotIdx = TXLLastTimestampIndex(_timestamps, count, [from timeIntervalSince1970], NO);
+            if (firstSnapshotIdx == NSNotFound)
+                firstSnapshotIdx = 0;
+        }
         
-        // Iterate over the snapshots and calculate
-        // the bounds of this moving object
-        for (TXLSnapshot *snapshot in [_snapshots subarrayWithRange:range]) {
-            
-            // calculate the union of the geometry of
-            // this snapshot and the previous snapshot 
-            if (b == nil) {
-                b = snapshot.geometry;
-            } else {
-                b = [b union:snapshot.geometry];
-            }
+        // find the last snapshot before end
+        if (to != nil) {
+            lastSnapshotIdx = TXLLastTimestampIndex(_timestamps, count, [to timeIntervalSince1970], YES);
+            if (lastSnapshotIdx == NSNotFound || lastSnapshotIdx < firstSnapshotIdx)
+                lastSnapshotIdx = firstSnapshotIdx;
         }
         
-        return b;
+        return [TXLGeometryCollection unionOfGeometries:_geometries + firstSnapshotIdx
+                                                  count:lastSnapshotIdx - firstSnapshotIdx + 1];
 
     }
     return nil;
@@ -307,7 +316,7 @@ typedef enum {
 #pragma mark Snapshots
 
 - (NSArray *)snapshots {
-    [self load];
+    [self loadSnapshots];
     return _snapshots;
 }
 
@@ -358,7 +367,7 @@ typedef enum {
 #pragma mark Description
 
 - (NSString *)description {
-    [self load];
+    [self loadSnapshots];
     return [NSString stringWithFormat:@"%@{snapshots = %@}", [super description], _snapshots];
 }
 
@@ -389,120 +398,66 @@ typedef enum {
     
     [self load];
     
-    NSMutableArray *result = [NSMutableArray array];
-    TXLSnapshot *lastSnapshotBeforeInterval = nil;
-    TXLSnapshot *lastSnapshotInInterval = nil;
+    // If the moving object lies completely in the
+    // interval, it is not changed by the mask.
+    if ((from == nil || (_begin != nil && [from compare:_begin] != NSOrderedDescending)) &&
+        (to == nil || (_end != nil && [to compare:_end] != NSOrderedAscending))) {
+        return self;
+    }
     
-    // Check if the snapshot is before (-2), at the beginning (-1), in (0),
-    // at the end (1) or after (2) the interval (from, to). 
-    int (^checkSnapshot)(int) = ^(int idx){
-        TXLSnapshot *snapshot = [_snapshots objectAtIndex:idx];
-        
-        if (snapshot.timestamp == nil) {
-            if ([_snapshots count] == 0) {
-                return 0;
-            } else if (idx == 0) {
-                if (from == nil)
-                    return 0;
-                else
-                    return -2;
-            } else {
-                if (to == nil)
-                    return 0;
-                else
-                    return 2;
-            }
-        }
-        
-        if (from == nil) {
-            switch ([to compare:snapshot.timestamp]) {
-                case NSOrderedDescending:
-                    return 0;
-                    
-                case NSOrderedSame:
-                    return 1;
-                    
-                case NSOrderedAscending:
-                    return 2;
-   
-                default:
-                    break;
-            }
-        } else if (to == nil) {
-            switch ([from compare:snapshot.timestamp]) {
-                case NSOrderedAscending:
-                    return 0;
-                    
-                case NSOrderedSame:
-                    return 1;
-                    
-                case NSOrderedDescending:
-                    return 2;
-                    
-                default:
-                    break;
-            }
-        } else {
-            switch ([from compare:snapshot.timestamp]) {
-                case NSOrderedAscending:
-                {
-                    switch ([to compare:snapshot.timestamp]) {
-                        case NSOrderedDescending:
-                            return 0;
-                            
-                        case NSOrderedSame:
-                            return 1;
-                            
-                        case NSOrderedAscending:
-                            return 2;
-                            
-                        default:
-                            break;
-                    }
-                }
-                    
-                case NSOrderedSame:
-                    return -1;
-                    
-                case NSOrderedDescending:
-                    return -2;
-                    
-                default:
-                    break;
-            }
-            
-        }
-        return 0;
-    };
+    [self loadSnapshotArrays];
+    
+    NSTimeInterval fromTime = from ? [from timeIntervalSince1970] : -INFINITY;
+    NSTimeInterval toTime = to ? [to timeIntervalSince1970] : INFINITY;
+    
+    // Skip the snapshots before the interval except of the last
+    // one, which is the position at the beginning of the interval.
+    NSUInteger count = _count;
+    NSUInteger first = TXLLastTimestampIndex(_timestamps, count, fromTime, YES);
+    if (first == NSNotFound)
+        first = 0;
+    
+    // The result contains the snapshots from the first index on and
+    // at most two additional snapshots at the beginning and the end
+    // of the interval. The geometries are retained by the result.
+    NSUInteger capacity = count - first + 2;
+    NSTimeInterval *timestamps = malloc(capacity * sizeof(NSTimeInterval));
+    TXLGeometryCollection **geometries = malloc(capacity * sizeof(TXLGeometryCollection *));
+    NSUInteger resultCount = 0;
+    
+    NSUInteger lastSnapshotBeforeInterval = NSNotFound;
+    NSUInteger lastSnapshotInInterval = NSNotFound;
     
     BOOL stop = NO;
     
-    for (NSUInteger idx = 0; !stop && idx < [_snapshots count]; idx++) {
-        switch (checkSnapshot(idx)) {
+    for (NSUInteger idx = first; !stop && idx < count; idx++) {
+        switch (TXLCheckTimestamp(_timestamps[idx], fromTime, toTime)) {
             case -2:
                 // before interval
-                lastSnapshotBeforeInterval = [_snapshots objectAtIndex:idx];
+                lastSnapshotBeforeInterval = idx;
                 break;
                 
             case -1:
                 // begin of interval
-                [result addObject:[_snapshots objectAtIndex:idx]];
-                lastSnapshotBeforeInterval = nil;
+                timestamps[resultCount] = _timestamps[idx];
+                geometries[resultCount++] = _geometries[idx];
+                lastSnapshotBeforeInterval = NSNotFound;
                 break;
                 
             case 1:
                 // end of interval
-                [result addObject:[_snapshots objectAtIndex:idx]];
-                lastSnapshotInInterval = nil;
+                timestamps[resultCount] = _timestamps[idx];
+                geometries[resultCount++] = _geometries[idx];
+                lastSnapshotInInterval = NSNotFound;
                 break;
                 
             case 2:
             {
                 // after interval
-                if (lastSnapshotInInterval != nil) {
-                    [result addObject:[TXLSnapshot snapshotWithTimestamp:to
-                                                                geometry:lastSnapshotInInterval.geometry]];
-                    lastSnapshotInInterval = nil;
+                if (lastSnapshotInInterval != NSNotFound) {
+                    timestamps[resultCount] = toTime;
+                    geometries[resultCount++] = _geometries[lastSnapshotInInterval];
+                    lastSnapshotInInterval = NSNotFound;
                 }
                 stop = YES;
                 break;
@@ -512,21 +467,26 @@ typedef enum {
             default:
             {
                 // in interval
-                if (lastSnapshotBeforeInterval != nil) {
-                    [result addObject:[TXLSnapshot snapshotWithTimestamp:from
-                                                                geometry:lastSnapshotBeforeInterval.geometry]];
-                    lastSnapshotBeforeInterval = nil;
+                if (lastSnapshotBeforeInterval != NSNotFound) {
+                    timestamps[resultCount] = fromTime;
+                    geometries[resultCount++] = _geometries[lastSnapshotBeforeInterval];
+                    lastSnapshotBeforeInterval = NSNotFound;
                 }
                 
-                TXLSnapshot *s = [_snapshots objectAtIndex:idx];
-                lastSnapshotInInterval = s;
-                [result addObject:s];
+                lastSnapshotInInterval = idx;
+                timestamps[resultCount] = _timestamps[idx];
+                geometries[resultCount++] = _geometries[idx];
                 break;
             }
         }
     }
     
-    return [TXLMovingObject movingObjectWithSnapshots:result];
+    TXLMovingObject *result = [TXLMovingObject movingObjectWithTimestamps:timestamps
+                                                               geometries:geometries
+                                                                    count:resultCount];
+    free(timestamps);
+    free(geometries);
+    return result;
 }
 
 - (TXLMovingObjectSequence *)movingObjectNotInIntervalFrom:(NSDate *)from
@@ -539,97 +499,18 @@ typedef enum {
     if (self.empty)
         return [TXLMovingObjectSequence emptySequence];
     
-    [self load];
+    [self loadSnapshots];
     
     NSMutableArray *resultSnapshots = [NSMutableArray array];
     NSMutableArray *resultObjects = [NSMutableArray array];
     TXLSnapshot *lastSnapshotBeforeInterval = nil;
     TXLSnapshot *lastSnapshotInInterval = nil;
     
-    // Check if the snapshot is before (-2), at the beginning (-1), in (0),
-    // at the end (1) or after (2) the interval (from, to). 
-    int (^checkSnapshot)(int) = ^(int idx){
-        TXLSnapshot *snapshot = [_snapshots objectAtIndex:idx];
-        
-        if (snapshot.timestamp == nil) {
-            if ([_snapshots count] == 0) {
-                return 0;
-            } else if (idx == 0) {
-                if (from == nil)
-                    return 0; // It should be -1, but the implementation uses this workaround. 
-                else
-                    return -2;
-            } else {
-                if (to == nil)
-                    return 0; // It should be 1, but the implementation uses this workaround.
-                else
-                    return 2;
-            }
-        }
-        
-        if (from == nil) {
-            switch ([to compare:snapshot.timestamp]) {
-                case NSOrderedDescending:
-                    return 0;
-                    
-                case NSOrderedSame:
-                    return 1;
-                    
-                case NSOrderedAscending:
-                    return 2;
-                    
-                default:
-                    break;
-            }
-        } else if (to == nil) {
-            switch ([from compare:snapshot.timestamp]) {
-                case NSOrderedAscending:
-                    return 0;
-                    
-                case NSOrderedSame:
-                    return 1;
-                    
-                case NSOrderedDescending:
-                    return 2;
-                    
-                default:
-                    break;
-            }
-        } else {
-            switch ([from compare:snapshot.timestamp]) {
-                case NSOrderedAscending:
-                {
-                    switch ([to compare:snapshot.timestamp]) {
-                        case NSOrderedDescending:
-                            return 0;
-                            
-                        case NSOrderedSame:
-                            return 1;
-                            
-                        case NSOrderedAscending:
-                            return 2;
-                            
-                        default:
-                            break;
-                    }
-                }
-                    
-                case NSOrderedSame:
-                    return -1;
-                    
-                case NSOrderedDescending:
-                    return -2;
-                    
-                default:
-                    break;
-            }
-            
-        }
-        return 0;
-    };
+    NSTimeInterval fromTime = from ? [from timeIntervalSince1970] : -INFINITY;
+    NSTimeInterval toTime = to ? [to timeIntervalSince1970] : INFINITY;
     
     for (NSUInteger idx = 0; idx < [_snapshots count]; idx++) {
-        switch (checkSnapshot(idx)) {
+        switch (TXLCheckTimestamp(_timestamps[idx], fromTime, toTime)) {
             case -2:
                 // before interval
                 lastSnapshotBeforeInterval = [_snapshots objectAtIndex:idx];
@@ -704,6 +585,52 @@ typedef enum {
     return [[[TXLMovingObject alloc] initWithPrimaryKey:pk] autorelease];
 }
 
++ (TXLMovingObject *)movingObjectWithTimestamps:(const NSTimeInterval *)timestamps
+                                     geometries:(TXLGeometryCollection * const *)geometries
+                                          count:(NSUInteger)count {
+    return [[[TXLMovingObject alloc] initWithTimestamps:timestamps
+                                             geometries:geometries
+                                                  count:count] autorelease];
+}
+
+#pragma mark -
+#pragma mark Snapshot Arrays
+
+- (NSUInteger)getTimestamps:(const NSTimeInterval **)timestamps
+                 geometries:(TXLGeometryCollection * const **)geometries
+              boundingBoxes:(const TXLBoundingBox **)boxes {
+    [self loadSnapshotArrays];
+    
+    @synchronized (self) {
+        if (boxes != NULL && _boxes == NULL && _count > 0) {
+            TXLBoundingBox *b = malloc(_count * sizeof(TXLBoundingBox));
+            BOOL unbounded = _count > 1;
+            for (NSUInteger idx = 0; idx < _count; idx++) {
+                if (_geometries[idx] == nil) {
+                    b[idx].minLatitude = INFINITY;
+                    b[idx].maxLatitude = -INFINITY;
+                    b[idx].minLongitude = INFINITY;
+                    b[idx].maxLongitude = -INFINITY;
+                    unbounded = NO;
+                } else {
+                    b[idx] = _geometries[idx].boundingBox;
+                    unbounded = unbounded && _geometries[idx].entireWorld;
+                }
+            }
+            _boxes = b;
+            _unbounded = unbounded;
+        }
+    }
+    
+    if (timestamps != NULL)
+        *timestamps = _timestamps;
+    if (geometries != NULL)
+        *geometries = _geometries;
+    if (boxes != NULL)
+        *boxes = _boxes;
+    return _count;
+}
+
 #pragma mark -
 #pragma mark Database Management
 
@@ -740,8 +667,8 @@ typedef enum {
             [parameters addObject:[NSNull null]];
         }
         
-        if (_bounds) {
-            TXLGeometryCollection *bounds = [_bounds save:error];
+        if (self.bounds) {
+            TXLGeometryCollection *bounds = [self.bounds save:error];
             if (bounds == nil) {
                 return nil;
             }
@@ -758,23 +685,31 @@ typedef enum {
             
             primaryKey = db.lastInsertRowid;
             
-            int count = 0;
+            if (_samples != nil) {
+                // The samples are written directly, without
+                // creating a snapshot for each sample.
+                if (![self saveSamples:error]) {
+                    return nil;
+                }
+                return self;
+            }
             
+            [self loadSnapshotArrays];
             
-            for (TXLSnapshot *snapshot in _snapshots) {
+            for (NSUInteger count = 0; count < _count; count++) {
                 NSAutoreleasePool *pool = [NSAutoreleasePool new];
                 
-                TXLGeometryCollection *geom = [snapshot.geometry save:error];
+                TXLGeometryCollection *geom = [_geometries[count] save:error];
                 if (geom == nil) {
                     [pool drain];
                     return nil;
                 } else {
                     NSArray *parameter = nil;
                     
-                    if (snapshot.timestamp) {
+                    if (!isinf(_timestamps[count])) {
                         parameter = [NSArray arrayWithObjects:[TXLInteger integerWithValue:primaryKey],
                                      [TXLInteger integerWithValue:geom.primaryKey],
-                                     [NSNumber numberWithDouble:[snapshot.timestamp timeIntervalSince1970]],
+                                     [NSNumber numberWithDouble:_timestamps[count]],
                                      [TXLInteger integerWithValue:count],
                                      nil];
                     } else {
@@ -792,7 +727,6 @@ typedef enum {
                         return nil;
                     }
                     
-                    count++;
                     [pool drain];
                 }
             }
@@ -802,6 +736,101 @@ typedef enum {
     return self;
 }
 
+- (BOOL)appendSnapshotWithTimestamp:(NSDate *)timestamp
+                           geometry:(TXLGeometryCollection *)geometry
+                              error:(NSError **)error {
+    
+    [self loadSnapshotArrays];
+    
+    if (primaryKey == 0 || _is_empty || _end != nil || _count == 0) {
+        [NSException raise:NSInvalidArgumentException
+                    format:@"A snapshot can only be appended to a stored open-ended moving object."];
+    }
+    
+    // The timestamp of the last snapshot is missing (INFINITY).
+    // A moving object with only one snapshot is always valid.
+    NSTimeInterval time = [timestamp timeIntervalSince1970];
+    NSTimeInterval last = _count > 1 ? _timestamps[_count - 2] : _timestamps[0];
+    if (!(time > last)) {
+        [NSException raise:NSInvalidArgumentException
+                    format:@"The timestamp of the appended snapshot must be after the last snapshot."];
+    }
+    
+    TXLGeometryCollection *geom = [geometry save:error];
+    if (geom == nil) {
+        return NO;
+    }
+    
+    TXLGeometryCollection *geometries[2] = {self.bounds, geom};
+    TXLGeometryCollection *bounds = [[TXLGeometryCollection unionOfGeometries:geometries count:2] save:error];
+    if (bounds == nil) {
+        return NO;
+    }
+    
+    TXLDatabase *db = [[TXLManager sharedManager] database];
+    
+    TXLInteger *pk = [TXLInteger integerWithValue:primaryKey];
+    TXLInteger *geom_pk = [TXLInteger integerWithValue:geom.primaryKey];
+    
+    // The last snapshot (without timestamp) becomes the snapshot at the
+    // timestamp, a new last snapshot is inserted. A moving object with
+    // only one snapshot keeps it as the first snapshot.
+    
+    NSUInteger count = _count;
+    if (count > 1) {
+        count--;
+        if ([db executeSQLWithParameters:@"UPDATE txl_snapshot SET timestamp = ?, geometry_id = ? WHERE movingobject_id = ? AND count = ?" error:error,
+             [NSNumber numberWithDouble:time], geom_pk, pk, [TXLInteger integerWithValue:count], nil] == nil) {
+            return NO;
+        }
+    } else {
+        if ([db executeSQLWithParameters:@"INSERT INTO txl_snapshot (movingobject_id, geometry_id, timestamp, count) VALUES (?, ?, ?, ?)" error:error,
+             pk, geom_pk, [NSNumber numberWithDouble:time], [TXLInteger integerWithValue:count], nil] == nil) {
+            return NO;
+        }
+    }
+    
+    if ([db executeSQLWithParameters:@"INSERT INTO txl_snapshot (movingobject_id, geometry_id, timestamp, count) VALUES (?, ?, ?, ?)" error:error,
+         pk, geom_pk, [NSNull null], [TXLInteger integerWithValue:count + 1], nil] == nil) {
+        return NO;
+    }
+    
+    if ([db executeSQLWithParameters:@"UPDATE txl_movingobject SET bounds = ? WHERE id = ?" error:error,
+         [TXLInteger integerWithValue:bounds.primaryKey], pk, nil] == nil) {
+        return NO;
+    }
+    
+    // Change the arrays in the same way. The snapshots and
+    // the bounding boxes are created again, if accessed.
+    
+    @synchronized (self) {
+        _timestamps = realloc(_timestamps, (count + 2) * sizeof(NSTimeInterval));
+        _geometries = realloc(_geometries, (count + 2) * sizeof(TXLGeometryCollection *));
+        if (_count > 1) {
+            [_geometries[count] release];
+        }
+        _timestamps[count] = time;
+        _geometries[count] = [geom retain];
+        _timestamps[count + 1] = INFINITY;
+        _geometries[count + 1] = [geom retain];
+        _count = count + 2;
+        
+        [_snapshots release];
+        _snapshots = nil;
+        [_samples release];
+        _samples = nil;
+        free(_boxes);
+        _boxes = NULL;
+        
+        [_bounds release];
+        _bounds = [bounds retain];
+        _lazyBounds = NO;
+        _hasBoundingBox = NO;
+    }
+    
+    return YES;
+}
+
 #pragma mark -
 #pragma mark -
 #pragma mark Private Methods
@@ -876,12 +905,11 @@ typedef enum {
     if ((self = [super init])) {
         _snapshots = [snapshots copy];
         
-        // Iterate over the snapshots and calculate begin,
-        // end and the bounds of this moving object
+        // Find begin and end of this moving object. The bounds are
+        // calculated on first access (see -calculateBounds).
         
         NSDate *begin = nil;
         NSDate *end = nil;
-        TXLGeometryCollection *bounds = nil;
         
 		//TODO: needs revising
 		// find the begin and end
@@ -897,41 +925,70 @@ typedef enum {
 			end = nil;
 		}
 				
-        for (TXLSnapshot *snapshot in _snapshots) {
-            
-            // find the earliest timestamp
-            // in the list of snapshots
-            /*
-			if (begin) {
-                begin = [snapshot.timestamp earlierDate:begin];
-            } else {
-                begin = snapshot.timestamp;
-            }
-            
-            // find the latest timestamp
-            // in the list of snapshots
-            if (end) {
-                end = [snapshot.timestamp laterDate:end];
-            } else {
-                end = snapshot.timestamp;
-            }
-            */
-			
-            // calculate the union of the geometry of
-            // this snapshot and the previous snapshot 
-            if (bounds == nil) {
-                bounds = snapshot.geometry;
-            } else if ([_snapshots lastObject] != snapshot) {
-                bounds = [bounds union:snapshot.geometry];
-            }
-        } 
-        
-        // set begin, end and the bounds
+        // set begin and end
         // for this moving object
         _begin = [begin retain];
         _end = [end retain];
-        _bounds = [bounds retain];
+        _lazyBounds = YES;
+        _loaded = YES;
+        
+        [self calculateBoundingBox];
+    }
+    return self;
+}
+
+- (id)initWithSamples:(const TXLTrajectorySample *)samples
+                count:(NSUInteger)count {
+    if ((self = [super init])) {
+        _samples = [[NSData alloc] initWithBytes:samples
+                                          length:count * sizeof(TXLTrajectorySample)];
+        
+        // Begin and end are set as for a list of snapshots (see
+        // -initWithSnapshots:). The bounds and the bounding box may
+        // need stored geometries and are calculated on first access.
+        
+        _begin = [[NSDate alloc] initWithTimeIntervalSince1970:samples[0].timestamp];
+        if (count > 1) {
+            _end = [[NSDate alloc] initWithTimeIntervalSince1970:samples[count - 1].timestamp];
+        }
+        
+        _lazyBounds = YES;
+        _loaded = YES;
+    }
+    return self;
+}
+
+- (id)initWithTimestamps:(const NSTimeInterval *)timestamps
+              geometries:(TXLGeometryCollection * const *)geometries
+                   count:(NSUInteger)count {
+    if (count == 0)
+        return [self initEmptyMovingObject];
+    
+    if ((self = [super init])) {
+        _count = count;
+        _timestamps = malloc(count * sizeof(NSTimeInterval));
+        memcpy(_timestamps, timestamps, count * sizeof(NSTimeInterval));
+        _geometries = malloc(count * sizeof(TXLGeometryCollection *));
+        for (NSUInteger idx = 0; idx < count; idx++) {
+            _geometries[idx] = [geometries[idx] retain];
+        }
+        
+        // Begin and end are set as for a list of snapshots (see
+        // -initWithSnapshots:). Only the bounding box of the bounds is
+        // calculated here, most moving objects created by the operations
+        // on moving objects are never asked for their bounds.
+        
+        if (!isinf(timestamps[0])) {
+            _begin = [[NSDate alloc] initWithTimeIntervalSince1970:timestamps[0]];
+        }
+        if (count > 1 && !isinf(timestamps[count - 1])) {
+            _end = [[NSDate alloc] initWithTimeIntervalSince1970:timestamps[count - 1]];
+        }
+        
+        _lazyBounds = YES;
         _loaded = YES;
+        
+        [self calculateBoundingBox];
     }
     return self;
 }
@@ -948,6 +1005,13 @@ typedef enum {
     [_end release];
     [_bounds release];
     [_snapshots release];
+    [_samples release];
+    for (NSUInteger idx = 0; _geometries != NULL && idx < _count; idx++) {
+        [_geometries[idx] release];
+    }
+    free(_geometries);
+    free(_timestamps);
+    free(_boxes);
     [super dealloc];
 }
 
@@ -1035,4 +1099,233 @@ typedef enum {
     }
 }
 
+- (void)loadSnapshots {
+    [self loadSnapshotArrays];
+    
+    @synchronized (self) {
+        if (_snapshots != nil || _geometries == NULL)
+            return;
+        
+        // Create the snapshots of a moving object created
+        // from samples or arrays, when they are needed.
+        
+        NSMutableArray *snapshots = [[NSMutableArray alloc] initWithCapacity:_count];
+        for (NSUInteger idx = 0; idx < _count; idx++) {
+            NSDate *timestamp = nil;
+            if (!isinf(_timestamps[idx])) {
+                timestamp = [NSDate dateWithTimeIntervalSince1970:_timestamps[idx]];
+            }
+            [snapshots addObject:[TXLSnapshot snapshotWithTimestamp:timestamp
+                                                           geometry:_geometries[idx]]];
+        }
+        _snapshots = snapshots;
+    }
+}
+
+- (void)loadSnapshotArrays {
+    [self load];
+    
+    @synchronized (self) {
+        if (_timestamps != NULL)
+            return;
+        
+        if (_samples != nil) {
+            
+            // Create the arrays directly from the samples.
+            
+            const TXLTrajectorySample *samples = [_samples bytes];
+            NSUInteger count = [_samples length] / sizeof(TXLTrajectorySample);
+            
+            TXLGeometryCollection **geometries = malloc(MAX(count, 1) * sizeof(TXLGeometryCollection *));
+            NSTimeInterval *timestamps = malloc(MAX(count, 1) * sizeof(NSTimeInterval));
+            for (NSUInteger i = 0; i < count; i++) {
+                timestamps[i] = samples[i].timestamp;
+                if (samples[i].geometry == 0) {
+                    geometries[i] = [[TXLGeometryCollection geometryWithCoordinates:&samples[i].coordinate
+                                                                              count:1] retain];
+                } else {
+                    geometries[i] = [[TXLGeometryCollection geometryWithPrimaryKey:samples[i].geometry] retain];
+                }
+            }
+            _count = count;
+            _geometries = geometries;
+            _timestamps = timestamps;
+            return;
+        }
+        
+        if (_snapshots == nil)
+            return;
+        
+        // Keep the timestamps and geometries of the snapshots in
+        // arrays, which are used for the temporal lookups (binary
+        // search) and the operations on moving objects.
+        
+        NSUInteger count = [_snapshots count];
+        TXLGeometryCollection **geometries = malloc(MAX(count, 1) * sizeof(TXLGeometryCollection *));
+        NSTimeInterval *timestamps = malloc(MAX(count, 1) * sizeof(NSTimeInterval));
+        for (NSUInteger idx = 0; idx < count; idx++) {
+            TXLSnapshot *snapshot = [_snapshots objectAtIndex:idx];
+            if (snapshot.timestamp) {
+                timestamps[idx] = [snapshot.timestamp timeIntervalSince1970];
+            } else {
+                timestamps[idx] = idx == 0 ? -INFINITY : INFINITY;
+            }
+            geometries[idx] = [snapshot.geometry retain];
+        }
+        _count = count;
+        _geometries = geometries;
+        _timestamps = timestamps;
+    }
+}
+
+- (BOOL)saveSamples:(NSError **)error {
+    
+    const TXLTrajectorySample *samples = [_samples bytes];
+    NSUInteger count = [_samples length] / sizeof(TXLTrajectorySample);
+    
+    // Store the positions of the samples without a stored
+    // geometry as points, and use the primary keys of these
+    // points and of the stored geometries for the snapshots.
+    
+    TXLCoordinate *coordinates = malloc(count * sizeof(TXLCoordinate));
+    NSUInteger *geometries = malloc(count * sizeof(NSUInteger));
+    NSUInteger numberOfPoints = 0;
+    
+    for (NSUInteger i = 0; i < count; i++) {
+        if (samples[i].geometry == 0) {
+            coordinates[numberOfPoints] = samples[i].coordinate;
+            numberOfPoints++;
+        }
+    }
+    
+    NSUInteger *points = malloc((numberOfPoints > 0 ? numberOfPoints : 1) * sizeof(NSUInteger));
+    BOOL success = [TXLGeometryCollection savePointsWithCoordinates:coordinates
+                                                              count:numberOfPoints
+                                                        primaryKeys:points
+                                                              error:error];
+    if (success) {
+        NSUInteger p = 0;
+        for (NSUInteger i = 0; i < count; i++) {
+            if (samples[i].geometry == 0) {
+                geometries[i] = points[p];
+                p++;
+            } else {
+                geometries[i] = samples[i].geometry;
+            }
+        }
+        
+        TXLDatabase *db = [[TXLManager sharedManager] database];
+        NSUInteger pk = primaryKey;
+        success = [db executeSQL:@"INSERT INTO txl_snapshot (movingobject_id, geometry_id, timestamp, count) VALUES (?, ?, ?, ?)"
+                    numberOfRows:count
+                  insertedRowids:NULL
+                           error:error
+                     bindHandler:^(sqlite3_stmt *statement, NSUInteger row){
+                         sqlite3_bind_int64(statement, 1, pk);
+                         sqlite3_bind_int64(statement, 2, geometries[row]);
+                         sqlite3_bind_double(statement, 3, samples[row].timestamp);
+                         sqlite3_bind_int64(statement, 4, row);
+                     }];
+    }
+    
+    free(points);
+    free(geometries);
+    free(coordinates);
+    return success;
+}
+
+#pragma mark -
+#pragma mark Bounds
+
+// The geometries forming the bounds of a moving object created from
+// samples: the positions of all samples except of the last one are
+// collected in one geometry, and each stored geometry is used once.
+- (NSArray *)sampleGeometries {
+    const TXLTrajectorySample *samples = [_samples bytes];
+    NSUInteger count = [_samples length] / sizeof(TXLTrajectorySample);
+    NSUInteger numberOfSamples = count > 1 ? count - 1 : count;
+    
+    TXLCoordinate *coordinates = malloc(MAX(numberOfSamples, 1) * sizeof(TXLCoordinate));
+    NSUInteger numberOfPoints = 0;
+    NSMutableIndexSet *geometries = [NSMutableIndexSet indexSet];
+    
+    for (NSUInteger i = 0; i < numberOfSamples; i++) {
+        if (samples[i].geometry == 0) {
+            coordinates[numberOfPoints] = samples[i].coordinate;
+            numberOfPoints++;
+        } else {
+            [geometries addIndex:samples[i].geometry];
+        }
+    }
+    
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:[geometries count] + 1];
+    if (numberOfPoints > 0) {
+        [result addObject:[TXLGeometryCollection geometryWithCoordinates:coordinates
+                                                                   count:numberOfPoints]];
+    }
+    free(coordinates);
+    
+    NSUInteger pk = [geometries firstIndex];
+    while (pk != NSNotFound) {
+        [result addObject:[TXLGeometryCollection geometryWithPrimaryKey:pk]];
+        pk = [geometries indexGreaterThanIndex:pk];
+    }
+    
+    return result;
+}
+
+// Calculate the bounds as the union of the geometries of all snapshots
+// except of the last one (see -initWithSnapshots:). The geometries are
+// united as a cascaded union instead of one after the other.
+- (void)calculateBounds {
+    TXLGeometryCollection *bounds = nil;
+    
+    if (_samples != nil) {
+        NSArray *geometries = [self sampleGeometries];
+        NSUInteger count = [geometries count];
+        TXLGeometryCollection **g = malloc(MAX(count, 1) * sizeof(TXLGeometryCollection *));
+        [geometries getObjects:g range:NSMakeRange(0, count)];
+        bounds = [TXLGeometryCollection unionOfGeometries:g count:count];
+        free(g);
+    } else {
+        [self loadSnapshotArrays];
+        NSUInteger count = _count > 1 ? _count - 1 : _count;
+        bounds = [TXLGeometryCollection unionOfGeometries:_geometries count:count];
+    }
+    
+    [_bounds release];
+    _bounds = [bounds retain];
+}
+
+// Calculate the bounding box of the bounds from the bounding
+// boxes of the geometries, without calculating the union.
+- (void)calculateBoundingBox {
+    TXLBoundingBox box;
+    box.minLatitude = INFINITY;
+    box.maxLatitude = -INFINITY;
+    box.minLongitude = INFINITY;
+    box.maxLongitude = -INFINITY;
+    
+    if (!_lazyBounds) {
+        if (_bounds != nil) {
+            box = _bounds.boundingBox;
+        }
+    } else if (_samples != nil) {
+        for (TXLGeometryCollection *geometry in [self sampleGeometries]) {
+            TXLExtendBoundingBox(&box, geometry.boundingBox);
+        }
+    } else {
+        [self loadSnapshotArrays];
+        NSUInteger count = _count > 1 ? _count - 1 : _count;
+        for (NSUInteger idx = 0; idx < count; idx++) {
+            if (_geometries[idx] != nil) {
+                TXLExtendBoundingBox(&box, _geometries[idx].boundingBox);
+            }
+        }
+    }
+    
+    _boundingBox = box;
+    _hasBoundingBox = YES;
+}
+
 @end
@@ -84,6 +84,14 @@ extern NSString * const TXLMovingObjectSequenceErrorDomain;
 
 @property (readonly, getter=isEmpty) BOOL empty;
 
+/*! YES, if all moving objects of the sequence are spatially
+ *  unbounded (see -[TXLMovingObject isSpatiallyUnbounded]).
+ *
+ *  The operations between two spatially unbounded sequences
+ *  are calculated on the time intervals only.
+ */
+@property (readonly, getter=isSpatiallyUnbounded) BOOL spatiallyUnbounded;
+
 #pragma mark -
 #pragma mark Begin & End
 
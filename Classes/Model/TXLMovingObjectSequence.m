@@ -31,6 +31,12 @@
 
 NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObjectSequenceErrorDomain";
 
+typedef enum {
+	kTXLMovingObjectOperationTypeUNION, 
+	kTXLMovingObjectOperationTypeINTERSECT, 
+	kTXLMovingObjectOperationTypeDIFFERENCE
+} kTXLMovingObjectOperationType;
+
 @interface TXLMovingObjectSequence ()
 
 #pragma mark -
@@ -48,7 +54,10 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
 #pragma mark Sweep Line Operation
 
 - (TXLMovingObjectSequence *)generateSequenceWithMovingObject:(TXLMovingObjectSequence *)mos
-                                               usingOperation:(TXLGeometryCollection  * (^)(TXLGeometryCollection *, TXLGeometryCollection *))operation;
+                                               usingOperation:(kTXLMovingObjectOperationType)operation;
+
+- (TXLMovingObjectSequence *)generateIntervalSequenceWithMovingObject:(TXLMovingObjectSequence *)mos
+                                                       usingOperation:(kTXLMovingObjectOperationType)operation;
 
 @end
 
@@ -85,58 +94,32 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
 
 - (TXLMovingObjectSequence *)intersectionWithMovingObject:(TXLMovingObject *)mo {
     return [self generateSequenceWithMovingObject:[TXLMovingObjectSequence sequenceWithMovingObject:mo]
-                                   usingOperation:^(TXLGeometryCollection *left, TXLGeometryCollection *right) {
-                                       if (left == nil)
-                                           return (TXLGeometryCollection *)nil;
-                                       if (right == nil)
-                                           return (TXLGeometryCollection *)nil;
-                                       return [left intersection:right];
-                                   }];
+                                   usingOperation:kTXLMovingObjectOperationTypeINTERSECT];
 }
 
 - (TXLMovingObjectSequence *)intersectionWithMovingObjectSequence:(TXLMovingObjectSequence *)mos {
     return [self generateSequenceWithMovingObject:mos
-                                   usingOperation:^(TXLGeometryCollection *left, TXLGeometryCollection *right) {
-                                       if (left == nil)
-                                           return (TXLGeometryCollection *)nil;
-                                       if (right == nil)
-                                           return (TXLGeometryCollection *)nil;
-                                       return [left intersection:right];
-                                   }];
+                                   usingOperation:kTXLMovingObjectOperationTypeINTERSECT];
 }
 
 - (TXLMovingObjectSequence *)unionWithMovingObject:(TXLMovingObject *)mo {
     return [self generateSequenceWithMovingObject:[TXLMovingObjectSequence sequenceWithMovingObject:mo]
-                                   usingOperation:^(TXLGeometryCollection *left, TXLGeometryCollection *right) {
-                                       if (left == nil) return right;
-                                       if (right == nil) return left;
-                                       return [left union:right];
-                                   }];
+                                   usingOperation:kTXLMovingObjectOperationTypeUNION];
 }
 
 - (TXLMovingObjectSequence *)unionWithMovingObjectSequence:(TXLMovingObjectSequence *)mos {
     return [self generateSequenceWithMovingObject:mos
-                                   usingOperation:^(TXLGeometryCollection *left, TXLGeometryCollection *right) {
-                                       if (left == nil) return right;
-                                       if (right == nil) return left;
-                                       return [left union:right];
-                                   }];
+                                   usingOperation:kTXLMovingObjectOperationTypeUNION];
 }
 
 - (TXLMovingObjectSequence *)complementWithMovingObject:(TXLMovingObject *)mo {
     return [self generateSequenceWithMovingObject:[TXLMovingObjectSequence sequenceWithMovingObject:mo]
-                                   usingOperation:^(TXLGeometryCollection *left, TXLGeometryCollection *right) {
-                                       if (left == nil || right == nil) return left;
-                                       return [left difference:right];
-                                   }];
+                                   usingOperation:kTXLMovingObjectOperationTypeDIFFERENCE];
 }
 
 - (TXLMovingObjectSequence *)complementWithMovingObjectSequnece:(TXLMovingObjectSequence *)mos {
     return [self generateSequenceWithMovingObject:mos
-                                   usingOperation:^(TXLGeometryCollection *left, TXLGeometryCollection *right) {
-                                       if (left == nil || right == nil) return left;
-                                       return [left difference:right];
-                                   }];
+                                   usingOperation:kTXLMovingObjectOperationTypeDIFFERENCE];
 }
 
 #pragma mark -
@@ -174,6 +157,14 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
     return [_sequence count] == 0;
 }
 
+- (BOOL)isSpatiallyUnbounded {
+    for (TXLMovingObject *mo in self.movingObjects) {
+        if (!mo.spatiallyUnbounded)
+            return NO;
+    }
+    return YES;
+}
+
 #pragma mark -
 #pragma mark Begin & End
 
@@ -218,15 +209,13 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
     @synchronized (_bounds) {
         if (_bounds == nil) {
             [self load];
-            TXLGeometryCollection *g = nil;
-            for (TXLMovingObject *mo in _sequence) {
-                if (g) {
-                    g = [g union:mo.bounds];
-                } else {
-                    g = mo.bounds;
-                }
+            NSUInteger count = [_sequence count];
+            TXLGeometryCollection **g = malloc(MAX(count, 1) * sizeof(TXLGeometryCollection *));
+            for (NSUInteger idx = 0; idx < count; idx++) {
+                g[idx] = [[_sequence objectAtIndex:idx] bounds];
             }
-            _bounds = [g retain];
+            _bounds = [[TXLGeometryCollection unionOfGeometries:g count:count] retain];
+            free(g);
         }        
     }
     return _bounds;
@@ -428,36 +417,255 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
 #pragma mark -
 #pragma mark Sweep Line Operation
 
+// The snapshots of one moving object as struct of arrays
+// (see -[TXLMovingObject getTimestamps:geometries:boundingBoxes:]).
+typedef struct {
+    NSUInteger count;
+    const NSTimeInterval *timestamps;
+    TXLGeometryCollection * const *geometries;
+    const TXLBoundingBox *boxes;
+} TXLSnapshotArrays;
+
+// The snapshots of the moving object, which is created next.
+typedef struct {
+    NSUInteger count;
+    NSUInteger capacity;
+    NSTimeInterval *timestamps;
+    TXLGeometryCollection **geometries;
+} TXLSnapshotBuffer;
+
+static TXLSnapshotArrays TXLSnapshotArraysOfMovingObject(TXLMovingObject *mo) {
+    TXLSnapshotArrays arrays;
+    arrays.count = [mo getTimestamps:&arrays.timestamps
+                          geometries:&arrays.geometries
+                       boundingBoxes:&arrays.boxes];
+    return arrays;
+}
+
+static void TXLSnapshotBufferAppend(TXLSnapshotBuffer *buffer,
+                                    NSTimeInterval timestamp,
+                                    TXLGeometryCollection *geometry) {
+    if (buffer->count == buffer->capacity) {
+        buffer->capacity = buffer->capacity == 0 ? 16 : buffer->capacity * 2;
+        buffer->timestamps = realloc(buffer->timestamps, buffer->capacity * sizeof(NSTimeInterval));
+        buffer->geometries = realloc(buffer->geometries, buffer->capacity * sizeof(TXLGeometryCollection *));
+    }
+    buffer->timestamps[buffer->count] = timestamp;
+    buffer->geometries[buffer->count] = geometry;
+    buffer->count++;
+}
+
+static BOOL TXLBoundingBoxesDisjoint(const TXLBoundingBox *a, const TXLBoundingBox *b) {
+    return a->maxLongitude < b->minLongitude || b->maxLongitude < a->minLongitude ||
+           a->maxLatitude < b->minLatitude || b->maxLatitude < a->minLatitude;
+}
+
+// Apply the operation to the geometries of the left and right moving
+// object (nil, if the moving object is not valid). The bounding boxes
+// of the geometries are used to avoid the geometric operation, if the
+// geometries are disjoint. The tests, which are not done by the
+// geometry itself, are noted in the statistics of TXLGeometryCollection.
+static TXLGeometryCollection *TXLApplyOperation(kTXLMovingObjectOperationType operation,
+                                                TXLGeometryCollection *left,
+                                                const TXLBoundingBox *leftBox,
+                                                TXLGeometryCollection *right,
+                                                const TXLBoundingBox *rightBox) {
+    switch (operation) {
+        case kTXLMovingObjectOperationTypeINTERSECT:
+            if (left == nil || right == nil)
+                return nil;
+            if (TXLBoundingBoxesDisjoint(leftBox, rightBox)) {
+                [TXLGeometryCollection noteBoundingBoxTestRejected:YES];
+                return nil;
+            }
+            if (left.entireWorld)
+                return right;
+            if (right.entireWorld)
+                return left;
+            return [left intersection:right];
+            
+        case kTXLMovingObjectOperationTypeUNION:
+            if (left == nil) return right;
+            if (right == nil) return left;
+            if (left.entireWorld)
+                return left;
+            if (right.entireWorld)
+                return right;
+            return [left union:right];
+            
+        case kTXLMovingObjectOperationTypeDIFFERENCE:
+            if (left == nil || right == nil) return left;
+            if (TXLBoundingBoxesDisjoint(leftBox, rightBox)) {
+                [TXLGeometryCollection noteBoundingBoxTestRejected:YES];
+                return left;
+            }
+            if (right.entireWorld)
+                return nil;
+            [TXLGeometryCollection noteBoundingBoxTestRejected:NO];
+            return [left difference:right];
+            
+        default:
+            return nil;
+    }
+}
+
+static int TXLCompareTimestamps(const void *a, const void *b) {
+    NSTimeInterval t1 = *(const NSTimeInterval *)a;
+    NSTimeInterval t2 = *(const NSTimeInterval *)b;
+    return t1 < t2 ? -1 : (t1 > t2 ? 1 : 0);
+}
+
+// Collect the time intervals [begin, end) of the spatially unbounded
+// moving objects as pairs in the array (with room for two timestamps
+// per moving object). The intervals are sorted by their begin and
+// overlapping or touching intervals are merged.
+static NSUInteger TXLIntervalsOfMovingObjects(NSArray *movingObjects, NSTimeInterval *intervals) {
+    NSUInteger count = 0;
+    for (TXLMovingObject *mo in movingObjects) {
+        const NSTimeInterval *timestamps;
+        NSUInteger n = [mo getTimestamps:&timestamps geometries:NULL boundingBoxes:NULL];
+        intervals[2 * count] = timestamps[0];
+        intervals[2 * count + 1] = timestamps[n - 1];
+        count++;
+    }
+    
+    qsort(intervals, count, 2 * sizeof(NSTimeInterval), TXLCompareTimestamps);
+    
+    NSUInteger merged = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        if (merged > 0 && intervals[2 * i] <= intervals[2 * merged - 1]) {
+            intervals[2 * merged - 1] = MAX(intervals[2 * merged - 1], intervals[2 * i + 1]);
+        } else {
+            intervals[2 * merged] = intervals[2 * i];
+            intervals[2 * merged + 1] = intervals[2 * i + 1];
+            merged++;
+        }
+    }
+    return merged;
+}
+
+// Operation on two sequences of spatially unbounded moving objects.
+// The result only depends on the time intervals of the moving objects,
+// the geometry of each resulting moving object is the entire world.
+- (TXLMovingObjectSequence *)generateIntervalSequenceWithMovingObject:(TXLMovingObjectSequence *)mos
+                                                       usingOperation:(kTXLMovingObjectOperationType)operation {
+    
+    NSArray *leftSequence = self.movingObjects;
+    NSArray *rightSequence = mos.movingObjects;
+    
+    NSTimeInterval *left = malloc(MAX([leftSequence count], 1) * 2 * sizeof(NSTimeInterval));
+    NSTimeInterval *right = malloc(MAX([rightSequence count], 1) * 2 * sizeof(NSTimeInterval));
+    
+    NSUInteger leftCount = TXLIntervalsOfMovingObjects(leftSequence, left);
+    NSUInteger rightCount = TXLIntervalsOfMovingObjects(rightSequence, right);
+    
+    // All begins and ends in temporal order. Between two
+    // of these timestamps the result does not change.
+    NSUInteger count = 2 * (leftCount + rightCount);
+    NSTimeInterval *timestamps = malloc(MAX(count, 1) * sizeof(NSTimeInterval));
+    memcpy(timestamps, left, 2 * leftCount * sizeof(NSTimeInterval));
+    memcpy(timestamps + 2 * leftCount, right, 2 * rightCount * sizeof(NSTimeInterval));
+    qsort(timestamps, count, sizeof(NSTimeInterval), TXLCompareTimestamps);
+    
+    NSMutableArray *resultSequence = [NSMutableArray array];
+    
+    NSUInteger leftIdx = 0;
+    NSUInteger rightIdx = 0;
+    BOOL valid = NO;
+    NSTimeInterval begin = 0;
+    
+    for (NSUInteger idx = 0; idx < count; idx++) {
+        NSTimeInterval t = timestamps[idx];
+        if (idx > 0 && t == timestamps[idx - 1])
+            continue;
+        
+        // Check if the left and right sequence
+        // is valid in the interval starting at t.
+        while (leftIdx < leftCount && left[2 * leftIdx + 1] <= t)
+            leftIdx++;
+        while (rightIdx < rightCount && right[2 * rightIdx + 1] <= t)
+            rightIdx++;
+        
+        BOOL inLeft = leftIdx < leftCount && left[2 * leftIdx] <= t;
+        BOOL inRight = rightIdx < rightCount && right[2 * rightIdx] <= t;
+        
+        BOOL inResult;
+        switch (operation) {
+            case kTXLMovingObjectOperationTypeINTERSECT:
+                inResult = inLeft && inRight;
+                break;
+            case kTXLMovingObjectOperationTypeUNION:
+                inResult = inLeft || inRight;
+                break;
+            case kTXLMovingObjectOperationTypeDIFFERENCE:
+            default:
+                inResult = inLeft && !inRight;
+                break;
+        }
+        
+        if (inResult && !valid) {
+            begin = t;
+            valid = YES;
+        } else if (!inResult && valid) {
+            // The last timestamp is the end of all intervals, so
+            // that each interval of the result is closed here.
+            [resultSequence addObject:[TXLMovingObject movingObjectWithBegin:isinf(begin) ? nil : [NSDate dateWithTimeIntervalSince1970:begin]
+                                                                         end:isinf(t) ? nil : [NSDate dateWithTimeIntervalSince1970:t]]];
+            valid = NO;
+        }
+    }
+    
+    free(timestamps);
+    free(left);
+    free(right);
+    
+    return [TXLMovingObjectSequence sequenceWithArray:resultSequence];
+}
+
 // A sweep line style algorithm for bilding a moving object sequence
 // from two moving objects by applying an operation. The algorithm uses
 // a constant interpolation. A Snapshot is valid up to the next snapshot
 // in the list of snapshots of the moving object.
+//
+// The snapshots are processed as arrays of timestamps, geometries and
+// bounding boxes. A moving object without begin (end) has a first (last)
+// timestamp of -INFINITY (INFINITY), so that the timestamps can be
+// compared directly.
 - (TXLMovingObjectSequence *)generateSequenceWithMovingObject:(TXLMovingObjectSequence *)mos
-                                               usingOperation:(TXLGeometryCollection *(^)(TXLGeometryCollection *, TXLGeometryCollection *))operation {
+                                               usingOperation:(kTXLMovingObjectOperationType)operation {
+    
+    // Purely temporal moving objects are
+    // combined by their time intervals.
+    if (self.spatiallyUnbounded && mos.spatiallyUnbounded) {
+        return [self generateIntervalSequenceWithMovingObject:mos
+                                               usingOperation:operation];
+    }
     
     __block NSMutableArray *resultSequence = [NSMutableArray array];
-    __block NSMutableArray *resultSnapshots = [NSMutableArray array];
+    __block TXLSnapshotBuffer result = {0, 0, NULL, NULL};
     
     NSArray *leftSequence = self.movingObjects;
-    __block NSArray *leftSnapshots = nil;
+    __block TXLSnapshotArrays left = {0, NULL, NULL, NULL};
     NSUInteger leftSequenceIdx = 0;
     __block TXLGeometryCollection *leftGeometry = nil;
-
+    __block const TXLBoundingBox *leftBox = NULL;
+    
     NSArray *rightSequence = mos.movingObjects;
-    __block NSArray *rightSnapshots = nil;
+    __block TXLSnapshotArrays right = {0, NULL, NULL, NULL};
     NSUInteger rightSequenceIdx = 0;
     __block TXLGeometryCollection *rightGeometry = nil;
+    __block const TXLBoundingBox *rightBox = NULL;
     
     __block NSUInteger leftIdx = 0;
     __block NSUInteger rightIdx = 0;
     
     if ([leftSequence count] > leftSequenceIdx) {
-        leftSnapshots = [[leftSequence objectAtIndex:leftSequenceIdx] snapshots];
+        left = TXLSnapshotArraysOfMovingObject([leftSequence objectAtIndex:leftSequenceIdx]);
         leftSequenceIdx++;
     }
     
     if ([rightSequence count] > rightSequenceIdx) {
-        rightSnapshots = [[rightSequence objectAtIndex:rightSequenceIdx] snapshots];
+        right = TXLSnapshotArraysOfMovingObject([rightSequence objectAtIndex:rightSequenceIdx]);
         rightSequenceIdx++;
     }
     
@@ -472,55 +680,24 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
         
         // both arrays are empty.
         // this should never happen.
-        if (leftIdx >= [leftSnapshots count] && rightIdx >= [rightSnapshots count])
+        if (leftIdx >= left.count && rightIdx >= right.count)
             return 0; // ???
         
         // left array of snapshots is empty
-        if (leftIdx >= [leftSnapshots count])
+        if (leftIdx >= left.count)
             return 1; // right
         
         // right array of snapshots is empty
-        if (rightIdx >= [rightSnapshots count])
-            return -1; // left
-        
-        TXLSnapshot *l = [leftSnapshots objectAtIndex:leftIdx];
-        TXLSnapshot *r = [rightSnapshots objectAtIndex:rightIdx];
-        
-        // both snapshots have a timestamp of -inf
-        if (l.timestamp == nil && leftIdx == 0 && r.timestamp == nil && rightIdx == 0)
-            return 0; // same
-        
-        // both snapshots have a timestamp of +inf
-        if (l.timestamp == nil && leftIdx > 0 && r.timestamp == nil && rightIdx > 0)
-            return 0; // same
-        
-        // the left snapshot has a timestamp of -inf
-        if (l.timestamp == nil && leftIdx == 0)
+        if (rightIdx >= right.count)
             return -1; // left
         
-        // the right snapshot has a timestamp of -inf
-        if (r.timestamp == nil && rightIdx == 0)
-            return 1; // right
-        
-        // the left snapshot has a timestamp of +inf
-        if (l.timestamp == nil && leftIdx > 0)
-            return 1; // left
-        
-        // the right snapshot has a timestamp of +inf
-        if (r.timestamp == nil && rightIdx > 0)
-            return -1; // right
-        
-        switch ([l.timestamp compare:r.timestamp]) {
-            case NSOrderedSame:
-                return 0;
-            case NSOrderedAscending:
-                return -1;
-            case NSOrderedDescending:
-                return 1;
-            default:
-                return 0;
-        }
+        NSTimeInterval l = left.timestamps[leftIdx];
+        NSTimeInterval r = right.timestamps[rightIdx];
         
+        if (l < r)
+            return -1;
+        if (l > r)
+            return 1;
         return 0;
     };
     
@@ -532,23 +709,21 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
     // end of the result snapshots.
     // Otherwise create a moving object out of the collected snapshots
     // and append it to at the result sequence. 
-    void (^createSnapshot)(NSDate *) = ^(NSDate *timestamp){
-        TXLGeometryCollection *geom = operation(leftGeometry, rightGeometry);
+    void (^createSnapshot)(NSTimeInterval) = ^(NSTimeInterval timestamp){
+        TXLGeometryCollection *geom = TXLApplyOperation(operation, leftGeometry, leftBox, rightGeometry, rightBox);
         if (geom && geom.empty == NO) {
-            [resultSnapshots addObject:[TXLSnapshot snapshotWithTimestamp:timestamp
-                                                                 geometry:geom]];
+            TXLSnapshotBufferAppend(&result, timestamp, geom);
         } else {
-            if ([resultSnapshots count] > 0) {
+            if (result.count > 0) {
                 // Add a snapshot to cover the time until this timestamp.
-                TXLSnapshot *snapshot = [resultSnapshots lastObject];
-                if( (timestamp != nil) &&
-                    ([snapshot.timestamp earlierDate:timestamp] == snapshot.timestamp) &&
-                    (snapshot.timestamp != timestamp) ){
-                    [resultSnapshots addObject:[TXLSnapshot snapshotWithTimestamp:timestamp
-                                                                         geometry:snapshot.geometry]];
+                NSTimeInterval last = result.timestamps[result.count - 1];
+                if (!isinf(timestamp) && last < timestamp) {
+                    TXLSnapshotBufferAppend(&result, timestamp, result.geometries[result.count - 1]);
                 }
-                [resultSequence addObject:[TXLMovingObject movingObjectWithSnapshots:resultSnapshots]];
-                resultSnapshots = [NSMutableArray array];
+                [resultSequence addObject:[TXLMovingObject movingObjectWithTimestamps:result.timestamps
+                                                                           geometries:result.geometries
+                                                                                count:result.count]];
+                result.count = 0;
             }
         }
     };
@@ -557,35 +732,36 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
     // Use the function nextSnapshot to check which snapshot schould
     // be processed next (next in time). Then update the left or right
     // geometry and create a new snapshot.
-    while ([leftSnapshots count] > leftIdx || [rightSnapshots count] > rightIdx) {
+    while (left.count > leftIdx || right.count > rightIdx) {
         
         switch (nextSnapshot()) {
             case -1: // left
             {
                 
-                TXLSnapshot *l = [leftSnapshots objectAtIndex:leftIdx];
+                NSTimeInterval l = left.timestamps[leftIdx];
                 
                 // Create a snapshot before the left moving object starts.
                 if (leftIdx == 0 && rightIdx != 0) {
                     // left snapshot is first
-                    createSnapshot(l.timestamp);
+                    createSnapshot(l);
                 }
                 
                 // Create the next snapshot.
-                leftGeometry = l.geometry;
-                createSnapshot(l.timestamp);
+                leftGeometry = left.geometries[leftIdx];
+                leftBox = &left.boxes[leftIdx];
+                createSnapshot(l);
                 
                 
-                if (leftIdx + 1 == [leftSnapshots count]) {
-                    if (l.timestamp != nil) {
+                if (leftIdx + 1 == left.count) {
+                    if (!isinf(l)) {
                         // Reset the geometry of the left moving object.
                         leftGeometry = nil;
                         // Create the snapshot after the left moving object.
-                        createSnapshot(l.timestamp);
+                        createSnapshot(l);
                     }
                     
                     if (leftSequenceIdx < [leftSequence count]) {
-                        leftSnapshots = [[leftSequence objectAtIndex:leftSequenceIdx] snapshots];
+                        left = TXLSnapshotArraysOfMovingObject([leftSequence objectAtIndex:leftSequenceIdx]);
                         leftSequenceIdx++;
                         leftIdx = 0;
                     } else {
@@ -600,27 +776,28 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
             case 1: // right
             {
                 
-                TXLSnapshot *r = [rightSnapshots objectAtIndex:rightIdx];
+                NSTimeInterval r = right.timestamps[rightIdx];
                 
                 // Create a snapshot before the right moving object starts.
                 if (rightIdx == 0 && leftIdx != 0) {
                     // left snapshot is first
-                    createSnapshot(r.timestamp);
+                    createSnapshot(r);
                 }
                 
                 // Create the next snapshot.
-                rightGeometry = r.geometry;
-                createSnapshot(r.timestamp);
+                rightGeometry = right.geometries[rightIdx];
+                rightBox = &right.boxes[rightIdx];
+                createSnapshot(r);
                                 
-                if (rightIdx + 1 == [rightSnapshots count]) {
-                    if (r.timestamp != nil) {
+                if (rightIdx + 1 == right.count) {
+                    if (!isinf(r)) {
                         // Reset the geometry of the right moving object.
                         rightGeometry = nil;
-                        createSnapshot(r.timestamp);
+                        createSnapshot(r);
                     }
                     
                     if (rightSequenceIdx < [rightSequence count]) {
-                        rightSnapshots = [[rightSequence objectAtIndex:rightSequenceIdx] snapshots];
+                        right = TXLSnapshotArraysOfMovingObject([rightSequence objectAtIndex:rightSequenceIdx]);
                         rightSequenceIdx++;
                         rightIdx = 0;
                     } else {
@@ -635,42 +812,46 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
             default: // same
             {
                 
-                TXLSnapshot *l = [leftSnapshots objectAtIndex:leftIdx];
-                TXLSnapshot *r = [rightSnapshots objectAtIndex:rightIdx];
+                NSTimeInterval l = left.timestamps[leftIdx];
+                NSTimeInterval r = right.timestamps[rightIdx];
                 
-                if (leftIdx == 0 && rightIdx + 1 == [rightSnapshots count]) {
+                if (leftIdx == 0 && rightIdx + 1 == right.count) {
                     // left is first AND right is last snapshot
                     
-                    rightGeometry = r.geometry;
+                    rightGeometry = right.geometries[rightIdx];
+                    rightBox = &right.boxes[rightIdx];
                     
-                } else if (rightIdx == 0 && leftIdx + 1 == [leftSnapshots count]) {
+                } else if (rightIdx == 0 && leftIdx + 1 == left.count) {
                     // right is first AND left is last snapshot
                     
-                    leftGeometry = l.geometry;
+                    leftGeometry = left.geometries[leftIdx];
+                    leftBox = &left.boxes[leftIdx];
                     
                 } else {
                     
-                    leftGeometry = l.geometry;
-                    rightGeometry = r.geometry;
+                    leftGeometry = left.geometries[leftIdx];
+                    leftBox = &left.boxes[leftIdx];
+                    rightGeometry = right.geometries[rightIdx];
+                    rightBox = &right.boxes[rightIdx];
                     
                 }
 
                 // Create the next snapshot.
-                createSnapshot(l.timestamp);
+                createSnapshot(l);
                 
-                if (l.timestamp == nil) {
+                if (isinf(l)) {
                     leftGeometry = nil;
                     rightGeometry = nil;
                 }
                 
-                if (leftIdx + 1 == [leftSnapshots count]) {
-                    if (l.timestamp != nil) {
+                if (leftIdx + 1 == left.count) {
+                    if (!isinf(l)) {
                         // Reset the geometry of the left movign object.
                         leftGeometry = nil;
                     }
                     
                     if (leftSequenceIdx < [leftSequence count]) {
-                        leftSnapshots = [[leftSequence objectAtIndex:leftSequenceIdx] snapshots];
+                        left = TXLSnapshotArraysOfMovingObject([leftSequence objectAtIndex:leftSequenceIdx]);
                         leftSequenceIdx++;
                         leftIdx = 0;
                     } else {
@@ -680,14 +861,14 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
                     leftIdx++;
                 }
                 
-                if (rightIdx + 1 == [rightSnapshots count]) {
-                    if (r.timestamp != nil) {
+                if (rightIdx + 1 == right.count) {
+                    if (!isinf(r)) {
                         // Reset the geometry of the right movign object.
                         rightGeometry = nil;
                     }
                     
                     if (rightSequenceIdx < [rightSequence count]) {
-                        rightSnapshots = [[rightSequence objectAtIndex:rightSequenceIdx] snapshots];
+                        right = TXLSnapshotArraysOfMovingObject([rightSequence objectAtIndex:rightSequenceIdx]);
                         rightSequenceIdx++;
                         rightIdx = 0;
                     } else {
@@ -702,16 +883,21 @@ NSString * const TXLMovingObjectSequenceErrorDomain = @"org.opentxl.TXLMovingObj
     
     // If the left or right geometry are not nil, at least one of
     // the moving objects has no end (timestamp == +inf).
-    if ([(TXLSnapshot *)[resultSnapshots lastObject] timestamp] != nil && (leftGeometry != nil || rightGeometry != nil)) {
+    if (result.count > 0 && !isinf(result.timestamps[result.count - 1]) && (leftGeometry != nil || rightGeometry != nil)) {
         
         // Create the last snapshot with timestamp == +inf
-        createSnapshot(nil);
+        createSnapshot(INFINITY);
     }
     
-    if ([resultSnapshots count] > 0) {
-        [resultSequence addObject:[TXLMovingObject movingObjectWithSnapshots:resultSnapshots]];
+    if (result.count > 0) {
+        [resultSequence addObject:[TXLMovingObject movingObjectWithTimestamps:result.timestamps
+                                                                   geometries:result.geometries
+                                                                        count:result.count]];
     }
     
+    free(result.timestamps);
+    free(result.geometries);
+    
     return [TXLMovingObjectSequence sequenceWithArray:resultSequence];
 }
 
@@ -40,6 +40,13 @@
 @property (readonly) TXLRevision *revision;
 @property (readonly) TXLQueryHandle *queryHandle;
 
+/*! Boolean flag indicating if the evaluation of the query in this
+ *  revision has been skipped, because it was coalesced with the
+ *  evaluation of a later revision. The result set is in this case
+ *  the result set of the preceding evaluated revision.
+ */
+@property (readonly, getter=isSkipped) BOOL skipped;
+
 #pragma mark -
 #pragma mark Result
 
@@ -51,6 +51,29 @@
     [super dealloc];
 }
 
+#pragma mark -
+#pragma mark Skipped Evaluation
+
+- (BOOL)isSkipped {
+    TXLDatabase *database = [[TXLManager sharedManager] database]; 
+    
+    NSError *error;
+    
+    NSArray *result = [database executeSQLWithParameters:@"SELECT COUNT(*) as c FROM txl_query_skipped WHERE query_id = ? AND revision_id = ?"
+                                                   error:&error,
+                       [TXLInteger integerWithValue:self.queryHandle.queryPrimaryKey],
+                       [TXLInteger integerWithValue:revision.primaryKey],
+                       nil];
+    
+    if (result == nil) {
+        [[NSException exceptionWithName:@"TXLResultSetException"
+                                 reason:[error localizedDescription]
+                               userInfo:nil] raise];
+    }
+    
+    return [result count] == 1 && [[[result objectAtIndex:0] objectForKey:@"c"] intValue] > 0;
+}
+
 #pragma mark -
 #pragma mark Count
 
@@ -0,0 +1,97 @@
+//
+//  TXLBindingArena.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 22.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import <Foundation/Foundation.h>
+
+/*! A binding of a variable: the primary key of the term,
+ *  or 0 if the variable is not bound.
+ */
+typedef int64_t TXLBinding;
+
+/*! Number of slots of a binding vector allocated by an arena.
+ */
+NSUInteger TXLBindingsCount(const TXLBinding *bindings);
+
+/*! Hash and equality of two binding vectors, comparing
+ *  the number of slots and the values of all slots.
+ */
+NSUInteger TXLBindingsHash(const TXLBinding *bindings);
+BOOL TXLBindingsEqual(const TXLBinding *bindings1, const TXLBinding *bindings2);
+
+/*! Callbacks for a CFDictionary or a CFSet with binding vectors as keys.
+ *  The keys are neither retained nor released, they are owned by the arena.
+ */
+extern const CFDictionaryKeyCallBacks kTXLBindingsDictionaryKeyCallBacks;
+extern const CFSetCallBacks kTXLBindingsSetCallBacks;
+
+
+/*! Memory for binding vectors used during one evaluation.
+ *
+ *  A binding vector is an array of TXLBinding with one slot for each
+ *  variable of a pattern (see TXLGraphPattern -slots). The vectors are
+ *  allocated in larger blocks and are not freed individually. All vectors
+ *  of an arena are freed together with the arena.
+ */
+@interface TXLBindingArena : NSObject {
+
+@private
+    TXLBinding **blocks;
+    NSUInteger numberOfBlocks;
+    NSUInteger capacityOfBlocks;
+    TXLBinding *next;
+    NSUInteger available;
+}
+
+#pragma mark -
+#pragma mark Creating an Arena
+
++ (TXLBindingArena *)arena;
+
+#pragma mark -
+#pragma mark Allocating Binding Vectors
+
+/*! A new binding vector with all slots unbound.
+ */
+- (TXLBinding *)bindingsWithNumberOfSlots:(NSUInteger)numberOfSlots;
+
+/*! A copy of the binding vector.
+ */
+- (TXLBinding *)copyOfBindings:(const TXLBinding *)bindings;
+
+#pragma mark -
+#pragma mark Converting Variable Maps
+
+/*! A binding vector for the slots with the values of the dictionary
+ *  (primary key of the variable -> primary key of the term, both as
+ *  TXLInteger). Variables without a slot are ignored.
+ */
+- (TXLBinding *)bindingsWithVariables:(NSDictionary *)vars
+                                slots:(NSArray *)slots;
+
+/*! A dictionary with the bound slots of the binding vector.
+ */
++ (NSDictionary *)variablesWithBindings:(const TXLBinding *)bindings
+                                  slots:(NSArray *)slots;
+
+@end
@@ -0,0 +1,175 @@
+//
+//  TXLBindingArena.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 22.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import "TXLBindingArena.h"
+
+#import "TXLInteger.h"
+
+// number of bindings in a block of the arena
+#define TXL_BINDING_ARENA_BLOCK_SIZE 4096
+
+#pragma mark -
+#pragma mark Binding Vectors
+
+// The number of slots is stored in front of the first slot
+// of each vector allocated by an arena.
+
+NSUInteger TXLBindingsCount(const TXLBinding *bindings) {
+    return (NSUInteger)bindings[-1];
+}
+
+NSUInteger TXLBindingsHash(const TXLBinding *bindings) {
+    NSUInteger count = TXLBindingsCount(bindings);
+    NSUInteger hash = count;
+    for (NSUInteger i = 0; i < count; i++) {
+        hash = hash * 31 + (NSUInteger)(bindings[i] ^ (bindings[i] >> 32));
+    }
+    return hash;
+}
+
+BOOL TXLBindingsEqual(const TXLBinding *bindings1, const TXLBinding *bindings2) {
+    NSUInteger count = TXLBindingsCount(bindings1);
+    if (count != TXLBindingsCount(bindings2)) {
+        return NO;
+    }
+    return memcmp(bindings1, bindings2, count * sizeof(TXLBinding)) == 0;
+}
+
+static Boolean TXLBindingsEqualCallBack(const void *value1, const void *value2) {
+    return TXLBindingsEqual(value1, value2);
+}
+
+static CFHashCode TXLBindingsHashCallBack(const void *value) {
+    return TXLBindingsHash(value);
+}
+
+const CFDictionaryKeyCallBacks kTXLBindingsDictionaryKeyCallBacks = {
+    0, NULL, NULL, NULL, TXLBindingsEqualCallBack, TXLBindingsHashCallBack
+};
+
+const CFSetCallBacks kTXLBindingsSetCallBacks = {
+    0, NULL, NULL, NULL, TXLBindingsEqualCallBack, TXLBindingsHashCallBack
+};
+
+
+@implementation TXLBindingArena
+
+#pragma mark -
+#pragma mark Creating an Arena
+
++ (TXLBindingArena *)arena {
+    return [[[self alloc] init] autorelease];
+}
+
+#pragma mark -
+#pragma mark Memory Management
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < numberOfBlocks; i++) {
+        free(blocks[i]);
+    }
+    free(blocks);
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Allocating Binding Vectors
+
+- (TXLBinding *)bindingsWithNumberOfSlots:(NSUInteger)numberOfSlots {
+    
+    NSUInteger size = numberOfSlots + 1;
+    
+    if (size > available) {
+        
+        // --------------------------------------------------------------------
+        // start a new block, vectors larger than a block
+        // get a block on their own
+        // --------------------------------------------------------------------
+        
+        NSUInteger blockSize = MAX(size, TXL_BINDING_ARENA_BLOCK_SIZE);
+        
+        if (numberOfBlocks == capacityOfBlocks) {
+            capacityOfBlocks = capacityOfBlocks > 0 ? capacityOfBlocks * 2 : 8;
+            blocks = realloc(blocks, capacityOfBlocks * sizeof(TXLBinding *));
+            if (blocks == NULL) {
+                [NSException raise:NSMallocException format:@"Could not allocate binding vectors."];
+            }
+        }
+        
+        TXLBinding *block = calloc(blockSize, sizeof(TXLBinding));
+        if (block == NULL) {
+            [NSException raise:NSMallocException format:@"Could not allocate binding vectors."];
+        }
+        blocks[numberOfBlocks++] = block;
+        
+        next = block;
+        available = blockSize;
+    }
+    
+    TXLBinding *bindings = next + 1;
+    bindings[-1] = numberOfSlots;
+    
+    next += size;
+    available -= size;
+    
+    return bindings;
+}
+
+- (TXLBinding *)copyOfBindings:(const TXLBinding *)bindings {
+    NSUInteger count = TXLBindingsCount(bindings);
+    TXLBinding *copy = [self bindingsWithNumberOfSlots:count];
+    memcpy(copy, bindings, count * sizeof(TXLBinding));
+    return copy;
+}
+
+#pragma mark -
+#pragma mark Converting Variable Maps
+
+- (TXLBinding *)bindingsWithVariables:(NSDictionary *)vars
+                                slots:(NSArray *)slots {
+    NSUInteger count = [slots count];
+    TXLBinding *bindings = [self bindingsWithNumberOfSlots:count];
+    for (NSUInteger slot = 0; slot < count; slot++) {
+        TXLInteger *value = [vars objectForKey:[slots objectAtIndex:slot]];
+        if (value != nil) {
+            bindings[slot] = [value int64Value];
+        }
+    }
+    return bindings;
+}
+
++ (NSDictionary *)variablesWithBindings:(const TXLBinding *)bindings
+                                  slots:(NSArray *)slots {
+    NSMutableDictionary *vars = [NSMutableDictionary dictionary];
+    NSUInteger count = [slots count];
+    for (NSUInteger slot = 0; slot < count; slot++) {
+        if (bindings[slot] != 0) {
+            [vars setObject:[TXLInteger integerWithValue:bindings[slot]]
+                     forKey:[slots objectAtIndex:slot]];
+        }
+    }
+    return vars;
+}
+
+@end
@@ -0,0 +1,144 @@
+//
+//  TXLFilter.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 18.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import <Foundation/Foundation.h>
+
+#import "TXLBindingArena.h"
+
+extern NSString * const TXLFilterFunctionNamespace;
+
+@class TXLInteger;
+@class TXLMovingObjectSequence;
+
+
+/*! Compiled FILTER expression of a graph pattern.
+ *
+ *  The expression is stored as property list in the table
+ *  txl_query_pattern_filter. Each node of the expression is a
+ *  dictionary with the key "type", which is one of:
+ *
+ *  var    - A variable with the primary key "id".
+ *  term   - A term with the primary key "id".
+ *  and, or, not - Logical operators with the operands "args".
+ *  =, !=, <, <=, >, >= - Comparisons with the operands "args".
+ *  call   - A call of the function with the IRI "function"
+ *           with the arguments "args".
+ *
+ *  Numeric, boolean and date literals are compared by their value.
+ *  A typed literal with the datatype xsd:dateTime is compared as date.
+ *  All other terms are only equal, if they are the same term.
+ *
+ *  The following functions (in the namespace TXLFilterFunctionNamespace)
+ *  test the window (the moving object sequence) of a match:
+ *
+ *  intersects(wkt)     - The window intersects the geometry.
+ *  within(wkt)         - The window is within the geometry.
+ *  before(date)        - The window ends before the date.
+ *  after(date)         - The window begins after the date.
+ *  overlaps(from, to)  - The window overlaps the interval.
+ */
+@interface TXLFilter : NSObject {
+
+@private
+    NSDictionary *expression;
+    NSArray *conjuncts;
+    NSDictionary *constants;
+    NSDictionary *slotOfVariable;
+}
+
+#pragma mark -
+#pragma mark Compiling Filters
+
+/*! Serialize an expression tree for the table txl_query_pattern_filter.
+ */
++ (NSString *)stringWithExpression:(NSDictionary *)expression;
+
+#pragma mark -
+#pragma mark Loading Filters
+
+/*! All filters of the graph pattern with the primary key.
+ */
++ (NSArray *)filtersOfPatternWithPrimaryKey:(NSUInteger)pk;
+
+#pragma mark -
+#pragma mark Evaluation
+
+/*! The primary keys (TXLInteger) of the variables used in the filter.
+ */
+@property (readonly) NSSet *variables;
+
+/*! Assign the variables of the filter to the slots of the
+ *  binding vectors of the pattern (see TXLGraphPattern -slots).
+ *  This has to be done before the filter is evaluated.
+ */
+- (void)bindVariablesToSlots:(NSArray *)slots;
+
+/*! YES if the filter calls a function, which tests the window
+ *  of the match.
+ */
+@property (readonly) BOOL dependsOnWindow;
+
+/*! Evaluate the filter for a complete match.
+ *
+ *  bindings - The binding vector of the match.
+ *  mos      - The window of the match (nil is always everywhere).
+ */
+- (BOOL)evaluateWithBindings:(const TXLBinding *)bindings
+                      window:(TXLMovingObjectSequence *)mos;
+
+/*! Check, if a partial match can be rejected.
+ *
+ *  Only the top level conjuncts of the filter are evaluated,
+ *  whose variables are all bound and whose result can not change
+ *  if the window is restricted further during the backtracking.
+ */
+- (BOOL)rejectsBindings:(const TXLBinding *)bindings
+                 window:(TXLMovingObjectSequence *)mos;
+
+#pragma mark -
+#pragma mark SQL Pushdown
+
+/*! Append the conditions of the filter to the SQL expression
+ *  of a triple pattern, that binds the variable to the column.
+ *
+ *  Only top level comparisons between the variable and a constant
+ *  are considered. All other conditions are evaluated afterwards.
+ */
+- (void)appendConditionsForVariable:(TXLInteger *)varId
+                             column:(NSString *)column
+                              toSQL:(NSMutableString *)sql
+                         parameters:(NSMutableArray *)params;
+
+/*! Append the conditions of the filter to the SQL expression
+ *  of a triple pattern, which have to hold for the moving object
+ *  of each statement contributing to a match.
+ *
+ *  The spatial conditions use the spatial index of the
+ *  geometries.
+ */
+- (void)appendWindowConditionsForColumn:(NSString *)column
+                                  toSQL:(NSMutableString *)sql
+                             parameters:(NSMutableArray *)params;
+
+@end
@@ -0,0 +1,812 @@
+//
+//  TXLFilter.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 18.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import "TXLFilter.h"
+
+#import "TXLDatabase.h"
+#import "TXLManager.h"
+#import "TXLInteger.h"
+#import "TXLTerm.h"
+#import "TXLMovingObject.h"
+#import "TXLMovingObjectSequence.h"
+#import "TXLGeometryCollection.h"
+
+#include <ctype.h>
+#include <time.h>
+
+NSString * const TXLFilterFunctionNamespace = @"http://schema.opentxl.org/filter#";
+
+@interface TXLFilter ()
+
+- (id)initWithExpression:(NSDictionary *)expr;
+
+#pragma mark Expression
+
+- (void)collectVariablesOfNode:(NSDictionary *)node intoSet:(NSMutableSet *)vars;
+- (BOOL)isNodeDependentOnWindow:(NSDictionary *)node;
+- (BOOL)isNodeDecidable:(NSDictionary *)node withBindings:(const TXLBinding *)bindings;
+- (BOOL)isNodeIndependentOfRestrictedWindow:(NSDictionary *)node;
+
+#pragma mark Evaluation
+
+- (id)valueOfNode:(NSDictionary *)node
+         bindings:(const TXLBinding *)bindings
+           window:(TXLMovingObjectSequence *)mos;
+
+- (NSNumber *)booleanValueOfNode:(NSDictionary *)node
+                        bindings:(const TXLBinding *)bindings
+                          window:(TXLMovingObjectSequence *)mos;
+
+- (NSNumber *)compareTerm:(TXLTerm *)a
+                 withTerm:(TXLTerm *)b
+                 operator:(NSString *)op;
+
+- (NSNumber *)callFunction:(NSString *)function
+             withArguments:(NSArray *)args
+                    window:(TXLMovingObjectSequence *)mos;
+
+#pragma mark Constants
+
+- (void)collectConstantsOfNode:(NSDictionary *)node intoDictionary:(NSMutableDictionary *)dict;
+- (TXLTerm *)termWithPrimaryKey:(NSNumber *)pk;
+- (NSDate *)dateOfTerm:(TXLTerm *)term strict:(BOOL)strict;
+- (TXLGeometryCollection *)geometryOfNode:(NSDictionary *)node;
+- (NSDate *)dateOfNode:(NSDictionary *)node;
+
+@end
+
+#pragma mark -
+#pragma mark Date Parsing
+
+static BOOL TXLFilterScanNumber(const char **s, int digits, int *value) {
+    int v = 0;
+    for (int i = 0; i < digits; i++) {
+        if (!isdigit((unsigned char)(*s)[i])) {
+            return NO;
+        }
+        v = v * 10 + ((*s)[i] - '0');
+    }
+    *s += digits;
+    *value = v;
+    return YES;
+}
+
+static NSDate *TXLFilterDateFromString(NSString *value) {
+    
+    // The lexical form of xsd:dateTime (and xsd:date):
+    // YYYY-MM-DD['T'hh:mm[:ss[.s+]]][Z|(+|-)hh[:]mm]
+    // A date without a time zone is interpreted as UTC.
+    
+    const char *s = [value UTF8String];
+    if (s == NULL) {
+        return nil;
+    }
+    
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    double fraction = 0;
+    int offset = 0;
+    
+    if (!TXLFilterScanNumber(&s, 4, &year) || *s++ != '-' ||
+        !TXLFilterScanNumber(&s, 2, &month) || *s++ != '-' ||
+        !TXLFilterScanNumber(&s, 2, &day)) {
+        return nil;
+    }
+    
+    if (*s == 'T') {
+        s++;
+        if (!TXLFilterScanNumber(&s, 2, &hour) || *s++ != ':' ||
+            !TXLFilterScanNumber(&s, 2, &minute)) {
+            return nil;
+        }
+        if (*s == ':') {
+            s++;
+            if (!TXLFilterScanNumber(&s, 2, &second)) {
+                return nil;
+            }
+            if (*s == '.') {
+                s++;
+                if (!isdigit((unsigned char)*s)) {
+                    return nil;
+                }
+                for (double scale = 0.1; isdigit((unsigned char)*s); s++, scale /= 10) {
+                    fraction += (*s - '0') * scale;
+                }
+            }
+        }
+    }
+    
+    if (*s == 'Z') {
+        s++;
+    } else if (*s == '+' || *s == '-') {
+        int sign = *s++ == '-' ? -1 : 1;
+        int offsetHours, offsetMinutes;
+        if (!TXLFilterScanNumber(&s, 2, &offsetHours)) {
+            return nil;
+        }
+        if (*s == ':') {
+            s++;
+        }
+        if (!TXLFilterScanNumber(&s, 2, &offsetMinutes)) {
+            return nil;
+        }
+        offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+    }
+    
+    if (*s != '\0' ||
+        month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 24 || minute > 59 || second > 60) {
+        return nil;
+    }
+    
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    t.tm_year = year - 1900;
+    t.tm_mon = month - 1;
+    t.tm_mday = day;
+    t.tm_hour = hour;
+    t.tm_min = minute;
+    t.tm_sec = second;
+    
+    return [NSDate dateWithTimeIntervalSince1970:(double)timegm(&t) - offset + fraction];
+}
+
+
+@implementation TXLFilter
+
+#pragma mark -
+#pragma mark Compiling Filters
+
++ (NSString *)stringWithExpression:(NSDictionary *)expression {
+    NSString *errorDescription = nil;
+    NSData *data = [NSPropertyListSerialization dataFromPropertyList:expression
+                                                              format:NSPropertyListXMLFormat_v1_0
+                                                    errorDescription:&errorDescription];
+    if (data == nil) {
+        [NSException raise:@"TXLFilterException" format:@"Could not serialize filter expression: %@", errorDescription];
+    }
+    return [[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] autorelease];
+}
+
+#pragma mark -
+#pragma mark Loading Filters
+
++ (NSArray *)filtersOfPatternWithPrimaryKey:(NSUInteger)pk {
+    
+    NSError *error;
+    
+    TXLDatabase *database = [[TXLManager sharedManager] database];
+    NSArray *result = [database executeSQLWithParameters:@"SELECT expression FROM txl_query_pattern_filter WHERE in_pattern_id = ? ORDER BY id"
+                                                   error:&error,
+                       [TXLInteger integerWithValue:pk], nil];
+    
+    if (result == nil) {
+        [NSException raise:@"TXLFilterException" format:@"Could not retrieve filters of pattern (%d): %@", pk, [error localizedDescription]];
+    }
+    
+    NSMutableArray *filters = [NSMutableArray array];
+    
+    for (NSDictionary *row in result) {
+        NSString *errorDescription = nil;
+        NSData *data = [[row objectForKey:@"expression"] dataUsingEncoding:NSUTF8StringEncoding];
+        NSDictionary *expr = [NSPropertyListSerialization propertyListFromData:data
+                                                              mutabilityOption:NSPropertyListImmutable
+                                                                        format:NULL
+                                                              errorDescription:&errorDescription];
+        if (expr == nil) {
+            [NSException raise:@"TXLFilterException" format:@"Could not read filter of pattern (%d): %@", pk, errorDescription];
+        }
+        
+        TXLFilter *filter = [[TXLFilter alloc] initWithExpression:expr];
+        [filters addObject:filter];
+        [filter release];
+    }
+    
+    return filters;
+}
+
+#pragma mark -
+#pragma mark Memory Management
+
+- (id)initWithExpression:(NSDictionary *)expr {
+    if ((self = [super init])) {
+        expression = [expr retain];
+        
+        // the constants of the expression are loaded once and
+        // not changed afterwards, so that the filter can be
+        // evaluated concurrently
+        NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+        [self collectConstantsOfNode:expr intoDictionary:dict];
+        constants = [dict copy];
+        
+        // split the expression into its top level conjuncts,
+        // so that each of them can be used separately
+        NSMutableArray *c = [NSMutableArray array];
+        NSMutableArray *stack = [NSMutableArray arrayWithObject:expr];
+        while ([stack count] > 0) {
+            NSDictionary *node = [stack lastObject];
+            [stack removeLastObject];
+            if ([[node objectForKey:@"type"] isEqual:@"and"]) {
+                [stack addObjectsFromArray:[node objectForKey:@"args"]];
+            } else {
+                [c addObject:node];
+            }
+        }
+        conjuncts = [c retain];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [expression release];
+    [conjuncts release];
+    [constants release];
+    [slotOfVariable release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Evaluation
+
+- (NSSet *)variables {
+    NSMutableSet *varIds = [NSMutableSet set];
+    [self collectVariablesOfNode:expression intoSet:varIds];
+    
+    NSMutableSet *variables = [NSMutableSet set];
+    for (NSNumber *varId in varIds) {
+        [variables addObject:[TXLInteger integerWithValue:[varId integerValue]]];
+    }
+    return variables;
+}
+
+- (void)bindVariablesToSlots:(NSArray *)slots {
+    NSMutableDictionary *map = [NSMutableDictionary dictionary];
+    for (NSUInteger slot = 0; slot < [slots count]; slot++) {
+        [map setObject:[NSNumber numberWithUnsignedInteger:slot]
+                forKey:[NSNumber numberWithInteger:[[slots objectAtIndex:slot] integerValue]]];
+    }
+    [slotOfVariable release];
+    slotOfVariable = [map copy];
+}
+
+- (BOOL)dependsOnWindow {
+    return [self isNodeDependentOnWindow:expression];
+}
+
+- (BOOL)evaluateWithBindings:(const TXLBinding *)bindings
+                      window:(TXLMovingObjectSequence *)mos {
+    // an error in the evaluation of the expression
+    // is treated as false
+    return [[self booleanValueOfNode:expression
+                            bindings:bindings
+                              window:mos] boolValue];
+}
+
+- (BOOL)rejectsBindings:(const TXLBinding *)bindings
+                 window:(TXLMovingObjectSequence *)mos {
+    for (NSDictionary *conjunct in conjuncts) {
+        if ([self isNodeDecidable:conjunct withBindings:bindings] &&
+            [self isNodeIndependentOfRestrictedWindow:conjunct]) {
+            if (![[self booleanValueOfNode:conjunct bindings:bindings window:mos] boolValue]) {
+                return YES;
+            }
+        }
+    }
+    return NO;
+}
+
+#pragma mark -
+#pragma mark SQL Pushdown
+
+- (void)appendConditionsForVariable:(TXLInteger *)varId
+                             column:(NSString *)column
+                              toSQL:(NSMutableString *)sql
+                         parameters:(NSMutableArray *)params {
+    
+    // A comparison with '!=' is true for terms of another type
+    // than the constant, so it is not restricted by the database.
+    NSDictionary *inverse = [NSDictionary dictionaryWithObjectsAndKeys:
+                             @"=", @"=",
+                             @">", @"<", @">=", @"<=",
+                             @"<", @">", @"<=", @">=",
+                             nil];
+    
+    for (NSDictionary *conjunct in conjuncts) {
+        
+        NSString *op = [conjunct objectForKey:@"type"];
+        if ([inverse objectForKey:op] == nil) {
+            continue;
+        }
+        
+        NSArray *args = [conjunct objectForKey:@"args"];
+        NSDictionary *a = [args objectAtIndex:0];
+        NSDictionary *b = [args objectAtIndex:1];
+        
+        NSDictionary *constant = nil;
+        if ([[a objectForKey:@"type"] isEqual:@"var"] &&
+            [[a objectForKey:@"id"] integerValue] == [varId integerValue] &&
+            [[b objectForKey:@"type"] isEqual:@"term"]) {
+            constant = b;
+        } else if ([[b objectForKey:@"type"] isEqual:@"var"] &&
+                   [[b objectForKey:@"id"] integerValue] == [varId integerValue] &&
+                   [[a objectForKey:@"type"] isEqual:@"term"]) {
+            constant = a;
+            op = [inverse objectForKey:op];
+        } else {
+            continue;
+        }
+        
+        TXLTerm *term = [self termWithPrimaryKey:[constant objectForKey:@"id"]];
+        NSDate *date = [self dateOfTerm:term strict:YES];
+        
+        if ([term numberValue] != nil) {
+            [sql appendFormat:@" AND %@ IN (SELECT id FROM txl_term WHERE type IN (%d, %d) AND value %@ ?)",
+             column, kTXLTermTypeIntegerLiteral, kTXLTermTypeDoubleLiteral, op];
+            [params addObject:[term numberValue]];
+        } else if (date != nil) {
+            // typed literals could be dates as well, these are compared afterwards
+            [sql appendFormat:@" AND %@ IN (SELECT id FROM txl_term WHERE (type = %d AND value %@ ?) OR type = %d)",
+             column, kTXLTermTypeDateTimeLiteral, op, kTXLTermTypeTypedLiteral];
+            [params addObject:[NSNumber numberWithDouble:[date timeIntervalSinceReferenceDate]]];
+        } else if ([op isEqual:@"="]) {
+            [sql appendFormat:@" AND %@ = ?", column];
+            [params addObject:[constant objectForKey:@"id"]];
+        }
+    }
+}
+
+- (void)appendWindowConditionsForColumn:(NSString *)column
+                                  toSQL:(NSMutableString *)sql
+                             parameters:(NSMutableArray *)params {
+    
+    // The window of a match is the intersection of the moving
+    // objects of all statements of the match. So the window can
+    // only intersect a region, if each of these moving objects
+    // intersects the region.
+    
+    for (NSDictionary *conjunct in conjuncts) {
+        
+        if (![[conjunct objectForKey:@"type"] isEqual:@"call"]) {
+            continue;
+        }
+        
+        NSString *function = [conjunct objectForKey:@"function"];
+        NSArray *args = [conjunct objectForKey:@"args"];
+        
+        if ([function isEqual:[TXLFilterFunctionNamespace stringByAppendingString:@"intersects"]] && [args count] == 1) {
+            
+            TXLGeometryCollection *geometry = [self geometryOfNode:[args objectAtIndex:0]];
+            if (geometry == nil) {
+                continue;
+            }
+            
+            TXLBoundingBox bbox = geometry.boundingBox;
+            
+            [sql appendFormat:@" AND (%@ ISNULL OR %@ IN (SELECT id FROM txl_movingobject WHERE bounds ISNULL OR bounds IN \
+             (SELECT pkid FROM idx_txl_geometry_geometry WHERE xmin <= ? AND xmax >= ? AND ymin <= ? AND ymax >= ?)))", column, column];
+            [params addObject:[NSNumber numberWithDouble:bbox.maxLongitude]];
+            [params addObject:[NSNumber numberWithDouble:bbox.minLongitude]];
+            [params addObject:[NSNumber numberWithDouble:bbox.maxLatitude]];
+            [params addObject:[NSNumber numberWithDouble:bbox.minLatitude]];
+            
+        } else if ([function isEqual:[TXLFilterFunctionNamespace stringByAppendingString:@"overlaps"]] && [args count] == 2) {
+            
+            NSDate *from = [self dateOfNode:[args objectAtIndex:0]];
+            NSDate *to = [self dateOfNode:[args objectAtIndex:1]];
+            if (from == nil || to == nil) {
+                continue;
+            }
+            
+            [sql appendFormat:@" AND (%@ ISNULL OR %@ IN (SELECT id FROM txl_movingobject WHERE \
+             (\"begin\" ISNULL OR \"begin\" <= ?) AND (\"end\" ISNULL OR \"end\" >= ?)))", column, column];
+            [params addObject:[NSNumber numberWithDouble:[to timeIntervalSince1970]]];
+            [params addObject:[NSNumber numberWithDouble:[from timeIntervalSince1970]]];
+        }
+    }
+}
+
+#pragma mark -
+#pragma mark -
+#pragma mark Private Methods
+
+#pragma mark -
+#pragma mark Expression
+
+- (void)collectVariablesOfNode:(NSDictionary *)node intoSet:(NSMutableSet *)vars {
+    if ([[node objectForKey:@"type"] isEqual:@"var"]) {
+        [vars addObject:[node objectForKey:@"id"]];
+    }
+    for (NSDictionary *arg in [node objectForKey:@"args"]) {
+        [self collectVariablesOfNode:arg intoSet:vars];
+    }
+}
+
+- (BOOL)isNodeDependentOnWindow:(NSDictionary *)node {
+    // all functions test the window of the match
+    if ([[node objectForKey:@"type"] isEqual:@"call"]) {
+        return YES;
+    }
+    for (NSDictionary *arg in [node objectForKey:@"args"]) {
+        if ([self isNodeDependentOnWindow:arg]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (BOOL)isNodeDecidable:(NSDictionary *)node withBindings:(const TXLBinding *)bindings {
+    NSMutableSet *varsOfNode = [NSMutableSet set];
+    [self collectVariablesOfNode:node intoSet:varsOfNode];
+    for (NSNumber *varId in varsOfNode) {
+        NSNumber *slot = [slotOfVariable objectForKey:varId];
+        if (slot == nil || bindings[[slot unsignedIntegerValue]] == 0) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (BOOL)isNodeIndependentOfRestrictedWindow:(NSDictionary *)node {
+    
+    // If the function intersects or overlaps is false for a window,
+    // it is false for every part of this window as well.
+    if ([[node objectForKey:@"type"] isEqual:@"call"]) {
+        NSString *function = [node objectForKey:@"function"];
+        return [function isEqual:[TXLFilterFunctionNamespace stringByAppendingString:@"intersects"]] ||
+        [function isEqual:[TXLFilterFunctionNamespace stringByAppendingString:@"overlaps"]];
+    }
+    
+    // Any other use of the window can change its value.
+    for (NSDictionary *arg in [node objectForKey:@"args"]) {
+        if ([[arg objectForKey:@"type"] isEqual:@"call"] ||
+            ![self isNodeIndependentOfRestrictedWindow:arg]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+#pragma mark -
+#pragma mark Evaluation
+
+- (id)valueOfNode:(NSDictionary *)node
+         bindings:(const TXLBinding *)bindings
+           window:(TXLMovingObjectSequence *)mos {
+    
+    NSString *type = [node objectForKey:@"type"];
+    
+    if ([type isEqual:@"var"]) {
+        NSNumber *slot = [slotOfVariable objectForKey:[node objectForKey:@"id"]];
+        if (slot == nil || bindings[[slot unsignedIntegerValue]] == 0) {
+            return nil;
+        }
+        return [self termWithPrimaryKey:[NSNumber numberWithLongLong:bindings[[slot unsignedIntegerValue]]]];
+    } else if ([type isEqual:@"term"]) {
+        return [self termWithPrimaryKey:[node objectForKey:@"id"]];
+    } else {
+        return [self booleanValueOfNode:node bindings:bindings window:mos];
+    }
+}
+
+- (NSNumber *)booleanValueOfNode:(NSDictionary *)node
+                        bindings:(const TXLBinding *)bindings
+                          window:(TXLMovingObjectSequence *)mos {
+    
+    NSString *type = [node objectForKey:@"type"];
+    NSArray *args = [node objectForKey:@"args"];
+    
+    if ([type isEqual:@"and"]) {
+        for (NSDictionary *arg in args) {
+            if (![[self booleanValueOfNode:arg bindings:bindings window:mos] boolValue]) {
+                return [NSNumber numberWithBool:NO];
+            }
+        }
+        return [NSNumber numberWithBool:YES];
+    }
+    
+    if ([type isEqual:@"or"]) {
+        for (NSDictionary *arg in args) {
+            if ([[self booleanValueOfNode:arg bindings:bindings window:mos] boolValue]) {
+                return [NSNumber numberWithBool:YES];
+            }
+        }
+        return [NSNumber numberWithBool:NO];
+    }
+    
+    if ([type isEqual:@"not"]) {
+        NSNumber *value = [self booleanValueOfNode:[args objectAtIndex:0] bindings:bindings window:mos];
+        if (value == nil) {
+            return nil;
+        }
+        return [NSNumber numberWithBool:![value boolValue]];
+    }
+    
+    if ([type isEqual:@"call"]) {
+        return [self callFunction:[node objectForKey:@"function"]
+                    withArguments:args
+                           window:mos];
+    }
+    
+    if ([type isEqual:@"var"] || [type isEqual:@"term"]) {
+        
+        // effective boolean value of a term
+        TXLTerm *term = [self valueOfNode:node bindings:bindings window:mos];
+        if ([term isType:kTXLTermTypeBooleanLiteral]) {
+            return [NSNumber numberWithBool:[term booleanValue]];
+        } else if ([term numberValue] != nil) {
+            return [NSNumber numberWithBool:[[term numberValue] doubleValue] != 0];
+        } else if ([term isType:kTXLTermTypePlainLiteral]) {
+            return [NSNumber numberWithBool:[[term literalValue] length] > 0];
+        }
+        return nil;
+    }
+    
+    // comparison
+    id a = [self valueOfNode:[args objectAtIndex:0] bindings:bindings window:mos];
+    id b = [self valueOfNode:[args objectAtIndex:1] bindings:bindings window:mos];
+    
+    if (a == nil || b == nil) {
+        return nil;
+    }
+    
+    if ([a isKindOfClass:[NSNumber class]] && [b isKindOfClass:[NSNumber class]]) {
+        if ([type isEqual:@"="]) {
+            return [NSNumber numberWithBool:[a boolValue] == [b boolValue]];
+        } else if ([type isEqual:@"!="]) {
+            return [NSNumber numberWithBool:[a boolValue] != [b boolValue]];
+        }
+        return nil;
+    }
+    
+    if ([a isKindOfClass:[TXLTerm class]] && [b isKindOfClass:[TXLTerm class]]) {
+        return [self compareTerm:a withTerm:b operator:type];
+    }
+    
+    return nil;
+}
+
+- (NSNumber *)compareTerm:(TXLTerm *)a
+                 withTerm:(TXLTerm *)b
+                 operator:(NSString *)op {
+    
+    NSComparisonResult result;
+    
+    NSDate *dateA = [self dateOfTerm:a strict:YES];
+    NSDate *dateB = [self dateOfTerm:b strict:YES];
+    
+    if ([a numberValue] != nil && [b numberValue] != nil) {
+        result = [[a numberValue] compare:[b numberValue]];
+    } else if (dateA != nil && dateB != nil) {
+        result = [dateA compare:dateB];
+    } else if ([a isType:kTXLTermTypeBooleanLiteral] && [b isType:kTXLTermTypeBooleanLiteral]) {
+        result = [[NSNumber numberWithBool:[a booleanValue]] compare:[NSNumber numberWithBool:[b booleanValue]]];
+    } else if ([a isType:kTXLTermTypePlainLiteral] && [b isType:kTXLTermTypePlainLiteral] &&
+               ![op isEqual:@"="] && ![op isEqual:@"!="]) {
+        result = [[a literalValue] compare:[b literalValue]];
+    } else if ([op isEqual:@"="]) {
+        return [NSNumber numberWithBool:a.primaryKey == b.primaryKey];
+    } else if ([op isEqual:@"!="]) {
+        return [NSNumber numberWithBool:a.primaryKey != b.primaryKey];
+    } else {
+        // terms of different types are not ordered
+        return nil;
+    }
+    
+    if ([op isEqual:@"="]) {
+        return [NSNumber numberWithBool:result == NSOrderedSame];
+    } else if ([op isEqual:@"!="]) {
+        return [NSNumber numberWithBool:result != NSOrderedSame];
+    } else if ([op isEqual:@"<"]) {
+        return [NSNumber numberWithBool:result == NSOrderedAscending];
+    } else if ([op isEqual:@"<="]) {
+        return [NSNumber numberWithBool:result != NSOrderedDescending];
+    } else if ([op isEqual:@">"]) {
+        return [NSNumber numberWithBool:result == NSOrderedDescending];
+    } else if ([op isEqual:@">="]) {
+        return [NSNumber numberWithBool:result != NSOrderedAscending];
+    }
+    
+    return nil;
+}
+
+- (NSNumber *)callFunction:(NSString *)function
+             withArguments:(NSArray *)args
+                    window:(TXLMovingObjectSequence *)mos {
+    
+    if (![function hasPrefix:TXLFilterFunctionNamespace]) {
+        return nil;
+    }
+    
+    NSString *name = [function substringFromIndex:[TXLFilterFunctionNamespace length]];
+    
+    // a window of nil is always everywhere
+    NSArray *movingObjects = mos == nil ? [NSArray arrayWithObject:[TXLMovingObject omnipresentMovingObject]] : mos.movingObjects;
+    
+    if ([name isEqual:@"intersects"] && [args count] == 1) {
+        
+        TXLGeometryCollection *geometry = [self geometryOfNode:[args objectAtIndex:0]];
+        if (geometry == nil) {
+            return nil;
+        }
+        for (TXLMovingObject *mo in movingObjects) {
+            if (mo.bounds == nil || [mo.bounds intersects:geometry]) {
+                return [NSNumber numberWithBool:YES];
+            }
+        }
+        return [NSNumber numberWithBool:NO];
+        
+    } else if ([name isEqual:@"within"] && [args count] == 1) {
+        
+        TXLGeometryCollection *geometry = [self geometryOfNode:[args objectAtIndex:0]];
+        if (geometry == nil) {
+            return nil;
+        }
+        for (TXLMovingObject *mo in movingObjects) {
+            if (mo.bounds == nil || ![mo.bounds within:geometry]) {
+                return [NSNumber numberWithBool:NO];
+            }
+        }
+        return [NSNumber numberWithBool:[movingObjects count] > 0];
+        
+    } else if ([name isEqual:@"before"] && [args count] == 1) {
+        
+        NSDate *date = [self dateOfNode:[args objectAtIndex:0]];
+        if (date == nil) {
+            return nil;
+        }
+        for (TXLMovingObject *mo in movingObjects) {
+            if (mo.end == nil || [mo.end compare:date] == NSOrderedDescending) {
+                return [NSNumber numberWithBool:NO];
+            }
+        }
+        return [NSNumber numberWithBool:[movingObjects count] > 0];
+        
+    } else if ([name isEqual:@"after"] && [args count] == 1) {
+        
+        NSDate *date = [self dateOfNode:[args objectAtIndex:0]];
+        if (date == nil) {
+            return nil;
+        }
+        for (TXLMovingObject *mo in movingObjects) {
+            if (mo.begin == nil || [mo.begin compare:date] == NSOrderedAscending) {
+                return [NSNumber numberWithBool:NO];
+            }
+        }
+        return [NSNumber numberWithBool:[movingObjects count] > 0];
+        
+    } else if ([name isEqual:@"overlaps"] && [args count] == 2) {
+        
+        NSDate *from = [self dateOfNode:[args objectAtIndex:0]];
+        NSDate *to = [self dateOfNode:[args objectAtIndex:1]];
+        if (from == nil || to == nil) {
+            return nil;
+        }
+        for (TXLMovingObject *mo in movingObjects) {
+            if ((mo.begin == nil || [mo.begin compare:to] != NSOrderedDescending) &&
+                (mo.end == nil || [mo.end compare:from] != NSOrderedAscending)) {
+                return [NSNumber numberWithBool:YES];
+            }
+        }
+        return [NSNumber numberWithBool:NO];
+    }
+    
+    return nil;
+}
+
+#pragma mark -
+#pragma mark Constants
+
+- (void)collectConstantsOfNode:(NSDictionary *)node intoDictionary:(NSMutableDictionary *)dict {
+    
+    NSString *type = [node objectForKey:@"type"];
+    NSArray *args = [node objectForKey:@"args"];
+    
+    if ([type isEqual:@"term"]) {
+        NSNumber *pk = [node objectForKey:@"id"];
+        if ([dict objectForKey:pk] == nil) {
+            [dict setObject:[TXLTerm termWithPrimaryKey:[pk integerValue]] forKey:pk];
+        }
+        return;
+    }
+    
+    for (NSDictionary *arg in args) {
+        [self collectConstantsOfNode:arg intoDictionary:dict];
+    }
+    
+    if (![type isEqual:@"call"]) {
+        return;
+    }
+    
+    // the geometries and dates used as arguments of the
+    // window functions are parsed once
+    NSString *function = [node objectForKey:@"function"];
+    BOOL spatial = [function isEqual:[TXLFilterFunctionNamespace stringByAppendingString:@"intersects"]] ||
+    [function isEqual:[TXLFilterFunctionNamespace stringByAppendingString:@"within"]];
+    
+    for (NSDictionary *arg in args) {
+        if (![[arg objectForKey:@"type"] isEqual:@"term"]) {
+            continue;
+        }
+        TXLTerm *term = [dict objectForKey:[arg objectForKey:@"id"]];
+        if (spatial) {
+            TXLGeometryCollection *geometry = [TXLGeometryCollection geometryFromWKT:[term literalValue]];
+            if (geometry != nil) {
+                [dict setObject:geometry forKey:[NSString stringWithFormat:@"geometry %@", [arg objectForKey:@"id"]]];
+            }
+        } else {
+            NSDate *date = [self dateOfTerm:term strict:NO];
+            if (date != nil) {
+                [dict setObject:date forKey:[NSString stringWithFormat:@"date %@", [arg objectForKey:@"id"]]];
+            }
+        }
+    }
+}
+
+- (TXLTerm *)termWithPrimaryKey:(NSNumber *)pk {
+    // terms bound to variables are not cached
+    TXLTerm *term = [constants objectForKey:pk];
+    if (term == nil) {
+        term = [TXLTerm termWithPrimaryKey:[pk integerValue]];
+    }
+    return term;
+}
+
+- (NSDate *)dateOfTerm:(TXLTerm *)term strict:(BOOL)strict {
+    
+    if ([term isType:kTXLTermTypeDateTimeLiteral]) {
+        return [term dateValue];
+    }
+    
+    NSString *value = nil;
+    if ([term isType:kTXLTermTypeTypedLiteral]) {
+        TXLTerm *dataType = [term dataType];
+        NSString *dataTypeName = [dataType iriValue] != nil ? [dataType iriValue] : [dataType literalValue];
+        if ([dataTypeName isEqual:@"http://www.w3.org/2001/XMLSchema#dateTime"]) {
+            value = [term literalValue];
+        }
+    } else if (!strict && [term isType:kTXLTermTypePlainLiteral]) {
+        value = [term literalValue];
+    }
+    
+    if (value == nil) {
+        return nil;
+    }
+    
+    return TXLFilterDateFromString(value);
+}
+
+- (TXLGeometryCollection *)geometryOfNode:(NSDictionary *)node {
+    if (![[node objectForKey:@"type"] isEqual:@"term"]) {
+        return nil;
+    }
+    return [constants objectForKey:[NSString stringWithFormat:@"geometry %@", [node objectForKey:@"id"]]];
+}
+
+- (NSDate *)dateOfNode:(NSDictionary *)node {
+    if (![[node objectForKey:@"type"] isEqual:@"term"]) {
+        return nil;
+    }
+    return [constants objectForKey:[NSString stringWithFormat:@"date %@", [node objectForKey:@"id"]]];
+}
+
+@end
@@ -23,15 +23,44 @@
 
 #import <Foundation/Foundation.h>
 
+#import "TXLBindingArena.h"
+
 @class TXLMovingObject;
 @class TXLMovingObjectSequence;
 @class TXLRevision;
+@class TXLInteger;
 
+/*! A triple pattern of a graph pattern.
+ *
+ *  For each position either the primary key of the variable
+ *  is set (not nil) together with the slot of the variable,
+ *  or the primary key of the term.
+ */
+typedef struct TXLTriplePattern_s {
+    NSUInteger primaryKey;
+    NSUInteger subject;
+    NSUInteger predicate;
+    NSUInteger object;
+    TXLInteger *subjectVar;
+    TXLInteger *predicateVar;
+    TXLInteger *objectVar;
+    NSUInteger subjectSlot;
+    NSUInteger predicateSlot;
+    NSUInteger objectSlot;
+} TXLTriplePattern;
 
 @interface TXLGraphPattern : NSObject {
     
 @private
     NSUInteger primaryKey; 
+    
+    TXLTriplePattern *triples;
+    NSUInteger numberOfTriples;
+    NSArray *notExistsPatterns;
+    NSArray *filters;
+    NSArray *slots;
+    
+    BOOL loaded;
 }
 
 #pragma mark -
@@ -69,6 +98,57 @@
                          forRevision:(TXLRevision *)rev
                        resultHandler:(void(^)(NSDictionary *vars, TXLMovingObjectSequence *mos))handler;
 
+/*! Evaluate the pattern with the given binding vector.
+ *
+ *  Same as above, but the variables are passed as binding vector
+ *  with one slot for each variable of the pattern (see -slots). The
+ *  binding vector passed to the result handler is only valid during
+ *  the call of the handler and has to be copied to be kept.
+ */
+- (BOOL)evaluatePatternWithBindings:(const TXLBinding *)bindings
+                         inContexts:(NSArray *)ctxs
+                             window:(TXLMovingObjectSequence *)mos
+                        forRevision:(TXLRevision *)rev
+                      resultHandler:(void(^)(const TXLBinding *bindings, TXLMovingObjectSequence *mos))handler;
+
+/*! The primary keys (TXLInteger) of the variables used in this pattern,
+ *  in its filters and in the contained 'not exists' patterns, ordered by
+ *  the primary key. The index of a variable in this list is its slot
+ *  in the binding vectors of this pattern.
+ */
+@property (readonly) NSArray *slots;
+
+#pragma mark -
+#pragma mark Incremental Evaluation
+
+/*! YES if the pattern can be maintained with delta rules.
+ *
+ *  This is the case for patterns consisting only of a basic graph
+ *  pattern. A change of the statements matching a 'not exists'
+ *  pattern can produce matches which do not contain any of the
+ *  changed statements, so these patterns have to be evaluated
+ *  completely.
+ */
+@property (readonly, getter=isIncrementallyEvaluable) BOOL incrementallyEvaluable;
+
+/*! Evaluate the delta of the pattern between two revisions.
+ *
+ *  The result handler is called for each match of the pattern which
+ *  uses at least one statement created or removed in the revisions
+ *  following <from> up to and including <to>. Matches using a created
+ *  statement are computed in revision <to>, matches using a removed
+ *  statement in revision <from>. The same variable binding can be
+ *  reported more than once.
+ *
+ *  The moving object sequences of the matches are not reported, since
+ *  the caller is expected to evaluate the pattern again for the
+ *  affected bindings.
+ */
+- (void)evaluateDeltaInContexts:(NSArray *)ctxs
+                   fromRevision:(TXLRevision *)from
+                     toRevision:(TXLRevision *)to
+                  resultHandler:(void(^)(const TXLBinding *bindings))handler;
+
 #pragma mark -
 #pragma mark Database Management
 
@@ -76,5 +156,14 @@
 
 @property (readonly) NSUInteger primaryKey; 
 
+/*! Load the triple patterns, the 'not exists' patterns and the
+ *  filters of this pattern.
+ *
+ *  The pattern is loaded once, on first use. After loading, the
+ *  pattern does not read the pattern tables again, so an instance
+ *  can be kept and evaluated repeatedly.
+ */
+- (void)load;
+
 
 @end
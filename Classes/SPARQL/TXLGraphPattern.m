@@ -30,33 +30,40 @@
 #import "TXLMovingObject.h"
 #import "TXLMovingObjectSequence.h"
 #import "TXLInteger.h"
+#import "TXLFilter.h"
 
 @interface TXLGraphPattern ()
 - (id)initWithPrimaryKey:(NSUInteger)pk;
 
-- (void)evaluateBasicGraphPatternWithVariables:(NSDictionary *)vars
-                                    inContexts:(NSArray *)ctxs
-                                       windows:(TXLMovingObjectSequence *)mos
-                                   forRevision:(TXLRevision *)rev
-                                 rootPatternId:(NSUInteger)rootPatternId
-                                 resultHandler:(void (^)(NSDictionary *, TXLMovingObjectSequence *))handler;
-
-- (void)evaluateNotExistsGraphPatternWithVariables:(NSDictionary *)vars
-                                        inContexts:(NSArray *)ctxs
-                                           windows:(TXLMovingObjectSequence *)mos
-                                       forRevision:(TXLRevision *)rev
-                                     rootPatternId:(NSUInteger)rootPatternId
-                                     resultHandler:(void (^)(NSDictionary *, TXLMovingObjectSequence *))handler;
-
-- (BOOL)evaluateFilterWithVariables:(NSDictionary *)vars
-                      rootPatternId:(NSUInteger)rootPatternId;
-
-- (BOOL)_evaluatePatternWithVariables:(NSDictionary *)vars
-                           inContexts:(NSArray *)ctxs
-                               window:(TXLMovingObjectSequence *)mos
-                          forRevision:(TXLRevision *)rev
-                        rootPatternId:(NSUInteger)rootPatternId
-                        resultHandler:(void(^)(NSDictionary *vars, TXLMovingObjectSequence *mos))handler;
+- (void)evaluateBasicGraphPatternWithBindings:(const TXLBinding *)bindings
+                                   inContexts:(NSArray *)ctxs
+                                      windows:(TXLMovingObjectSequence *)mos
+                                  forRevision:(TXLRevision *)rev
+                                rootPatternId:(NSUInteger)rootPatternId
+                                        arena:(TXLBindingArena *)arena
+                                resultHandler:(void (^)(const TXLBinding *, TXLMovingObjectSequence *))handler;
+
+- (void)evaluateNotExistsGraphPatternsForBindings:(TXLBinding **)matchBindings
+                                          windows:(NSMutableArray *)matchWindows
+                                       inContexts:(NSArray *)ctxs
+                                      forRevision:(TXLRevision *)rev
+                                    rootPatternId:(NSUInteger)rootPatternId
+                                            arena:(TXLBindingArena *)arena;
+
+- (BOOL)evaluateFilterWithBindings:(const TXLBinding *)bindings
+                            window:(TXLMovingObjectSequence *)mos
+                     rootPatternId:(NSUInteger)rootPatternId;
+
+- (NSSet *)variables;
+- (BOOL)dependsOnWindow;
+
+- (BOOL)_evaluatePatternWithBindings:(const TXLBinding *)bindings
+                          inContexts:(NSArray *)ctxs
+                              window:(TXLMovingObjectSequence *)mos
+                         forRevision:(TXLRevision *)rev
+                       rootPatternId:(NSUInteger)rootPatternId
+                               arena:(TXLBindingArena *)arena
+                       resultHandler:(void(^)(const TXLBinding *bindings, TXLMovingObjectSequence *mos))handler;
 @end
 
 
@@ -74,6 +81,19 @@
     return self; 
 }
 
+- (void)dealloc {
+    for (NSUInteger i = 0; i < numberOfTriples; i++) {
+        [triples[i].subjectVar release];
+        [triples[i].predicateVar release];
+        [triples[i].objectVar release];
+    }
+    free(triples);
+    [notExistsPatterns release];
+    [filters release];
+    [slots release];
+    [super dealloc];
+}
+
 #pragma mark -
 #pragma mark Database Management
 
@@ -86,60 +106,290 @@
                               window:(TXLMovingObjectSequence *)mos
                          forRevision:(TXLRevision *)rev
                        resultHandler:(void(^)(NSDictionary *vars, TXLMovingObjectSequence *mos))handler {
-     
-    return [self _evaluatePatternWithVariables:vars
-                                    inContexts:ctxs
-                                        window:mos
-                                   forRevision:rev
-                                 rootPatternId:self.primaryKey
-                                 resultHandler:handler];
     
+    [self load];
+    
+    TXLBindingArena *arena = [TXLBindingArena arena];
+    
+    return [self _evaluatePatternWithBindings:[arena bindingsWithVariables:vars slots:slots]
+                                   inContexts:ctxs
+                                       window:mos
+                                  forRevision:rev
+                                rootPatternId:self.primaryKey
+                                        arena:arena
+                                resultHandler:^(const TXLBinding *bindings, TXLMovingObjectSequence *mos) {
+                                    // the variables passed to the pattern,
+                                    // which are not used in the pattern,
+                                    // are part of the match as well
+                                    NSMutableDictionary *result = [NSMutableDictionary dictionaryWithDictionary:vars];
+                                    [result addEntriesFromDictionary:[TXLBindingArena variablesWithBindings:bindings slots:slots]];
+                                    handler(result, mos);
+                                }];
+}
+
+- (BOOL)evaluatePatternWithBindings:(const TXLBinding *)bindings
+                         inContexts:(NSArray *)ctxs
+                             window:(TXLMovingObjectSequence *)mos
+                        forRevision:(TXLRevision *)rev
+                      resultHandler:(void(^)(const TXLBinding *bindings, TXLMovingObjectSequence *mos))handler {
+    
+    [self load];
+    
+    return [self _evaluatePatternWithBindings:bindings
+                                   inContexts:ctxs
+                                       window:mos
+                                  forRevision:rev
+                                rootPatternId:self.primaryKey
+                                        arena:[TXLBindingArena arena]
+                                resultHandler:handler];
+}
+
+- (NSArray *)slots {
+    [self load];
+    return slots;
 }
 
-- (BOOL)_evaluatePatternWithVariables:(NSDictionary *)vars
-                           inContexts:(NSArray *)ctxs
-                               window:(TXLMovingObjectSequence *)mos
-                          forRevision:(TXLRevision *)rev
-                        rootPatternId:(NSUInteger)rootPatternId
-                        resultHandler:(void(^)(NSDictionary *vars, TXLMovingObjectSequence *mos))handler {
+- (BOOL)_evaluatePatternWithBindings:(const TXLBinding *)bindings
+                          inContexts:(NSArray *)ctxs
+                              window:(TXLMovingObjectSequence *)mos
+                         forRevision:(TXLRevision *)rev
+                       rootPatternId:(NSUInteger)rootPatternId
+                               arena:(TXLBindingArena *)arena
+                       resultHandler:(void(^)(const TXLBinding *bindings, TXLMovingObjectSequence *mos))handler {
     
     __block BOOL success = NO;
     
-    [self evaluateBasicGraphPatternWithVariables:vars
-                                      inContexts:ctxs
-                                         windows:mos
-                                     forRevision:rev
-                                   rootPatternId:rootPatternId
-                                   resultHandler:^(NSDictionary *vars, TXLMovingObjectSequence *mos) {
-                                       
-                                       [self evaluateNotExistsGraphPatternWithVariables:vars
-                                                                             inContexts:ctxs
-                                                                                windows:mos
-                                                                            forRevision:rev
-                                                                          rootPatternId:rootPatternId
-                                                                          resultHandler:^(NSDictionary *vars, TXLMovingObjectSequence *mos) {
-                                                                              
-                                                                              if ([self evaluateFilterWithVariables:vars
-                                                                                                      rootPatternId:rootPatternId]) {
-                                                                                  success = YES;
-                                                                                  handler(vars, mos);
-                                                                              }
-                                                                              
-                                                                          }];
-                                   }];
+    [self load];
+    
+    if ([notExistsPatterns count] == 0) {
+        
+        [self evaluateBasicGraphPatternWithBindings:bindings
+                                         inContexts:ctxs
+                                            windows:mos
+                                        forRevision:rev
+                                      rootPatternId:rootPatternId
+                                              arena:arena
+                                      resultHandler:^(const TXLBinding *bindings, TXLMovingObjectSequence *mos) {
+                                          if (mos == nil) {
+                                              // the match is valid always everywhere
+                                              mos = [TXLMovingObjectSequence sequenceWithMovingObject:[TXLMovingObject omnipresentMovingObject]];
+                                          }
+                                          if ([self evaluateFilterWithBindings:bindings
+                                                                        window:mos
+                                                                 rootPatternId:rootPatternId]) {
+                                              success = YES;
+                                              handler(bindings, mos);
+                                          }
+                                      }];
+        
+    } else {
+        
+        // The 'not exists' patterns are evaluated for the set of all
+        // matches of the basic graph pattern at once. Therefore the
+        // matches are collected first.
+        
+        NSMutableData *matchBindings = [NSMutableData data];
+        NSMutableArray *matchWindows = [NSMutableArray array];
+        
+        [self evaluateBasicGraphPatternWithBindings:bindings
+                                         inContexts:ctxs
+                                            windows:mos
+                                        forRevision:rev
+                                      rootPatternId:rootPatternId
+                                              arena:arena
+                                      resultHandler:^(const TXLBinding *bindings, TXLMovingObjectSequence *mos) {
+                                          TXLBinding *match = [arena copyOfBindings:bindings];
+                                          [matchBindings appendBytes:&match length:sizeof(TXLBinding *)];
+                                          [matchWindows addObject:mos != nil ? mos : [TXLMovingObjectSequence sequenceWithMovingObject:[TXLMovingObject omnipresentMovingObject]]];
+                                      }];
+        
+        TXLBinding **matches = (TXLBinding **)[matchBindings mutableBytes];
+        
+        [self evaluateNotExistsGraphPatternsForBindings:matches
+                                                windows:matchWindows
+                                             inContexts:ctxs
+                                            forRevision:rev
+                                          rootPatternId:rootPatternId
+                                                  arena:arena];
+        
+        for (NSUInteger i = 0; i < [matchWindows count]; i++) {
+            TXLMovingObjectSequence *w = [matchWindows objectAtIndex:i];
+            if (![w isEmpty] && [self evaluateFilterWithBindings:matches[i]
+                                                          window:w
+                                                   rootPatternId:rootPatternId]) {
+                success = YES;
+                handler(matches[i], w);
+            }
+        }
+    }
     
     return success;
 }
 
+#pragma mark -
+#pragma mark Incremental Evaluation
+
+- (BOOL)isIncrementallyEvaluable {
+    [self load];
+    return numberOfTriples > 0 && [notExistsPatterns count] == 0;
+}
+
+- (void)evaluateDeltaInContexts:(NSArray *)ctxs
+                   fromRevision:(TXLRevision *)from
+                     toRevision:(TXLRevision *)to
+                  resultHandler:(void(^)(const TXLBinding *bindings))handler {
+
+    // Semi-naive evaluation of the basic graph pattern. Every match,
+    // which uses a statement created or removed in the revisions
+    // (from, to], uses this statement for at least one triple pattern <i>.
+    // So for each triple pattern the changed statements matching it
+    // are used as seed for its variables and the whole pattern is
+    // evaluated with these bound variables. Created statements are
+    // joined with the state in revision <to>, removed statements with
+    // the state in revision <from>, so that matches which disappeared
+    // are found as well. Extended statements (positions appended to
+    // their moving object) are handled like created statements.
+
+    [self load];
+
+    NSError *error;
+
+    TXLDatabase *database = [[TXLManager sharedManager] database];
+
+    NSArray *deltaTables = [NSArray arrayWithObjects:@"txl_statement_created", @"txl_statement_removed", @"txl_statement_extended", nil];
+
+    for (NSUInteger i = 0; i < numberOfTriples; i++) {
+
+        TXLTriplePattern pattern = triples[i];
+
+        for (NSString *deltaTable in deltaTables) {
+
+            NSAutoreleasePool *pool = [NSAutoreleasePool new];
+
+            // --------------------------------------------------------------------
+            // find the statements changed in the interval (from, to]
+            // matching the terms of this triple pattern
+            // --------------------------------------------------------------------
+
+            NSMutableString *sql = [NSMutableString stringWithFormat:@"\
+                                    SELECT st.subject_id, st.predicate_id, st.object_id \
+                                    FROM txl_statement as st \
+                                    INNER JOIN %@ as d ON (st.id = d.statement_id AND d.revision_id > ? AND d.revision_id <= ?) \
+                                    INNER JOIN txl_context as ctx ON (st.context_id = ctx.id) \
+                                    WHERE (", deltaTable];
+            NSMutableArray *sqlParams = [NSMutableArray array];
+            [sqlParams addObject:[TXLInteger integerWithValue:[from primaryKey]]];
+            [sqlParams addObject:[TXLInteger integerWithValue:[to primaryKey]]];
+
+            BOOL first = YES;
+            for (TXLContext *ctx in ctxs) {
+
+                if (!first) {
+                    [sql appendString:@" OR"];
+                } else {
+                    first = NO;
+                }
+
+                [sql appendFormat:@" (ctx.name glob '%@*')", [ctx description]];
+            }
+
+            [sql appendString:@")"];
+
+            if (pattern.subjectVar == nil) {
+                [sql appendString:@" AND st.subject_id=?"];
+                [sqlParams addObject:[TXLInteger integerWithValue:pattern.subject]];
+            }
+
+            if (pattern.predicateVar == nil) {
+                [sql appendString:@" AND st.predicate_id=?"];
+                [sqlParams addObject:[TXLInteger integerWithValue:pattern.predicate]];
+            }
+
+            if (pattern.objectVar == nil) {
+                [sql appendString:@" AND st.object_id=?"];
+                [sqlParams addObject:[TXLInteger integerWithValue:pattern.object]];
+            }
+
+            // --------------------------------------------------------------------
+            // collect the bindings of the variables of this triple pattern.
+            // a variable used twice in the triple pattern must be bound
+            // to the same term.
+            // --------------------------------------------------------------------
+
+            TXLBindingArena *arena = [TXLBindingArena arena];
+            NSUInteger numberOfSlots = [slots count];
+
+            CFMutableSetRef seeds = CFSetCreateMutable(NULL, 0, &kTXLBindingsSetCallBacks);
+
+            BOOL success = [database executeSQL:sql
+                                 withParameters:sqlParams
+                                          error:&error
+                                  resultHandler:^(NSDictionary *row, BOOL *stop) {
+
+                                      TXLBinding *seed = [arena bindingsWithNumberOfSlots:numberOfSlots];
+
+                                      TXLInteger *varIds[3] = {pattern.subjectVar, pattern.predicateVar, pattern.objectVar};
+                                      NSUInteger varSlots[3] = {pattern.subjectSlot, pattern.predicateSlot, pattern.objectSlot};
+                                      NSString *columns[3] = {@"subject_id", @"predicate_id", @"object_id"};
+
+                                      for (int position = 0; position < 3; position++) {
+                                          if (varIds[position] != nil) {
+                                              TXLBinding value = [[row objectForKey:columns[position]] int64Value];
+                                              TXLBinding bound = seed[varSlots[position]];
+                                              if (bound != 0 && bound != value) {
+                                                  return;
+                                              }
+                                              seed[varSlots[position]] = value;
+                                          }
+                                      }
+
+                                      CFSetAddValue(seeds, seed);
+                                  }];
+
+            if (!success) {
+                CFRelease(seeds);
+                [NSException raise:@"TXLGraphPatternException" format:@"Could not retrieve changed statements for basic graph pattern (%d) in graph pattern (%d): %@", pattern.primaryKey, [self primaryKey], [error localizedDescription]];
+            }
+
+            // --------------------------------------------------------------------
+            // join the seeds with the other triple patterns
+            // --------------------------------------------------------------------
+
+            TXLRevision *rev = [deltaTable isEqual:@"txl_statement_removed"] ? from : to;
+
+            NSUInteger numberOfSeeds = CFSetGetCount(seeds);
+            NSMutableData *seedList = [NSMutableData dataWithLength:numberOfSeeds * sizeof(TXLBinding *)];
+            CFSetGetValues(seeds, (const void **)[seedList mutableBytes]);
+            CFRelease(seeds);
+
+            TXLBinding **seedVectors = (TXLBinding **)[seedList mutableBytes];
+            for (NSUInteger j = 0; j < numberOfSeeds; j++) {
+                [self _evaluatePatternWithBindings:seedVectors[j]
+                                        inContexts:ctxs
+                                            window:nil
+                                       forRevision:rev
+                                     rootPatternId:self.primaryKey
+                                             arena:arena
+                                     resultHandler:^(const TXLBinding *bindings, TXLMovingObjectSequence *mos) {
+                                         handler(bindings);
+                                     }];
+            }
+
+            [pool drain];
+        }
+    }
+}
+
 #pragma mark -
 #pragma mark Internal Evaluation
 
-- (void)evaluateBasicGraphPatternWithVariables:(NSDictionary *)vars
-                                    inContexts:(NSArray *)ctxs
-                                       windows:(TXLMovingObjectSequence *)mos
-                                   forRevision:(TXLRevision *)rev
-                                 rootPatternId:(NSUInteger)rootPatternId
-                                 resultHandler:(void(^)(NSDictionary *vars, TXLMovingObjectSequence *mos))handler {
+- (void)evaluateBasicGraphPatternWithBindings:(const TXLBinding *)bindings
+                                   inContexts:(NSArray *)ctxs
+                                      windows:(TXLMovingObjectSequence *)mos
+                                  forRevision:(TXLRevision *)rev
+                                rootPatternId:(NSUInteger)rootPatternId
+                                        arena:(TXLBindingArena *)arena
+                                resultHandler:(void(^)(const TXLBinding *bindings, TXLMovingObjectSequence *mos))handler {
     
     // evaluate basic graph pattern (a set of sequential triple patterns) contained in this query graph pattern
     // stepwise in sequence. For every composing variable match, where
@@ -147,581 +397,761 @@
     // call the result handler with the match.
     
     // --------------------------------------------------------------------
-    // retrieve all basic graph pattern
+    // the triple patterns are loaded once for this pattern
     // --------------------------------------------------------------------
     
+    [self load];
+    
     NSError *error;
     
-    TXLDatabase *database = [[TXLManager sharedManager] database];   
-    NSArray *result = [database executeSQLWithParameters:@"\
-                       SELECT \
-                       id, \
-                       subject_id, \
-                       subject_var_id, \
-                       predicate_id, \
-                       predicate_var_id, \
-                       object_id, \
-                       object_var_id \
-                       FROM \
-                       txl_query_pattern_triple \
-                       WHERE \
-                       in_pattern_id = ?"
-                                                   error:&error,
-                       [TXLInteger integerWithValue:[self primaryKey]], nil];
+    NSArray *patternFilters = filters;
+    
+    // --------------------------------------------------------------------
+    // the variables are bound in one binding vector during the
+    // backtracking. each step binds the variables, which are free
+    // in its triple pattern, and unbinds them after the match
+    // has been processed.
+    // --------------------------------------------------------------------
+    
+    TXLBinding *variables = [arena copyOfBindings:bindings];
     
-    if (result == nil) {
+    // --------------------------------------------------------------------
+    // function for evaluating pattern <i>
+    // of a sequence (pattern 1.pattern 2.pattern 3. ... .pattern n.)
+    // of basic graph patterns dependent on there predecessors 
+    // --------------------------------------------------------------------
+    
+    __block void (^evaluateBasicGraphPattern)(NSUInteger, 
+                                              TXLMovingObjectSequence*);
+    evaluateBasicGraphPattern = ^(NSUInteger i, 
+                                  TXLMovingObjectSequence *windows) {
         
-        [NSException raise:@"TXLGraphPatternException" format:@"Could not retrieve basic graph patterns of pattern (%d): %@", primaryKey, [error localizedDescription]];
+        NSAutoreleasePool *pool = [NSAutoreleasePool new];
         
-    } else {
+        TXLTriplePattern pattern = triples[i];
+        
+        // start building the SQL expression consisting of a sql string
+        // and the corresponding parameters for evaluating
+        // the pattern by querying the database
+        
+        // OPTIMIZE: Try to build a resusable SQL expression (Compilation of SQL expressions is expensive).
+        
+        NSMutableString *sql = [NSMutableString stringWithString:@"SELECT st.id, st.mo_id"];
+        NSMutableArray *sqlParams = [NSMutableArray array];
+        
+        // --------------------------------------------------------------------        
+        // consider variables if set 
+        //
+        // The current implementation treats blank nodes equal to variables
+        // in any sense
+        // --------------------------------------------------------------------
+        
+        // a variable is free, if it is currently not bound
+        // to a value, so there is still a free choice of
+        // finding an appropriate match
+        BOOL subjectFree = pattern.subjectVar != nil && variables[pattern.subjectSlot] == 0;
+        BOOL predicateFree = pattern.predicateVar != nil && variables[pattern.predicateSlot] == 0;
+        BOOL objectFree = pattern.objectVar != nil && variables[pattern.objectSlot] == 0;
+        
+        if (subjectFree) {
+            [sql appendString:@",st.subject_id"];
+        }
+        
+        if (predicateFree) {
+            [sql appendString:@",st.predicate_id"];
+        }
+        
+        if (objectFree) {
+            [sql appendString:@",st.object_id"];
+        }
         
         // --------------------------------------------------------------------
-        // function for evaluating pattern <i>
-        // of a sequence (pattern 1.pattern 2.pattern 3. ... .pattern n.)
-        // of basic graph patterns dependent on there predecessors 
+        // consider revision
         // --------------------------------------------------------------------
         
-        __block void (^evaluateBasicGraphPattern)(NSUInteger, 
-                                                  NSDictionary*, 
-                                                  TXLMovingObjectSequence*);
-        evaluateBasicGraphPattern = ^(NSUInteger i, 
-                                      NSDictionary *variables,
-                                      TXLMovingObjectSequence *windows) {
-            
-            NSAutoreleasePool *pool = [NSAutoreleasePool new];
-            
-            NSDictionary *pattern = [result objectAtIndex:i];
-            
-            // start building the SQL expression consisting of a sql string
-            // and the corresponding parameters for evaluating
-            // the pattern by querying the database
-            
-            // OPTIMIZE: Try to build a resusable SQL expression (Compilation of SQL expressions is expensive).
-            
-            NSMutableString *sql = [NSMutableString stringWithString:@"SELECT st.id, st.mo_id"];
-            NSMutableArray *sqlParams = [NSMutableArray array];
-            
-            // --------------------------------------------------------------------        
-            // consider variables if set 
-            //
-            // The current implementation treats blank nodes equal to variables
-            // in any sense
-            // --------------------------------------------------------------------
+        [sql appendString:@" \
+         FROM txl_statement as st \
+         INNER JOIN txl_statement_created as cr ON (st.id = cr.statement_id AND cr.revision_id <= ?) \
+         LEFT JOIN txl_statement_removed as rm ON (st.id = rm.statement_id) "];
+        [sqlParams addObject:[TXLInteger integerWithValue:[rev primaryKey]]];
+        
+        
+        [sql appendString:@"INNER JOIN txl_context as ctx ON (st.context_id = ctx.id) "];
+        
+        [sql appendString:@" \
+         WHERE (rm.revision_id ISNULL OR rm.revision_id > ?)"];
+        [sqlParams addObject:[TXLInteger integerWithValue:[rev primaryKey]]];
+        
+        // --------------------------------------------------------------------
+        // consider contexts
+        // --------------------------------------------------------------------
+        
+        [sql appendString:@" AND ("];
+        
+        BOOL first = YES;
+        for (TXLContext *ctx in ctxs) {
             
-            TXLInteger *subjectVarId = [pattern objectForKey:@"subject_var_id"];
-            if ([subjectVarId integerValue] != 0) {
-                
-                if (![[variables allKeys] containsObject:subjectVarId]) {
-                    // currently the variable is not bound to a value
-                    // so there is still a free choice of finding
-                    // an appropriate match
-                    [sql appendString:@",st.subject_id"];
-                }
+            if (!first) {
+                [sql appendString:@" OR"];
+            } else {
+                first = NO;
             }
             
-            TXLInteger *predicateVarId = [pattern objectForKey:@"predicate_var_id"];
-            if ([predicateVarId integerValue] != 0) {
-                
-                if (![[variables allKeys] containsObject:predicateVarId]) {
-                    // currently the variable is not bound to a value
-                    // so there is still a free choice of finding
-                    // an appropriate match
-                    [sql appendString:@",st.predicate_id"];
-                }
+            [sql appendFormat:@" (ctx.name glob '%@*')", [ctx description]];
+        }
+        
+        [sql appendString:@")"];
+        
+        
+        // --------------------------------------------------------------------
+        // consider terms if the corresponding
+        // variables are not set or are bound
+        // --------------------------------------------------------------------
+        
+        if (pattern.subjectVar != nil) {
+            if (!subjectFree) {
+                // currently the variable is bound to a value
+                [sql appendString:@" AND st.subject_id=?"];
+                [sqlParams addObject:[TXLInteger integerWithValue:variables[pattern.subjectSlot]]];
             }
-            
-            TXLInteger *objectVarId = [pattern objectForKey:@"object_var_id"];
-            if ([objectVarId integerValue] != 0) {
-                
-                if (![[variables allKeys] containsObject:objectVarId]) {
-                    // currently the variable is not bound to a value
-                    // so there is still a free choice of finding
-                    // an appropriate match
-                    [sql appendString:@",st.object_id"];
-                }
+        } else {
+            // variable is not set so use the term
+            [sql appendString:@" AND st.subject_id=?"];
+            [sqlParams addObject:[TXLInteger integerWithValue:pattern.subject]];
+        }
+        
+        if (pattern.predicateVar != nil) {
+            if (!predicateFree) {
+                // currently the variable is bound to a value
+                [sql appendString:@" AND st.predicate_id=?"];
+                [sqlParams addObject:[TXLInteger integerWithValue:variables[pattern.predicateSlot]]];
             }
-            
-            // --------------------------------------------------------------------
-            // consider revision
-            // --------------------------------------------------------------------
-            
-            [sql appendString:@" \
-             FROM txl_statement as st \
-             INNER JOIN txl_statement_created as cr ON (st.id = cr.statement_id AND cr.revision_id <= ?) \
-             LEFT JOIN txl_statement_removed as rm ON (st.id = rm.statement_id) "];
-            [sqlParams addObject:[TXLInteger integerWithValue:[rev primaryKey]]];
-            
-            
-            [sql appendString:@"INNER JOIN txl_context as ctx ON (st.context_id = ctx.id) "];
-            
-            [sql appendString:@" \
-             WHERE (rm.revision_id ISNULL OR rm.revision_id > ?)"];
-            [sqlParams addObject:[TXLInteger integerWithValue:[rev primaryKey]]];
-            
-            // --------------------------------------------------------------------
-            // consider contexts
-            // --------------------------------------------------------------------
-            
-            [sql appendString:@" AND ("];
-            
-            BOOL first = YES;
-            for (TXLContext *ctx in ctxs) {
-                
-                if (!first) {
-                    [sql appendString:@" OR"];
-                } else {
-                    first = NO;
-                }
-                
-                [sql appendFormat:@" (ctx.name glob '%@*')", [ctx description]];
+        } else {
+            // variable is not set so use the term
+            [sql appendString:@" AND st.predicate_id=?"];
+            [sqlParams addObject:[TXLInteger integerWithValue:pattern.predicate]];
+        }
+        
+        if (pattern.objectVar != nil) {
+            if (!objectFree) {
+                // currently the variable is bound to a value
+                [sql appendString:@" AND st.object_id=?"];
+                [sqlParams addObject:[TXLInteger integerWithValue:variables[pattern.objectSlot]]];
             }
+        } else {
+            // variable is not set so use the term
+            [sql appendString:@" AND st.object_id=?"];
+            [sqlParams addObject:[TXLInteger integerWithValue:pattern.object]];
+        }
+        
+        // --------------------------------------------------------------------
+        // consider the filters of this pattern, which can be decided
+        // by the database for the variables bound in this step and
+        // for the moving object of the statement
+        // --------------------------------------------------------------------
+        
+        for (TXLFilter *filter in patternFilters) {
             
-            [sql appendString:@")"];
-            
-            
-            // --------------------------------------------------------------------
-            // consider terms if the corresponding
-            // variables are not set or are bound
-            // --------------------------------------------------------------------
-            
-            subjectVarId = [pattern objectForKey:@"subject_var_id"];
-            if ([subjectVarId integerValue] != 0) {
-                
-                TXLInteger *value = [variables objectForKey:subjectVarId];
-                
-                if (value != nil) {
-                    // currently the variable is bound to a value
-                    [sql appendString:@" AND st.subject_id=?"];
-                    [sqlParams addObject:value];
-                }
-            } else {
-                // variable is not set so use the term
-                [sql appendString:@" AND st.subject_id=?"];
-                [sqlParams addObject:[pattern objectForKey:@"subject_id"]];
+            if (subjectFree) {
+                [filter appendConditionsForVariable:pattern.subjectVar column:@"st.subject_id" toSQL:sql parameters:sqlParams];
             }
             
-            predicateVarId = [pattern objectForKey:@"predicate_var_id"];
-            if ([predicateVarId integerValue] != 0) {
-                
-                TXLInteger *value = [variables objectForKey:predicateVarId];
-                
-                if (value != nil) {
-                    // currently the variable is bound to a value
-                    [sql appendString:@" AND st.predicate_id=?"];
-                    [sqlParams addObject:value];
-                }
-            } else {
-                // variable is not set so use the term
-                [sql appendString:@" AND st.predicate_id=?"];
-                [sqlParams addObject:[pattern objectForKey:@"predicate_id"]];
+            if (predicateFree) {
+                [filter appendConditionsForVariable:pattern.predicateVar column:@"st.predicate_id" toSQL:sql parameters:sqlParams];
             }
             
-            objectVarId = [pattern objectForKey:@"object_var_id"];
-            if ([objectVarId integerValue] != 0) {
-                
-                TXLInteger *value = [variables objectForKey:objectVarId];
-                
-                if (value != nil) {
-                    // currently the variable is bound to a value
-                    [sql appendString:@" AND st.object_id=?"];
-                    [sqlParams addObject:value];
-                }
-            } else {
-                // variable is not set so use the term
-                [sql appendString:@" AND st.object_id=?"];
-                [sqlParams addObject:[pattern objectForKey:@"object_id"]];
+            if (objectFree) {
+                [filter appendConditionsForVariable:pattern.objectVar column:@"st.object_id" toSQL:sql parameters:sqlParams];
             }
             
-            // --------------------------------------------------------------------
-            // evaluate basic graph pattern by querying the database
-            // using the formerly created SQL expression
-            // --------------------------------------------------------------------
-            
-            NSError *error;
-            
-            TXLDatabase *database = [[TXLManager sharedManager] database];   
-            BOOL success = [database executeSQL:sql
-                                 withParameters:sqlParams
-                                          error:&error
-                                  resultHandler:^(NSDictionary *row, BOOL *stop) {
-                                      
-                                      // --------------------------------------------------------------------
-                                      // consider window constraint
-                                      // --------------------------------------------------------------------
-                                      
-                                      TXLMovingObjectSequence *newWindows = nil;
-                                      
-                                      NSUInteger movingObjectPk = [[row objectForKey:@"mo_id"] intValue];
+            [filter appendWindowConditionsForColumn:@"st.mo_id" toSQL:sql parameters:sqlParams];
+        }
+        
+        // --------------------------------------------------------------------
+        // evaluate basic graph pattern by querying the database
+        // using the formerly created SQL expression
+        // --------------------------------------------------------------------
+        
+        NSError *error;
+        
+        TXLDatabase *database = [[TXLManager sharedManager] database];   
+        BOOL success = [database executeSQL:sql
+                             withParameters:sqlParams
+                                      error:&error
+                              resultHandler:^(NSDictionary *row, BOOL *stop) {
+                                  
+                                  // --------------------------------------------------------------------
+                                  // consider window constraint
+                                  // --------------------------------------------------------------------
+                                  
+                                  TXLMovingObjectSequence *newWindows = nil;
+                                  
+                                  NSUInteger movingObjectPk = [[row objectForKey:@"mo_id"] intValue];
+                                  
+                                  if (movingObjectPk != 0) {
+                                      // moving object for this statement is defined.
+                                      // take the moving object defined for this statement
+                                      TXLMovingObject *movingObject = [TXLMovingObject movingObjectWithPrimaryKey:movingObjectPk];
                                       
-                                      if (movingObjectPk != 0) {
-                                          // moving object for this statement is defined.
-                                          // take the moving object defined for this statement
-                                          TXLMovingObject *movingObject = [TXLMovingObject movingObjectWithPrimaryKey:movingObjectPk];
+                                      if (windows != nil) {
+                                          // given windows are defined, so intersect the given
+                                          // windows with the moving object defined for this
+                                          // statement
+                                          newWindows = [windows intersectionWithMovingObject:movingObject];
                                           
-                                          if (windows != nil) {
-                                              // given windows are defined, so intersect the given
-                                              // windows with the moving object defined for this
-                                              // statement
-                                              newWindows = [windows intersectionWithMovingObject:movingObject];
+                                          if ([newWindows isEmpty]) {
                                               
-                                              if ([newWindows isEmpty]) {
-                                                  
-                                                  // no intersections where found,
-                                                  // so the result obtained is not valid
-                                                  // so track back one step
-                                                  
-                                                  return;
-                                              }
-                                          } else {
-                                              // given windows are not defined, so we assume validity
-                                              // always everywhere.
-                                              // the intersection of a moving object A, that is valid
-                                              // always everywhere and a moving object B is moving
-                                              // object B, so form a sequence with one moving object B
-                                              // as element, since moving object B is defined
-                                              newWindows = [TXLMovingObjectSequence sequenceWithMovingObject:movingObject];                                              
+                                              // no intersections where found,
+                                              // so the result obtained is not valid
+                                              // so track back one step
+                                              
+                                              return;
                                           }
-                                          
                                       } else {
-                                          // no moving object defined for this statement, so
-                                          // the statement is valid always everywhere.
-                                          // take the given windows, since the intersection of
-                                          // something that is valid always everywhere and something
-                                          // else is something else.
-                                          newWindows = windows;
+                                          // given windows are not defined, so we assume validity
+                                          // always everywhere.
+                                          // the intersection of a moving object A, that is valid
+                                          // always everywhere and a moving object B is moving
+                                          // object B, so form a sequence with one moving object B
+                                          // as element, since moving object B is defined
+                                          newWindows = [TXLMovingObjectSequence sequenceWithMovingObject:movingObject];                                              
                                       }
                                       
-                                      // --------------------------------------------------------------------
-                                      // copy vars
-                                      // --------------------------------------------------------------------
-                                      
-                                      // copy var dictionary so there is
-                                      // no confusion in the backtracking
-                                      // process
-                                      NSMutableDictionary *tmpVars = [NSMutableDictionary dictionaryWithDictionary:variables];
-                                      
-                                      // fill vars
-                                      for (NSString *key in [row allKeys]) {
-                                          if ([key isEqual:@"subject_id"]) {
-                                              [tmpVars setObject:[row objectForKey:@"subject_id"]
-                                                          forKey:[pattern objectForKey:@"subject_var_id"]];
-                                          }
-                                          if ([key isEqual:@"predicate_id"]) {
-                                              [tmpVars setObject:[row objectForKey:@"predicate_id"]
-                                                          forKey:[pattern objectForKey:@"predicate_var_id"]];
-                                          }
-                                          if ([key isEqual:@"object_id"]) {
-                                              [tmpVars setObject:[row objectForKey:@"object_id"]
-                                                          forKey:[pattern objectForKey:@"object_var_id"]];
-                                          }
+                                  } else {
+                                      // no moving object defined for this statement, so
+                                      // the statement is valid always everywhere.
+                                      // take the given windows, since the intersection of
+                                      // something that is valid always everywhere and something
+                                      // else is something else.
+                                      newWindows = windows;
+                                  }
+                                  
+                                  // --------------------------------------------------------------------
+                                  // bind the free variables
+                                  // --------------------------------------------------------------------
+                                  
+                                  // a variable used twice in the triple pattern
+                                  // must be bound to the same term
+                                  BOOL consistent = YES;
+                                  
+                                  if (subjectFree) {
+                                      variables[pattern.subjectSlot] = [[row objectForKey:@"subject_id"] int64Value];
+                                  }
+                                  
+                                  if (predicateFree) {
+                                      TXLBinding value = [[row objectForKey:@"predicate_id"] int64Value];
+                                      if (variables[pattern.predicateSlot] != 0 && variables[pattern.predicateSlot] != value) {
+                                          consistent = NO;
                                       }
-                                      
-                                      if (i == [result count] - 1) {
+                                      variables[pattern.predicateSlot] = value;
+                                  }
+                                  
+                                  if (objectFree) {
+                                      TXLBinding value = [[row objectForKey:@"object_id"] int64Value];
+                                      if (variables[pattern.objectSlot] != 0 && variables[pattern.objectSlot] != value) {
+                                          consistent = NO;
+                                      }
+                                      variables[pattern.objectSlot] = value;
+                                  }
+                                  
+                                  // --------------------------------------------------------------------
+                                  // prune the search, if a filter is already false
+                                  // for the variables bound so far
+                                  // --------------------------------------------------------------------
+                                  
+                                  for (TXLFilter *filter in patternFilters) {
+                                      if (!consistent) {
+                                          break;
+                                      }
+                                      if ([filter rejectsBindings:variables window:newWindows]) {
+                                          consistent = NO;
+                                      }
+                                  }
+                                  
+                                  if (consistent) {
+                                      if (i == numberOfTriples - 1) {
                                           // the mapping is complete -
                                           // all basic graph pattern
                                           // are evaluated so all corresponding
                                           // variables are bound -
                                           // so call the result handler
-                                          handler(tmpVars, newWindows);
+                                          handler(variables, newWindows);
                                       } else {
                                           // evaluate the next basic graph pattern
                                           evaluateBasicGraphPattern(i + 1, 
-                                                                    tmpVars, 
                                                                     newWindows);
                                       }
-                                  }];
+                                  }
+                                  
+                                  // --------------------------------------------------------------------
+                                  // unbind the variables of this step
+                                  // for the next match (backtracking)
+                                  // --------------------------------------------------------------------
+                                  
+                                  if (subjectFree) {
+                                      variables[pattern.subjectSlot] = 0;
+                                  }
+                                  if (predicateFree) {
+                                      variables[pattern.predicateSlot] = 0;
+                                  }
+                                  if (objectFree) {
+                                      variables[pattern.objectSlot] = 0;
+                                  }
+                              }];
+        
+        if (!success) {
             
-            if (!success) {
-                
-                [NSException raise:@"TXLGraphPatternException" format:@"Could not evaluate basic graph pattern (%d) in graph pattern (%d): %@", [[pattern objectForKey:@"id"] intValue], [self primaryKey], [error localizedDescription]];
-                
-            }
+            [NSException raise:@"TXLGraphPatternException" format:@"Could not evaluate basic graph pattern (%d) in graph pattern (%d): %@", pattern.primaryKey, [self primaryKey], [error localizedDescription]];
             
-            [pool drain];
-        };
+        }
+        
+        [pool drain];
+    };
+    
+    // --------------------------------------------------------------------
+    
+    if (numberOfTriples > 0) {
+        // min. one basic graph pattern exists,
+        // so try to evaluate all available
+        // basic graph pattern stepwise by forming the
+        // stepwise conjunction of them to find
+        // suitable matches for the variables contained
+        // beginning with the first basic graph pattern
+        evaluateBasicGraphPattern(0, 
+                                  mos);
+    } else {
+        // no basic graph pattern defined, this
+        // will be interpreted as always TRUE resp.
+        // that there is no constraint defined, so
+        // retrieve all available results
+        
+        // OPTIMIZE: Try to build a resusable SQL expression (Compilation of SQL expressions is expensive).
         
+        NSMutableString *sql = [NSMutableString stringWithString:@"SELECT st.id, st.mo_id"];
+        NSMutableArray *sqlParams = [NSMutableArray array];
+        
+        
+        
+        // --------------------------------------------------------------------
+        // consider revision
         // --------------------------------------------------------------------
         
-        if ([result count] > 0) {
-            // min. one basic graph pattern exists,
-            // so try to evaluate all available
-            // basic graph pattern stepwise by forming the
-            // stepwise conjunction of them to find
-            // suitable matches for the variables contained
-            // beginning with the first basic graph pattern
-            evaluateBasicGraphPattern(0, 
-                                      vars, 
-                                      mos);
-        } else {
-            // no basic graph pattern defined, this
-            // will be interpreted as always TRUE resp.
-            // that there is no constraint defined, so
-            // retrieve all available results
+        [sql appendString:@" \
+         FROM txl_statement as st \
+         INNER JOIN txl_statement_created as cr ON (st.id = cr.statement_id AND cr.revision_id <= ?) \
+         LEFT JOIN txl_statement_removed as rm ON (st.id = rm.statement_id) "];
+        [sqlParams addObject:[TXLInteger integerWithValue:[rev primaryKey]]];
+        
+        
+        [sql appendString:@"INNER JOIN txl_context as ctx ON (st.context_id = ctx.id) "];
+        
+        [sql appendString:@" \
+         WHERE (rm.revision_id ISNULL OR rm.revision_id > ?)"];
+        [sqlParams addObject:[TXLInteger integerWithValue:[rev primaryKey]]];
+        
+        // --------------------------------------------------------------------
+        // consider contexts
+        // --------------------------------------------------------------------
+        
+        [sql appendString:@" AND ("];
+        
+        BOOL first = YES;
+        for (TXLContext *ctx in ctxs) {
             
-            // OPTIMIZE: Try to build a resusable SQL expression (Compilation of SQL expressions is expensive).
+            if (!first) {
+                [sql appendString:@" OR"];
+            } else {
+                first = NO;
+            }
             
-            NSMutableString *sql = [NSMutableString stringWithString:@"SELECT st.id, st.mo_id"];
-            NSMutableArray *sqlParams = [NSMutableArray array];
+            [sql appendFormat:@" (ctx.name glob '%@*')", [ctx description]];
+        }
+        
+        [sql appendString:@")"];
+        
+        TXLDatabase *database = [[TXLManager sharedManager] database];   
+        BOOL success = [database executeSQL:sql
+                             withParameters:sqlParams
+                                      error:&error
+                              resultHandler:^(NSDictionary *row, BOOL *stop) {
+                                  
+                                  // --------------------------------------------------------------------
+                                  // consider window constraint
+                                  // --------------------------------------------------------------------
+                                  
+                                  TXLMovingObjectSequence *newWindows = nil;
+                                  
+                                  NSUInteger movingObjectPk = [[row objectForKey:@"mo_id"] intValue];
+                                  
+                                  if (movingObjectPk != 0) {
+                                      // moving object for this statement is defined.
+                                      // take the moving object defined for this statement
+                                      TXLMovingObject *movingObject = [TXLMovingObject movingObjectWithPrimaryKey:movingObjectPk];
+                                      
+                                      if (mos != nil) {
+                                          // given windows are defined, so intersect the given
+                                          // windows with the moving object defined for this
+                                          // statement
+                                          newWindows = [mos intersectionWithMovingObject:movingObject];
+                                          
+                                          if ([newWindows isEmpty]) {
+                                              
+                                              // no intersections where found,
+                                              // so the result obtained is not valid
+                                              // so track back one step
+                                              
+                                              return;
+                                          }
+                                      } else {
+                                          // given windows are not defined, so we assume validity
+                                          // always everywhere.
+                                          // the intersection of a moving object A, that is valid
+                                          // always everywhere and a moving object B is moving
+                                          // object B, so form a sequence with one moving object B
+                                          // as element, and for moving object B it is guarenteed that
+                                          // it is defined, since moving object B is the moving object
+                                          // of this statement
+                                          newWindows = [TXLMovingObjectSequence sequenceWithMovingObject:movingObject];                                              
+                                      }
+                                      
+                                  } else {
+                                      // no moving object defined for this statement, so
+                                      // the statement is valid always everywhere.
+                                      // take the given windows, since the intersection of
+                                      // something that is valid always everywhere and something
+                                      // else is something else.
+                                      newWindows = mos;
+                                  }
+                                  
+                                  handler(bindings, newWindows);
+                                  
+                              }];
+        
+        if (!success) {
             
+            [NSException raise:@"TXLGraphPatternException" format:@"Could not evaluate graph pattern (%d): %@", [self primaryKey], [error localizedDescription]];
             
+        }
+        
+    }            
+    
+}
+
+- (void)evaluateNotExistsGraphPatternsForBindings:(TXLBinding **)matchBindings
+                                          windows:(NSMutableArray *)matchWindows
+                                       inContexts:(NSArray *)ctxs
+                                      forRevision:(TXLRevision *)rev
+                                    rootPatternId:(NSUInteger)rootPatternId
+                                            arena:(TXLBindingArena *)arena {
+    
+    // Evaluate all 'not exists' graph patterns contained in this query graph
+    // pattern for the set of matches (an anti join). The window of each match
+    // is reduced by the windows of the matches of the 'not exists' pattern,
+    // which are compatible with the match.
+    //
+    // A 'not exists' pattern depends only on the variables it shares with the
+    // outer match. So the outer matches are grouped by the values of these
+    // variables and the pattern is evaluated once for each group (without
+    // a window). The windows found for a group are unified and subtracted
+    // from the window of each match of the group in one step.
+    //
+    // If a filter of the 'not exists' pattern tests the window, the pattern
+    // is evaluated for each match of the group with the window of this match.
+    
+    for (TXLGraphPattern *pattern in notExistsPatterns) {
+        
+        NSAutoreleasePool *pool = [NSAutoreleasePool new];
+        
+        BOOL windowDependent = [pattern dependsOnWindow];
+        
+        // --------------------------------------------------------------------
+        // the slot in the matches for each slot of the 'not exists'
+        // pattern (NSNotFound, if the variable is not shared)
+        // --------------------------------------------------------------------
+        
+        NSArray *patternSlots = [pattern slots];
+        NSUInteger numberOfPatternSlots = [patternSlots count];
+        
+        NSMutableData *sharedSlotList = [NSMutableData dataWithLength:numberOfPatternSlots * sizeof(NSUInteger)];
+        NSUInteger *sharedSlots = [sharedSlotList mutableBytes];
+        for (NSUInteger k = 0; k < numberOfPatternSlots; k++) {
+            sharedSlots[k] = [slots indexOfObject:[patternSlots objectAtIndex:k]];
+        }
+        
+        // --------------------------------------------------------------------
+        // group the matches by the shared variables
+        // --------------------------------------------------------------------
+        
+        CFMutableDictionaryRef groups = CFDictionaryCreateMutable(NULL, 0, &kTXLBindingsDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+        
+        for (NSUInteger i = 0; i < [matchWindows count]; i++) {
             
-            // --------------------------------------------------------------------
-            // consider revision
-            // --------------------------------------------------------------------
+            if ([[matchWindows objectAtIndex:i] isEmpty]) {
+                // this match is already rejected
+                continue;
+            }
             
-            [sql appendString:@" \
-             FROM txl_statement as st \
-             INNER JOIN txl_statement_created as cr ON (st.id = cr.statement_id AND cr.revision_id <= ?) \
-             LEFT JOIN txl_statement_removed as rm ON (st.id = rm.statement_id) "];
-            [sqlParams addObject:[TXLInteger integerWithValue:[rev primaryKey]]];
+            TXLBinding *sharedBindings = [arena bindingsWithNumberOfSlots:numberOfPatternSlots];
+            for (NSUInteger k = 0; k < numberOfPatternSlots; k++) {
+                if (sharedSlots[k] != NSNotFound) {
+                    sharedBindings[k] = matchBindings[i][sharedSlots[k]];
+                }
+            }
             
+            NSMutableArray *group = (NSMutableArray *)CFDictionaryGetValue(groups, sharedBindings);
+            if (group == nil) {
+                group = [NSMutableArray array];
+                CFDictionarySetValue(groups, sharedBindings, group);
+            }
+            [group addObject:[NSNumber numberWithUnsignedInteger:i]];
+        }
+        
+        NSUInteger numberOfGroups = CFDictionaryGetCount(groups);
+        NSMutableData *keyList = [NSMutableData dataWithLength:numberOfGroups * sizeof(void *)];
+        NSMutableData *valueList = [NSMutableData dataWithLength:numberOfGroups * sizeof(void *)];
+        CFDictionaryGetKeysAndValues(groups, (const void **)[keyList mutableBytes], (const void **)[valueList mutableBytes]);
+        
+        // --------------------------------------------------------------------
+        // the unified windows of the matches of the 'not exists' pattern
+        // for the shared variables (nil, if there is no match)
+        // --------------------------------------------------------------------
+        
+        TXLMovingObjectSequence *(^notExistsWindows)(const TXLBinding *, TXLMovingObjectSequence *);
+        notExistsWindows = ^(const TXLBinding *sharedBindings, TXLMovingObjectSequence *window) {
             
-            [sql appendString:@"INNER JOIN txl_context as ctx ON (st.context_id = ctx.id) "];
+            NSMutableArray *movingObjects = [NSMutableArray array];
             
-            [sql appendString:@" \
-             WHERE (rm.revision_id ISNULL OR rm.revision_id > ?)"];
-            [sqlParams addObject:[TXLInteger integerWithValue:[rev primaryKey]]];
+            [pattern _evaluatePatternWithBindings:sharedBindings
+                                       inContexts:ctxs
+                                           window:window
+                                      forRevision:rev
+                                    rootPatternId:rootPatternId
+                                            arena:arena
+                                    resultHandler:^(const TXLBinding *bindingsEval, TXLMovingObjectSequence *mosEval) {
+                                        [movingObjects addObjectsFromArray:mosEval.movingObjects];
+                                    }];
             
-            // --------------------------------------------------------------------
-            // consider contexts
-            // --------------------------------------------------------------------
+            if ([movingObjects count] == 0) {
+                return (TXLMovingObjectSequence *)nil;
+            }
+            return [TXLMovingObjectSequence sequenceByUnifyingMovingObjects:movingObjects];
+        };
+        
+        // --------------------------------------------------------------------
+        // form the difference between the windows of the matches in the
+        // group and the windows of the 'not exists' pattern
+        // --------------------------------------------------------------------
+        
+        for (NSUInteger g = 0; g < numberOfGroups; g++) {
             
-            [sql appendString:@" AND ("];
+            const TXLBinding *sharedBindings = ((const TXLBinding **)[keyList mutableBytes])[g];
+            NSArray *group = ((NSArray **)[valueList mutableBytes])[g];
             
-            BOOL first = YES;
-            for (TXLContext *ctx in ctxs) {
+            if (windowDependent) {
                 
-                if (!first) {
-                    [sql appendString:@" OR"];
-                } else {
-                    first = NO;
+                for (NSNumber *index in group) {
+                    TXLMovingObjectSequence *window = [matchWindows objectAtIndex:[index unsignedIntegerValue]];
+                    TXLMovingObjectSequence *windows = notExistsWindows(sharedBindings, window);
+                    if (windows != nil) {
+                        [matchWindows replaceObjectAtIndex:[index unsignedIntegerValue]
+                                                withObject:[window complementWithMovingObjectSequnece:windows]];
+                    }
                 }
                 
-                [sql appendFormat:@" (ctx.name glob '%@*')", [ctx description]];
-            }
-            
-            [sql appendString:@")"];
-            
-            TXLDatabase *database = [[TXLManager sharedManager] database];   
-            BOOL success = [database executeSQL:sql
-                                 withParameters:sqlParams
-                                          error:&error
-                                  resultHandler:^(NSDictionary *row, BOOL *stop) {
-                                      
-                                      // --------------------------------------------------------------------
-                                      // consider window constraint
-                                      // --------------------------------------------------------------------
-                                      
-                                      TXLMovingObjectSequence *newWindows = nil;
-                                      
-                                      NSUInteger movingObjectPk = [[row objectForKey:@"mo_id"] intValue];
-                                      
-                                      if (movingObjectPk != 0) {
-                                          // moving object for this statement is defined.
-                                          // take the moving object defined for this statement
-                                          TXLMovingObject *movingObject = [TXLMovingObject movingObjectWithPrimaryKey:movingObjectPk];
-                                          
-                                          if (mos != nil) {
-                                              // given windows are defined, so intersect the given
-                                              // windows with the moving object defined for this
-                                              // statement
-                                              newWindows = [mos intersectionWithMovingObject:movingObject];
-                                              
-                                              if ([newWindows isEmpty]) {
-                                                  
-                                                  // no intersections where found,
-                                                  // so the result obtained is not valid
-                                                  // so track back one step
-                                                  
-                                                  return;
-                                              }
-                                          } else {
-                                              // given windows are not defined, so we assume validity
-                                              // always everywhere.
-                                              // the intersection of a moving object A, that is valid
-                                              // always everywhere and a moving object B is moving
-                                              // object B, so form a sequence with one moving object B
-                                              // as element, and for moving object B it is guarenteed that
-                                              // it is defined, since moving object B is the moving object
-                                              // of this statement
-                                              newWindows = [TXLMovingObjectSequence sequenceWithMovingObject:movingObject];                                              
-                                          }
-                                          
-                                      } else {
-                                          // no moving object defined for this statement, so
-                                          // the statement is valid always everywhere.
-                                          // take the given windows, since the intersection of
-                                          // something that is valid always everywhere and something
-                                          // else is something else.
-                                          newWindows = mos;
-                                      }
-                                      
-                                      handler(vars, newWindows);
-                                      
-                                  }];
-            
-            if (!success) {
+            } else {
                 
-                [NSException raise:@"TXLGraphPatternException" format:@"Could not evaluate graph pattern (%d): %@", [self primaryKey], [error localizedDescription]];
+                TXLMovingObjectSequence *windows = notExistsWindows(sharedBindings, nil);
+                if (windows == nil) {
+                    continue;
+                }
                 
+                for (NSNumber *index in group) {
+                    TXLMovingObjectSequence *window = [matchWindows objectAtIndex:[index unsignedIntegerValue]];
+                    [matchWindows replaceObjectAtIndex:[index unsignedIntegerValue]
+                                            withObject:[window complementWithMovingObjectSequnece:windows]];
+                }
             }
-            
-        }            
+        }
         
+        CFRelease(groups);
+        
+        [pool drain];
     }
+}
+
+- (BOOL)evaluateFilterWithBindings:(const TXLBinding *)bindings 
+                            window:(TXLMovingObjectSequence *)mos
+                     rootPatternId:(NSUInteger)rootPatternId {
     
+    // all filters of the pattern must be true for the
+    // complete match and the window of the match
+    for (TXLFilter *filter in filters) {
+        if (![filter evaluateWithBindings:bindings window:mos]) {
+            return NO;
+        }
+    }
+    return YES;
 }
 
-- (void)evaluateNotExistsGraphPatternWithVariables:(NSDictionary *)vars
-                                        inContexts:(NSArray *)ctxs
-                                           windows:(TXLMovingObjectSequence *)mos
-                                       forRevision:(TXLRevision *)rev
-                                     rootPatternId:(NSUInteger)rootPatternId
-                                     resultHandler:(void(^)(NSDictionary *vars, TXLMovingObjectSequence *mos))handler {
-    // evaluate all not exists graph patterns contained in this query graph pattern
-    // stepwise in sequence. If there is a match found then track back
+- (BOOL)dependsOnWindow {
     
-    // --------------------------------------------------------------------
-    // retrieve all not exists graph pattern
-    // --------------------------------------------------------------------
+    // a filter of this pattern or of a nested
+    // 'not exists' pattern tests the window
     
-    NSError *error;
+    [self load];
     
-    TXLDatabase *database = [[TXLManager sharedManager] database];   
-    NSArray *result = [database executeSQLWithParameters:@"\
-                       SELECT \
-                       pattern_id \
-                       FROM \
-                       txl_query_pattern_not_exists \
-                       WHERE \
-                       in_pattern_id = ?"
-                                                   error:&error, 
-                       [TXLInteger integerWithValue:[self primaryKey]], nil];
+    for (TXLFilter *filter in filters) {
+        if (filter.dependsOnWindow) {
+            return YES;
+        }
+    }
+    for (TXLGraphPattern *pattern in notExistsPatterns) {
+        if ([pattern dependsOnWindow]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (NSSet *)variables {
     
-    if (result == nil) {
-        
-        [NSException raise:@"TXLGraphPatternException" format:@"Could not retrieve not exists graph patterns of pattern (%d): %@", primaryKey, [error localizedDescription]];
+    // the variables used in this pattern, in the filters
+    // of this pattern and in the contained 'not exists' patterns
+    
+    [self load];
+    
+    return [NSSet setWithArray:slots];
+}
+
+#pragma mark -
+#pragma mark Loading
+
+- (void)load {
+    
+    @synchronized (self) {
         
-    } else {
+        if (loaded) {
+            return;
+        }
         
+        NSError *error;
         
+        TXLDatabase *database = [[TXLManager sharedManager] database];
         
         // --------------------------------------------------------------------
-        // function for evaluating pattern <i>
-        // of a sequence ({...} {...} {...} ... {...})
-        // of not exists graph patterns independent on there predecessors 
-        // --------------------------------------------------------------------
-//        
-//        __block void (^evaluateNotExistsGraphPattern)(NSUInteger);
-//        evaluateNotExistsGraphPattern = ^(NSUInteger i) {
-//            
-//            TXLGraphPattern *pattern = [TXLGraphPattern graphPatternWithPrimaryKey:[[[result objectAtIndex:i] objectForKey:@"pattern_id"] intValue]];
-//            
-//            [pattern evaluatePatternWithVariables:vars inContexts:ctxs window:windows forRevision:rev resultHandler:^(NSDictionary *varsEval, TXLMovingObjectSequence *mosEval) {
-//                
-//                // --------------------------------------------------------------------
-//                // consider window constraint
-//                //
-//                // form the difference between the given moving object sequence and
-//                // moving object sequence retrieved by the result, since the retrieved
-//                // result represents the result of the not exists pattern, which we want
-//                // to have withdrawed from the final result
-//                // --------------------------------------------------------------------
-//                
-//                if (mosEval == nil) {
-//                    
-//                    // since mosEval is nil, the match for the not exists pattern
-//                    // is valid always everywhere, so the difference is always empty
-//                    windows = [TXLMovingObjectSequence emptySequence];
-//                    
-//                } else {
-//                    
-//                    if (windows != nil) {
-//                        
-//                        // form the difference of the given windows
-//                        // and the windows obtained for the match of the
-//                        // not exists pattern
-//                        windows = [windows complementWithMovingObjectSequnece:mosEval];
-//                        
-//                    } else {
-//                        
-//                        // since windows is nil, they are valid always everywhere.
-//                        // so form the difference of something that is valid always
-//                        // everywhere and the windows that are defined by the
-//                        // match of the not exists pattern
-//                        
-//                        windows = [[TXLMovingObjectSequence sequenceWithMovingObject:
-//                                    [TXLMovingObject movingObjectWithBegin:nil end:nil]]
-//                                   complementWithMovingObjectSequnece:mosEval];
-//                    }
-//                }
-//                //[windows retain];
-//            }];
-//            //[windows autorelease];
-//        };
-//        
+        // triple patterns
         // --------------------------------------------------------------------
         
-        __block TXLMovingObjectSequence *windows = mos;
-        if (mos == nil) {
-            windows = [TXLMovingObjectSequence sequenceWithMovingObject:[TXLMovingObject omnipresentMovingObject]];
+        NSArray *result = [database executeSQLWithParameters:@"\
+                           SELECT \
+                           id, \
+                           subject_id, \
+                           subject_var_id, \
+                           predicate_id, \
+                           predicate_var_id, \
+                           object_id, \
+                           object_var_id \
+                           FROM \
+                           txl_query_pattern_triple \
+                           WHERE \
+                           in_pattern_id = ?"
+                                                       error:&error,
+                           [TXLInteger integerWithValue:[self primaryKey]], nil];
+        
+        if (result == nil) {
+            [NSException raise:@"TXLGraphPatternException" format:@"Could not retrieve basic graph patterns of pattern (%d): %@", primaryKey, [error localizedDescription]];
         }
-        [windows retain];
-        
-        for (NSUInteger i = 0; i < [result count]; i++) {
-            // min. one not exists graph pattern exists,
-            // so try to evaluate all available
-            // not exists graph pattern stepwise
-            //
-            // if one not exists graph pattern find
-            // a match then track back
-            
-            
-            TXLGraphPattern *pattern = [TXLGraphPattern graphPatternWithPrimaryKey:[[[result objectAtIndex:i] objectForKey:@"pattern_id"] intValue]];
-            
-            [pattern _evaluatePatternWithVariables:vars
-                                        inContexts:ctxs
-                                            window:windows
-                                       forRevision:rev
-                                     rootPatternId:rootPatternId
-                                     resultHandler:^(NSDictionary *varsEval, TXLMovingObjectSequence *mosEval) {
-                
-                                        // --------------------------------------------------------------------
-                                        // consider window constraint
-                                        //
-                                        // form the difference between the given moving object sequence and
-                                        // moving object sequence retrieved by the result, since the retrieved
-                                        // result represents the result of the not exists pattern, which we want
-                                        // to have withdrawed from the final result
-                                        // --------------------------------------------------------------------
-                                        if (mosEval != nil) {
-                                            if (windows) {
-                                                TXLMovingObjectSequence *w = [windows complementWithMovingObjectSequnece:mosEval];
-                                                [windows release];
-                                                windows = [w retain];
-                                            } else {
-                                                TXLMovingObjectSequence *w = [windows complementWithMovingObjectSequnece:mosEval];
-                                                [windows release];
-                                                windows = [w retain];
-                                            }
-                                        }
-            }];
+        
+        numberOfTriples = [result count];
+        triples = calloc(numberOfTriples > 0 ? numberOfTriples : 1, sizeof(TXLTriplePattern));
+        
+        for (NSUInteger i = 0; i < numberOfTriples; i++) {
+            NSDictionary *row = [result objectAtIndex:i];
+            triples[i].primaryKey = [[row objectForKey:@"id"] unsignedIntegerValue];
             
-            if ([windows isEmpty]) {
-                [windows release];
-                return;
+            // a variable is set, if the primary key of the variable is not 0,
+            // otherwise the term is used
+            if ([[row objectForKey:@"subject_var_id"] integerValue] != 0) {
+                triples[i].subjectVar = [[row objectForKey:@"subject_var_id"] retain];
+            } else {
+                triples[i].subject = [[row objectForKey:@"subject_id"] unsignedIntegerValue];
+            }
+            if ([[row objectForKey:@"predicate_var_id"] integerValue] != 0) {
+                triples[i].predicateVar = [[row objectForKey:@"predicate_var_id"] retain];
+            } else {
+                triples[i].predicate = [[row objectForKey:@"predicate_id"] unsignedIntegerValue];
+            }
+            if ([[row objectForKey:@"object_var_id"] integerValue] != 0) {
+                triples[i].objectVar = [[row objectForKey:@"object_var_id"] retain];
+            } else {
+                triples[i].object = [[row objectForKey:@"object_id"] unsignedIntegerValue];
             }
         }
         
-        handler(vars, windows);
-        [windows release];
+        // --------------------------------------------------------------------
+        // 'not exists' patterns
+        // --------------------------------------------------------------------
+        
+        result = [database executeSQLWithParameters:@"SELECT pattern_id FROM txl_query_pattern_not_exists WHERE in_pattern_id = ?"
+                                              error:&error, 
+                  [TXLInteger integerWithValue:[self primaryKey]], nil];
+        
+        if (result == nil) {
+            [NSException raise:@"TXLGraphPatternException" format:@"Could not retrieve not exists graph patterns of pattern (%d): %@", primaryKey, [error localizedDescription]];
+        }
+        
+        NSMutableArray *patterns = [NSMutableArray array];
+        for (NSDictionary *row in result) {
+            TXLGraphPattern *pattern = [TXLGraphPattern graphPatternWithPrimaryKey:[[row objectForKey:@"pattern_id"] integerValue]];
+            [pattern load];
+            [patterns addObject:pattern];
+        }
+        notExistsPatterns = [patterns copy];
+        
+        // --------------------------------------------------------------------
+        // filters
+        // --------------------------------------------------------------------
+        
+        filters = [[TXLFilter filtersOfPatternWithPrimaryKey:self.primaryKey] retain];
+        
+        // --------------------------------------------------------------------
+        // slots of the variables in the binding vectors
+        // --------------------------------------------------------------------
+        
+        NSMutableSet *variables = [NSMutableSet set];
+        for (NSUInteger i = 0; i < numberOfTriples; i++) {
+            if (triples[i].subjectVar != nil) [variables addObject:triples[i].subjectVar];
+            if (triples[i].predicateVar != nil) [variables addObject:triples[i].predicateVar];
+            if (triples[i].objectVar != nil) [variables addObject:triples[i].objectVar];
+        }
+        
+        for (TXLFilter *filter in filters) {
+            [variables unionSet:[filter variables]];
+        }
+        
+        for (TXLGraphPattern *pattern in notExistsPatterns) {
+            [variables unionSet:[pattern variables]];
+        }
+        
+        slots = [[[variables allObjects] sortedArrayUsingComparator:^(id a, id b) {
+            if ([a integerValue] < [b integerValue]) return (NSComparisonResult)NSOrderedAscending;
+            if ([a integerValue] > [b integerValue]) return (NSComparisonResult)NSOrderedDescending;
+            return (NSComparisonResult)NSOrderedSame;
+        }] retain];
+        
+        for (NSUInteger i = 0; i < numberOfTriples; i++) {
+            if (triples[i].subjectVar != nil) triples[i].subjectSlot = [slots indexOfObject:triples[i].subjectVar];
+            if (triples[i].predicateVar != nil) triples[i].predicateSlot = [slots indexOfObject:triples[i].predicateVar];
+            if (triples[i].objectVar != nil) triples[i].objectSlot = [slots indexOfObject:triples[i].objectVar];
+        }
+        
+        for (TXLFilter *filter in filters) {
+            [filter bindVariablesToSlots:slots];
+        }
+        
+        loaded = YES;
     }
 }
 
-- (BOOL)evaluateFilterWithVariables:(NSDictionary *)vars 
-                      rootPatternId:(NSUInteger)rootPatternId{
-    return YES;
-}
-
 @end
 
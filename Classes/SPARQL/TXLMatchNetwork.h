@@ -0,0 +1,92 @@
+//
+//  TXLMatchNetwork.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 14.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import <Foundation/Foundation.h>
+
+@class TXLQuery;
+@class TXLRevision;
+
+
+/*! Discrimination network over the triple patterns of all
+ *  registered queries and situation definitions.
+ *
+ *  Each distinct triple pattern (terms are compared by their
+ *  primary key, variables are wildcards) is represented by one
+ *  alpha node, which is shared by all queries using this pattern.
+ *  The statements created and removed in a revision are propagated
+ *  through the network once. The result is, for each affected query,
+ *  the set of variable bindings (seeds) derived from the statements
+ *  matching its triple patterns.
+ *
+ *  The joins between the triple patterns are not part of the network.
+ *  They are evaluated for each query by the backtracking evaluation of
+ *  the graph pattern, starting with the seeds.
+ */
+@interface TXLMatchNetwork : NSObject {
+
+@private
+    // alpha nodes: signature -> list of subscriptions
+    NSMutableDictionary *alphaNodes;
+
+    // query primary key -> list of signatures used by this query
+    NSMutableDictionary *querySignatures;
+
+    BOOL loaded;
+}
+
+#pragma mark -
+#pragma mark Managing Queries
+
+/*! Add the triple patterns of the query to the network.
+ *
+ *  All triple patterns of the query pattern and of the patterns
+ *  contained in it are added.
+ */
+- (void)addQuery:(TXLQuery *)query;
+
+/*! Remove the triple patterns of the query from the network.
+ */
+- (void)removeQuery:(TXLQuery *)query;
+
+#pragma mark -
+#pragma mark Propagating Changes
+
+/*! Propagate the statements created and removed in the
+ *  revision through the network.
+ *
+ *  Returns a dictionary with the primary key (TXLInteger) of each
+ *  query having at least one triple pattern matched by a changed
+ *  statement in one of its contexts as key. The value is a dictionary
+ *  with the keys "created" and "removed", each containing a set of
+ *  variable bindings (dictionaries with the primary key of the variable
+ *  as key and the primary key of the term as value).
+ *
+ *  A statement is in the context of a query, if its context is the
+ *  context of the query or one of its child contexts (compared by the
+ *  path components of the context names).
+ *
+ *  Queries not contained in the result are not affected by the changes.
+ */
+- (NSDictionary *)activationsForRevision:(TXLRevision *)revision;
+
+@end
@@ -0,0 +1,446 @@
+//
+//  TXLMatchNetwork.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 14.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import "TXLMatchNetwork.h"
+
+#import "TXLDatabase.h"
+#import "TXLManager.h"
+#import "TXLInteger.h"
+#import "TXLQuery.h"
+#import "TXLGraphPattern.h"
+#import "TXLContext.h"
+#import "TXLRevision.h"
+
+@interface TXLMatchNetwork ()
+
+- (void)load;
+
+- (NSArray *)triplePatternsOfQuery:(TXLQuery *)query;
+
+- (NSString *)signatureWithSubject:(id)subject
+                         predicate:(id)predicate
+                            object:(id)object;
+
+- (NSString *)signatureOfTriplePattern:(NSDictionary *)pattern;
+
+- (void)propagateStatementsOfTable:(NSString *)table
+                       inRevision:(TXLRevision *)revision
+                          withKey:(NSString *)key
+                  intoActivations:(NSMutableDictionary *)activations;
+
+- (BOOL)path:(NSArray *)path hasPrefix:(NSArray *)prefix;
+
+@end
+
+
+@implementation TXLMatchNetwork
+
+#pragma mark -
+#pragma mark Memory Management
+
+- (id)init {
+    if ((self = [super init])) {
+        alphaNodes = [[NSMutableDictionary alloc] init];
+        querySignatures = [[NSMutableDictionary alloc] init];
+        loaded = NO;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [alphaNodes release];
+    [querySignatures release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Managing Queries
+
+- (void)addQuery:(TXLQuery *)query {
+
+    TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+
+    NSMutableArray *contextPaths = [NSMutableArray array];
+    for (TXLContext *ctx in query.contexts) {
+        [contextPaths addObject:[[ctx description] pathComponents]];
+    }
+
+    NSArray *patterns = [self triplePatternsOfQuery:query];
+
+    @synchronized (self) {
+
+        if ([querySignatures objectForKey:queryPk] != nil) {
+            return;
+        }
+
+        NSMutableArray *signatures = [NSMutableArray array];
+
+        for (NSDictionary *pattern in patterns) {
+
+            NSString *signature = [self signatureOfTriplePattern:pattern];
+
+            // share the alpha node with all queries
+            // using the same triple pattern
+            NSMutableArray *subscriptions = [alphaNodes objectForKey:signature];
+            if (subscriptions == nil) {
+                subscriptions = [NSMutableArray array];
+                [alphaNodes setObject:subscriptions forKey:signature];
+            }
+
+            [subscriptions addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                                      queryPk, @"query_id",
+                                      pattern, @"pattern",
+                                      contextPaths, @"contexts",
+                                      nil]];
+
+            [signatures addObject:signature];
+        }
+
+        [querySignatures setObject:signatures forKey:queryPk];
+    }
+}
+
+- (void)removeQuery:(TXLQuery *)query {
+
+    TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+
+    @synchronized (self) {
+
+        for (NSString *signature in [querySignatures objectForKey:queryPk]) {
+
+            NSMutableArray *subscriptions = [alphaNodes objectForKey:signature];
+
+            NSIndexSet *indexes = [subscriptions indexesOfObjectsPassingTest:^(id obj, NSUInteger idx, BOOL *stop) {
+                return [[obj objectForKey:@"query_id"] isEqual:queryPk];
+            }];
+            [subscriptions removeObjectsAtIndexes:indexes];
+
+            if ([subscriptions count] == 0) {
+                [alphaNodes removeObjectForKey:signature];
+            }
+        }
+
+        [querySignatures removeObjectForKey:queryPk];
+    }
+}
+
+#pragma mark -
+#pragma mark Propagating Changes
+
+- (NSDictionary *)activationsForRevision:(TXLRevision *)revision {
+
+    NSMutableDictionary *activations = [NSMutableDictionary dictionary];
+
+    @synchronized (self) {
+
+        if (!loaded) {
+            [self load];
+        }
+
+        [self propagateStatementsOfTable:@"txl_statement_created"
+                              inRevision:revision
+                                 withKey:@"created"
+                         intoActivations:activations];
+
+        [self propagateStatementsOfTable:@"txl_statement_removed"
+                              inRevision:revision
+                                 withKey:@"removed"
+                         intoActivations:activations];
+
+        // The moving object of an extended statement has changed, the
+        // statement is propagated like a created statement, so that the
+        // results using it are evaluated again in the new revision.
+        [self propagateStatementsOfTable:@"txl_statement_extended"
+                              inRevision:revision
+                                 withKey:@"created"
+                         intoActivations:activations];
+    }
+
+    return activations;
+}
+
+#pragma mark -
+#pragma mark -
+#pragma mark Private Methods
+
+#pragma mark -
+#pragma mark Loading Registered Queries
+
+- (void)load {
+
+    // The network is kept in memory only, so it is built
+    // on first use from the queries registered in the database.
+
+    NSError *error;
+
+    TXLDatabase *database = [[TXLManager sharedManager] database];
+    NSArray *result = [database executeSQL:@"SELECT id \
+                       FROM txl_query \
+                       WHERE id IN (SELECT query_id FROM txl_query_name WHERE query_id = txl_query.id) \
+                       OR id IN (SELECT query_id FROM txl_context_query WHERE query_id = txl_query.id)" error:&error];
+
+    if (result == nil) {
+        [NSException raise:@"TXLMatchNetworkException" format:@"Could not load registered queries: %@", [error localizedDescription]];
+    }
+
+    for (NSDictionary *row in result) {
+        [self addQuery:[TXLQuery queryWithPrimaryKey:[[row objectForKey:@"id"] unsignedIntegerValue]]];
+    }
+
+    loaded = YES;
+}
+
+#pragma mark -
+#pragma mark Triple Patterns
+
+- (NSArray *)triplePatternsOfQuery:(TXLQuery *)query {
+
+    // collect the triple patterns of the query pattern and
+    // of all patterns contained in the query pattern
+
+    NSError *error;
+
+    TXLDatabase *database = [[TXLManager sharedManager] database];
+
+    NSMutableArray *triplePatterns = [NSMutableArray array];
+    NSMutableArray *patternIds = [NSMutableArray arrayWithObject:[TXLInteger integerWithValue:query.queryPattern.primaryKey]];
+
+    while ([patternIds count] > 0) {
+
+        TXLInteger *patternId = [patternIds lastObject];
+        [patternIds removeLastObject];
+
+        NSArray *result = [database executeSQLWithParameters:@"\
+                           SELECT \
+                           id, \
+                           subject_id, \
+                           subject_var_id, \
+                           predicate_id, \
+                           predicate_var_id, \
+                           object_id, \
+                           object_var_id \
+                           FROM \
+                           txl_query_pattern_triple \
+                           WHERE \
+                           in_pattern_id = ?"
+                                                       error:&error,
+                           patternId, nil];
+
+        if (result == nil) {
+            [NSException raise:@"TXLMatchNetworkException" format:@"Could not retrieve basic graph patterns of pattern (%@): %@", patternId, [error localizedDescription]];
+        }
+
+        if ([result count] > 0) {
+            [triplePatterns addObjectsFromArray:result];
+        } else {
+            // a pattern without any triple pattern
+            // matches every statement
+            [triplePatterns addObject:[NSDictionary dictionary]];
+        }
+
+        result = [database executeSQLWithParameters:@"\
+                  SELECT pattern_id FROM txl_query_pattern_not_exists WHERE in_pattern_id = ? \
+                  UNION SELECT pattern_id FROM txl_query_pattern_group WHERE in_pattern_id = ? \
+                  UNION SELECT pattern_id FROM txl_query_pattern_optional WHERE in_pattern_id = ? \
+                  UNION SELECT up.pattern_id FROM txl_query_pattern_union_pattern AS up \
+                  INNER JOIN txl_query_pattern_union AS u ON (up.union_id = u.id) WHERE u.in_pattern_id = ?"
+                                              error:&error,
+                  patternId, patternId, patternId, patternId, nil];
+
+        if (result == nil) {
+            [NSException raise:@"TXLMatchNetworkException" format:@"Could not retrieve sub patterns of pattern (%@): %@", patternId, [error localizedDescription]];
+        }
+
+        for (NSDictionary *row in result) {
+            [patternIds addObject:[row objectForKey:@"pattern_id"]];
+        }
+    }
+
+    return triplePatterns;
+}
+
+#pragma mark -
+#pragma mark Signatures
+
+- (NSString *)signatureWithSubject:(id)subject
+                         predicate:(id)predicate
+                            object:(id)object {
+    return [NSString stringWithFormat:@"%@ %@ %@",
+            subject ? subject : @"?",
+            predicate ? predicate : @"?",
+            object ? object : @"?"];
+}
+
+- (NSString *)signatureOfTriplePattern:(NSDictionary *)pattern {
+
+    // variables (and terms of a pattern without any
+    // triple pattern) are wildcards in the signature
+
+    id subject = nil;
+    if ([[pattern objectForKey:@"subject_var_id"] integerValue] == 0) {
+        subject = [pattern objectForKey:@"subject_id"];
+    }
+
+    id predicate = nil;
+    if ([[pattern objectForKey:@"predicate_var_id"] integerValue] == 0) {
+        predicate = [pattern objectForKey:@"predicate_id"];
+    }
+
+    id object = nil;
+    if ([[pattern objectForKey:@"object_var_id"] integerValue] == 0) {
+        object = [pattern objectForKey:@"object_id"];
+    }
+
+    return [self signatureWithSubject:subject
+                            predicate:predicate
+                               object:object];
+}
+
+#pragma mark -
+#pragma mark Propagation
+
+- (void)propagateStatementsOfTable:(NSString *)table
+                       inRevision:(TXLRevision *)revision
+                          withKey:(NSString *)key
+                  intoActivations:(NSMutableDictionary *)activations {
+
+    // The statements are joined by the revision, a revision
+    // can contain any number of statements (e.g., a bulk ingest).
+
+    NSError *error;
+
+    TXLDatabase *database = [[TXLManager sharedManager] database];
+    NSString *sql = [NSString stringWithFormat:@"\
+                     SELECT st.subject_id, st.predicate_id, st.object_id, ctx.name AS context \
+                     FROM %@ AS changed \
+                     INNER JOIN txl_statement AS st ON (changed.statement_id = st.id) \
+                     INNER JOIN txl_context AS ctx ON (st.context_id = ctx.id) \
+                     WHERE changed.revision_id = ?", table];
+
+    // context name -> path components
+    NSMutableDictionary *contextPaths = [NSMutableDictionary dictionary];
+
+    BOOL success = [database executeSQL:sql
+                         withParameters:[NSArray arrayWithObject:[TXLInteger integerWithValue:revision.primaryKey]]
+                                  error:&error
+                          resultHandler:^(NSDictionary *row, BOOL *stop) {
+
+                              TXLInteger *s = [row objectForKey:@"subject_id"];
+                              TXLInteger *p = [row objectForKey:@"predicate_id"];
+                              TXLInteger *o = [row objectForKey:@"object_id"];
+                              NSString *context = [row objectForKey:@"context"];
+                              NSArray *contextPath = [contextPaths objectForKey:context];
+                              if (contextPath == nil) {
+                                  contextPath = [context pathComponents];
+                                  [contextPaths setObject:contextPath forKey:context];
+                              }
+
+                              // --------------------------------------------------------------------
+                              // a statement activates all alpha nodes whose
+                              // signature equals the statement, where each
+                              // term can be replaced by a wildcard
+                              // --------------------------------------------------------------------
+
+                              for (int i = 0; i < 8; i++) {
+
+                                  NSString *signature = [self signatureWithSubject:(i & 4) ? s : nil
+                                                                         predicate:(i & 2) ? p : nil
+                                                                            object:(i & 1) ? o : nil];
+
+                                  for (NSDictionary *subscription in [alphaNodes objectForKey:signature]) {
+
+                                      // the statement must be in (or underneath)
+                                      // one of the contexts of the query
+
+                                      BOOL inContext = NO;
+                                      for (NSArray *path in [subscription objectForKey:@"contexts"]) {
+                                          if ([self path:contextPath hasPrefix:path]) {
+                                              inContext = YES;
+                                              break;
+                                          }
+                                      }
+
+                                      if (!inContext) {
+                                          continue;
+                                      }
+
+                                      // bind the variables of the triple pattern.
+                                      // a variable used twice in the triple pattern
+                                      // must be bound to the same term.
+
+                                      NSDictionary *pattern = [subscription objectForKey:@"pattern"];
+                                      NSMutableDictionary *seed = [NSMutableDictionary dictionary];
+                                      BOOL consistent = YES;
+
+                                      NSArray *values = [NSArray arrayWithObjects:s, p, o, nil];
+                                      NSArray *varIds = [NSArray arrayWithObjects:@"subject_var_id", @"predicate_var_id", @"object_var_id", nil];
+
+                                      for (NSUInteger j = 0; j < 3; j++) {
+                                          TXLInteger *varId = [pattern objectForKey:[varIds objectAtIndex:j]];
+                                          if ([varId integerValue] != 0) {
+                                              TXLInteger *bound = [seed objectForKey:varId];
+                                              if (bound != nil && ![bound isEqual:[values objectAtIndex:j]]) {
+                                                  consistent = NO;
+                                                  break;
+                                              }
+                                              [seed setObject:[values objectAtIndex:j] forKey:varId];
+                                          }
+                                      }
+
+                                      if (!consistent) {
+                                          continue;
+                                      }
+
+                                      TXLInteger *queryPk = [subscription objectForKey:@"query_id"];
+                                      NSMutableDictionary *activation = [activations objectForKey:queryPk];
+                                      if (activation == nil) {
+                                          activation = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                                                        [NSMutableSet set], @"created",
+                                                        [NSMutableSet set], @"removed",
+                                                        nil];
+                                          [activations setObject:activation forKey:queryPk];
+                                      }
+                                      [[activation objectForKey:key] addObject:seed];
+                                  }
+                              }
+                          }];
+
+    if (!success) {
+        [NSException raise:@"TXLMatchNetworkException" format:@"Could not propagate statements: %@", [error localizedDescription]];
+    }
+}
+
+- (BOOL)path:(NSArray *)path hasPrefix:(NSArray *)prefix {
+    NSUInteger count = [prefix count];
+    if ([path count] < count) {
+        return NO;
+    }
+    for (NSUInteger i = 0; i < count; i++) {
+        if (![[path objectAtIndex:i] isEqualToString:[prefix objectAtIndex:i]]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+@end
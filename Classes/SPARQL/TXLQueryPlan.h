@@ -0,0 +1,123 @@
+//
+//  TXLQueryPlan.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 21.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import <Foundation/Foundation.h>
+
+@class TXLQuery;
+@class TXLGraphPattern;
+
+/*! A term of a triple of the construct template. It is either a
+ *  term (primary key), the value of a variable of the resultset
+ *  (primary key of the variable), or a blank node, which is created
+ *  for each result (index of the blank node in the template).
+ */
+typedef struct {
+    NSUInteger term;
+    NSUInteger variable;
+    NSInteger blankNode;
+} TXLTemplateTerm;
+
+typedef struct {
+    TXLTemplateTerm subject;
+    TXLTemplateTerm predicate;
+    TXLTemplateTerm object;
+} TXLTemplateTriple;
+
+
+/*! Compiled plan of a registered query.
+ *
+ *  The plan contains everything needed to evaluate the query:
+ *  the loaded pattern tree, the variables, the contexts of the
+ *  FROM clause and the construct template. It is loaded once
+ *  from the database and not changed afterwards. A plan has to be
+ *  discarded if the query is unregistered or redefined.
+ */
+@interface TXLQueryPlan : NSObject {
+
+@private
+    NSUInteger queryPrimaryKey;
+    TXLGraphPattern *queryPattern;
+    NSArray *variables;
+    NSArray *variablesOfResultset;
+    NSUInteger *slotsOfResultset;
+    NSArray *contexts;
+    NSArray *constructTemplate;
+    TXLTemplateTriple *templateTriples;
+    NSUInteger numberOfTemplateBlankNodes;
+}
+
+#pragma mark -
+#pragma mark Compiling a Plan
+
++ (TXLQueryPlan *)planForQuery:(TXLQuery *)query;
+
+#pragma mark -
+#pragma mark Plan
+
+/*! The primary key of the query.
+ */
+@property (readonly) NSUInteger queryPrimaryKey;
+
+/*! The root pattern of the query with all contained
+ *  patterns loaded.
+ */
+@property (readonly) TXLGraphPattern *queryPattern;
+
+/*! The primary keys (TXLInteger) of all variables of the query pattern.
+ *  The index of a variable in this list is its slot in the binding
+ *  vectors of the query pattern.
+ */
+@property (readonly) NSArray *variables;
+
+/*! The primary keys (TXLInteger) of the variables of the resultset.
+ */
+@property (readonly) NSArray *variablesOfResultset;
+
+/*! The slot of each variable of the resultset (in the order
+ *  of variablesOfResultset), or NSNotFound if the variable is
+ *  not used in the query pattern.
+ */
+@property (readonly) const NSUInteger *slotsOfResultset;
+
+/*! The contexts (TXLContext) of the FROM clause.
+ */
+@property (readonly) NSArray *contexts;
+
+/*! The triple patterns of the construct template as rows of the table
+ *  txl_query_pattern_triple, or nil if the query is not a construct query.
+ */
+@property (readonly) NSArray *constructTemplate;
+
+/*! The triples of the construct template (in the order of
+ *  constructTemplate) with the variables and blank nodes resolved.
+ */
+@property (readonly) const TXLTemplateTriple *templateTriples;
+
+/*! The number of distinct blank nodes in the construct template.
+ */
+@property (readonly) NSUInteger numberOfTemplateBlankNodes;
+
+@property (readonly, getter=isConstructQuery) BOOL constructQuery;
+
+@end
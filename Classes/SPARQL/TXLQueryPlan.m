@@ -0,0 +1,185 @@
+//
+//  TXLQueryPlan.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 21.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import "TXLQueryPlan.h"
+
+#import "TXLDatabase.h"
+#import "TXLManager.h"
+#import "TXLInteger.h"
+#import "TXLQuery.h"
+#import "TXLGraphPattern.h"
+
+@interface TXLQueryPlan ()
+
+- (id)initWithQuery:(TXLQuery *)query;
+
+- (TXLTemplateTerm)templateTermWithTerm:(id)term
+                               variable:(id)var
+                             blankNodes:(NSMutableDictionary *)blankNodes;
+
+@end
+
+
+@implementation TXLQueryPlan
+
+@synthesize queryPrimaryKey;
+@synthesize queryPattern;
+@synthesize variables;
+@synthesize variablesOfResultset;
+@synthesize slotsOfResultset;
+@synthesize contexts;
+@synthesize constructTemplate;
+@synthesize templateTriples;
+@synthesize numberOfTemplateBlankNodes;
+
+#pragma mark -
+#pragma mark Compiling a Plan
+
++ (TXLQueryPlan *)planForQuery:(TXLQuery *)query {
+    return [[[self alloc] initWithQuery:query] autorelease];
+}
+
+#pragma mark -
+#pragma mark Plan
+
+- (BOOL)isConstructQuery {
+    return constructTemplate != nil;
+}
+
+#pragma mark -
+#pragma mark Memory Management
+
+- (id)initWithQuery:(TXLQuery *)query {
+    if ((self = [super init])) {
+        
+        NSError *error;
+        
+        TXLDatabase *database = [[TXLManager sharedManager] database];
+        
+        queryPrimaryKey = query.primaryKey;
+        
+        // pattern tree
+        queryPattern = [query.queryPattern retain];
+        [queryPattern load];
+        
+        // variables and their slots
+        variables = [queryPattern.slots copy];
+        variablesOfResultset = [query.variablesOfResultset copy];
+        
+        // a variable of the resultset, which is not used in the
+        // query pattern, has no slot (NSNotFound) and is never bound
+        slotsOfResultset = calloc([variablesOfResultset count] > 0 ? [variablesOfResultset count] : 1, sizeof(NSUInteger));
+        for (NSUInteger i = 0; i < [variablesOfResultset count]; i++) {
+            slotsOfResultset[i] = [variables indexOfObject:[variablesOfResultset objectAtIndex:i]];
+        }
+        
+        // contexts of the FROM clause
+        contexts = [query.contexts copy];
+        
+        // construct template
+        if (query.constructQuery) {
+            constructTemplate = [[database executeSQLWithParameters:@"SELECT txl_query_pattern_triple.* FROM txl_query_pattern_triple, txl_query WHERE txl_query_pattern_triple.in_pattern_id = txl_query.construct_template_pattern_id AND txl_query.id = ?"
+                                                              error:&error,
+                                  [TXLInteger integerWithValue:queryPrimaryKey], nil] retain];
+            if (constructTemplate == nil) {
+                [self release];
+                [NSException raise:@"TXLQueryPlanException" format:@"Could not load construct template of query (%d): %@", query.primaryKey, [error localizedDescription]];
+            }
+            
+            // resolve the variables of the template once, blank nodes
+            // are numbered by their variable
+            NSMutableDictionary *blankNodes = [NSMutableDictionary dictionary];
+            templateTriples = calloc([constructTemplate count] > 0 ? [constructTemplate count] : 1, sizeof(TXLTemplateTriple));
+            for (NSUInteger i = 0; i < [constructTemplate count]; i++) {
+                NSDictionary *triple = [constructTemplate objectAtIndex:i];
+                templateTriples[i].subject = [self templateTermWithTerm:[triple objectForKey:@"subject_id"]
+                                                               variable:[triple objectForKey:@"subject_var_id"]
+                                                             blankNodes:blankNodes];
+                templateTriples[i].predicate = [self templateTermWithTerm:[triple objectForKey:@"predicate_id"]
+                                                                 variable:[triple objectForKey:@"predicate_var_id"]
+                                                               blankNodes:blankNodes];
+                templateTriples[i].object = [self templateTermWithTerm:[triple objectForKey:@"object_id"]
+                                                              variable:[triple objectForKey:@"object_var_id"]
+                                                            blankNodes:blankNodes];
+            }
+            numberOfTemplateBlankNodes = [blankNodes count];
+        }
+    }
+    return self;
+}
+
+- (TXLTemplateTerm)templateTermWithTerm:(id)term
+                               variable:(id)var
+                             blankNodes:(NSMutableDictionary *)blankNodes {
+    
+    TXLTemplateTerm result = {0, 0, -1};
+    
+    if ([term isKindOfClass:[TXLInteger class]] && [term integerValue] > 0) {
+        result.term = [term integerValue];
+        return result;
+    }
+    
+    if (![var isKindOfClass:[TXLInteger class]]) {
+        [NSException raise:@"TXLQueryPlanException" format:@"Expecting a term or a variable in the construct template of query (%d).", queryPrimaryKey];
+    }
+    
+    result.variable = [var integerValue];
+    
+    NSNumber *blankNode = [blankNodes objectForKey:var];
+    if (blankNode != nil) {
+        result.blankNode = [blankNode integerValue];
+        return result;
+    }
+    
+    NSError *error;
+    NSArray *rows = [[[TXLManager sharedManager] database] executeSQLWithParameters:@"SELECT is_blanknode FROM txl_query_variable WHERE id = ?"
+                                                                              error:&error,
+                     var, nil];
+    if (rows == nil) {
+        [NSException raise:@"TXLQueryPlanException" format:@"Could not load variable (%@) of query (%d): %@", var, queryPrimaryKey, [error localizedDescription]];
+    }
+    if ([rows count] != 1) {
+        [NSException raise:@"TXLQueryPlanException" format:@"Expecting values for var with id %@", var];
+    }
+    
+    if ([[[rows objectAtIndex:0] objectForKey:@"is_blanknode"] integerValue]) {
+        result.blankNode = [blankNodes count];
+        [blankNodes setObject:[NSNumber numberWithInteger:result.blankNode] forKey:var];
+    }
+    
+    return result;
+}
+
+- (void)dealloc {
+    [queryPattern release];
+    [variables release];
+    [variablesOfResultset release];
+    free(slotsOfResultset);
+    [contexts release];
+    [constructTemplate release];
+    free(templateTriples);
+    [super dealloc];
+}
+
+@end
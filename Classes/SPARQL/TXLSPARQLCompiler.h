@@ -89,6 +89,11 @@ typedef enum {
 	NSMutableArray *patternIds;
 	
 	NSError *compilerError;
+    
+    // TRUE while the lexer is inside of a FILTER constraint
+    // and the depth of the parentheses in this constraint.
+    BOOL inFilter;
+    NSInteger filterDepth;
 }
 
 @property (assign) kTXLQueryPart partOfQuery;
@@ -98,6 +103,8 @@ typedef enum {
 @property (retain) NSMutableDictionary *variables;
 @property (retain) NSMutableArray *patternIds;
 @property (retain) NSError *compilerError;
+@property (assign) BOOL inFilter;
+@property (assign) NSInteger filterDepth;
 
 #pragma mark -
 #pragma mark Compile SPARQL Expression
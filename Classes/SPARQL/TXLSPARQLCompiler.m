@@ -62,6 +62,8 @@ int sparql_YYINPUT(char* theBuffer, int maxSize, TXLSPARQLCompiler *compiler) {
 @synthesize pos;
 @synthesize length;
 @synthesize compilerError;
+@synthesize inFilter;
+@synthesize filterDepth;
 
 
 
@@ -180,6 +182,31 @@ int sparql_YYINPUT(char* theBuffer, int maxSize, TXLSPARQLCompiler *compiler) {
 	int parsingResult = sparql_parse(compiler, compiler.yyscanner);
 	
 	if(parsingResult == 0) {
+		
+		// 'SELECT *' projects the variables bound by the pattern. A variable
+		// is stored when it is seen first, so a variable used only in a
+		// FILTER (never bound) is stored in the result set, and a variable
+		// used in a FILTER before its triple pattern is not.
+		if (compiler.selectStar) {
+			result = [database executeSQLWithParameters:@"\
+					  UPDATE txl_query_variable SET in_resultset = ( \
+					  EXISTS (SELECT 1 FROM txl_query_pattern_triple AS t \
+					  WHERE t.subject_var_id = txl_query_variable.id \
+					  OR t.predicate_var_id = txl_query_variable.id \
+					  OR t.object_var_id = txl_query_variable.id) \
+					  OR EXISTS (SELECT 1 FROM txl_query_pattern_named AS n \
+					  WHERE n.context_var_id = txl_query_variable.id)) \
+					  WHERE query_id = ? AND is_blanknode = ?"
+												  error:error,
+					  [NSNumber numberWithUnsignedInteger:compiler.queryId],
+					  [NSNumber numberWithBool:NO],
+					  nil];
+			
+			if (result == nil) {
+				return nil;
+			}
+		}
+		
 		// Create the tables for the result set of this query.
 		// Find which variables should be in the result set of this query.
 		result = [database executeSQLWithParameters:@"SELECT id FROM txl_query_variable WHERE query_id = ? and in_resultset = ?"
@@ -209,7 +236,18 @@ int sparql_YYINPUT(char* theBuffer, int maxSize, TXLSPARQLCompiler *compiler) {
         
         // Create the 'resultset' table
         SQL_ON_ERROR_RETURN(sql);
-		
+
+        // Create an index over the variables of the result set. It is used
+        // to find the rows of a result during the incremental maintenance
+        // of the result set.
+        if ([result count] > 0) {
+            NSMutableArray *columns = [NSMutableArray array];
+            for (NSDictionary *dict in result) {
+                [columns addObject:[NSString stringWithFormat:@"var_%d", [[dict objectForKey:@"id"] unsignedIntegerValue]]];
+            }
+            SQL_ON_ERROR_RETURN_FORMAT(@"CREATE INDEX txl_resultset_%d_vars ON %@ (%@)", compiler.queryId, resultsetTableName, [columns componentsJoinedByString:@", "]);
+        }
+
 		// Create the 'created' table
 		NSString *createdTableName = [NSString stringWithFormat:@"txl_resultset_%d_created", compiler.queryId];
 		
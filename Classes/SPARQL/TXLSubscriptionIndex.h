@@ -0,0 +1,71 @@
+//
+//  TXLSubscriptionIndex.h
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 16.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import <Foundation/Foundation.h>
+
+@class TXLQuery;
+
+
+/*! Index of the contexts used in the FROM clauses of all
+ *  registered queries and situation definitions.
+ *
+ *  The index is a trie over the path components of the context
+ *  names. Each node holds the queries listening on the subtree
+ *  below this node. The queries affected by a change in a context
+ *  are found by walking the path of this context from the root,
+ *  collecting the queries on the way.
+ */
+@interface TXLSubscriptionIndex : NSObject {
+
+@private
+    // root node of the trie
+    NSMutableDictionary *root;
+
+    // query primary key -> list of context names used by this query
+    NSMutableDictionary *queryContexts;
+
+    BOOL loaded;
+}
+
+#pragma mark -
+#pragma mark Managing Queries
+
+/*! Subscribe the query for the contexts of its FROM clause.
+ */
+- (void)addQuery:(TXLQuery *)query;
+
+/*! Remove all subscriptions of the query.
+ */
+- (void)removeQuery:(TXLQuery *)query;
+
+#pragma mark -
+#pragma mark Finding Queries
+
+/*! Return all queries containing a context in the FROM
+ *  clause which is equal to one of the given contexts or
+ *  where one of the given contexts is a child context.
+ */
+- (NSArray *)queriesForContexts:(NSSet *)ctxs;
+
+@end
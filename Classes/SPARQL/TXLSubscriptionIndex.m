@@ -0,0 +1,214 @@
+//
+//  TXLSubscriptionIndex.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 16.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import "TXLSubscriptionIndex.h"
+
+#import "TXLDatabase.h"
+#import "TXLManager.h"
+#import "TXLInteger.h"
+#import "TXLQuery.h"
+#import "TXLContext.h"
+
+@interface TXLSubscriptionIndex ()
+
+- (void)load;
+
+- (NSMutableDictionary *)node;
+
+@end
+
+
+@implementation TXLSubscriptionIndex
+
+#pragma mark -
+#pragma mark Memory Management
+
+- (id)init {
+    if ((self = [super init])) {
+        root = [[self node] retain];
+        queryContexts = [[NSMutableDictionary alloc] init];
+        loaded = NO;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [root release];
+    [queryContexts release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Managing Queries
+
+- (void)addQuery:(TXLQuery *)query {
+
+    TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+
+    NSMutableArray *contextNames = [NSMutableArray array];
+    for (TXLContext *ctx in query.contexts) {
+        [contextNames addObject:[ctx description]];
+    }
+
+    @synchronized (self) {
+
+        if ([queryContexts objectForKey:queryPk] != nil) {
+            return;
+        }
+
+        for (NSString *name in contextNames) {
+
+            // create the nodes along the path of the
+            // context and subscribe the query at the last one
+            NSMutableDictionary *node = root;
+            for (NSString *component in [name pathComponents]) {
+                NSMutableDictionary *children = [node objectForKey:@"children"];
+                NSMutableDictionary *child = [children objectForKey:component];
+                if (child == nil) {
+                    child = [self node];
+                    [children setObject:child forKey:component];
+                }
+                node = child;
+            }
+
+            [[node objectForKey:@"queries"] addObject:queryPk];
+        }
+
+        [queryContexts setObject:contextNames forKey:queryPk];
+    }
+}
+
+- (void)removeQuery:(TXLQuery *)query {
+
+    TXLInteger *queryPk = [TXLInteger integerWithValue:query.primaryKey];
+
+    @synchronized (self) {
+
+        for (NSString *name in [queryContexts objectForKey:queryPk]) {
+
+            // remember the path, to remove the nodes
+            // which are not used anymore afterwards
+            NSMutableArray *path = [NSMutableArray arrayWithObject:root];
+            NSArray *components = [name pathComponents];
+
+            for (NSString *component in components) {
+                NSMutableDictionary *child = [[[path lastObject] objectForKey:@"children"] objectForKey:component];
+                if (child == nil) {
+                    break;
+                }
+                [path addObject:child];
+            }
+
+            if ([path count] != [components count] + 1) {
+                continue;
+            }
+
+            [[[path lastObject] objectForKey:@"queries"] removeObject:queryPk];
+
+            for (NSInteger i = [components count]; i > 0; i--) {
+                NSMutableDictionary *node = [path objectAtIndex:i];
+                if ([[node objectForKey:@"queries"] count] > 0 ||
+                    [[node objectForKey:@"children"] count] > 0) {
+                    break;
+                }
+                [[[path objectAtIndex:i - 1] objectForKey:@"children"] removeObjectForKey:[components objectAtIndex:i - 1]];
+            }
+        }
+
+        [queryContexts removeObjectForKey:queryPk];
+    }
+}
+
+#pragma mark -
+#pragma mark Finding Queries
+
+- (NSArray *)queriesForContexts:(NSSet *)ctxs {
+
+    NSMutableSet *queryPks = [NSMutableSet set];
+
+    @synchronized (self) {
+
+        if (!loaded) {
+            [self load];
+        }
+
+        // A query is affected by a change in a context, if it
+        // is subscribed to this context or one of its antecendents.
+        // These are exactly the queries on the path of the context.
+        for (TXLContext *ctx in ctxs) {
+            NSMutableDictionary *node = root;
+            for (NSString *component in [[ctx description] pathComponents]) {
+                node = [[node objectForKey:@"children"] objectForKey:component];
+                if (node == nil) {
+                    break;
+                }
+                [queryPks unionSet:[node objectForKey:@"queries"]];
+            }
+        }
+    }
+
+    NSMutableArray *queries = [NSMutableArray array];
+    for (TXLInteger *queryPk in queryPks) {
+        [queries addObject:[TXLQuery queryWithPrimaryKey:[queryPk integerValue]]];
+    }
+
+    return queries;
+}
+
+#pragma mark -
+#pragma mark -
+#pragma mark Private Methods
+
+- (void)load {
+
+    // The index is kept in memory only, so it is built
+    // on first use from the queries registered in the database.
+
+    NSError *error;
+
+    TXLDatabase *database = [[TXLManager sharedManager] database];
+    NSArray *result = [database executeSQL:@"SELECT id \
+                       FROM txl_query \
+                       WHERE id IN (SELECT query_id FROM txl_query_name WHERE query_id = txl_query.id) \
+                       OR id IN (SELECT query_id FROM txl_context_query WHERE query_id = txl_query.id)" error:&error];
+
+    if (result == nil) {
+        [NSException raise:@"TXLSubscriptionIndexException" format:@"Could not load registered queries: %@", [error localizedDescription]];
+    }
+
+    for (NSDictionary *row in result) {
+        [self addQuery:[TXLQuery queryWithPrimaryKey:[[row objectForKey:@"id"] unsignedIntegerValue]]];
+    }
+
+    loaded = YES;
+}
+
+- (NSMutableDictionary *)node {
+    return [NSMutableDictionary dictionaryWithObjectsAndKeys:
+            [NSMutableDictionary dictionary], @"children",
+            [NSMutableSet set], @"queries",
+            nil];
+}
+
+@end
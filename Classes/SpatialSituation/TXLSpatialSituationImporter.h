@@ -26,6 +26,14 @@
 
 extern NSString * const TXLSpatialSituationImporterErrorDomain;
 
+/*
+    Key of the compile options. If the value is YES, the context is not
+    created in the database. The result contains the URL of the context
+    (KEY:"context_url" VALUE:NSURL object) instead of the context. The
+    context can be created later with +contextWithURL:error:.
+ */
+extern NSString * const TXLSpatialSituationImporterDeferContextOption;
+
 #define SPATIAL_SITUATION_COMPILER_ERROR_SYNTAX_ERROR 1
 #define SPATIAL_SITUATION_COMPILER_ERROR_MEMORY_EXHAUSTION 2
 #define SPATIAL_SITUATION_COMPILER_ERROR_MISSING_INFO 3
@@ -39,7 +47,7 @@ extern NSString * const TXLSpatialSituationImporterErrorDomain;
 @private
 	// Variables to store the output 
 	NSMutableArray *statementList;
-	TXLContext *context;
+	NSURL *contextURL;
 	TXLMovingObject *mo;
 	
 	// Help variables	
@@ -54,6 +62,9 @@ extern NSString * const TXLSpatialSituationImporterErrorDomain;
 
 	NSError *compilerError;
 	
+	// Time zone of the timestamps of the snapshots
+	NSTimeZone *timeZone;
+	
 	void *yyscanner;    // state of the lexer 
 	NSData *buf; 		// buffer we read from 
 	NSInteger pos; 		// current position in buf 
@@ -61,7 +72,7 @@ extern NSString * const TXLSpatialSituationImporterErrorDomain;
 }
 
 @property (retain) NSMutableArray *statementList;
-@property (retain) TXLContext *context;
+@property (retain) NSURL *contextURL;
 @property (retain) TXLMovingObject *mo;
 
 @property (retain) NSMutableArray *snapshots;
@@ -86,15 +97,51 @@ extern NSString * const TXLSpatialSituationImporterErrorDomain;
  		  Contains the initialized TXLMovingObject object. This object is not yet stored in the database. 
 		* KEY:"context" VALUE:TXLContext object 
  		  Contains the TXLContext object. This object is already stored in the database. 
+ 		  (With the option TXLSpatialSituationImporterDeferContextOption the key is
+ 		  "context_url" and the value the NSURL of the context.)
  */
 + (NSDictionary *)compileSpatialSituationWithExpression:(NSString *)expression
 								   parameters:(NSDictionary *)parameters
 									  options:(NSDictionary *)options
 										error:(NSError **)error;
 
+/*
+    This method compiles the Spatial Situation expression stored in the file at path.
+ 
+    The file is mapped into memory and scanned in chunks, instead of being read
+    into a string first. This should be used for large files (e.g., long trajectories).
+    The result is the same as of the method above.
+ */
++ (NSDictionary *)compileSpatialSituationWithContentsOfFile:(NSString *)path
+												 parameters:(NSDictionary *)parameters
+													options:(NSDictionary *)options
+													  error:(NSError **)error;
+
+/*
+    This method compiles a Spatial Situation expression given as UTF-8 encoded data.
+ */
++ (NSDictionary *)compileSpatialSituationWithData:(NSData *)data
+									   parameters:(NSDictionary *)parameters
+										  options:(NSDictionary *)options
+											error:(NSError **)error;
+
+/*
+    Returns the context with the URL (e.g., txl://example.com/a/b). The context
+    and its parents are created in the database, if they do not exist.
+ */
++ (TXLContext *)contextWithURL:(NSURL *)url
+						  error:(NSError **)error;
+
 - (int)yyinputToBuffer:(char *)theBuffer
               withSize:(int)maxSize;
 
+/*
+    Returns the date of a snapshot timestamp (yyyy-MM-dd'T'HH:mm'Z') in the
+    local time zone, or nil if the timestamp is not valid. The timestamp is
+    parsed directly from the scanner buffer, without a date formatter.
+ */
+- (NSDate *)dateFromTimestamp:(const char *)timestamp;
+
 @end
 
 /*
@@ -30,6 +30,40 @@
 #import "TXLManager.h"
 
 NSString * const TXLSpatialSituationImporterErrorDomain = @"org.opentxl.SpatialSituationCompilerErrorDomain";
+NSString * const TXLSpatialSituationImporterDeferContextOption = @"defer_context";
+
+// Parse a number of the timestamp up to the delimiter.
+static BOOL TXLTimestampComponent(const char **p, char delimiter, long *value) {
+	const char *c = *p;
+	long v = 0;
+	if (*c < '0' || *c > '9') {
+		return NO;
+	}
+	while (*c >= '0' && *c <= '9') {
+		v = v * 10 + (*c - '0');
+		if (v > 1000000) {
+			return NO;
+		}
+		c++;
+	}
+	if (*c != delimiter) {
+		return NO;
+	}
+	*p = c + 1;
+	*value = v;
+	return YES;
+}
+
+// Number of days since 1970-01-01 of a date in the proleptic
+// gregorian calendar.
+static long TXLDaysSinceEpoch(long year, long month, long day) {
+	year -= month <= 2;
+	long era = (year >= 0 ? year : year - 399) / 400;
+	long yoe = year - era * 400;
+	long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
 
 int spatialsituation_YYINPUT(char* theBuffer, int maxSize, TXLSpatialSituationImporter *compiler) {
 	return [compiler yyinputToBuffer:theBuffer
@@ -49,7 +83,7 @@ int spatialsituation_YYINPUT(char* theBuffer, int maxSize, TXLSpatialSituationIm
 
 @implementation TXLSpatialSituationImporter
 
-@synthesize statementList, context, mo, snapshots, prefixes, compilerError;
+@synthesize statementList, contextURL, mo, snapshots, prefixes, compilerError;
 @synthesize yyscanner, buf, pos, length;
 
 #pragma mark -
@@ -64,6 +98,7 @@ int spatialsituation_YYINPUT(char* theBuffer, int maxSize, TXLSpatialSituationIm
 		self.statementList = [NSMutableArray array];
 	    self.prefixes = [NSMutableDictionary dictionary];
         self.snapshots = [NSMutableArray array];
+        timeZone = [[NSTimeZone localTimeZone] retain];
         
         spatialsituation_set_extra(self, yyscanner);
     }
@@ -74,10 +109,11 @@ int spatialsituation_YYINPUT(char* theBuffer, int maxSize, TXLSpatialSituationIm
 	[buf release];
 	[prefixes release];
 	[snapshots release];
-	[context release];
+	[contextURL release];
 	[statementList release];
 	[mo release];
 	[compilerError release];
+	[timeZone release];
     
     spatialsituation_lex_destroy(yyscanner);
     [super dealloc];
@@ -101,6 +137,79 @@ int spatialsituation_YYINPUT(char* theBuffer, int maxSize, TXLSpatialSituationIm
 	return res;
 }
 
+#pragma mark -
+#pragma mark Timestamps
+
+- (NSDate *)dateFromTimestamp:(const char *)timestamp {
+	
+	// The timestamp has the format of the lexer rule TIMESTAMP
+	// (yyyy-MM-dd'T'HH:mm'Z'). Like the date formatter used before,
+	// the timestamp is interpreted in the local time zone.
+	
+	long year, month, day, hour, minute;
+	const char *p = timestamp;
+	if (!TXLTimestampComponent(&p, '-', &year) ||
+		!TXLTimestampComponent(&p, '-', &month) ||
+		!TXLTimestampComponent(&p, 'T', &day) ||
+		!TXLTimestampComponent(&p, ':', &hour) ||
+		!TXLTimestampComponent(&p, 'Z', &minute)) {
+		return nil;
+	}
+	
+	static const long daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	BOOL leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+	if (month < 1 || month > 12 ||
+		day < 1 || day > daysInMonth[month - 1] + (month == 2 && leap ? 1 : 0) ||
+		hour > 23 || minute > 59) {
+		return nil;
+	}
+	
+	NSTimeInterval t = (NSTimeInterval)(TXLDaysSinceEpoch(year, month, day) * 86400 + hour * 3600 + minute * 60);
+	
+	// The offset of the time zone is looked up at the time in
+	// UTC and corrected, if the offset at the result is different
+	// (e.g., near a daylight saving time transition).
+	NSInteger offset = [timeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSince1970:t]];
+	NSInteger offset_ = [timeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSince1970:t - offset]];
+	
+	return [NSDate dateWithTimeIntervalSince1970:t - offset_];
+}
+
+#pragma mark -
+#pragma mark Context
+
++ (TXLContext *)contextWithURL:(NSURL *)url
+						  error:(NSError **)error {
+	
+	// The method - [TXLManager contextForProtocol:host:path:&error:] create and store only the context components 
+	// which have not been yet stored in the database. After this process the TXLContext object is assigned a valid value fot the primary key.
+	
+	NSString *protocol = url.scheme;
+	NSMutableString *host = [NSMutableString string];
+	
+	if ([url.user length] > 0) {
+		[host appendFormat:@"%@@", url.user];
+	}
+	
+	[host appendString:url.host];
+	
+	if (url.port != 0) {
+		[host appendFormat:@":%d", url.port];
+	}
+	
+	NSMutableArray *pathComponents = [NSMutableArray array];
+	// Remove the "/" path component.
+	for(NSString *component in url.pathComponents) {
+		if (![component isEqualToString:@"/"]) {
+			[pathComponents addObject:component];
+		}
+	}
+	
+	return [[TXLManager sharedManager] contextForProtocol:protocol
+													 host:host
+													 path:pathComponents
+													error:error];
+}
 
 #pragma mark -
 #pragma mark Compile Spatial Situation Expression
@@ -109,6 +218,39 @@ int spatialsituation_YYINPUT(char* theBuffer, int maxSize, TXLSpatialSituationIm
 								   parameters:(NSDictionary *)parameters
 									  options:(NSDictionary *)options
 										error:(NSError **)error {
+	return [self compileSpatialSituationWithData:[expression dataUsingEncoding:NSUTF8StringEncoding]
+									  parameters:parameters
+										 options:options
+										   error:error];
+}
+
++ (NSDictionary *)compileSpatialSituationWithContentsOfFile:(NSString *)path
+												 parameters:(NSDictionary *)parameters
+													options:(NSDictionary *)options
+													  error:(NSError **)error {
+	
+	// The file is mapped into memory and not read as a whole.
+	// The scanner reads the mapped data in chunks (see YY_INPUT),
+	// so that only the pages currently scanned are loaded.
+	// No string representation of the whole file is created.
+	
+	NSData *data = [NSData dataWithContentsOfFile:path
+										  options:NSDataReadingMapped
+											error:error];
+	if (data == nil) {
+		return nil;
+	}
+	
+	return [self compileSpatialSituationWithData:data
+									  parameters:parameters
+										 options:options
+										   error:error];
+}
+
++ (NSDictionary *)compileSpatialSituationWithData:(NSData *)data
+									   parameters:(NSDictionary *)parameters
+										  options:(NSDictionary *)options
+											error:(NSError **)error {
     
 	// The compiler should be reentrant. 
 	// Therefore the FLEX scanner and the BISON parser are used in reentrant mode and
@@ -126,7 +268,7 @@ int spatialsituation_YYINPUT(char* theBuffer, int maxSize, TXLSpatialSituationIm
 	// The FLEX scanner and the BISON parser are used to parse the spatial situation.	
 	// The spatial situation is parsed sequentially. 
 	
-	compiler.buf = [expression dataUsingEncoding:NSUTF8StringEncoding];
+	compiler.buf = data;
 	compiler.length = [compiler.buf length];
 	compiler.pos = 0;
 	
@@ -137,11 +279,28 @@ int spatialsituation_YYINPUT(char* theBuffer, int maxSize, TXLSpatialSituationIm
 	
 	if(parsingResult == 0) {
 		
-		if(compiler.context && compiler.statementList && compiler.statementList ){
+		if(compiler.contextURL && compiler.statementList){
+			
+			// The context is created after the parsing, unless the
+			// caller creates it (e.g., the writer of the manager in
+			// the transaction of the import).
+			
+			if ([[options objectForKey:TXLSpatialSituationImporterDeferContextOption] boolValue]) {
+				return [NSDictionary dictionaryWithObjectsAndKeys:compiler.statementList, @"statement_list",
+																  compiler.mo, @"moving_object",
+																  compiler.contextURL, @"context_url",
+																  nil];
+			}
+			
+			TXLContext *context = [self contextWithURL:compiler.contextURL
+												 error:error];
+			if (context == nil) {
+				return nil;
+			}
 			
 			NSDictionary *dict = [NSDictionary dictionaryWithObjectsAndKeys:compiler.statementList, @"statement_list",
 								  											compiler.mo, @"moving_object",
-								  											compiler.context, @"context",
+								  											context, @"context",
 								  											nil];
 			return dict;	
 			
@@ -0,0 +1,113 @@
+//
+//  TXLBindingArenaTest.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 22.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#import <GHUnit/GHUnit.h>
+
+#import "TXLBindingArena.h"
+#import "TXLInteger.h"
+
+@interface TXLBindingArenaTest : GHTestCase {
+    
+}
+
+@end
+
+@implementation TXLBindingArenaTest
+
+- (void)testAllocateBindings {
+    
+    TXLBindingArena *arena = [TXLBindingArena arena];
+    
+    // vectors are unbound initially and keep their size,
+    // also if they do not fit into the current block
+    for (NSUInteger n = 0; n < 10000; n += 7) {
+        TXLBinding *bindings = [arena bindingsWithNumberOfSlots:n];
+        GHAssertEquals(TXLBindingsCount(bindings), n, nil);
+        for (NSUInteger i = 0; i < n; i++) {
+            GHAssertEquals(bindings[i], (TXLBinding)0, nil);
+            bindings[i] = i + 1;
+        }
+    }
+    
+    TXLBinding *bindings = [arena bindingsWithNumberOfSlots:3];
+    bindings[0] = 4;
+    bindings[2] = 8;
+    
+    TXLBinding *copy = [arena copyOfBindings:bindings];
+    GHAssertTrue(copy != bindings, nil);
+    GHAssertTrue(TXLBindingsEqual(copy, bindings), nil);
+    GHAssertEquals(TXLBindingsHash(copy), TXLBindingsHash(bindings), nil);
+    
+    copy[1] = 5;
+    GHAssertFalse(TXLBindingsEqual(copy, bindings), nil);
+    
+    // vectors of different size are not equal
+    TXLBinding *shorter = [arena bindingsWithNumberOfSlots:2];
+    shorter[0] = 4;
+    GHAssertFalse(TXLBindingsEqual(shorter, bindings), nil);
+}
+
+- (void)testBindingsAsDictionaryKeys {
+    
+    TXLBindingArena *arena = [TXLBindingArena arena];
+    
+    CFMutableDictionaryRef dict = CFDictionaryCreateMutable(NULL, 0, &kTXLBindingsDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+    
+    for (NSUInteger i = 0; i < 100; i++) {
+        TXLBinding *bindings = [arena bindingsWithNumberOfSlots:2];
+        bindings[0] = i % 10;
+        bindings[1] = 1;
+        CFDictionarySetValue(dict, bindings, [NSNumber numberWithUnsignedInteger:i]);
+    }
+    
+    GHAssertEquals((NSUInteger)CFDictionaryGetCount(dict), (NSUInteger)10, nil);
+    
+    TXLBinding *key = [arena bindingsWithNumberOfSlots:2];
+    key[0] = 3;
+    key[1] = 1;
+    GHAssertEqualObjects((id)CFDictionaryGetValue(dict, key), [NSNumber numberWithUnsignedInteger:93], nil);
+    
+    CFRelease(dict);
+}
+
+- (void)testConvertVariables {
+    
+    TXLBindingArena *arena = [TXLBindingArena arena];
+    
+    NSArray *slots = [NSArray arrayWithObjects:[TXLInteger integerWithValue:3], [TXLInteger integerWithValue:7], nil];
+    NSDictionary *vars = [NSDictionary dictionaryWithObjectsAndKeys:
+                          [TXLInteger integerWithValue:42], [TXLInteger integerWithValue:7],
+                          [TXLInteger integerWithValue:1], [TXLInteger integerWithValue:9],
+                          nil];
+    
+    TXLBinding *bindings = [arena bindingsWithVariables:vars slots:slots];
+    GHAssertEquals(bindings[0], (TXLBinding)0, nil);
+    GHAssertEquals(bindings[1], (TXLBinding)42, nil);
+    
+    NSDictionary *result = [TXLBindingArena variablesWithBindings:bindings slots:slots];
+    GHAssertEqualObjects(result, [NSDictionary dictionaryWithObject:[TXLInteger integerWithValue:42]
+                                                             forKey:[TXLInteger integerWithValue:7]], nil);
+}
+
+@end
@@ -33,10 +33,19 @@
 #import "TXLGeometryCollection.h"
 #import "TXLMovingObject.h"
 #import "TXLTerm.h"
+#import "TXLStatement.h"
+#import "TXLRevision.h"
+#import "TXLQuery.h"
+#import "TXLQueryPlan.h"
+#import "TXLSPARQLCompiler.h"
 
 #define SQL(x) {TXLDatabase *database = [[TXLManager sharedManager] database]; NSError *error; NSArray *result = [database executeSQL:x error:&error]; GHAssertNotNil(result, [error localizedDescription]);}
 
-@interface TXLContextSituationDefinitionTest : GHAsyncTestCase {}
+@interface TXLContextSituationDefinitionTest : GHAsyncTestCase {
+    
+    // revision primary key -> primary keys of the changed contexts
+    NSMutableDictionary *changedContexts;
+}
 @property (retain) TXLQueryHandle *qh;
 @end
 
@@ -150,6 +159,9 @@
     }
     self.qh = nil;
     [TXLManager sharedManager].delegate = nil;
+    
+    [changedContexts release];
+    changedContexts = nil;
 }
 
 #pragma mark -
@@ -164,6 +176,22 @@
     [self notify:kGHUnitWaitStatusSuccess];
 }
 
+- (void)didChangeContexts:(NSSet *)ctxs
+               inRevision:(TXLRevision *)rev {
+    if (changedContexts == nil) {
+        return;
+    }
+    
+    NSMutableSet *pks = [NSMutableSet set];
+    for (TXLContext *ctx in ctxs) {
+        [pks addObject:[NSNumber numberWithUnsignedInteger:ctx.primaryKey]];
+    }
+    
+    @synchronized (changedContexts) {
+        [changedContexts setObject:pks forKey:[NSNumber numberWithUnsignedInteger:rev.primaryKey]];
+    }
+}
+
 #pragma mark -
 #pragma mark Test
 
@@ -251,6 +279,330 @@
     GHAssertEqualObjects([rs valuesAtIndex:0], [NSDictionary dictionaryWithObject:[TXLTerm termWithInteger:16] forKey:@"event_id"], nil);
 }
 
+- (void)testDiamondDependency {
+    
+    /*
+     * The definitions A and B read the context base, the definition C
+     * reads the contexts of A and B. An update of base is propagated
+     * level by level: A and B are evaluated once and their situations
+     * are stored in one revision, C is evaluated once afterwards and
+     * its situations are stored in the next revision.
+     */
+    
+    NSError *error;
+    
+    TXLContext *base = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                 host:@"TXLContextSituationDefinitionTest"
+                                                                 path:[NSArray arrayWithObject:@"diamond-base"]
+                                                                error:&error];
+    GHAssertNotNil(base, [error localizedDescription]);
+    
+    TXLContext *ctxA = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                 host:@"TXLContextSituationDefinitionTest"
+                                                                 path:[NSArray arrayWithObject:@"diamond-a"]
+                                                                error:&error];
+    GHAssertNotNil(ctxA, [error localizedDescription]);
+    
+    TXLContext *ctxB = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                 host:@"TXLContextSituationDefinitionTest"
+                                                                 path:[NSArray arrayWithObject:@"diamond-b"]
+                                                                error:&error];
+    GHAssertNotNil(ctxB, [error localizedDescription]);
+    
+    TXLContext *ctxC = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                 host:@"TXLContextSituationDefinitionTest"
+                                                                 path:[NSArray arrayWithObject:@"diamond-c"]
+                                                                error:&error];
+    GHAssertNotNil(ctxC, [error localizedDescription]);
+    
+    GHAssertTrue([ctxA setSituationDefinition:@"PREFIX d: <http://schema.opentxl.org/diamond#> CONSTRUCT { [d:a ?v] . } FROM <txl://TXLContextSituationDefinitionTest/diamond-base> WHERE { [d:value ?v] . }"
+                                  withOptions:nil
+                                        error:&error], [error localizedDescription]);
+    
+    GHAssertTrue([ctxB setSituationDefinition:@"PREFIX d: <http://schema.opentxl.org/diamond#> CONSTRUCT { [d:b ?v] . } FROM <txl://TXLContextSituationDefinitionTest/diamond-base> WHERE { [d:value ?v] . }"
+                                  withOptions:nil
+                                        error:&error], [error localizedDescription]);
+    
+    // If C were evaluated after A or B alone, it would store a
+    // situation for each of these evaluations.
+    
+    GHAssertTrue([ctxC setSituationDefinition:@"PREFIX d: <http://schema.opentxl.org/diamond#> CONSTRUCT { [d:c ?v] . } FROM <txl://TXLContextSituationDefinitionTest/diamond-a> FROM <txl://TXLContextSituationDefinitionTest/diamond-b> WHERE { { [d:a ?v] . } UNION { [d:b ?v] . } }"
+                                  withOptions:nil
+                                        error:&error], [error localizedDescription]);
+    
+    // Wait for end of processing
+    if ([TXLManager sharedManager].processing) {
+        [self prepare];
+        [self waitForStatus:kGHUnitWaitStatusSuccess
+                    timeout:120.0];
+    }
+    
+    changedContexts = [[NSMutableDictionary alloc] init];
+    
+    __block NSUInteger baseRevision = 0;
+    [base updateWithStatements:[NSArray arrayWithObject:[TXLStatement statementWithSubject:[TXLTerm termWithBlankNode:@"x"]
+                                                                                 predicate:[TXLTerm termWithIRI:@"http://schema.opentxl.org/diamond#value"]
+                                                                                    object:[TXLTerm termWithInteger:1]]]
+               completionBlock:^(TXLRevision *r, NSError *error){
+                   @synchronized (self) {
+                       baseRevision = r.primaryKey;
+                   }
+               }];
+    
+    // wait until the update has been propagated through all levels
+    
+    BOOL finished = NO;
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:120.0];
+    while (!finished && [timeout timeIntervalSinceNow] > 0) {
+        [NSThread sleepForTimeInterval:0.1];
+        @synchronized (self) {
+            finished = baseRevision != 0 && ![TXLManager sharedManager].processing;
+        }
+    }
+    GHAssertTrue(finished, @"The update has not been propagated.");
+    
+    NSNumber *pkA = [NSNumber numberWithUnsignedInteger:ctxA.primaryKey];
+    NSNumber *pkB = [NSNumber numberWithUnsignedInteger:ctxB.primaryKey];
+    NSNumber *pkC = [NSNumber numberWithUnsignedInteger:ctxC.primaryKey];
+    
+    NSMutableArray *revisionsOfA = [NSMutableArray array];
+    NSMutableArray *revisionsOfB = [NSMutableArray array];
+    NSMutableArray *revisionsOfC = [NSMutableArray array];
+    
+    @synchronized (changedContexts) {
+        for (NSNumber *rev in changedContexts) {
+            NSSet *pks = [changedContexts objectForKey:rev];
+            if ([pks containsObject:pkA]) [revisionsOfA addObject:rev];
+            if ([pks containsObject:pkB]) [revisionsOfB addObject:rev];
+            if ([pks containsObject:pkC]) [revisionsOfC addObject:rev];
+        }
+    }
+    
+    GHTestLog(@"Changed contexts: %@", changedContexts);
+    
+    // one revision for the level of A and B, one for the level of C
+    
+    GHAssertEquals([revisionsOfA count], (NSUInteger)1, nil);
+    GHAssertEquals([revisionsOfB count], (NSUInteger)1, nil);
+    GHAssertEquals([revisionsOfC count], (NSUInteger)1, nil);
+    
+    GHAssertEqualObjects([revisionsOfA objectAtIndex:0], [revisionsOfB objectAtIndex:0], nil);
+    GHAssertTrue([[revisionsOfA objectAtIndex:0] unsignedIntegerValue] > baseRevision, nil);
+    GHAssertTrue([[revisionsOfC objectAtIndex:0] unsignedIntegerValue] > [[revisionsOfA objectAtIndex:0] unsignedIntegerValue], nil);
+    
+    GHAssertEquals([changedContexts count], (NSUInteger)3, nil);
+}
+
+- (void)testRemoveAndSetAgain {
+    
+    /*
+     * The contexts created by a situation definition are cleared when the
+     * definition is removed. If the definition is set again right away, the
+     * situations of its first evaluation are stored in the same contexts
+     * (#1, ...). They are stored after the clear and are kept.
+     */
+    
+    NSError *error;
+    
+    TXLContext *base = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                 host:@"TXLContextSituationDefinitionTest"
+                                                                 path:[NSArray arrayWithObject:@"reset-base"]
+                                                                error:&error];
+    GHAssertNotNil(base, [error localizedDescription]);
+    
+    TXLContext *ctx = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                host:@"TXLContextSituationDefinitionTest"
+                                                                path:[NSArray arrayWithObject:@"reset"]
+                                                               error:&error];
+    GHAssertNotNil(ctx, [error localizedDescription]);
+    
+    [self prepare];
+    [base updateWithStatements:[NSArray arrayWithObject:[TXLStatement statementWithSubject:[TXLTerm termWithBlankNode:@"x"]
+                                                                                 predicate:[TXLTerm termWithIRI:@"http://schema.opentxl.org/reset#value"]
+                                                                                    object:[TXLTerm termWithInteger:1]]]
+               completionBlock:^(TXLRevision *r, NSError *e){
+                   [self notify:kGHUnitWaitStatusSuccess];
+               }];
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:60.0];
+    
+    NSString *definition = @"PREFIX r: <http://schema.opentxl.org/reset#> CONSTRUCT { [r:situation ?v] . } FROM <txl://TXLContextSituationDefinitionTest/reset-base> WHERE { [r:value ?v] . }";
+    
+    self.qh = [[TXLManager sharedManager] registerQueryWithName:@"TXLContextSituationDefinitionTest_reset"
+                                                     expression:@"PREFIX r: <http://schema.opentxl.org/reset#> SELECT ?v FROM <txl://TXLContextSituationDefinitionTest/reset/> WHERE { [r:situation ?v] . }"
+                                                     parameters:nil
+                                                        options:nil
+                                                          error:&error];
+    GHAssertNotNil(self.qh, [error localizedDescription]);
+    
+    for (int i = 0; i < 2; i++) {
+        
+        if (i > 0) {
+            [ctx removeSituationDefinition];
+        }
+        
+        GHAssertTrue([ctx setSituationDefinition:definition
+                                     withOptions:nil
+                                           error:&error], [error localizedDescription]);
+        
+        // wait until the situations have been stored and
+        // the query has been evaluated
+        
+        NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:120.0];
+        do {
+            [NSThread sleepForTimeInterval:0.5];
+        } while ([TXLManager sharedManager].processing && [timeout timeIntervalSinceNow] > 0);
+        GHAssertFalse([TXLManager sharedManager].processing, @"The definition has not been evaluated.");
+        
+        TXLResultSet *rs = [self.qh resultSetForRevision:self.qh.lastEvaluation];
+        GHAssertNotNil(rs, nil);
+        GHAssertEquals([rs count], (NSUInteger)1, @"Evaluation %d", i);
+        GHAssertEqualObjects([rs valuesAtIndex:0], [NSDictionary dictionaryWithObject:[TXLTerm termWithInteger:1] forKey:@"v"], nil);
+    }
+}
+
+- (void)testConstructTemplateInstantiation {
+    
+    /*
+     * The construct template is resolved once by the plan of the query.
+     * Each result gets its own child context and its own blank nodes,
+     * which are shared by the triples of this result. The situations of
+     * all results are stored in one revision.
+     */
+    
+    NSError *error;
+    
+    NSString *definition = @"PREFIX c: <http://schema.opentxl.org/construct#> CONSTRUCT { _:e c:value ?v . _:e c:source ?s . _:e c:kind c:Event . } FROM <txl://TXLContextSituationDefinitionTest/construct-base> WHERE { ?s c:value ?v . }";
+    
+    // the resolved template
+    
+    TXLQuery *query = [TXLSPARQLCompiler compileQueryWithExpression:definition
+                                                         parameters:nil
+                                                            options:nil
+                                                              error:&error];
+    GHAssertNotNil(query, [error localizedDescription]);
+    
+    TXLQueryPlan *plan = [TXLQueryPlan planForQuery:query];
+    GHAssertTrue(plan.constructQuery, nil);
+    GHAssertEquals([plan.constructTemplate count], (NSUInteger)3, nil);
+    GHAssertEquals(plan.numberOfTemplateBlankNodes, (NSUInteger)1, nil);
+    
+    NSUInteger kind = [[TXLTerm termWithIRI:@"http://schema.opentxl.org/construct#kind"] save:&error].primaryKey;
+    NSUInteger event = [[TXLTerm termWithIRI:@"http://schema.opentxl.org/construct#Event"] save:&error].primaryKey;
+    
+    for (NSUInteger i = 0; i < [plan.constructTemplate count]; i++) {
+        TXLTemplateTriple triple = plan.templateTriples[i];
+        
+        // the subject is the same blank node in all triples
+        GHAssertEquals(triple.subject.blankNode, (NSInteger)0, nil);
+        GHAssertTrue(triple.predicate.term > 0, nil);
+        
+        if (triple.predicate.term == kind) {
+            GHAssertEquals(triple.object.term, event, nil);
+        } else {
+            GHAssertEquals(triple.object.term, (NSUInteger)0, nil);
+            GHAssertTrue(triple.object.variable > 0, nil);
+            GHAssertEquals(triple.object.blankNode, (NSInteger)-1, nil);
+        }
+    }
+    
+    // the instantiated template
+    
+    TXLContext *base = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                 host:@"TXLContextSituationDefinitionTest"
+                                                                 path:[NSArray arrayWithObject:@"construct-base"]
+                                                                error:&error];
+    GHAssertNotNil(base, [error localizedDescription]);
+    
+    TXLContext *ctx = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                host:@"TXLContextSituationDefinitionTest"
+                                                                path:[NSArray arrayWithObject:@"construct"]
+                                                               error:&error];
+    GHAssertNotNil(ctx, [error localizedDescription]);
+    
+    NSUInteger numberOfResults = 3;
+    
+    NSMutableArray *statements = [NSMutableArray array];
+    for (NSUInteger i = 1; i <= numberOfResults; i++) {
+        [statements addObject:[TXLStatement statementWithSubject:[TXLTerm termWithIRI:[NSString stringWithFormat:@"http://schema.opentxl.org/construct#s%lu", (unsigned long)i]]
+                                                       predicate:[TXLTerm termWithIRI:@"http://schema.opentxl.org/construct#value"]
+                                                          object:[TXLTerm termWithInteger:i]]];
+    }
+    
+    [self prepare];
+    [base updateWithStatements:statements
+               completionBlock:^(TXLRevision *r, NSError *e){
+                   [self notify:kGHUnitWaitStatusSuccess];
+               }];
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:60.0];
+    
+    changedContexts = [[NSMutableDictionary alloc] init];
+    
+    GHAssertTrue([ctx setSituationDefinition:definition
+                                 withOptions:nil
+                                       error:&error], [error localizedDescription]);
+    
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:120.0];
+    do {
+        [NSThread sleepForTimeInterval:0.5];
+    } while ([TXLManager sharedManager].processing && [timeout timeIntervalSinceNow] > 0);
+    GHAssertFalse([TXLManager sharedManager].processing, @"The definition has not been evaluated.");
+    
+    // one child context for each result, all
+    // of them changed in the same revision
+    
+    NSSet *children = [ctx subcontextsMatchingPattern:@"#*"];
+    GHAssertEquals([children count], numberOfResults, nil);
+    
+    NSMutableSet *revisionsOfChildren = [NSMutableSet set];
+    @synchronized (changedContexts) {
+        for (NSNumber *rev in changedContexts) {
+            for (TXLContext *child in children) {
+                if ([[changedContexts objectForKey:rev] containsObject:[NSNumber numberWithUnsignedInteger:child.primaryKey]]) {
+                    [revisionsOfChildren addObject:rev];
+                }
+            }
+        }
+    }
+    GHAssertEquals([revisionsOfChildren count], (NSUInteger)1, nil);
+    
+    // the triples of a result share their blank node
+    
+    self.qh = [[TXLManager sharedManager] registerQueryWithName:@"TXLContextSituationDefinitionTest_construct"
+                                                     expression:@"PREFIX c: <http://schema.opentxl.org/construct#> SELECT ?e ?v ?s ?k FROM <txl://TXLContextSituationDefinitionTest/construct/> WHERE { ?e c:value ?v . ?e c:source ?s . ?e c:kind ?k . }"
+                                                     parameters:nil
+                                                        options:nil
+                                                          error:&error];
+    GHAssertNotNil(self.qh, [error localizedDescription]);
+    
+    timeout = [NSDate dateWithTimeIntervalSinceNow:120.0];
+    while (self.qh.lastEvaluation == nil && [timeout timeIntervalSinceNow] > 0) {
+        [NSThread sleepForTimeInterval:0.1];
+    }
+    
+    TXLResultSet *rs = [self.qh resultSetForRevision:self.qh.lastEvaluation];
+    GHAssertNotNil(rs, nil);
+    GHAssertEquals([rs count], numberOfResults, nil);
+    
+    NSMutableSet *blankNodes = [NSMutableSet set];
+    NSMutableSet *values = [NSMutableSet set];
+    for (NSUInteger i = 0; i < [rs count]; i++) {
+        NSDictionary *row = [rs valuesAtIndex:i];
+        NSNumber *v = [[row objectForKey:@"v"] numberValue];
+        
+        GHAssertEqualStrings([[row objectForKey:@"s"] iriValue], ([NSString stringWithFormat:@"http://schema.opentxl.org/construct#s%@", v]), nil);
+        GHAssertEqualStrings([[row objectForKey:@"k"] iriValue], @"http://schema.opentxl.org/construct#Event", nil);
+        
+        [blankNodes addObject:[NSNumber numberWithUnsignedInteger:[[row objectForKey:@"e"] primaryKey]]];
+        [values addObject:v];
+    }
+    
+    // a blank node for each result
+    GHAssertEquals([blankNodes count], numberOfResults, nil);
+    GHAssertEquals([values count], numberOfResults, nil);
+}
+
 #pragma mark -
 #pragma mark Query Handle Delegate 
 
@@ -194,6 +194,42 @@
     GHTestLog(@"%@", [context subcontextsMatchingPattern:@"*"]);
 }
 
+- (void)testChildrenWithNames {
+    NSError *error;
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"example.com"
+                                                                    path:[NSArray arrayWithObject:@"situations"]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    // an existing child and two missing ones
+    TXLContext *existing = [context childWithName:@"#1"];
+    GHAssertNotNil(existing, nil);
+    
+    NSArray *names = [NSArray arrayWithObjects:@"#1", @"#2", @"#3", nil];
+    NSDictionary *children = [context childrenWithNames:names];
+    GHAssertEquals([children count], (NSUInteger)3, nil);
+    GHAssertEquals([[children objectForKey:@"#1"] primaryKey], existing.primaryKey, nil);
+    
+    // the same contexts as created one by one
+    for (NSString *name in names) {
+        TXLContext *child = [children objectForKey:name];
+        GHAssertNotNil(child, @"Missing child '%@'.", name);
+        GHAssertEqualStrings(child.name, [NSString stringWithFormat:@"txl://example.com/situations/%@", name], nil);
+        GHAssertEquals(child.primaryKey, [context childWithName:name].primaryKey, nil);
+    }
+    
+    GHAssertEquals([[context subcontextsMatchingPattern:@"#*"] count], (NSUInteger)3, nil);
+    
+    // the children are only created once
+    children = [context childrenWithNames:names];
+    GHAssertEquals([children count], (NSUInteger)3, nil);
+    GHAssertEquals([[context subcontextsMatchingPattern:@"#*"] count], (NSUInteger)3, nil);
+    
+    GHAssertEquals([[context childrenWithNames:[NSArray array]] count], (NSUInteger)0, nil);
+}
+
 - (void)testIsDescendantOf {
     NSError *error;
     TXLContext *ctx1 = [[TXLManager sharedManager] contextForProtocol:@"txl"
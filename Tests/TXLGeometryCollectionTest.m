@@ -24,6 +24,8 @@
 #import <GHUnit/GHUnit.h>
 
 #import "TXLGeometryCollection.h"
+#import "TXLPreparedGeometryCache.h"
+#import "TXLPointKernels.h"
 #import "TXLPolygon.h"
 #import "TXLRing.h"
 #import "TXLPoint.h"
@@ -308,6 +310,153 @@
     GHAssertEqualObjects([NSArray arrayWithObject:polyC], result.polygons, nil);
 }
 
+- (void)testBoundingBoxRejection {
+    
+    TXLGeometryCollection *rect = [TXLGeometryCollection geometryFromWKT:@"POLYGON((10 10, 20 10, 20 20, 10 20, 10 10))"];
+    TXLGeometryCollection *far = [TXLGeometryCollection geometryFromWKT:@"LINESTRING(30 30, 40 35)"];
+    TXLGeometryCollection *inside = [TXLGeometryCollection geometryFromWKT:@"LINESTRING(12 12, 18 15)"];
+    TXLGeometryCollection *boundary = [TXLGeometryCollection geometryFromWKT:@"POINT(10 15)"];
+    
+    NSUInteger tests = [TXLGeometryCollection numberOfBoundingBoxTests];
+    NSUInteger rejections = [TXLGeometryCollection numberOfBoundingBoxRejections];
+    
+    // decided by the bounding boxes
+    GHAssertFalse([rect intersects:far], nil);
+    GHAssertTrue([rect disjoint:far], nil);
+    GHAssertTrue([[rect intersection:far] isEmpty], nil);
+    GHAssertTrue([rect intersects:inside], nil);
+    GHAssertTrue([rect contains:inside], nil);
+    GHAssertTrue([inside within:rect], nil);
+    GHAssertEqualObjects([rect intersection:inside], inside, nil);
+    
+    GHAssertEquals([TXLGeometryCollection numberOfBoundingBoxTests] - tests, (NSUInteger)7, nil);
+    GHAssertEquals([TXLGeometryCollection numberOfBoundingBoxRejections] - rejections, (NSUInteger)7, nil);
+    
+    // a point on the boundary is not contained
+    GHAssertTrue([rect intersects:boundary], nil);
+    GHAssertFalse([rect contains:boundary], nil);
+    GHAssertFalse([far contains:inside], nil);
+}
+
+- (void)testPreparedGeometryCache {
+    
+    // polygon with 32 vertices approximating a circle
+    NSMutableString *wkt = [NSMutableString stringWithString:@"POLYGON(("];
+    for (int i = 0; i < 32; i++) {
+        [wkt appendFormat:@"%f %f, ", 10 * cos(i * M_PI / 16), 10 * sin(i * M_PI / 16)];
+    }
+    [wkt appendString:@"10 0))"];
+    
+    TXLGeometryCollection *circle = [TXLGeometryCollection geometryFromWKT:wkt];
+    TXLGeometryCollection *sameCircle = [TXLGeometryCollection geometryFromWKT:wkt];
+    TXLGeometryCollection *inside = [TXLGeometryCollection geometryFromWKT:@"POINT(3 4)"];
+    TXLGeometryCollection *outside = [TXLGeometryCollection geometryFromWKT:@"POINT(9 9)"];
+    
+    TXLPreparedGeometryCache *cache = [TXLPreparedGeometryCache sharedCache];
+    [cache removeAllPreparedGeometries];
+    
+    NSUInteger hits = cache.numberOfHits;
+    NSUInteger misses = cache.numberOfMisses;
+    
+    GHAssertTrue([circle intersects:inside], nil);
+    GHAssertTrue([circle contains:inside], nil);
+    GHAssertTrue([inside within:sameCircle], nil);
+    GHAssertFalse([outside intersects:sameCircle], nil);
+    GHAssertTrue([[circle intersection:outside] isEmpty], nil);
+    GHAssertEqualObjects([sameCircle intersection:inside], inside, nil);
+    
+    // equal geometries share one prepared geometry
+    GHAssertEquals(cache.numberOfPreparedGeometries, (NSUInteger)1, nil);
+    GHAssertEquals(cache.numberOfMisses - misses, (NSUInteger)1, nil);
+    GHAssertTrue(cache.numberOfHits - hits >= 5, nil);
+    
+    // a budget of 0 removes the prepared geometries and disables the cache
+    NSUInteger budget = cache.memoryBudget;
+    cache.memoryBudget = 0;
+    GHAssertEquals(cache.numberOfPreparedGeometries, (NSUInteger)0, nil);
+    GHAssertEquals(cache.usedMemory, (NSUInteger)0, nil);
+    GHAssertTrue([circle contains:inside], nil);
+    GHAssertFalse([circle contains:outside], nil);
+    GHAssertEquals(cache.numberOfPreparedGeometries, (NSUInteger)0, nil);
+    cache.memoryBudget = budget;
+}
+
+- (void)testPointKernels {
+    
+    // concave polygon with a hole and a rectangle
+    const char *wkts[] = {
+        "POLYGON((0 0, 10 0, 10 10, 5 4, 0 10, 0 0), (2 1, 4 1, 4 3, 2 3, 2 1))",
+        "POLYGON((1 1, 9 1, 9 8, 1 8, 1 1))"
+    };
+    
+    for (int w = 0; w < 2; w++) {
+        gaiaGeomCollPtr polygon = gaiaParseWkt((const unsigned char *)wkts[w], -1);
+        gaiaMbrGeometry(polygon);
+        
+        NSUInteger decided = 0;
+        NSUInteger tested = 0;
+        
+        // points on a grid (hitting vertices and segments) and random points
+        srand(42);
+        for (int i = 0; i < 1000; i++) {
+            double x, y;
+            if (i < 625) {
+                x = -1 + (i % 25) * 0.5;
+                y = -1 + (i / 25) * 0.5;
+            } else {
+                x = -1 + 12.0 * rand() / RAND_MAX;
+                y = -1 + 12.0 * rand() / RAND_MAX;
+            }
+            
+            gaiaGeomCollPtr point = gaiaAllocGeomColl();
+            gaiaAddPointToGeomColl(point, x, y);
+            gaiaMbrGeometry(point);
+            
+            int intersects = TXLPointKernelIntersects(point, NO, polygon, NO);
+            int contains = TXLPointKernelContains(polygon, NO, point);
+            int within = TXLPointKernelContains(point, NO, polygon);
+            gaiaGeomCollPtr intersection = TXLPointKernelIntersection(polygon, NO, point, NO);
+            
+            tested++;
+            if (intersects >= 0) {
+                decided++;
+                GHAssertEquals(intersects, gaiaGeomCollIntersects(point, polygon), @"POINT(%f %f)", x, y);
+            }
+            if (contains >= 0) {
+                GHAssertEquals(contains, gaiaGeomCollContains(polygon, point), @"POINT(%f %f)", x, y);
+            }
+            if (intersection) {
+                GHAssertEquals(gaiaIsEmpty(intersection) == 0, gaiaGeomCollIntersects(point, polygon) == 1, @"POINT(%f %f)", x, y);
+                gaiaFreeGeomColl(intersection);
+            }
+            GHAssertEquals(within, 0, nil);
+            
+            // a rectangle is located with its bounding box
+            if (w == 1) {
+                GHAssertEquals(TXLPointKernelIntersects(point, NO, polygon, YES), gaiaGeomCollIntersects(point, polygon), nil);
+                GHAssertEquals(TXLPointKernelContains(polygon, YES, point), gaiaGeomCollContains(polygon, point), nil);
+            }
+            
+            gaiaFreeGeomColl(point);
+        }
+        
+        // only points on the segments (not on vertices or
+        // horizontal segments) are left to GEOS
+        GHAssertTrue(decided > tested * 4 / 5, nil);
+        
+        gaiaFreeGeomColl(polygon);
+    }
+    
+    // points and multipoints
+    TXLGeometryCollection *a = [TXLGeometryCollection geometryFromWKT:@"MULTIPOINT(1 1, 2 2, 3 3)"];
+    TXLGeometryCollection *b = [TXLGeometryCollection geometryFromWKT:@"MULTIPOINT(2 2, 3 3)"];
+    TXLGeometryCollection *c = [TXLGeometryCollection geometryFromWKT:@"POINT(1.5 1.5)"];
+    GHAssertTrue([a contains:b], nil);
+    GHAssertFalse([b contains:a], nil);
+    GHAssertFalse([a intersects:c], nil);
+    GHAssertEqualObjects([a intersection:b], b, nil);
+}
+
 - (void)testEqual {
     GHAssertEqualObjects([TXLGeometryCollection geometryFromWKT:@"POLYGON((4 4, 4 2, 4 1, 1 1, 1 4, 2 4, 4 4))"],
                          [TXLGeometryCollection geometryFromWKT:@"POLYGON((1 1, 4 1, 4 4, 1 4, 1 1))"],
@@ -318,4 +467,54 @@
     GHTestLog(@"%@", [[TXLGeometryCollection geometryFromWKT:@"LINESTRING (6 6, 6 1)"] union:[TXLGeometryCollection geometryFromWKT:@"LINESTRING (4 3, 6 3)"]]);
 }
 
+- (void)testConcurrentOperations {
+    
+    // Each thread calls GEOS with its own context. The relations
+    // and operations computed concurrently are the same as the ones
+    // computed on this thread.
+    
+    TXLGeometryCollection *square = [TXLGeometryCollection geometryFromWKT:@"POLYGON((10 10, 20 10, 20 20, 10 20, 10 10))"];
+    
+    size_t count = 64;
+    NSMutableArray *geometries = [NSMutableArray arrayWithCapacity:count];
+    for (size_t i = 0; i < count; i++) {
+        double offset = 5 + 0.2 * i;
+        [geometries addObject:[TXLGeometryCollection geometryFromWKT:[NSString stringWithFormat:@"POLYGON((%f %f, %f %f, %f %f, %f %f))", offset, offset, offset + 8, offset, offset, offset + 8, offset, offset]]];
+    }
+    
+    NSMutableArray *expected = [NSMutableArray arrayWithCapacity:count];
+    for (TXLGeometryCollection *g in geometries) {
+        [expected addObject:[NSArray arrayWithObjects:
+                             [NSNumber numberWithBool:[square overlaps:g]],
+                             [NSNumber numberWithBool:[square touches:g]],
+                             [square intersection:g],
+                             [square union:g],
+                             [square difference:g],
+                             nil]];
+    }
+    
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:count];
+    for (size_t i = 0; i < count; i++) {
+        [results addObject:[NSNull null]];
+    }
+    
+    dispatch_apply(count * 4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i){
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        TXLGeometryCollection *g = [geometries objectAtIndex:i % count];
+        NSArray *result = [NSArray arrayWithObjects:
+                           [NSNumber numberWithBool:[square overlaps:g]],
+                           [NSNumber numberWithBool:[square touches:g]],
+                           [square intersection:g],
+                           [square union:g],
+                           [square difference:g],
+                           nil];
+        @synchronized (results) {
+            [results replaceObjectAtIndex:i % count withObject:result];
+        }
+        [pool drain];
+    });
+    
+    GHAssertEqualObjects(results, expected, nil);
+}
+
 @end
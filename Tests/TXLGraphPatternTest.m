@@ -32,6 +32,11 @@
 #import "TXLRevision.h"
 #import "TXLSPARQLCompiler.h"
 #import "TXLQuery.h"
+#import "TXLQueryPlan.h"
+#import "TXLBindingArena.h"
+#import "TXLMovingObject.h"
+#import "TXLMovingObjectSequence.h"
+#import "TXLGeometryCollection.h"
 
 #define SQL(x) {TXLDatabase *database = [[TXLManager sharedManager] database]; NSError *error; NSArray *result = [database executeSQL:x error:&error]; GHAssertNotNil(result, [error localizedDescription]);}
 
@@ -48,6 +53,17 @@
 - (TXLGraphPattern *)buildQueryPattern6;
 - (TXLGraphPattern *)buildQueryPattern7;
 - (TXLGraphPattern *)buildQueryPattern8;
+- (TXLGraphPattern *)buildQueryPattern9;
+
+- (NSArray *)resultsOfQueryWithExpression:(NSString *)expression
+                                inContext:(TXLContext *)context
+                                   window:(TXLMovingObjectSequence *)mos;
+- (NSSet *)valuesOfResults:(NSArray *)results;
+
+- (NSSet *)resultsOfPlan:(TXLQueryPlan *)plan
+               inContext:(TXLContext *)context;
+- (NSSet *)resultsOfPatternOfQuery:(TXLQuery *)query
+                         inContext:(TXLContext *)context;
 
 @end
 
@@ -690,6 +706,27 @@
     
 }
 
+- (TXLGraphPattern *)buildQueryPattern9 {
+    
+    /*
+     * Query Pattern: { [m:temperature ?temp]. FILTER (?temp > 10) }
+     */
+    
+    NSError *error;
+    
+    TXLQuery *query = [TXLSPARQLCompiler compileQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?temp FROM <txl://weather.situmet.at> WHERE { [m:temperature ?temp]. FILTER (?temp > 10) }" 
+                                                         parameters:nil 
+                                                            options:nil 
+                                                              error:&error];
+    
+    if (query == nil) {
+        [NSException raise:@"TXLGraphPatternTestException" format:@"Could not compile query: %@", [error localizedDescription]];
+    }
+    
+    return [query queryPattern];
+    
+}
+
 - (TXLGraphPattern *)buildQueryPattern2 {
     
     /*
@@ -2549,4 +2586,463 @@
     
 }
 
+- (void)testEvaluateQueryPattern9WithFilter {
+    
+    // the filter of the pattern restricts the values of the variable temp,
+    // the comparison is evaluated by the database while matching the triple pattern
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLGraphPattern *graphPattern = [self buildQueryPattern9];
+    
+    TXLContext *context1 = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                     host:@"weather"
+                                                                     path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                    error:&error];
+    GHAssertNotNil(context1, [error localizedDescription]);
+    
+    TXLRevision *rev = [[TXLManager sharedManager] headRevision];
+    
+    NSMutableArray *results = [NSMutableArray array];
+    
+    BOOL found = [graphPattern evaluatePatternWithVariables:[NSDictionary dictionary]
+                                                 inContexts:[NSArray arrayWithObject:context1]
+                                                     window:nil
+                                                forRevision:rev
+                                              resultHandler:^(NSDictionary *vars, TXLMovingObjectSequence *mos) {
+                                                  [results addObject:vars];
+                                              }];
+    
+    GHAssertTrue(found, @"Evaluating the query pattern should conclude into 1 result - but the return value indicates that no result was found!");
+    GHAssertTrue([results count] == 1, @"1 result should be found - but there were (%d results) found!", [results count]);
+    NSMutableArray *temperature = [NSMutableArray array];
+    for (TXLInteger *val in [[results lastObject] allValues]) {
+        NSNumber *temp = [[TXLTerm termWithPrimaryKey:[val integerValue]] numberValue];
+        if (temp != nil) {
+            [temperature addObject:temp];
+        }
+    }
+    GHAssertEqualObjects(temperature, [NSArray arrayWithObject:[NSNumber numberWithDouble:12.0]], nil);
+}
+
+#pragma mark -
+#pragma mark Filter Expressions
+
+- (NSArray *)resultsOfQueryWithExpression:(NSString *)expression
+                                inContext:(TXLContext *)context
+                                   window:(TXLMovingObjectSequence *)mos {
+    
+    NSError *error;
+    
+    TXLQuery *query = [TXLSPARQLCompiler compileQueryWithExpression:expression
+                                                         parameters:nil
+                                                            options:nil
+                                                              error:&error];
+    
+    if (query == nil) {
+        [NSException raise:@"TXLGraphPatternTestException" format:@"Could not compile query: %@", [error localizedDescription]];
+    }
+    
+    NSMutableArray *results = [NSMutableArray array];
+    
+    [[query queryPattern] evaluatePatternWithVariables:[NSDictionary dictionary]
+                                            inContexts:[NSArray arrayWithObject:context]
+                                                window:mos
+                                           forRevision:[[TXLManager sharedManager] headRevision]
+                                         resultHandler:^(NSDictionary *vars, TXLMovingObjectSequence *mos) {
+                                             [results addObject:vars];
+                                         }];
+    
+    return results;
+}
+
+- (NSSet *)valuesOfResults:(NSArray *)results {
+    
+    // the numbers and literals bound in the results
+    
+    NSMutableSet *values = [NSMutableSet set];
+    for (NSDictionary *vars in results) {
+        for (TXLInteger *val in [vars allValues]) {
+            TXLTerm *term = [TXLTerm termWithPrimaryKey:[val integerValue]];
+            if ([term numberValue] != nil) {
+                [values addObject:[term numberValue]];
+            } else if ([term isType:kTXLTermTypePlainLiteral]) {
+                [values addObject:[term literalValue]];
+            }
+        }
+    }
+    return values;
+}
+
+- (void)testFilterComparisonWithoutWhitespace {
+    
+    // the '<' in front of a variable is an operator inside of a filter
+    // and not the beginning of an IRI
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"weather"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    NSArray *results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?a ?b WHERE { [m:temperature ?a]. [m:temperature ?b]. FILTER(?a<?b&&?b>?a) }"
+                                                inContext:context
+                                                   window:nil];
+    
+    GHAssertTrue([results count] == 1, @"1 result should be found - but there were (%d results) found!", [results count]);
+    GHAssertEqualObjects([self valuesOfResults:results], ([NSSet setWithObjects:[NSNumber numberWithDouble:10.0], [NSNumber numberWithDouble:12.0], nil]), nil);
+    
+    // an IRI is still recognized in a filter
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?a WHERE { [m:temperature ?a]. FILTER <http://schema.opentxl.org/filter#after>(\"2011-01-01T00:00:00Z\") }"
+                                       inContext:context
+                                          window:nil];
+    
+    GHAssertTrue([results count] == 0, @"No result should be found - but there were (%d results) found!", [results count]);
+}
+
+- (void)testFilterDateComparison {
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"weather"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    // 2011-03-02T00:00:00+01:00 is 2011-03-01T23:00:00Z
+    
+    NSArray *results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX xsd: <http://www.w3.org/2001/XMLSchema#> SELECT ?t WHERE { [m:temperature ?t]. FILTER (\"2011-03-01T22:30:00Z\"^^xsd:dateTime < \"2011-03-02T00:00:00+01:00\"^^xsd:dateTime) }"
+                                                inContext:context
+                                                   window:nil];
+    GHAssertTrue([results count] == 2, @"2 results should be found - but there were (%d results) found!", [results count]);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX xsd: <http://www.w3.org/2001/XMLSchema#> SELECT ?t WHERE { [m:temperature ?t]. FILTER (\"2011-03-01T23:30:00.5Z\"^^xsd:dateTime < \"2011-03-02T00:00:00+01:00\"^^xsd:dateTime) }"
+                                       inContext:context
+                                          window:nil];
+    GHAssertTrue([results count] == 0, @"No result should be found - but there were (%d results) found!", [results count]);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX xsd: <http://www.w3.org/2001/XMLSchema#> SELECT ?t WHERE { [m:temperature ?t]. FILTER (\"2011-03-01T23:00:00Z\"^^xsd:dateTime = \"2011-03-02T00:00:00+0100\"^^xsd:dateTime) }"
+                                       inContext:context
+                                          window:nil];
+    GHAssertTrue([results count] == 2, @"2 results should be found - but there were (%d results) found!", [results count]);
+}
+
+- (void)testFilterWindowFunctions {
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"weather"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    // the window of the matches is given by the
+    // window passed to the evaluation
+    
+    TXLMovingObjectSequence *interval = [TXLMovingObjectSequence sequenceWithMovingObject:
+                                         [TXLMovingObject movingObjectWithBegin:[NSDate dateWithTimeIntervalSince1970:1293840000] // 2011-01-01
+                                                                            end:[NSDate dateWithTimeIntervalSince1970:1293926400]]]; // 2011-01-02
+    
+    NSArray *results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?t WHERE { [m:temperature ?t]. FILTER f:before(\"2011-01-03T00:00:00Z\") }"
+                                                inContext:context
+                                                   window:interval];
+    GHAssertTrue([results count] == 2, @"2 results should be found - but there were (%d results) found!", [results count]);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?t WHERE { [m:temperature ?t]. FILTER f:before(\"2011-01-01T12:00:00Z\") }"
+                                       inContext:context
+                                          window:interval];
+    GHAssertTrue([results count] == 0, @"No result should be found - but there were (%d results) found!", [results count]);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?t WHERE { [m:temperature ?t]. FILTER f:after(\"2010-12-31\") }"
+                                       inContext:context
+                                          window:interval];
+    GHAssertTrue([results count] == 2, @"2 results should be found - but there were (%d results) found!", [results count]);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?t WHERE { [m:temperature ?t]. FILTER f:after(\"2011-01-01T12:00:00Z\") }"
+                                       inContext:context
+                                          window:interval];
+    GHAssertTrue([results count] == 0, @"No result should be found - but there were (%d results) found!", [results count]);
+    
+    // without a window the match is valid always everywhere
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?t WHERE { [m:temperature ?t]. FILTER (!f:before(\"2011-01-03T00:00:00Z\")) }"
+                                       inContext:context
+                                          window:nil];
+    GHAssertTrue([results count] == 2, @"2 results should be found - but there were (%d results) found!", [results count]);
+    
+    TXLMovingObjectSequence *point = [TXLMovingObjectSequence sequenceWithMovingObject:
+                                      [TXLMovingObject movingObjectWithGeometry:[TXLGeometryCollection geometryFromWKT:@"POINT(10 10)"]]];
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?t WHERE { [m:temperature ?t]. FILTER f:within(\"POLYGON((0 0, 20 0, 20 20, 0 20, 0 0))\") }"
+                                       inContext:context
+                                          window:point];
+    GHAssertTrue([results count] == 2, @"2 results should be found - but there were (%d results) found!", [results count]);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?t WHERE { [m:temperature ?t]. FILTER f:within(\"POLYGON((30 30, 40 30, 40 40, 30 40, 30 30))\") }"
+                                       inContext:context
+                                          window:point];
+    GHAssertTrue([results count] == 0, @"No result should be found - but there were (%d results) found!", [results count]);
+}
+
+- (void)testFilterLogicalOperators {
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"weather"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    NSArray *results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?t WHERE { [m:temperature ?t]. FILTER (?t > 9 && ?t < 11) }"
+                                                inContext:context
+                                                   window:nil];
+    GHAssertEqualObjects([self valuesOfResults:results], [NSSet setWithObject:[NSNumber numberWithDouble:10.0]], nil);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?t WHERE { [m:temperature ?t]. FILTER (?t = 10 || ?t = 12) }"
+                                       inContext:context
+                                          window:nil];
+    GHAssertEqualObjects([self valuesOfResults:results], ([NSSet setWithObjects:[NSNumber numberWithDouble:10.0], [NSNumber numberWithDouble:12.0], nil]), nil);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?t WHERE { [m:temperature ?t]. FILTER (!(?t > 11)) }"
+                                       inContext:context
+                                          window:nil];
+    GHAssertEqualObjects([self valuesOfResults:results], [NSSet setWithObject:[NSNumber numberWithDouble:10.0]], nil);
+}
+
+- (void)testFilterStringComparison {
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"events"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    NSArray *results = [self resultsOfQueryWithExpression:@"PREFIX e: <http://schema.situmet.at/events#> SELECT ?c WHERE { ?e e:category ?c. FILTER (?c = \"musical\") }"
+                                                inContext:context
+                                                   window:nil];
+    GHAssertTrue([results count] == 2, @"2 results should be found - but there were (%d results) found!", [results count]);
+    GHAssertEqualObjects([self valuesOfResults:results], [NSSet setWithObject:@"musical"], nil);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX e: <http://schema.situmet.at/events#> SELECT ?c WHERE { ?e e:category ?c. FILTER (?c != \"musical\") }"
+                                       inContext:context
+                                          window:nil];
+    GHAssertEqualObjects([self valuesOfResults:results], ([NSSet setWithObjects:@"art exhibition", @"concert", nil]), nil);
+}
+
+#pragma mark -
+#pragma mark Not Exists Patterns
+
+- (void)testNotExistsWithMatchingPattern {
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"events"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    // the events _:x and _:y are suitable if it rains
+    
+    NSArray *results = [self resultsOfQueryWithExpression:@"PREFIX e: <http://schema.situmet.at/events#> SELECT ?c WHERE { ?e e:category ?c. NOT EXISTS { ?e e:suitable_if \"rain\". } }"
+                                                inContext:context
+                                                   window:nil];
+    GHAssertTrue([results count] == 1, @"1 result should be found - but there were (%d results) found!", [results count]);
+    GHAssertEqualObjects([self valuesOfResults:results], [NSSet setWithObject:@"concert"], nil);
+}
+
+- (void)testNotExistsWithoutMatchingPattern {
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"events"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    NSArray *results = [self resultsOfQueryWithExpression:@"PREFIX e: <http://schema.situmet.at/events#> SELECT ?c WHERE { ?e e:category ?c. NOT EXISTS { ?e e:suitable_if \"sunshine\". } }"
+                                                inContext:context
+                                                   window:nil];
+    GHAssertTrue([results count] == 4, @"4 results should be found - but there were (%d results) found!", [results count]);
+    GHAssertEqualObjects([self valuesOfResults:results], ([NSSet setWithObjects:@"art exhibition", @"musical", @"concert", nil]), nil);
+}
+
+- (void)testNotExistsWithWindowFilter {
+    
+    // the filter of the 'not exists' pattern is
+    // evaluated with the window of the outer match
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"events"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    TXLMovingObjectSequence *interval = [TXLMovingObjectSequence sequenceWithMovingObject:
+                                         [TXLMovingObject movingObjectWithBegin:[NSDate dateWithTimeIntervalSince1970:1293840000] // 2011-01-01
+                                                                            end:[NSDate dateWithTimeIntervalSince1970:1293926400]]]; // 2011-01-02
+    
+    NSArray *results = [self resultsOfQueryWithExpression:@"PREFIX e: <http://schema.situmet.at/events#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?c WHERE { ?e e:category ?c. NOT EXISTS { ?e e:suitable_if \"rain\". FILTER f:before(\"2011-01-03T00:00:00Z\") } }"
+                                                inContext:context
+                                                   window:interval];
+    GHAssertEqualObjects([self valuesOfResults:results], [NSSet setWithObject:@"concert"], nil);
+    
+    results = [self resultsOfQueryWithExpression:@"PREFIX e: <http://schema.situmet.at/events#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?c WHERE { ?e e:category ?c. NOT EXISTS { ?e e:suitable_if \"rain\". FILTER f:after(\"2011-01-03T00:00:00Z\") } }"
+                                       inContext:context
+                                          window:interval];
+    GHAssertTrue([results count] == 4, @"4 results should be found - but there were (%d results) found!", [results count]);
+    
+    // without a window the matches are not before any date
+    results = [self resultsOfQueryWithExpression:@"PREFIX e: <http://schema.situmet.at/events#> PREFIX f: <http://schema.opentxl.org/filter#> SELECT ?c WHERE { ?e e:category ?c. NOT EXISTS { ?e e:suitable_if \"rain\". FILTER f:before(\"2011-01-03T00:00:00Z\") } }"
+                                       inContext:context
+                                          window:nil];
+    GHAssertTrue([results count] == 4, @"4 results should be found - but there were (%d results) found!", [results count]);
+}
+
+- (NSSet *)resultsOfPlan:(TXLQueryPlan *)plan
+               inContext:(TXLContext *)context {
+    
+    // evaluation with the loaded pattern of the plan
+    // and binding vectors (as done by the manager)
+    
+    NSMutableSet *results = [NSMutableSet set];
+    
+    TXLBindingArena *arena = [TXLBindingArena arena];
+    [plan.queryPattern evaluatePatternWithBindings:[arena bindingsWithNumberOfSlots:[plan.variables count]]
+                                        inContexts:[NSArray arrayWithObject:context]
+                                            window:nil
+                                       forRevision:[[TXLManager sharedManager] headRevision]
+                                     resultHandler:^(const TXLBinding *bindings, TXLMovingObjectSequence *mos) {
+                                         [results addObject:[TXLBindingArena variablesWithBindings:bindings
+                                                                                             slots:plan.variables]];
+                                     }];
+    
+    return results;
+}
+
+- (NSSet *)resultsOfPatternOfQuery:(TXLQuery *)query
+                         inContext:(TXLContext *)context {
+    
+    // evaluation with a pattern freshly read from the
+    // pattern tables and a dictionary of variables
+    
+    NSMutableSet *results = [NSMutableSet set];
+    
+    [[query queryPattern] evaluatePatternWithVariables:[NSDictionary dictionary]
+                                            inContexts:[NSArray arrayWithObject:context]
+                                                window:nil
+                                           forRevision:[[TXLManager sharedManager] headRevision]
+                                         resultHandler:^(NSDictionary *vars, TXLMovingObjectSequence *mos) {
+                                             [results addObject:vars];
+                                         }];
+    
+    return results;
+}
+
+- (void)testQueryPlanResultsEqualPatternResults {
+    
+    // A compiled plan keeps its loaded pattern. Evaluating the plan
+    // gives the same results as a pattern read from the pattern tables,
+    // also after the statements of the context have been changed.
+    
+    NSError *error;
+    
+    GHAssertTrue([self buildDataSet], @"building dataset failed!");
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"weather"
+                                                                    path:[NSArray arrayWithObjects:@"situmet", @"at", nil]
+                                                                   error:&error];
+    GHAssertNotNil(context, [error localizedDescription]);
+    
+    NSArray *expressions = [NSArray arrayWithObjects:
+                            @"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?x ?t WHERE { ?x m:temperature ?t . }",
+                            @"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?x ?t ?r WHERE { ?x m:temperature ?t . ?x m:rain ?r . }",
+                            @"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?a ?b WHERE { [m:temperature ?a]. [m:temperature ?b]. FILTER(?a < ?b) }",
+                            @"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?x ?t WHERE { ?x m:temperature ?t . NOT EXISTS { ?x m:sky_coverage [] . } }",
+                            nil];
+    
+    NSMutableArray *queries = [NSMutableArray array];
+    NSMutableArray *plans = [NSMutableArray array];
+    
+    for (NSString *expression in expressions) {
+        TXLQuery *query = [TXLSPARQLCompiler compileQueryWithExpression:expression
+                                                             parameters:nil
+                                                                options:nil
+                                                                  error:&error];
+        GHAssertNotNil(query, [error localizedDescription]);
+        [queries addObject:query];
+        [plans addObject:[TXLQueryPlan planForQuery:query]];
+    }
+    
+    for (NSUInteger i = 0; i < [queries count]; i++) {
+        NSSet *expected = [self resultsOfPatternOfQuery:[queries objectAtIndex:i] inContext:context];
+        GHAssertTrue([expected count] > 0, @"Query: %@", [expressions objectAtIndex:i]);
+        GHAssertEqualObjects([self resultsOfPlan:[plans objectAtIndex:i] inContext:context], expected, @"Query: %@", [expressions objectAtIndex:i]);
+    }
+    
+    // change the statements of the context and
+    // evaluate the same plans again
+    
+    TXLTerm *x = [TXLTerm termWithBlankNode:@"x"];
+    NSArray *statements = [NSArray arrayWithObjects:
+                           [TXLStatement statementWithSubject:x
+                                                    predicate:[TXLTerm termWithIRI:@"http://schema.situmet.at/meteorology#temperature"]
+                                                       object:[TXLTerm termWithDouble:11.0]],
+                           [TXLStatement statementWithSubject:x
+                                                    predicate:[TXLTerm termWithIRI:@"http://schema.situmet.at/meteorology#temperature"]
+                                                       object:[TXLTerm termWithDouble:14.0]],
+                           [TXLStatement statementWithSubject:x
+                                                    predicate:[TXLTerm termWithIRI:@"http://schema.situmet.at/meteorology#sky_coverage"]
+                                                       object:[TXLTerm termWithDouble:5.0]],
+                           nil];
+    
+    __block NSError *updateError = nil;
+    
+    [self prepare];
+    [context updateWithStatements:statements
+                  completionBlock:^(TXLRevision *r, NSError *e){
+                      updateError = [e retain];
+                      [self notify:kGHUnitWaitStatusSuccess];
+                  }];
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:10.0];
+    
+    [updateError autorelease];
+    GHAssertNil(updateError, [updateError localizedDescription]);
+    
+    for (NSUInteger i = 0; i < [queries count]; i++) {
+        GHAssertEqualObjects([self resultsOfPlan:[plans objectAtIndex:i] inContext:context],
+                             [self resultsOfPatternOfQuery:[queries objectAtIndex:i] inContext:context],
+                             @"Query: %@", [expressions objectAtIndex:i]);
+    }
+}
+
 @end
@@ -0,0 +1,263 @@
+//
+//  TXLManagerImportCompilationTest.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 25.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import <GHUnit/GHUnit.h>
+
+#import "TXLDatabase.h"
+#import "TXLManager.h"
+#import "TXLRevision.h"
+#import "TXLManagerImportOperation.h"
+#import "TXLManagerImportCompilation.h"
+
+#define SQL(x) {TXLDatabase *database = [[TXLManager sharedManager] database]; NSError *error; NSArray *result = [database executeSQL:x error:&error]; GHAssertNotNil(result, [error localizedDescription]);}
+
+@interface TXLManagerImportCompilationTest : GHAsyncTestCase {
+
+}
+
+- (NSString *)writeSituationWithIndex:(NSUInteger)index
+                    numberOfSnapshots:(NSUInteger)numberOfSnapshots;
+
+- (NSString *)writeInvalidSituationWithIndex:(NSUInteger)index;
+
+@end
+
+@implementation TXLManagerImportCompilationTest
+
+#pragma mark -
+#pragma mark Set Up
+
+- (void)setUp {
+    for (NSString *name in [[[TXLManager sharedManager] database] tableNames]) {
+
+        // delete content for tables
+        if ([name hasPrefix:@"txl_context"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        if ([name hasPrefix:@"txl_statement"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        if ([name hasPrefix:@"txl_movingobject"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+    }
+}
+
+#pragma mark -
+#pragma mark Helper
+
+- (NSString *)writeSituationWithIndex:(NSUInteger)index
+                    numberOfSnapshots:(NSUInteger)numberOfSnapshots {
+
+    NSMutableString *expression = [NSMutableString string];
+    [expression appendFormat:@"@context <txl://TXLManagerImportCompilationTest/order/%lu> .\n", (unsigned long)index];
+
+    // One snapshot per minute.
+    for (NSUInteger i = 0; i < numberOfSnapshots; i++) {
+        [expression appendFormat:@"@snapshot 2011-01-%02luT%02lu:%02luZ : POINT(%f 50.0) .\n",
+         (unsigned long)(i / 1440 + 1),
+         (unsigned long)(i / 60 % 24),
+         (unsigned long)(i % 60),
+         10.0 + i * 0.001];
+    }
+
+    [expression appendFormat:@"<txl://TXLManagerImportCompilationTest/item> <http://schema.opentxl.org/test#index> \"%lu\" .\n", (unsigned long)index];
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"TXLManagerImportCompilationTest-%lu.n3", (unsigned long)index]];
+
+    NSError *error;
+    GHAssertTrue([expression writeToFile:path
+                              atomically:YES
+                                encoding:NSUTF8StringEncoding
+                                   error:&error], [error localizedDescription]);
+    return path;
+}
+
+- (NSString *)writeInvalidSituationWithIndex:(NSUInteger)index {
+
+    NSString *expression = [NSString stringWithFormat:@"@context <txl://TXLManagerImportCompilationTest/order/%lu> .\n@snapshot 2011-01-01T00:00Z POINT(10.0 50.0) .\n", (unsigned long)index];
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"TXLManagerImportCompilationTest-%lu.n3", (unsigned long)index]];
+
+    NSError *error;
+    GHAssertTrue([expression writeToFile:path
+                              atomically:YES
+                                encoding:NSUTF8StringEncoding
+                                   error:&error], [error localizedDescription]);
+    return path;
+}
+
+#pragma mark -
+#pragma mark Tests
+
+- (void)testResultsOfCompilations {
+
+    // The first files are the largest, their compilations
+    // finish last. The results are taken in the order of
+    // the files, each with the context of its file.
+
+    NSUInteger numberOfFiles = 6;
+    NSUInteger invalidFile = 3;
+
+    NSMutableArray *paths = [NSMutableArray array];
+    for (NSUInteger i = 0; i < numberOfFiles; i++) {
+        if (i == invalidFile) {
+            [paths addObject:[self writeInvalidSituationWithIndex:i]];
+        } else {
+            [paths addObject:[self writeSituationWithIndex:i
+                                         numberOfSnapshots:(numberOfFiles - i) * 2000]];
+        }
+    }
+
+    NSMutableArray *compilations = [NSMutableArray array];
+    for (NSString *path in paths) {
+        TXLManagerImportCompilation *compilation = [[TXLManagerImportCompilation alloc] initWithPath:path];
+        [compilations addObject:compilation];
+        [compilation release];
+    }
+
+    for (NSUInteger i = 0; i < numberOfFiles; i++) {
+        TXLManagerImportCompilation *compilation = [compilations objectAtIndex:i];
+
+        NSError *error = nil;
+        NSDictionary *result = [compilation takeResult:&error];
+
+        // The error is still valid, when the compilation is released.
+        [compilations replaceObjectAtIndex:i withObject:[NSNull null]];
+
+        if (i == invalidFile) {
+            GHAssertNil(result, nil);
+            GHAssertNotNil(error, nil);
+            GHAssertEqualObjects([[error userInfo] objectForKey:NSFilePathErrorKey], [paths objectAtIndex:i], nil);
+        } else {
+            GHAssertNotNil(result, [error localizedDescription]);
+            GHAssertEqualObjects([[result objectForKey:@"context_url"] absoluteString],
+                                 ([NSString stringWithFormat:@"txl://TXLManagerImportCompilationTest/order/%lu", (unsigned long)i]), nil);
+        }
+    }
+
+    for (NSString *path in paths) {
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    }
+}
+
+- (void)testOrderOfImports {
+
+    // The files are compiled in parallel, but the statements
+    // are created in the order of the import operations.
+
+    NSUInteger numberOfFiles = 6;
+
+    NSMutableArray *paths = [NSMutableArray array];
+    NSMutableArray *operations = [NSMutableArray array];
+    for (NSUInteger i = 0; i < numberOfFiles; i++) {
+        NSString *path = [self writeSituationWithIndex:i
+                                     numberOfSnapshots:(numberOfFiles - i) * 2000];
+        [paths addObject:path];
+        [operations addObject:[TXLManagerImportOperation operationWithPath:path
+                                                              intervalFrom:nil
+                                                                        to:nil]];
+    }
+
+    __block TXLRevision *revision = nil;
+    __block NSError *error = nil;
+
+    [self prepare];
+    [[TXLManager sharedManager] applyOperations:operations
+                            withCompletionBlock:^(TXLRevision *r, NSError *e){
+                                revision = [r retain];
+                                error = [e retain];
+                                [self notify:kGHUnitWaitStatusSuccess];
+                            }];
+    [self waitForStatus:kGHUnitWaitStatusSuccess timeout:300.0];
+
+    [revision autorelease];
+    [error autorelease];
+
+    for (NSString *path in paths) {
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    }
+
+    GHAssertNotNil(revision, [error localizedDescription]);
+
+    NSArray *result = [[[TXLManager sharedManager] database] executeSQLWithParameters:@"SELECT t.value AS value FROM txl_statement_created AS c JOIN txl_statement AS s ON s.id = c.statement_id JOIN txl_term AS t ON t.id = s.object_id WHERE c.revision_id = ? ORDER BY s.id"
+                                                                               error:&error,
+                       [NSNumber numberWithUnsignedInteger:revision.primaryKey],
+                       nil];
+    GHAssertNotNil(result, [error localizedDescription]);
+    GHAssertEquals([result count], numberOfFiles, nil);
+
+    for (NSUInteger i = 0; i < numberOfFiles; i++) {
+        GHAssertEqualObjects([[result objectAtIndex:i] objectForKey:@"value"],
+                             ([NSString stringWithFormat:@"%lu", (unsigned long)i]), nil);
+    }
+}
+
+- (void)testFailureOfOneImport {
+
+    // The compilation of the second file fails. Nothing is
+    // imported and the error names the second file.
+
+    NSArray *paths = [NSArray arrayWithObjects:
+                      [self writeSituationWithIndex:10 numberOfSnapshots:4000],
+                      [self writeInvalidSituationWithIndex:11],
+                      [self writeSituationWithIndex:12 numberOfSnapshots:10],
+                      nil];
+
+    NSMutableArray *operations = [NSMutableArray array];
+    for (NSString *path in paths) {
+        [operations addObject:[TXLManagerImportOperation operationWithPath:path
+                                                              intervalFrom:nil
+                                                                        to:nil]];
+    }
+
+    __block TXLRevision *revision = nil;
+    __block NSError *error = nil;
+
+    [self prepare];
+    [[TXLManager sharedManager] applyOperations:operations
+                            withCompletionBlock:^(TXLRevision *r, NSError *e){
+                                revision = [r retain];
+                                error = [e retain];
+                                [self notify:kGHUnitWaitStatusSuccess];
+                            }];
+    [self waitForStatus:kGHUnitWaitStatusSuccess timeout:300.0];
+
+    [revision autorelease];
+    [error autorelease];
+
+    for (NSString *path in paths) {
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    }
+
+    GHAssertNil(revision, nil);
+    GHAssertNotNil(error, nil);
+    GHAssertEqualObjects([[error userInfo] objectForKey:NSFilePathErrorKey], [paths objectAtIndex:1], nil);
+}
+
+@end
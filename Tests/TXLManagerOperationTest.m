@@ -29,10 +29,15 @@
 #import "TXLStatement.h"
 #import "TXLTerm.h"
 #import "TXLMovingObject.h"
+#import "TXLSnapshot.h"
 #import "TXLRevision.h"
 #import "TXLContext.h"
 #import "TXLDatabase.h"
 #import "TXLInteger.h"
+#import "TXLGeometryCollection.h"
+#import "TXLSituation.h"
+#import "TXLManagerUpdateOperation.h"
+#import "TXLManagerImportOperation.h"
 
 #import <TargetConditionals.h>
 
@@ -46,6 +51,8 @@
     
 }
 
+- (NSUInteger)numberOfStatementIndexes;
+
 @end
 
 
@@ -135,6 +142,20 @@
     [self notify:kGHUnitWaitStatusSuccess];
 }
 
+#pragma mark -
+#pragma mark Helper
+
+- (NSUInteger)numberOfStatementIndexes {
+    
+    // The indexes dropped during a bulk ingest (see ingestOperations:withCompletionBlock:).
+    
+    NSError *error;
+    NSArray *indexes = [[[TXLManager sharedManager] database] executeSQL:@"SELECT name FROM sqlite_master WHERE type = 'index' AND name IN ('txl_statement_subject_id', 'txl_statement_predicate_id', 'txl_statement_object_id')"
+                                                                   error:&error];
+    GHAssertNotNil(indexes, [error localizedDescription]);
+    return [indexes count];
+}
+
 #pragma mark -
 #pragma mark Tests
 
@@ -876,6 +897,195 @@
 }
 
 
+- (void)testExtend {
+    
+    TXLDatabase *db = [[TXLManager sharedManager] database];
+    NSError *error;
+    __block TXLRevision *rev3;
+    
+    // ---------------------------------------
+    // Setup data for test
+    
+    TXLStatement *statement = [TXLStatement statementWithSubject:[TXLTerm termWithLiteral:@"subject"]
+                                                       predicate:[TXLTerm termWithLiteral:@"predicate"]
+                                                          object:[TXLTerm termWithLiteral:@"object"]];
+    NSArray *statements = [NSArray arrayWithObject:statement];
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"TXLManagerOperationTest"
+                                                                    path:[NSArray arrayWithObject:@"testExtend"]
+                                                                   error:nil];
+    
+    TXLGeometryCollection *p1 = [TXLGeometryCollection geometryFromWKT:@"POINT(1 1)"];
+    TXLGeometryCollection *p2 = [TXLGeometryCollection geometryFromWKT:@"POINT(2 2)"];
+    
+    NSDate *t1 = [NSDate dateWithString:@"2010-09-29 11:00:00 +0200"];
+    NSDate *t2 = [NSDate dateWithString:@"2010-09-29 12:00:00 +0200"];
+    NSDate *t3 = [NSDate dateWithString:@"2010-09-29 13:00:00 +0200"];
+    
+    // ---------------------------------------
+    
+    // extend the statement three times, the second
+    // time without a change of the position.
+    
+    [self prepare];
+    [[TXLManager sharedManager] extendContext:context withStatements:statements toGeometry:p1 atTimestamp:t1 completionBlock:^(TXLRevision *rev, NSError *error) {
+        if (rev == nil) {
+            GHTestLog([error localizedDescription]);
+            [self notify:kGHUnitWaitStatusFailure];
+            return;
+        }
+        [[TXLManager sharedManager] extendContext:context withStatements:statements toGeometry:p1 atTimestamp:t2 completionBlock:^(TXLRevision *rev, NSError *error) {
+            if (rev == nil) {
+                GHTestLog([error localizedDescription]);
+                [self notify:kGHUnitWaitStatusFailure];
+                return;
+            }
+            [[TXLManager sharedManager] extendContext:context withStatements:statements toGeometry:p2 atTimestamp:t3 completionBlock:^(TXLRevision *rev, NSError *error) {
+                if (rev) {
+                    rev3 = [rev retain];
+                    [self notify:kGHUnitWaitStatusSuccess];
+                } else {
+                    GHTestLog([error localizedDescription]);
+                    [self notify:kGHUnitWaitStatusFailure];
+                }
+            }];
+        }];
+    }];
+    
+    // ---------------------------------------
+    // Wait for completion
+    
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:10.0];
+    
+    [rev3 autorelease];
+    
+    // check content of corresponding tables
+    // ---------------------------------------
+    
+    NSArray *result_statement = [db executeSQL:@"SELECT txl_statement.* FROM txl_statement WHERE NOT txl_statement.id IN (SELECT statement_id from txl_statement_removed) ORDER BY txl_statement.id" error:&error];
+    GHAssertNotNil(result_statement, [error localizedDescription]);
+    GHAssertEquals([result_statement count], (NSUInteger)1, nil);
+    
+    // The positions are appended to the open-ended moving
+    // object, the unchanged position is skipped.
+    
+    TXLMovingObject *mo = [TXLMovingObject movingObjectWithPrimaryKey:[[[result_statement objectAtIndex:0] objectForKey:@"mo_id"] unsignedIntegerValue]];
+    NSArray *snapshots = [NSArray arrayWithObjects:
+                          [TXLSnapshot snapshotWithTimestamp:t1 geometry:p1],
+                          [TXLSnapshot snapshotWithTimestamp:t3 geometry:p2],
+                          [TXLSnapshot snapshotWithTimestamp:nil geometry:p2],
+                          nil];
+    GHAssertEqualObjects(mo, [TXLMovingObject movingObjectWithSnapshots:snapshots], nil);
+    GHAssertEquals([mo.snapshots count], (NSUInteger)3, nil);
+    for (NSUInteger i = 0; i < 3; i++) {
+        TXLSnapshot *s = [mo.snapshots objectAtIndex:i];
+        TXLSnapshot *e = [snapshots objectAtIndex:i];
+        GHAssertTrue((s.timestamp == nil && e.timestamp == nil) || [s.timestamp isEqualToDate:e.timestamp], nil);
+        GHAssertEqualObjects(s.geometry, e.geometry, nil);
+    }
+    
+    // The last revision neither removes nor creates a
+    // statement, it only records the extended statement.
+    
+    NSArray *result_statement_removed = [db executeSQLWithParameters:@"SELECT * FROM txl_statement_removed WHERE revision_id = ?" error:&error,
+                                         [TXLInteger integerWithValue:rev3.primaryKey], nil];
+    GHAssertNotNil(result_statement_removed, [error localizedDescription]);
+    GHAssertEquals([result_statement_removed count], (NSUInteger)0, nil);
+    
+    NSArray *result_statement_created = [db executeSQLWithParameters:@"SELECT * FROM txl_statement_created WHERE revision_id = ?" error:&error,
+                                         [TXLInteger integerWithValue:rev3.primaryKey], nil];
+    GHAssertNotNil(result_statement_created, [error localizedDescription]);
+    GHAssertEquals([result_statement_created count], (NSUInteger)0, nil);
+    
+    NSArray *result_statement_extended = [db executeSQLWithParameters:@"SELECT * FROM txl_statement_extended WHERE revision_id = ?" error:&error,
+                                          [TXLInteger integerWithValue:rev3.primaryKey], nil];
+    GHAssertNotNil(result_statement_extended, [error localizedDescription]);
+    GHAssertEquals([result_statement_extended count], (NSUInteger)1, nil);
+    GHAssertEqualObjects([[result_statement_extended objectAtIndex:0] objectForKey:@"statement_id"],
+                         [[result_statement objectAtIndex:0] objectForKey:@"id"], nil);
+}
+
+- (void)testExtendOutOfOrder {
+    
+    __block NSError *extendError = nil;
+    __block TXLRevision *extendRevision = nil;
+    
+    // ---------------------------------------
+    // Setup data for test
+    
+    TXLStatement *statement = [TXLStatement statementWithSubject:[TXLTerm termWithLiteral:@"subject"]
+                                                       predicate:[TXLTerm termWithLiteral:@"predicate"]
+                                                          object:[TXLTerm termWithLiteral:@"object"]];
+    NSArray *statements = [NSArray arrayWithObject:statement];
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"TXLManagerOperationTest"
+                                                                    path:[NSArray arrayWithObject:@"testExtendOutOfOrder"]
+                                                                   error:nil];
+    
+    TXLGeometryCollection *p1 = [TXLGeometryCollection geometryFromWKT:@"POINT(1 1)"];
+    TXLGeometryCollection *p2 = [TXLGeometryCollection geometryFromWKT:@"POINT(2 2)"];
+    
+    NSDate *t1 = [NSDate dateWithString:@"2010-09-29 11:00:00 +0200"];
+    NSDate *t2 = [NSDate dateWithString:@"2010-09-29 12:00:00 +0200"];
+    NSDate *t3 = [NSDate dateWithString:@"2010-09-29 13:00:00 +0200"];
+    
+    // ---------------------------------------
+    
+    // extend the statement at t1 and t3 and
+    // then with an older position at t2.
+    
+    [self prepare];
+    [[TXLManager sharedManager] extendContext:context withStatements:statements toGeometry:p1 atTimestamp:t1 completionBlock:^(TXLRevision *rev, NSError *error) {
+        if (rev == nil) {
+            GHTestLog([error localizedDescription]);
+            [self notify:kGHUnitWaitStatusFailure];
+            return;
+        }
+        [[TXLManager sharedManager] extendContext:context withStatements:statements toGeometry:p2 atTimestamp:t3 completionBlock:^(TXLRevision *rev, NSError *error) {
+            if (rev == nil) {
+                GHTestLog([error localizedDescription]);
+                [self notify:kGHUnitWaitStatusFailure];
+                return;
+            }
+            [[TXLManager sharedManager] extendContext:context withStatements:statements toGeometry:p1 atTimestamp:t2 completionBlock:^(TXLRevision *rev, NSError *error) {
+                extendRevision = [rev retain];
+                extendError = [error retain];
+                [self notify:kGHUnitWaitStatusSuccess];
+            }];
+        }];
+    }];
+    
+    // ---------------------------------------
+    // Wait for completion
+    
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:10.0];
+    
+    [extendRevision autorelease];
+    [extendError autorelease];
+    
+    // The older position is rejected and the
+    // moving object is not changed.
+    
+    GHAssertNil(extendRevision, nil);
+    GHAssertNotNil(extendError, nil);
+    GHAssertEqualObjects([extendError domain], TXLManagerErrorDomain, nil);
+    GHAssertEquals([extendError code], (NSInteger)TXL_MANAGER_ERROR_OUT_OF_ORDER, nil);
+    
+    NSError *error;
+    NSArray *result_statement = [[[TXLManager sharedManager] database] executeSQLWithParameters:@"SELECT s.mo_id AS mo_id FROM txl_statement AS s WHERE s.context_id = ? AND NOT s.id IN (SELECT statement_id FROM txl_statement_removed)" error:&error,
+                                 [TXLInteger integerWithValue:context.primaryKey], nil];
+    GHAssertNotNil(result_statement, [error localizedDescription]);
+    GHAssertEquals([result_statement count], (NSUInteger)1, nil);
+    
+    TXLMovingObject *mo = [TXLMovingObject movingObjectWithPrimaryKey:[[[result_statement objectAtIndex:0] objectForKey:@"mo_id"] unsignedIntegerValue]];
+    GHAssertEquals([mo.snapshots count], (NSUInteger)3, nil);
+    GHAssertTrue([[[mo.snapshots objectAtIndex:1] timestamp] isEqualToDate:t3], nil);
+}
+
 - (void)testClear {
     
     
@@ -1040,4 +1250,166 @@
     GHAssertEquals([[[result_statement_created objectAtIndex:0] objectForKey:@"revision_id"] unsignedIntegerValue], rev1.primaryKey, nil);
 }
 
+- (void)testIngest {
+    
+    TXLDatabase *db = [[TXLManager sharedManager] database];
+    __block NSError *error;
+    __block TXLRevision *rev;
+    
+    GHAssertEquals([self numberOfStatementIndexes], (NSUInteger)3, nil);
+    
+    NSArray *revisions = [db executeSQL:@"SELECT id FROM txl_revision" error:&error];
+    GHAssertNotNil(revisions, [error localizedDescription]);
+    NSUInteger numberOfRevisions = [revisions count];
+    
+    // ---------------------------------------
+    // Setup data for test
+    
+    TXLContext *context1 = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                     host:@"TXLManagerOperationTest"
+                                                                     path:[NSArray arrayWithObject:@"testIngest1"]
+                                                                    error:nil];
+    
+    TXLContext *context2 = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                     host:@"TXLManagerOperationTest"
+                                                                     path:[NSArray arrayWithObject:@"testIngest2"]
+                                                                    error:nil];
+    
+    NSMutableArray *operations = [NSMutableArray array];
+    for (TXLContext *context in [NSArray arrayWithObjects:context1, context2, nil]) {
+        NSArray *statements = [NSArray arrayWithObjects:
+                               [TXLStatement statementWithSubject:[TXLTerm termWithLiteral:@"subject"]
+                                                        predicate:[TXLTerm termWithLiteral:@"predicate"]
+                                                           object:[TXLTerm termWithLiteral:@"object 1"]],
+                               [TXLStatement statementWithSubject:[TXLTerm termWithLiteral:@"subject"]
+                                                        predicate:[TXLTerm termWithLiteral:@"predicate"]
+                                                           object:[TXLTerm termWithLiteral:@"object 2"]],
+                               nil];
+        [operations addObject:[TXLManagerUpdateOperation operationForContext:context
+                                                               withSituation:[TXLSituation situationWithStatements:statements
+                                                                                              movingObjectSequence:nil]
+                                                              inIntervalFrom:nil
+                                                                          to:nil]];
+    }
+    
+    // ---------------------------------------
+    // Ingest all operations
+    
+    [self prepare];
+    [[TXLManager sharedManager] ingestOperations:operations
+                             withCompletionBlock:^(TXLRevision *r, NSError *e){
+                                 rev = [r retain];
+                                 error = [e retain];
+                                 [self notify:kGHUnitWaitStatusSuccess];
+                             }];
+    
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:10.0];
+    
+    [rev autorelease];
+    [error autorelease];
+    
+    GHAssertNotNil(rev, @"revision == nil indicates an error: %@", [error localizedDescription]);
+    
+    // ---------------------------------------
+    // All changes are written in one revision.
+    
+    revisions = [db executeSQL:@"SELECT id FROM txl_revision" error:&error];
+    GHAssertNotNil(revisions, [error localizedDescription]);
+    GHAssertEquals([revisions count], numberOfRevisions + 1, nil);
+    
+    NSArray *result_statement_created = [db executeSQL:@"SELECT DISTINCT revision_id FROM txl_statement_created" error:&error];
+    GHAssertNotNil(result_statement_created, [error localizedDescription]);
+    GHAssertEquals([result_statement_created count], (NSUInteger)1, nil);
+    GHAssertEquals([[[result_statement_created objectAtIndex:0] objectForKey:@"revision_id"] unsignedIntegerValue], rev.primaryKey, nil);
+    
+    NSArray *result_statement = [db executeSQL:@"SELECT * FROM txl_statement" error:&error];
+    GHAssertNotNil(result_statement, [error localizedDescription]);
+    GHAssertEquals([result_statement count], (NSUInteger)4, nil);
+    
+    // ---------------------------------------
+    // The indexes have been rebuilt.
+    
+    GHAssertEquals([self numberOfStatementIndexes], (NSUInteger)3, nil);
+}
+
+- (void)testIngestWithFailingOperation {
+    
+    TXLDatabase *db = [[TXLManager sharedManager] database];
+    __block NSError *error;
+    __block TXLRevision *rev;
+    
+    GHAssertEquals([self numberOfStatementIndexes], (NSUInteger)3, nil);
+    
+    NSArray *revisions = [db executeSQL:@"SELECT id FROM txl_revision" error:&error];
+    GHAssertNotNil(revisions, [error localizedDescription]);
+    NSUInteger numberOfRevisions = [revisions count];
+    
+    // ---------------------------------------
+    // Setup data for test
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"TXLManagerOperationTest"
+                                                                    path:[NSArray arrayWithObject:@"testIngestWithFailingOperation"]
+                                                                   error:nil];
+    
+    NSArray *statements = [NSArray arrayWithObject:[TXLStatement statementWithSubject:[TXLTerm termWithLiteral:@"subject"]
+                                                                            predicate:[TXLTerm termWithLiteral:@"predicate"]
+                                                                               object:[TXLTerm termWithLiteral:@"object"]]];
+    
+    // The import of a file, which does not exist, fails after
+    // the update of the context has been written.
+    
+    NSArray *operations = [NSArray arrayWithObjects:
+                           [TXLManagerUpdateOperation operationForContext:context
+                                                            withSituation:[TXLSituation situationWithStatements:statements
+                                                                                           movingObjectSequence:nil]
+                                                           inIntervalFrom:nil
+                                                                       to:nil],
+                           [TXLManagerImportOperation operationWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"TXLManagerOperationTest-does-not-exist.n3"]
+                                                           intervalFrom:nil
+                                                                     to:nil],
+                           nil];
+    
+    // ---------------------------------------
+    // Ingest all operations
+    
+    [self prepare];
+    [[TXLManager sharedManager] ingestOperations:operations
+                             withCompletionBlock:^(TXLRevision *r, NSError *e){
+                                 rev = [r retain];
+                                 error = [e retain];
+                                 [self notify:kGHUnitWaitStatusSuccess];
+                             }];
+    
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:10.0];
+    
+    [rev autorelease];
+    [error autorelease];
+    
+    GHAssertNil(rev, nil);
+    GHAssertNotNil(error, nil);
+    
+    // ---------------------------------------
+    // All changes have been rolled back.
+    
+    revisions = [db executeSQL:@"SELECT id FROM txl_revision" error:&error];
+    GHAssertNotNil(revisions, [error localizedDescription]);
+    GHAssertEquals([revisions count], numberOfRevisions, nil);
+    
+    NSArray *result_statement = [db executeSQL:@"SELECT * FROM txl_statement" error:&error];
+    GHAssertNotNil(result_statement, [error localizedDescription]);
+    GHAssertEquals([result_statement count], (NSUInteger)0, nil);
+    
+    NSArray *result_statement_created = [db executeSQL:@"SELECT * FROM txl_statement_created" error:&error];
+    GHAssertNotNil(result_statement_created, [error localizedDescription]);
+    GHAssertEquals([result_statement_created count], (NSUInteger)0, nil);
+    
+    // ---------------------------------------
+    // The rollback has restored the dropped indexes.
+    
+    GHAssertEquals([self numberOfStatementIndexes], (NSUInteger)3, nil);
+}
+
 @end
@@ -35,6 +35,7 @@
 #import "TXLStatement.h"
 #import "TXLContext.h"
 #import "TXLResultSet.h"
+#import "TXLRevision.h"
 
 #import "TXLMovingObjectSequence.h"
 #import "TXLMovingObject.h"
@@ -44,6 +45,10 @@
 @interface TXLManagerTestUpdateResultSet : GHAsyncTestCase {
     TXLResultSet *resultSet;
     TXLRevision *resultRevision;
+    
+    // the revisions (primary keys) of the result sets
+    // for each query, if the order is recorded
+    NSMutableDictionary *revisionsOfQueries;
 }
 
 @property (retain) TXLResultSet *resultSet;
@@ -119,6 +124,8 @@
     
     self.resultSet = nil;
     self.resultRevision = nil;
+    [revisionsOfQueries release];
+    revisionsOfQueries = nil;
     [TXLManager sharedManager].delegate = nil;
 }
 
@@ -205,6 +212,288 @@
     [[TXLManager sharedManager] unregisterQueryWithName:@"TXLManagerTestUpdateResultSet"];
 }
 
+- (void)testIncrementalUpdate {
+
+    /*
+     * After the first evaluation of a query, the resultset is only maintained
+     * for the results affected by the statements created or removed in a revision.
+     * This test checks, that the results of earlier revisions are kept, that new
+     * results are added and that results of removed statements are removed.
+     */
+
+    NSError *error;
+
+    // create context
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"TXLManagerTestUpdateResultSet"
+                                                                    path:[NSArray arrayWithObject:@"incremental"]
+                                                                   error:nil];
+    [self prepare];
+    [context clear:^(TXLRevision *r, NSError *error){
+        [self notify:kGHUnitWaitStatusSuccess];
+    }];
+
+    [self waitForStatus:kGHUnitWaitStatusSuccess timeout:120.0];
+
+    TXLQueryHandle *qh = [[TXLManager sharedManager] registerQueryWithName:@"TXLManagerTestUpdateResultSet_incremental"
+                                                                expression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?temp FROM <txl://TXLManagerTestUpdateResultSet/incremental> WHERE { [m:temperature ?temp]. }"
+                                                                parameters:nil
+                                                                   options:nil
+                                                                     error:&error];
+    GHAssertNotNil(qh, [error localizedDescription]);
+    qh.delegate = self;
+
+    TXLTerm *predicate = [TXLTerm termWithIRI:@"http://schema.situmet.at/meteorology#temperature"];
+    TXLTerm *object1 = [TXLTerm termWithDouble:10.0];
+    TXLTerm *object2 = [TXLTerm termWithDouble:12.0];
+
+    TXLStatement *statement1 = [TXLStatement statementWithSubject:[TXLTerm termWithBlankNode:@"a"]
+                                                        predicate:predicate
+                                                           object:object1];
+    TXLStatement *statement2 = [TXLStatement statementWithSubject:[TXLTerm termWithBlankNode:@"b"]
+                                                        predicate:predicate
+                                                           object:object2];
+
+    // first revision (complete evaluation)
+    [self prepare];
+    [context updateWithStatements:[NSArray arrayWithObject:statement1] completionBlock:^(TXLRevision *r, NSError *error){}];
+    [self waitForStatus:kGHUnitWaitStatusSuccess timeout:120.0];
+
+    GHAssertEquals([resultSet count], (NSUInteger)1, nil);
+
+    // second revision (incremental evaluation)
+    [self prepare];
+    [context updateWithStatements:[NSArray arrayWithObjects:statement1, statement2, nil] completionBlock:^(TXLRevision *r, NSError *error){}];
+    [self waitForStatus:kGHUnitWaitStatusSuccess timeout:120.0];
+
+    GHAssertEquals([resultSet count], (NSUInteger)2, nil);
+
+    // third revision (incremental evaluation, removing a result)
+    [self prepare];
+    [context updateWithStatements:[NSArray arrayWithObject:statement2] completionBlock:^(TXLRevision *r, NSError *error){}];
+    [self waitForStatus:kGHUnitWaitStatusSuccess timeout:120.0];
+
+    GHAssertEquals([resultSet count], (NSUInteger)1, nil);
+    GHAssertEqualObjects([resultSet valuesAtIndex:0], [NSDictionary dictionaryWithObject:object2 forKey:@"temp"], nil);
+
+    [[TXLManager sharedManager] unregisterQueryWithName:@"TXLManagerTestUpdateResultSet_incremental"];
+}
+
+- (void)testConcurrentEvaluation {
+    
+    /*
+     * The queries are evaluated concurrently, each in its own queue.
+     * This test updates a context several times without waiting and
+     * checks, that each query gets its result sets in the order of the
+     * revisions and that the result sets of the last revision are correct.
+     */
+    
+    NSError *error;
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"TXLManagerTestUpdateResultSet"
+                                                                    path:[NSArray arrayWithObject:@"concurrent"]
+                                                                   error:nil];
+    [self prepare];
+    [context clear:^(TXLRevision *r, NSError *error){
+        [self notify:kGHUnitWaitStatusSuccess];
+    }];
+    
+    [self waitForStatus:kGHUnitWaitStatusSuccess timeout:120.0];
+    
+    TXLQueryHandle *qh1 = [[TXLManager sharedManager] registerQueryWithName:@"TXLManagerTestUpdateResultSet_concurrent_temp"
+                                                                 expression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?temp FROM <txl://TXLManagerTestUpdateResultSet/concurrent> WHERE { [m:temperature ?temp]. }"
+                                                                 parameters:nil
+                                                                    options:nil
+                                                                      error:&error];
+    GHAssertNotNil(qh1, [error localizedDescription]);
+    
+    TXLQueryHandle *qh2 = [[TXLManager sharedManager] registerQueryWithName:@"TXLManagerTestUpdateResultSet_concurrent_rain"
+                                                                 expression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?rain FROM <txl://TXLManagerTestUpdateResultSet/concurrent> WHERE { [m:rain ?rain]. }"
+                                                                 parameters:nil
+                                                                    options:nil
+                                                                      error:&error];
+    GHAssertNotNil(qh2, [error localizedDescription]);
+    
+    revisionsOfQueries = [[NSMutableDictionary alloc] init];
+    qh1.delegate = self;
+    qh2.delegate = self;
+    
+    TXLTerm *temperature = [TXLTerm termWithIRI:@"http://schema.situmet.at/meteorology#temperature"];
+    TXLTerm *rain = [TXLTerm termWithIRI:@"http://schema.situmet.at/meteorology#rain"];
+    
+    // several revisions without waiting for the evaluations
+    
+    NSUInteger numberOfRevisions = 5;
+    __block NSUInteger lastRevision = 0;
+    __block NSUInteger completedRevisions = 0;
+    
+    for (NSUInteger i = 1; i <= numberOfRevisions; i++) {
+        NSArray *statements = [NSArray arrayWithObjects:
+                               [TXLStatement statementWithSubject:[TXLTerm termWithBlankNode:@"a"]
+                                                        predicate:temperature
+                                                           object:[TXLTerm termWithDouble:i]],
+                               [TXLStatement statementWithSubject:[TXLTerm termWithBlankNode:@"a"]
+                                                        predicate:rain
+                                                           object:[TXLTerm termWithDouble:i * 10]],
+                               nil];
+        [context updateWithStatements:statements completionBlock:^(TXLRevision *r, NSError *error){
+            @synchronized (self) {
+                lastRevision = MAX(lastRevision, r.primaryKey);
+                completedRevisions++;
+            }
+        }];
+    }
+    
+    // wait until both queries have a result set for the last revision
+    
+    NSNumber *key1 = [NSNumber numberWithUnsignedInteger:qh1.queryPrimaryKey];
+    NSNumber *key2 = [NSNumber numberWithUnsignedInteger:qh2.queryPrimaryKey];
+    
+    BOOL finished = NO;
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:120.0];
+    while (!finished && [timeout timeIntervalSinceNow] > 0) {
+        [NSThread sleepForTimeInterval:0.1];
+        @synchronized (self) {
+            NSUInteger expected = lastRevision;
+            @synchronized (revisionsOfQueries) {
+                finished = completedRevisions == numberOfRevisions &&
+                [[[revisionsOfQueries objectForKey:key1] lastObject] unsignedIntegerValue] == expected &&
+                [[[revisionsOfQueries objectForKey:key2] lastObject] unsignedIntegerValue] == expected;
+            }
+        }
+    }
+    
+    qh1.delegate = nil;
+    qh2.delegate = nil;
+    
+    GHAssertTrue(finished, @"The queries have not been evaluated for the last revision.");
+    
+    // the result sets of each query are in the order of the revisions
+    
+    for (NSNumber *key in [NSArray arrayWithObjects:key1, key2, nil]) {
+        NSArray *revisions = [revisionsOfQueries objectForKey:key];
+        for (NSUInteger i = 1; i < [revisions count]; i++) {
+            GHAssertLessThan([[revisions objectAtIndex:i - 1] unsignedIntegerValue],
+                             [[revisions objectAtIndex:i] unsignedIntegerValue],
+                             @"The result sets of query %@ are not in the order of the revisions: %@", key, revisions);
+        }
+    }
+    
+    TXLRevision *rev = [TXLRevision revisionWithPrimaryKey:lastRevision];
+    
+    TXLResultSet *rs1 = [qh1 resultSetForRevision:rev];
+    GHAssertEquals([rs1 count], (NSUInteger)1, nil);
+    GHAssertEqualObjects([rs1 valuesAtIndex:0], [NSDictionary dictionaryWithObject:[TXLTerm termWithDouble:numberOfRevisions] forKey:@"temp"], nil);
+    
+    TXLResultSet *rs2 = [qh2 resultSetForRevision:rev];
+    GHAssertEquals([rs2 count], (NSUInteger)1, nil);
+    GHAssertEqualObjects([rs2 valuesAtIndex:0], [NSDictionary dictionaryWithObject:[TXLTerm termWithDouble:numberOfRevisions * 10] forKey:@"rain"], nil);
+    
+    [[TXLManager sharedManager] unregisterQueryWithName:@"TXLManagerTestUpdateResultSet_concurrent_temp"];
+    [[TXLManager sharedManager] unregisterQueryWithName:@"TXLManagerTestUpdateResultSet_concurrent_rain"];
+}
+
+- (void)testSkippedEvaluations {
+    
+    /*
+     * The evaluations of a query, which are scheduled while another
+     * evaluation of the query is running, are coalesced. This test
+     * updates a context several times without waiting and checks, that
+     * each revision has either been evaluated or has been marked as
+     * skipped, and that the number of skipped evaluations matches.
+     */
+    
+    NSError *error;
+    
+    TXLContext *context = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                    host:@"TXLManagerTestUpdateResultSet"
+                                                                    path:[NSArray arrayWithObject:@"skipped"]
+                                                                   error:nil];
+    [self prepare];
+    [context clear:^(TXLRevision *r, NSError *error){
+        [self notify:kGHUnitWaitStatusSuccess];
+    }];
+    
+    [self waitForStatus:kGHUnitWaitStatusSuccess timeout:120.0];
+    
+    TXLQueryHandle *qh = [[TXLManager sharedManager] registerQueryWithName:@"TXLManagerTestUpdateResultSet_skipped"
+                                                                expression:@"PREFIX m: <http://schema.situmet.at/meteorology#> SELECT ?temp FROM <txl://TXLManagerTestUpdateResultSet/skipped> WHERE { [m:temperature ?temp]. }"
+                                                                parameters:nil
+                                                                   options:nil
+                                                                     error:&error];
+    GHAssertNotNil(qh, [error localizedDescription]);
+    
+    revisionsOfQueries = [[NSMutableDictionary alloc] init];
+    qh.delegate = self;
+    
+    TXLTerm *temperature = [TXLTerm termWithIRI:@"http://schema.situmet.at/meteorology#temperature"];
+    
+    NSUInteger numberOfRevisions = 10;
+    NSMutableArray *revisions = [NSMutableArray array];
+    
+    // wait for the first evaluation of the query, so that
+    // only the evaluations of the following revisions are counted
+    
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:120.0];
+    while (([TXLManager sharedManager].processing || [TXLManager sharedManager].numberOfPendingEvaluations > 0) &&
+           [timeout timeIntervalSinceNow] > 0) {
+        [NSThread sleepForTimeInterval:0.1];
+    }
+    
+    NSUInteger skippedBefore = [TXLManager sharedManager].numberOfSkippedEvaluations;
+    
+    for (NSUInteger i = 1; i <= numberOfRevisions; i++) {
+        NSArray *statements = [NSArray arrayWithObject:[TXLStatement statementWithSubject:[TXLTerm termWithBlankNode:@"a"]
+                                                                                predicate:temperature
+                                                                                   object:[TXLTerm termWithDouble:i]]];
+        [context updateWithStatements:statements completionBlock:^(TXLRevision *r, NSError *error){
+            @synchronized (revisions) {
+                [revisions addObject:r];
+            }
+        }];
+    }
+    
+    // wait until all revisions have been processed
+    
+    BOOL finished = NO;
+    timeout = [NSDate dateWithTimeIntervalSinceNow:120.0];
+    while (!finished && [timeout timeIntervalSinceNow] > 0) {
+        [NSThread sleepForTimeInterval:0.1];
+        @synchronized (revisions) {
+            finished = [revisions count] == numberOfRevisions &&
+            ![TXLManager sharedManager].processing &&
+            [TXLManager sharedManager].numberOfPendingEvaluations == 0;
+        }
+    }
+    
+    qh.delegate = nil;
+    
+    GHAssertTrue(finished, @"The revisions have not been processed.");
+    
+    // each revision has either been evaluated or skipped
+    
+    NSArray *evaluated = [revisionsOfQueries objectForKey:[NSNumber numberWithUnsignedInteger:qh.queryPrimaryKey]];
+    NSUInteger numberOfSkippedRevisions = 0;
+    NSUInteger lastRevision = 0;
+    
+    for (TXLRevision *r in revisions) {
+        BOOL skipped = [[qh resultSetForRevision:r] isSkipped];
+        BOOL wasEvaluated = [evaluated containsObject:[NSNumber numberWithUnsignedInteger:r.primaryKey]];
+        GHAssertTrue(skipped != wasEvaluated, @"Revision %d is %@.", r.primaryKey, skipped ? @"evaluated and skipped" : @"neither evaluated nor skipped");
+        if (skipped) {
+            numberOfSkippedRevisions++;
+        }
+        lastRevision = MAX(lastRevision, r.primaryKey);
+    }
+    
+    GHAssertFalse([[qh resultSetForRevision:[TXLRevision revisionWithPrimaryKey:lastRevision]] isSkipped], @"The last revision must be evaluated.");
+    GHAssertEquals([TXLManager sharedManager].numberOfSkippedEvaluations - skippedBefore, numberOfSkippedRevisions, nil);
+    GHAssertEquals([evaluated count] + numberOfSkippedRevisions, numberOfRevisions, nil);
+    
+    [[TXLManager sharedManager] unregisterQueryWithName:@"TXLManagerTestUpdateResultSet_skipped"];
+}
+
 #pragma mark -
 #pragma mark TXLResultSet Delegate 
 
@@ -212,6 +501,21 @@
         hasNewResultSet:(TXLResultSet *)result
             forRevision:(TXLRevision *)revision {
     GHTestLog(@"Delegate for result set called.");
+    
+    if (revisionsOfQueries != nil) {
+        // the queries are evaluated concurrently (see testConcurrentEvaluation)
+        @synchronized (revisionsOfQueries) {
+            NSNumber *key = [NSNumber numberWithUnsignedInteger:query.queryPrimaryKey];
+            NSMutableArray *revisions = [revisionsOfQueries objectForKey:key];
+            if (revisions == nil) {
+                revisions = [NSMutableArray array];
+                [revisionsOfQueries setObject:revisions forKey:key];
+            }
+            [revisions addObject:[NSNumber numberWithUnsignedInteger:revision.primaryKey]];
+        }
+        return;
+    }
+    
     self.resultSet = result;
     self.resultRevision = revision;
     [self notify:kGHUnitWaitStatusSuccess];
@@ -0,0 +1,297 @@
+//
+//  TXLMatchNetworkTest.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 24.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import <GHUnit/GHUnit.h>
+
+#import "TXLDatabase.h"
+#import "TXLManager.h"
+#import "TXLQueryHandle.h"
+#import "TXLTerm.h"
+#import "TXLStatement.h"
+#import "TXLContext.h"
+#import "TXLRevision.h"
+#import "TXLInteger.h"
+#import "TXLMatchNetwork.h"
+
+#define SQL(x) {TXLDatabase *database = [[TXLManager sharedManager] database]; NSError *error; NSArray *result = [database executeSQL:x error:&error]; GHAssertNotNil(result, [error localizedDescription]);}
+
+@interface TXLMatchNetworkTest : GHAsyncTestCase {
+
+}
+
+- (TXLContext *)contextWithPath:(NSArray *)path;
+
+- (TXLQueryHandle *)registerQueryWithName:(NSString *)name
+                               expression:(NSString *)expression;
+
+- (TXLRevision *)updateContext:(TXLContext *)ctx
+                withStatements:(NSArray *)statements;
+
+- (TXLRevision *)clearContext:(TXLContext *)ctx;
+
+@end
+
+@implementation TXLMatchNetworkTest
+
+#pragma mark -
+#pragma mark Set Up & Tear Down
+
+- (void)setUp {
+    for (NSString *name in [[[TXLManager sharedManager] database] tableNames]) {
+
+        // delete content for tables
+        if ([name hasPrefix:@"txl_context"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        if ([name hasPrefix:@"txl_statement"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        if ([name hasPrefix:@"txl_query"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        if ([name hasPrefix:@"txl_movingobject"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        if ([name hasPrefix:@"txl_term"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        // delete tables
+        if ([name hasPrefix:@"txl_resultset"]) {
+            NSString *expr = [NSString stringWithFormat:@"DROP TABLE %@", name];
+            SQL(expr);
+        }
+    }
+
+    [TXLManager sharedManager].delegate = self;
+}
+
+- (void)tearDown {
+
+    if ([TXLManager sharedManager].processing) {
+        [self prepare];
+        [self waitForStatus:kGHUnitWaitStatusSuccess
+                    timeout:120.0];
+    }
+
+    [TXLManager sharedManager].delegate = nil;
+}
+
+#pragma mark -
+#pragma mark Processing
+
+- (void)didStartProcessing {
+    GHTestLog(@"Start Processing.");
+}
+
+- (void)didEndProcessing {
+    GHTestLog(@"End Processing.");
+    [self notify:kGHUnitWaitStatusSuccess];
+}
+
+#pragma mark -
+#pragma mark Helper
+
+- (TXLContext *)contextWithPath:(NSArray *)path {
+    NSError *error;
+    TXLContext *ctx = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                host:@"TXLMatchNetworkTest"
+                                                                path:path
+                                                               error:&error];
+    GHAssertNotNil(ctx, [error localizedDescription]);
+    return ctx;
+}
+
+- (TXLQueryHandle *)registerQueryWithName:(NSString *)name
+                               expression:(NSString *)expression {
+    NSError *error;
+    TXLQueryHandle *qh = [[TXLManager sharedManager] registerQueryWithName:name
+                                                                expression:expression
+                                                                parameters:nil
+                                                                   options:nil
+                                                                     error:&error];
+    GHAssertNotNil(qh, [error localizedDescription]);
+    return qh;
+}
+
+- (TXLRevision *)updateContext:(TXLContext *)ctx
+                withStatements:(NSArray *)statements {
+    __block TXLRevision *rev = nil;
+    __block NSError *error = nil;
+
+    [self prepare];
+    [ctx updateWithStatements:statements
+              completionBlock:^(TXLRevision *r, NSError *e){
+                  rev = [r retain];
+                  error = [e retain];
+                  [self notify:kGHUnitWaitStatusSuccess];
+              }];
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:60.0];
+
+    [rev autorelease];
+    [error autorelease];
+
+    GHAssertNotNil(rev, [error localizedDescription]);
+    return rev;
+}
+
+- (TXLRevision *)clearContext:(TXLContext *)ctx {
+    __block TXLRevision *rev = nil;
+    __block NSError *error = nil;
+
+    [self prepare];
+    [ctx clear:^(TXLRevision *r, NSError *e){
+        rev = [r retain];
+        error = [e retain];
+        [self notify:kGHUnitWaitStatusSuccess];
+    }];
+    [self waitForStatus:kGHUnitWaitStatusSuccess
+                timeout:60.0];
+
+    [rev autorelease];
+    [error autorelease];
+
+    GHAssertNotNil(rev, [error localizedDescription]);
+    return rev;
+}
+
+#pragma mark -
+#pragma mark Tests
+
+- (void)testActivations {
+
+    NSError *error;
+
+    TXLQueryHandle *qh = [self registerQueryWithName:@"TXLMatchNetworkTest_activations"
+                                          expression:@"SELECT ?s ?o FROM <txl://TXLMatchNetworkTest/activations> WHERE { ?s <http://schema.opentxl.org/test#p> ?o . }"];
+    TXLInteger *queryPk = [TXLInteger integerWithValue:qh.queryPrimaryKey];
+
+    TXLContext *ctx = [self contextWithPath:[NSArray arrayWithObject:@"activations"]];
+
+    TXLTerm *object = [[TXLTerm termWithLiteral:@"object"] save:&error];
+    GHAssertNotNil(object, [error localizedDescription]);
+
+    NSArray *statements = [NSArray arrayWithObjects:
+                           [TXLStatement statementWithSubject:[TXLTerm termWithLiteral:@"subject"]
+                                                    predicate:[TXLTerm termWithIRI:@"http://schema.opentxl.org/test#p"]
+                                                       object:object],
+                           [TXLStatement statementWithSubject:[TXLTerm termWithLiteral:@"subject"]
+                                                    predicate:[TXLTerm termWithIRI:@"http://schema.opentxl.org/test#other"]
+                                                       object:object],
+                           nil];
+
+    TXLRevision *rev1 = [self updateContext:ctx withStatements:statements];
+    TXLRevision *rev2 = [self clearContext:ctx];
+
+    TXLMatchNetwork *network = [[[TXLMatchNetwork alloc] init] autorelease];
+
+    // Only the statement with the predicate of the
+    // triple pattern is propagated to the query.
+
+    NSDictionary *activations = [network activationsForRevision:rev1];
+    GHAssertEquals([activations count], (NSUInteger)1, nil);
+
+    NSDictionary *activation = [activations objectForKey:queryPk];
+    GHAssertNotNil(activation, nil);
+    GHAssertEquals([[activation objectForKey:@"created"] count], (NSUInteger)1, nil);
+    GHAssertEquals([[activation objectForKey:@"removed"] count], (NSUInteger)0, nil);
+
+    NSDictionary *seed = [[activation objectForKey:@"created"] anyObject];
+    GHAssertEquals([seed count], (NSUInteger)2, nil);
+    GHAssertTrue([[seed allValues] containsObject:[TXLInteger integerWithValue:object.primaryKey]], nil);
+
+    activations = [network activationsForRevision:rev2];
+    activation = [activations objectForKey:queryPk];
+    GHAssertNotNil(activation, nil);
+    GHAssertEquals([[activation objectForKey:@"created"] count], (NSUInteger)0, nil);
+    GHAssertEquals([[activation objectForKey:@"removed"] count], (NSUInteger)1, nil);
+}
+
+- (void)testContextsByPathComponents {
+
+    // A query listening on "a/b" is affected by changes in "a/b" and
+    // its children, but not by changes in the sibling context "a/bc".
+
+    TXLQueryHandle *qh = [self registerQueryWithName:@"TXLMatchNetworkTest_path"
+                                          expression:@"SELECT ?s ?o FROM <txl://TXLMatchNetworkTest/a/b> WHERE { ?s <http://schema.opentxl.org/test#p> ?o . }"];
+    TXLInteger *queryPk = [TXLInteger integerWithValue:qh.queryPrimaryKey];
+
+    NSArray *statements = [NSArray arrayWithObject:[TXLStatement statementWithSubject:[TXLTerm termWithLiteral:@"subject"]
+                                                                            predicate:[TXLTerm termWithIRI:@"http://schema.opentxl.org/test#p"]
+                                                                               object:[TXLTerm termWithLiteral:@"object"]]];
+
+    TXLRevision *revOfContext = [self updateContext:[self contextWithPath:[NSArray arrayWithObjects:@"a", @"b", nil]]
+                                     withStatements:statements];
+    TXLRevision *revOfChild = [self updateContext:[self contextWithPath:[NSArray arrayWithObjects:@"a", @"b", @"c", nil]]
+                                   withStatements:statements];
+    TXLRevision *revOfSibling = [self updateContext:[self contextWithPath:[NSArray arrayWithObjects:@"a", @"bc", nil]]
+                                     withStatements:statements];
+
+    TXLMatchNetwork *network = [[[TXLMatchNetwork alloc] init] autorelease];
+
+    GHAssertNotNil([[network activationsForRevision:revOfContext] objectForKey:queryPk], nil);
+    GHAssertNotNil([[network activationsForRevision:revOfChild] objectForKey:queryPk], nil);
+    GHAssertNil([[network activationsForRevision:revOfSibling] objectForKey:queryPk], nil);
+}
+
+- (void)testManyStatementsInOneRevision {
+
+    // The statements of a revision are not passed as list in the
+    // SQL expression, their number is not limited by the length
+    // of the expression.
+
+    TXLQueryHandle *qh = [self registerQueryWithName:@"TXLMatchNetworkTest_many"
+                                          expression:@"SELECT ?s ?o FROM <txl://TXLMatchNetworkTest/many> WHERE { ?s <http://schema.opentxl.org/test#p> ?o . }"];
+    TXLInteger *queryPk = [TXLInteger integerWithValue:qh.queryPrimaryKey];
+
+    NSUInteger numberOfStatements = 5000;
+
+    NSMutableArray *statements = [NSMutableArray arrayWithCapacity:numberOfStatements];
+    TXLTerm *predicate = [TXLTerm termWithIRI:@"http://schema.opentxl.org/test#p"];
+    for (NSUInteger i = 0; i < numberOfStatements; i++) {
+        [statements addObject:[TXLStatement statementWithSubject:[TXLTerm termWithBlankNode:@"s"]
+                                                       predicate:predicate
+                                                          object:[TXLTerm termWithInteger:i]]];
+    }
+
+    TXLRevision *rev = [self updateContext:[self contextWithPath:[NSArray arrayWithObject:@"many"]]
+                            withStatements:statements];
+
+    TXLMatchNetwork *network = [[[TXLMatchNetwork alloc] init] autorelease];
+
+    NSDictionary *activation = [[network activationsForRevision:rev] objectForKey:queryPk];
+    GHAssertNotNil(activation, nil);
+    GHAssertEquals([[activation objectForKey:@"created"] count], numberOfStatements, nil);
+}
+
+@end
@@ -674,6 +674,113 @@
     GHAssertEqualObjects([(TXLSnapshot *)[mo.snapshots objectAtIndex:5] geometry], GEO(@"POLYGON((15 15, 25 15, 25 25, 15 25, 15 15))"), nil);
 }
 
+- (void)testMovingObjectWithSamples {
+    
+    // Test the constructor and the "basic accessor methods"
+    // for an moving object constructed with packed samples.
+    // ====================================================
+    
+    NSError *error;
+    
+    TXLGeometryCollection *polygon = [GEO(@"POLYGON((10 10, 20 10, 20 20, 10 20, 10 10))") save:&error];
+    GHAssertNotNil(polygon, [error localizedDescription]);
+    
+    TXLTrajectorySample samples[4];
+    
+    samples[0].timestamp = [DATE(@"2010-09-29 10:00:00 +0200") timeIntervalSince1970];
+    samples[0].coordinate.longitude = 1;
+    samples[0].coordinate.latitude = 2;
+    samples[0].geometry = 0;
+    
+    samples[1].timestamp = [DATE(@"2010-09-29 11:00:00 +0200") timeIntervalSince1970];
+    samples[1].coordinate.longitude = 3;
+    samples[1].coordinate.latitude = 4;
+    samples[1].geometry = 0;
+    
+    samples[2].timestamp = [DATE(@"2010-09-29 12:00:00 +0200") timeIntervalSince1970];
+    samples[2].coordinate.longitude = 5;
+    samples[2].coordinate.latitude = 6;
+    samples[2].geometry = 0;
+    
+    samples[3].timestamp = [DATE(@"2010-09-29 13:00:00 +0200") timeIntervalSince1970];
+    samples[3].geometry = polygon.primaryKey;
+    
+    TXLMovingObject *mo = [TXLMovingObject movingObjectWithSamples:samples count:4];
+    GHAssertNotNil(mo, @"Could not create a moving object from samples.");
+    
+    // Begin, end and bounds are known before the object is saved.
+    
+    GHAssertEqualObjects(mo.begin, DATE(@"2010-09-29 10:00:00 +0200"), nil);
+    GHAssertEqualObjects(mo.end, DATE(@"2010-09-29 13:00:00 +0200"), nil);
+    // The last sample is not part of the bounds.
+    GHAssertEqualObjects(mo.bounds, GEO(@"MULTIPOINT(1 2, 3 4, 5 6)"), nil);
+    
+    // The object is not masked by its own interval.
+    GHAssertTrue([mo movingObjectInIntervalFrom:mo.begin to:mo.end] == mo, nil);
+    
+    // Save & Load
+    // ----------------------
+    
+    GHAssertNotNil([mo save:&error], [error localizedDescription]);
+    
+    NSUInteger pk = mo.primaryKey;
+    GHAssertNotEquals(pk, (NSUInteger)0, @"The primary key of an saved moving object must not be 0.");
+    
+    mo = [TXLMovingObject movingObjectWithPrimaryKey:pk];
+    
+    GHAssertEqualObjects(mo.begin, DATE(@"2010-09-29 10:00:00 +0200"), nil);
+    GHAssertEqualObjects(mo.end, DATE(@"2010-09-29 13:00:00 +0200"), nil);
+    
+    // Snapshots
+    // ----------------------
+    
+    GHAssertEquals([mo.snapshots count], (NSUInteger)4, nil);
+    
+    GHAssertEqualObjects([(TXLSnapshot *)[mo.snapshots objectAtIndex:0] timestamp], DATE(@"2010-09-29 10:00:00 +0200"), nil);
+    GHAssertEqualObjects([(TXLSnapshot *)[mo.snapshots objectAtIndex:0] geometry], GEO(@"POINT(1 2)"), nil);
+    
+    GHAssertEqualObjects([(TXLSnapshot *)[mo.snapshots objectAtIndex:2] geometry], GEO(@"POINT(5 6)"), nil);
+    
+    GHAssertEqualObjects([(TXLSnapshot *)[mo.snapshots objectAtIndex:3] timestamp], DATE(@"2010-09-29 13:00:00 +0200"), nil);
+    GHAssertEquals([(TXLSnapshot *)[mo.snapshots objectAtIndex:3] geometry].primaryKey, polygon.primaryKey, nil);
+}
+
+- (void)testMovingObjectWithTimestamps {
+    
+    // Test the constructor used by the operations, which
+    // creates a moving object from arrays of timestamps
+    // and geometries.
+    // ====================================================
+    
+    NSTimeInterval timestamps[3];
+    timestamps[0] = -INFINITY;
+    timestamps[1] = [DATE(@"2010-09-29 11:00:00 +0200") timeIntervalSince1970];
+    timestamps[2] = INFINITY;
+    
+    TXLGeometryCollection *geometries[3];
+    geometries[0] = GEO(@"POINT(1 2)");
+    geometries[1] = GEO(@"POINT(3 4)");
+    geometries[2] = geometries[1];
+    
+    TXLMovingObject *mo = [TXLMovingObject movingObjectWithTimestamps:timestamps
+                                                           geometries:geometries
+                                                                count:3];
+    
+    GHAssertNil(mo.begin, nil);
+    GHAssertNil(mo.end, nil);
+    GHAssertEqualObjects(mo.bounds, GEO(@"MULTIPOINT(1 2, 3 4)"), nil);
+    
+    GHAssertEqualObjects([mo boundsAtDate:DATE(@"2010-09-29 10:00:00 +0200")], GEO(@"POINT(1 2)"), nil);
+    GHAssertEqualObjects([mo boundsAtDate:DATE(@"2010-09-29 12:00:00 +0200")], GEO(@"POINT(3 4)"), nil);
+    
+    GHAssertEqualObjects(mo, [TXLMovingObject movingObjectWithSnapshots:
+                              [NSArray arrayWithObjects:
+                               [TXLSnapshot snapshotWithTimestamp:nil geometry:GEO(@"POINT(1 2)")],
+                               [TXLSnapshot snapshotWithTimestamp:DATE(@"2010-09-29 11:00:00 +0200") geometry:GEO(@"POINT(3 4)")],
+                               [TXLSnapshot snapshotWithTimestamp:nil geometry:GEO(@"POINT(3 4)")],
+                               nil]], nil);
+}
+
 #pragma mark -
 #pragma mark Test Equality
 
@@ -814,4 +921,153 @@
 								  [TXLMovingObject emptyMovingObject]], nil);
 }
 
+- (void)testNotInIntervalWithoutEnd {
+    TXLMovingObject *mo = [TXLMovingObject movingObjectWithGeometry:GEO(@"POINT(1 1)")
+                                                              begin:DATE(@"2000-01-01 07:00:00 +0200")
+                                                                end:nil];
+    TXLMovingObjectSequence *result = [mo movingObjectNotInIntervalFrom:DATE(@"2000-01-01 08:00:00 +0200")
+                                                                     to:nil];
+    GHAssertEqualObjects(result, [TXLMovingObjectSequence sequenceWithMovingObject:
+                                  [TXLMovingObject movingObjectWithGeometry:GEO(@"POINT(1 1)")
+                                                                      begin:DATE(@"2000-01-01 07:00:00 +0200")
+                                                                        end:DATE(@"2000-01-01 08:00:00 +0200")]], nil);
+    
+    GHAssertEqualObjects([mo movingObjectInIntervalFrom:DATE(@"2000-01-01 08:00:00 +0200") to:nil],
+                         [TXLMovingObject movingObjectWithGeometry:GEO(@"POINT(1 1)")
+                                                             begin:DATE(@"2000-01-01 08:00:00 +0200")
+                                                               end:nil], nil);
+}
+
+- (void)testSpatiallyUnbounded {
+    TXLMovingObject *a = [TXLMovingObject movingObjectWithBegin:DATE(@"2010-09-29 10:00:00 +0200")
+                                                            end:DATE(@"2010-09-29 12:00:00 +0200")];
+    TXLMovingObject *b = [TXLMovingObject movingObjectWithBegin:DATE(@"2010-09-29 11:00:00 +0200")
+                                                            end:nil];
+    
+    GHAssertTrue(a.spatiallyUnbounded, nil);
+    GHAssertTrue([TXLMovingObject omnipresentMovingObject].spatiallyUnbounded, nil);
+    GHAssertTrue([TXLMovingObject movingObjectWithGeometry:[TXLGeometryCollection geometryForEntireWorld]].spatiallyUnbounded, nil);
+    GHAssertFalse([TXLMovingObject movingObjectWithGeometry:GEO(@"POINT(1 1)")].spatiallyUnbounded, nil);
+    GHAssertFalse([TXLMovingObject emptyMovingObject].spatiallyUnbounded, nil);
+    
+    GHAssertEqualObjects([a intersectionWithMovingObject:b],
+                         [TXLMovingObjectSequence sequenceWithMovingObject:
+                          [TXLMovingObject movingObjectWithBegin:DATE(@"2010-09-29 11:00:00 +0200")
+                                                             end:DATE(@"2010-09-29 12:00:00 +0200")]], nil);
+    
+    GHAssertEqualObjects([a unionWithMovingObject:b],
+                         [TXLMovingObjectSequence sequenceWithMovingObject:
+                          [TXLMovingObject movingObjectWithBegin:DATE(@"2010-09-29 10:00:00 +0200")
+                                                             end:nil]], nil);
+    
+    GHAssertEqualObjects([a complementWithMovingObject:b],
+                         [TXLMovingObjectSequence sequenceWithMovingObject:
+                          [TXLMovingObject movingObjectWithBegin:DATE(@"2010-09-29 10:00:00 +0200")
+                                                             end:DATE(@"2010-09-29 11:00:00 +0200")]], nil);
+    
+    GHAssertTrue([b complementWithMovingObject:[TXLMovingObject omnipresentMovingObject]].empty, nil);
+}
+
+- (void)testLazyBounds {
+    
+    // The bounding box of the bounds is calculated from the boxes of the
+    // geometries, the bounds (cascaded union) on first access. The
+    // geometry of the last snapshot is not part of the bounds.
+    // ====================================================
+    
+    NSTimeInterval timestamps[5];
+    TXLGeometryCollection *geometries[5];
+    for (int i = 0; i < 5; i++) {
+        timestamps[i] = [DATE(@"2010-09-29 10:00:00 +0200") timeIntervalSince1970] + i * 60;
+    }
+    geometries[0] = GEO(@"POINT(1 1)");
+    geometries[1] = GEO(@"POLYGON((2 2, 3 2, 3 3, 2 3, 2 2))");
+    geometries[2] = geometries[1];
+    geometries[3] = GEO(@"POINT(5 7)");
+    geometries[4] = GEO(@"POINT(20 20)");
+    
+    TXLMovingObject *mo = [TXLMovingObject movingObjectWithTimestamps:timestamps
+                                                           geometries:geometries
+                                                                count:5];
+    
+    TXLBoundingBox box = mo.boundingBox;
+    GHAssertEquals(box.minLongitude, 1.0, nil);
+    GHAssertEquals(box.maxLongitude, 5.0, nil);
+    GHAssertEquals(box.minLatitude, 1.0, nil);
+    GHAssertEquals(box.maxLatitude, 7.0, nil);
+    
+    GHAssertEqualObjects(mo.bounds, [[geometries[0] union:geometries[1]] union:geometries[3]], nil);
+    GHAssertEquals(mo.bounds.boundingBox.maxLatitude, box.maxLatitude, nil);
+    
+    GHAssertEqualObjects([TXLGeometryCollection unionOfGeometries:geometries count:1], geometries[0], nil);
+    GHAssertNil([TXLGeometryCollection unionOfGeometries:geometries count:0], nil);
+    
+    TXLBoundingBox empty = [TXLMovingObject emptyMovingObject].boundingBox;
+    GHAssertTrue(empty.minLongitude > empty.maxLongitude, nil);
+}
+
+#pragma mark -
+#pragma mark Benchmark
+
+- (void)testTemporalLookupBenchmark {
+    
+    // Measure the temporal lookups of moving objects with an
+    // increasing number of snapshots. With the binary search
+    // the time per lookup should grow logarithmically.
+    
+    NSUInteger lookups = 1000;
+    NSUInteger lengths[] = {10, 100, 1000, 10000};
+    NSTimeInterval begin = [DATE(@"2010-09-29 10:00:00 +0200") timeIntervalSince1970];
+    
+    for (NSUInteger l = 0; l < sizeof(lengths) / sizeof(NSUInteger); l++) {
+        NSAutoreleasePool *pool = [NSAutoreleasePool new];
+        
+        NSUInteger count = lengths[l];
+        TXLTrajectorySample *samples = malloc(count * sizeof(TXLTrajectorySample));
+        for (NSUInteger i = 0; i < count; i++) {
+            samples[i].timestamp = begin + i * 60;
+            samples[i].coordinate.longitude = (double)i / count;
+            samples[i].coordinate.latitude = 0;
+            samples[i].geometry = 0;
+        }
+        TXLMovingObject *mo = [TXLMovingObject movingObjectWithSamples:samples count:count];
+        free(samples);
+        
+        // materialize the snapshots before the measurement
+        GHAssertEquals([mo.snapshots count], count, nil);
+        
+        // the results are checked after the measurement, the
+        // comparison of the geometries is not part of the lookup
+        TXLGeometryCollection **bounds = malloc(lookups * sizeof(TXLGeometryCollection *));
+        
+        NSDate *start = [NSDate date];
+        for (NSUInteger i = 0; i < lookups; i++) {
+            NSUInteger idx = (i * 7919) % (count - 1);
+            NSDate *date = [NSDate dateWithTimeIntervalSince1970:begin + idx * 60 + 30];
+            bounds[i] = [mo boundsAtDate:date];
+        }
+        NSTimeInterval atDateTime = -[start timeIntervalSinceNow];
+        
+        for (NSUInteger i = 0; i < lookups; i++) {
+            NSUInteger idx = (i * 7919) % (count - 1);
+            GHAssertEqualObjects(bounds[i], [(TXLSnapshot *)[mo.snapshots objectAtIndex:idx] geometry], nil);
+        }
+        free(bounds);
+        
+        start = [NSDate date];
+        for (NSUInteger i = 0; i < lookups; i++) {
+            NSUInteger idx = (i * 7919) % (count - 1);
+            NSDate *from = [NSDate dateWithTimeIntervalSince1970:begin + idx * 60 + 30];
+            NSDate *to = [NSDate dateWithTimeIntervalSince1970:begin + idx * 60 + 90];
+            [mo movingObjectInIntervalFrom:from to:to];
+        }
+        NSTimeInterval inIntervalTime = -[start timeIntervalSinceNow];
+        
+        NSLog(@"Temporal lookups (%lu) in %lu snapshots: boundsAtDate %f s, movingObjectInInterval %f s",
+              (unsigned long)lookups, (unsigned long)count, atDateTime, inIntervalTime);
+        
+        [pool drain];
+    }
+}
+
 @end
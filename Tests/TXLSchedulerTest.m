@@ -0,0 +1,213 @@
+//
+//  TXLSchedulerTest.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 23.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//	
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//	
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+
+#import <GHUnit/GHUnit.h>
+
+#import "TXLScheduler.h"
+
+@interface TXLSchedulerTest : GHTestCase {
+    
+}
+
+@end
+
+@implementation TXLSchedulerTest
+
+- (void)testPriorityOrder {
+    
+    dispatch_queue_t queue = dispatch_queue_create("org.opentxl.test.scheduler", NULL);
+    dispatch_group_t group = dispatch_group_create();
+    
+    TXLScheduler *scheduler = [[TXLScheduler alloc] initWithQueue:queue
+                                                            group:group];
+    
+    NSMutableArray *order = [NSMutableArray array];
+    
+    // Block the queue until all other blocks are scheduled.
+    dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+    [scheduler scheduleBlock:^{
+        dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+    } withPriority:TXLSchedulerPriorityInteractive
+                    contexts:[NSSet set]];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"maintenance"];
+    } withPriority:TXLSchedulerPriorityMaintenance
+                    contexts:[NSSet setWithObject:@"a"]];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"backfill"];
+    } withPriority:TXLSchedulerPriorityBackfill
+                    contexts:[NSSet setWithObject:@"b"]];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"interactive"];
+    } withPriority:TXLSchedulerPriorityInteractive
+                    contexts:[NSSet setWithObject:@"c"]];
+    
+    GHAssertEquals([scheduler numberOfWaitingTasksWithPriority:TXLSchedulerPriorityBackfill], (NSUInteger)1, nil);
+    
+    dispatch_semaphore_signal(sema);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    NSArray *expected = [NSArray arrayWithObjects:@"interactive", @"backfill", @"maintenance", nil];
+    GHAssertEqualObjects(order, expected, nil);
+    
+    GHAssertEquals([scheduler numberOfWaitingTasksWithPriority:TXLSchedulerPriorityBackfill], (NSUInteger)0, nil);
+    GHAssertTrue([scheduler maximumWaitTimeForPriority:TXLSchedulerPriorityBackfill] > 0, nil);
+    
+    [scheduler release];
+    dispatch_release(sema);
+    dispatch_release(group);
+    dispatch_release(queue);
+}
+
+- (void)testDeadline {
+    
+    dispatch_queue_t queue = dispatch_queue_create("org.opentxl.test.scheduler", NULL);
+    dispatch_group_t group = dispatch_group_create();
+    
+    TXLScheduler *scheduler = [[TXLScheduler alloc] initWithQueue:queue
+                                                            group:group];
+    
+    // backfill blocks must not wait at all
+    [scheduler setDeadline:0 forPriority:TXLSchedulerPriorityBackfill];
+    
+    NSMutableArray *order = [NSMutableArray array];
+    
+    dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+    [scheduler scheduleBlock:^{
+        dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+    } withPriority:TXLSchedulerPriorityInteractive
+                    contexts:[NSSet set]];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"backfill"];
+    } withPriority:TXLSchedulerPriorityBackfill
+                    contexts:[NSSet setWithObject:@"a"]];
+    
+    [NSThread sleepForTimeInterval:0.01];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"interactive"];
+    } withPriority:TXLSchedulerPriorityInteractive
+                    contexts:[NSSet setWithObject:@"b"]];
+    
+    dispatch_semaphore_signal(sema);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    // the backfill block has the earlier deadline
+    NSArray *expected = [NSArray arrayWithObjects:@"backfill", @"interactive", nil];
+    GHAssertEqualObjects(order, expected, nil);
+    
+    [scheduler release];
+    dispatch_release(sema);
+    dispatch_release(group);
+    dispatch_release(queue);
+}
+
+- (void)testOrderOfContexts {
+    
+    dispatch_queue_t queue = dispatch_queue_create("org.opentxl.test.scheduler", NULL);
+    dispatch_group_t group = dispatch_group_create();
+    
+    TXLScheduler *scheduler = [[TXLScheduler alloc] initWithQueue:queue
+                                                            group:group];
+    
+    NSMutableArray *order = [NSMutableArray array];
+    
+    dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+    [scheduler scheduleBlock:^{
+        dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+    } withPriority:TXLSchedulerPriorityInteractive
+                    contexts:[NSSet set]];
+    
+    // the clear of a context (e.g., of a removed situation definition)
+    [scheduler scheduleBlock:^{
+        [order addObject:@"clear a"];
+    } withPriority:TXLSchedulerPriorityMaintenance
+                    contexts:[NSSet setWithObject:@"a"]];
+    
+    // an import with unknown contexts
+    [scheduler scheduleBlock:^{
+        [order addObject:@"import"];
+    } withPriority:TXLSchedulerPriorityBackfill
+                    contexts:nil];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"update b"];
+    } withPriority:TXLSchedulerPriorityInteractive
+                    contexts:[NSSet setWithObject:@"b"]];
+    
+    dispatch_semaphore_signal(sema);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    // nothing overtakes the import
+    NSArray *expected = [NSArray arrayWithObjects:@"clear a", @"import", @"update b", nil];
+    GHAssertEqualObjects(order, expected, nil);
+    
+    [order removeAllObjects];
+    
+    [scheduler scheduleBlock:^{
+        dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+    } withPriority:TXLSchedulerPriorityInteractive
+                    contexts:[NSSet set]];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"clear a"];
+    } withPriority:TXLSchedulerPriorityMaintenance
+                    contexts:[NSSet setWithObject:@"a"]];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"backfill c"];
+    } withPriority:TXLSchedulerPriorityBackfill
+                    contexts:[NSSet setWithObject:@"c"]];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"update a"];
+    } withPriority:TXLSchedulerPriorityContinuous
+                    contexts:[NSSet setWithObjects:@"a", @"b", nil]];
+    
+    [scheduler scheduleBlock:^{
+        [order addObject:@"update b"];
+    } withPriority:TXLSchedulerPriorityInteractive
+                    contexts:[NSSet setWithObject:@"b"]];
+    
+    dispatch_semaphore_signal(sema);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    // The updates of a and b keep their order. The clear of a gets
+    // the priority of the updates waiting for it and is executed
+    // before the block of the backfill class.
+    expected = [NSArray arrayWithObjects:@"clear a", @"update a", @"update b", @"backfill c", nil];
+    GHAssertEqualObjects(order, expected, nil);
+    
+    [scheduler release];
+    dispatch_release(sema);
+    dispatch_release(group);
+    dispatch_release(queue);
+}
+
+@end
@@ -3925,4 +3925,89 @@
 }
 
 
+- (void)testSelectStarWithFilterVariables {
+	
+	/*
+	SELECT *
+	FROM <txl://weather.situmet.at>
+	WHERE {
+		FILTER(?temp > 10 || ?unused = 3)
+		[<http://schema.situmet.at/meteorology#temperature> ?temp].
+	}
+	*/
+	
+	// Only the variables bound by the pattern are in the result set, not
+	// the variable used only in the filter. The variable ?temp is used
+	// in the filter before its triple pattern.
+	
+	NSError *error;
+	
+	TXLQuery *query = [TXLSPARQLCompiler compileQueryWithExpression:@"SELECT * FROM <txl://weather.situmet.at> WHERE { FILTER(?temp > 10 || ?unused = 3) [<http://schema.situmet.at/meteorology#temperature> ?temp]. }"
+														 parameters:nil
+															options:nil
+															  error:&error];
+	GHAssertNotNil(query, [error localizedDescription]);
+	
+	NSUInteger queryId = [query primaryKey];
+	
+	TXLDatabase *database = [[TXLManager sharedManager] database];
+	
+	NSArray *result = [database executeSQLWithParameters:@"SELECT id, name FROM txl_query_variable WHERE query_id = ? and in_resultset = ?"
+												   error:&error,
+					   [NSNumber numberWithUnsignedInteger:queryId],
+					   [NSNumber numberWithBool:YES],
+					   nil];
+	GHAssertNotNil(result, [error localizedDescription]);
+	
+	GHAssertEquals([result count], (NSUInteger)1, @"There should be 1 variable in the resultset for this query.");
+	GHAssertEqualObjects([[result objectAtIndex:0] objectForKey:@"name"], @"temp", nil);
+	
+	// The result set table has a column for ?temp only.
+	result = [database executeSQL:[NSString stringWithFormat:@"PRAGMA table_info(txl_resultset_%d)", queryId]
+							error:&error];
+	GHAssertNotNil(result, [error localizedDescription]);
+	
+	GHAssertEquals([result count], (NSUInteger)3, @"The table 'txl_resultset_%d' should have 3 columns.", queryId);
+}
+
+
+- (void)testBooleanLiterals {
+	
+	/*
+	SELECT ?x
+	FROM <txl://weather.situmet.at>
+	WHERE {
+		?x <http://schema.situmet.at/meteorology#rain> false.
+		?x <http://schema.situmet.at/meteorology#sun> true.
+	}
+	*/
+	
+	NSError *error;
+	
+	TXLQuery *query = [TXLSPARQLCompiler compileQueryWithExpression:@"SELECT ?x FROM <txl://weather.situmet.at> WHERE { ?x <http://schema.situmet.at/meteorology#rain> false. ?x <http://schema.situmet.at/meteorology#sun> true. }"
+														 parameters:nil
+															options:nil
+															  error:&error];
+	GHAssertNotNil(query, [error localizedDescription]);
+	
+	TXLDatabase *database = [[TXLManager sharedManager] database];
+	
+	NSArray *result = [database executeSQLWithParameters:@"SELECT t.object_id FROM txl_query_pattern_triple AS t, txl_query AS q WHERE q.id = ? AND t.in_pattern_id = q.pattern_id ORDER BY t.id"
+												   error:&error,
+					   [NSNumber numberWithUnsignedInteger:[query primaryKey]],
+					   nil];
+	GHAssertNotNil(result, [error localizedDescription]);
+	GHAssertEquals([result count], (NSUInteger)2, @"There should be 2 triple patterns for this query.");
+	
+	TXLTerm *falseTerm = [TXLTerm termWithPrimaryKey:[[[result objectAtIndex:0] objectForKey:@"object_id"] unsignedIntegerValue]];
+	TXLTerm *trueTerm = [TXLTerm termWithPrimaryKey:[[[result objectAtIndex:1] objectForKey:@"object_id"] unsignedIntegerValue]];
+	
+	GHAssertEquals([falseTerm type], kTXLTermTypeBooleanLiteral, nil);
+	GHAssertEquals([trueTerm type], kTXLTermTypeBooleanLiteral, nil);
+	
+	GHAssertFalse(falseTerm.booleanValue, @"The literal false should be false.");
+	GHAssertTrue(trueTerm.booleanValue, @"The literal true should be true.");
+}
+
+
 @end
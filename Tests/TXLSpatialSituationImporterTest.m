@@ -25,16 +25,104 @@
 #import "TXLSpatialSituationImporter.h"
 #import "TXLManager.h"
 #import "TXLMovingObject.h"
+#import "TXLSnapshot.h"
+#import "TXLGeometryCollection.h"
 #import "TXLDatabase.h"
+#import "TXLRevision.h"
+
+#define SQL(x) {TXLDatabase *database = [[TXLManager sharedManager] database]; NSError *error; NSArray *result = [database executeSQL:x error:&error]; GHAssertNotNil(result, [error localizedDescription]);}
 
 @interface TXLSpatialSituationImporterTest : GHAsyncTestCase {
 	
 }
+
+- (NSString *)largeSpatialSituationWithContext:(NSString *)name
+								numberOfSnapshots:(NSUInteger)numberOfSnapshots
+							   numberOfStatements:(NSUInteger)numberOfStatements;
+
+- (NSArray *)createdStatementsOfRevision:(TXLRevision *)revision;
+
 @end
 
 
 @implementation TXLSpatialSituationImporterTest
 
+#pragma mark -
+#pragma mark Set Up
+
+- (void)setUp {
+	for (NSString *name in [[[TXLManager sharedManager] database] tableNames]) {
+		
+		// delete content for tables
+		if ([name hasPrefix:@"txl_context"]) {
+			NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+			SQL(expr);
+		}
+		
+		if ([name hasPrefix:@"txl_statement"]) {
+			NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+			SQL(expr);
+		}
+		
+		if ([name hasPrefix:@"txl_movingobject"]) {
+			NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+			SQL(expr);
+		}
+	}
+}
+
+#pragma mark -
+#pragma mark Helper
+
+- (NSString *)largeSpatialSituationWithContext:(NSString *)name
+								numberOfSnapshots:(NSUInteger)numberOfSnapshots
+							   numberOfStatements:(NSUInteger)numberOfStatements {
+	
+	NSMutableString *expression = [NSMutableString string];
+	[expression appendFormat:@"@context <txl://TXLSpatialSituationImporterTest/large/%@> .\n", name];
+	
+	// One snapshot per minute, starting in January (no change
+	// of the daylight saving time in the interval).
+	NSDateFormatter *dateFormatter = [[[NSDateFormatter alloc] init] autorelease];
+	[dateFormatter setTimeZone:[NSTimeZone timeZoneForSecondsFromGMT:0]];
+	[dateFormatter setDateFormat:@"yyyy-MM-dd'T'HH:mm'Z'"];
+	NSDate *begin = [dateFormatter dateFromString:@"2011-01-02T00:00Z"];
+	
+	for (NSUInteger i = 0; i < numberOfSnapshots; i++) {
+		[expression appendFormat:@"@snapshot %@ : POINT(%f %f) .\n",
+		 [dateFormatter stringFromDate:[begin dateByAddingTimeInterval:i * 60]],
+		 10.0 + (i % 1000) * 0.001,
+		 50.0 + (i / 1000) * 0.001];
+	}
+	
+	[expression appendString:@"@prefix ex: <http://example.org/stuff/1.0/> .\n"];
+	for (NSUInteger i = 0; i < numberOfStatements; i++) {
+		[expression appendFormat:@"<txl://TXLSpatialSituationImporterTest/large/item-%lu> ex:index \"%lu\" .\n", (unsigned long)i, (unsigned long)i];
+	}
+	
+	return expression;
+}
+
+- (NSArray *)createdStatementsOfRevision:(TXLRevision *)revision {
+	
+	// The created statements (without the context) with
+	// the interval and the number of snapshots of their
+	// moving objects.
+	
+	NSError *error;
+	NSArray *result = [[[TXLManager sharedManager] database] executeSQLWithParameters:@"SELECT s.subject_id, s.predicate_id, s.object_id, m.\"begin\", m.\"end\", (SELECT count(*) FROM txl_snapshot WHERE movingobject_id = s.mo_id) AS snapshots \
+						FROM txl_statement_created AS c JOIN txl_statement AS s ON s.id = c.statement_id JOIN txl_movingobject AS m ON m.id = s.mo_id \
+						WHERE c.revision_id = ? ORDER BY s.subject_id, s.predicate_id, s.object_id"
+																				   error:&error,
+					   [NSNumber numberWithUnsignedInteger:revision.primaryKey],
+					   nil];
+	GHAssertNotNil(result, [error localizedDescription]);
+	return result;
+}
+
+#pragma mark -
+#pragma mark Tests
+
 
 - (void)testSpatialSituationCompiler {
 	
@@ -174,4 +262,168 @@
 	GHAssertTrue([mo isAlways], @"Result should be always valid.");		
 }
 
+- (void)testSnapshotTimestamp {
+	
+	NSError *error;
+	
+	NSDictionary *result = [TXLSpatialSituationImporter compileSpatialSituationWithExpression:@" @context <txl://opentxl.org/events/> . @snapshot 2011-07-22T20:00Z : POINT(20.4 30.1) . @snapshot 2012-02-29T23:59Z : POINT(15.4 47.1) . @prefix ex: <http://example.org/stuff/1.0/> . <txl://opentxl.org/events/event-graz-1> ex:name \"Event Graz 1\". "
+																				   parameters:nil
+																					  options:nil
+																						error:&error]; 
+	GHAssertNotNil(result, @"Result should not be nil.");
+	
+	// The timestamps must be the same as parsed by a date formatter.
+	NSDateFormatter *dateFormatter = [[[NSDateFormatter alloc] init] autorelease];
+	[dateFormatter setTimeZone:[NSTimeZone localTimeZone]];
+	[dateFormatter setDateFormat:@"yyyy-MM-dd'T'HH:mm'Z'"];
+	
+	NSArray *snapshots = [(TXLMovingObject *)[result objectForKey:@"moving_object"] snapshots];
+	GHAssertEquals([snapshots count], (NSUInteger)2, nil);
+	GHAssertEqualObjects([(TXLSnapshot *)[snapshots objectAtIndex:0] timestamp], [dateFormatter dateFromString:@"2011-07-22T20:00Z"], nil);
+	GHAssertEqualObjects([(TXLSnapshot *)[snapshots objectAtIndex:1] timestamp], [dateFormatter dateFromString:@"2012-02-29T23:59Z"], nil);
+	
+	// Invalid dates are rejected.
+	TXLSpatialSituationImporter *importer = [[[TXLSpatialSituationImporter alloc] init] autorelease];
+	GHAssertNil([importer dateFromTimestamp:"2011-02-29T12:00Z"], nil);
+	GHAssertNil([importer dateFromTimestamp:"2011-13-01T12:00Z"], nil);
+	GHAssertNil([importer dateFromTimestamp:"2011-01-01T24:00Z"], nil);
+}
+
+- (void)testLargeImport {
+	
+	// A large situation is imported from a string (the file was read
+	// into a string before), from a mapped file and from a mapped file
+	// in bulk mode. Each import creates one revision with the same
+	// statements and moving objects.
+	
+	NSUInteger numberOfSnapshots = 10000;
+	NSUInteger numberOfStatements = 50;
+	
+	NSError *error;
+	
+	NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"TXLSpatialSituationImporterTest-large.n3"];
+	NSString *bulkPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"TXLSpatialSituationImporterTest-large-bulk.n3"];
+	
+	GHAssertTrue([[self largeSpatialSituationWithContext:@"file"
+									   numberOfSnapshots:numberOfSnapshots
+									  numberOfStatements:numberOfStatements] writeToFile:path
+																			  atomically:YES
+																				encoding:NSUTF8StringEncoding
+																				   error:&error], [error localizedDescription]);
+	GHAssertTrue([[self largeSpatialSituationWithContext:@"bulk"
+									   numberOfSnapshots:numberOfSnapshots
+									  numberOfStatements:numberOfStatements] writeToFile:bulkPath
+																			  atomically:YES
+																				encoding:NSUTF8StringEncoding
+																				   error:&error], [error localizedDescription]);
+	
+	__block TXLRevision *stringRevision = nil;
+	__block TXLRevision *fileRevision = nil;
+	__block TXLRevision *bulkRevision = nil;
+	
+	[self prepare];
+	GHAssertTrue([[TXLManager sharedManager] importSpatialSituationFromString:[self largeSpatialSituationWithContext:@"string"
+																								   numberOfSnapshots:numberOfSnapshots
+																								  numberOfStatements:numberOfStatements]
+															   inIntervalFrom:nil
+																		   to:nil
+																		error:&error
+															  completionBlock:^(TXLRevision *rev, NSError *e){
+																  stringRevision = [rev retain];
+																  [self notify:kGHUnitWaitStatusSuccess];
+															  }], [error localizedDescription]);
+	[self waitForStatus:kGHUnitWaitStatusSuccess timeout:300.0];
+	
+	[self prepare];
+	[[TXLManager sharedManager] importSpatialSituationFromFileAtPath:path
+													  inIntervalFrom:nil
+																  to:nil
+															   error:&error
+													 completionBlock:^(TXLRevision *rev, NSError *e){
+														 fileRevision = [rev retain];
+														 [self notify:kGHUnitWaitStatusSuccess];
+													 }];
+	[self waitForStatus:kGHUnitWaitStatusSuccess timeout:300.0];
+	
+	[self prepare];
+	[[TXLManager sharedManager] ingestSpatialSituationsFromFilesAtPaths:[NSArray arrayWithObject:bulkPath]
+														 inIntervalFrom:nil
+																	 to:nil
+														completionBlock:^(TXLRevision *rev, NSError *e){
+															bulkRevision = [rev retain];
+															[self notify:kGHUnitWaitStatusSuccess];
+														}];
+	[self waitForStatus:kGHUnitWaitStatusSuccess timeout:300.0];
+	
+	[stringRevision autorelease];
+	[fileRevision autorelease];
+	[bulkRevision autorelease];
+	
+	[[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+	[[NSFileManager defaultManager] removeItemAtPath:bulkPath error:nil];
+	
+	GHAssertNotNil(stringRevision, nil);
+	GHAssertNotNil(fileRevision, nil);
+	GHAssertNotNil(bulkRevision, nil);
+	
+	// One revision per import.
+	GHAssertEquals(fileRevision.precursor.primaryKey, stringRevision.primaryKey, nil);
+	GHAssertEquals(bulkRevision.precursor.primaryKey, fileRevision.primaryKey, nil);
+	
+	NSArray *expected = [self createdStatementsOfRevision:stringRevision];
+	GHAssertEquals([expected count], numberOfStatements, nil);
+	GHAssertEquals([[[expected objectAtIndex:0] objectForKey:@"snapshots"] unsignedIntegerValue], numberOfSnapshots, nil);
+	
+	GHAssertEqualObjects([self createdStatementsOfRevision:fileRevision], expected, nil);
+	GHAssertEqualObjects([self createdStatementsOfRevision:bulkRevision], expected, nil);
+}
+
+- (void)testSnapshotParsingBenchmark {
+	
+	// Compare the conversion of the literals of a snapshot
+	// with a date formatter and a WKT string (as done before)
+	// and directly from the scanner buffer.
+	
+	NSUInteger iterations = 10000;
+	TXLSpatialSituationImporter *importer = [[[TXLSpatialSituationImporter alloc] init] autorelease];
+	
+	NSDate *start = [NSDate date];
+	for (NSUInteger i = 0; i < iterations; i++) {
+		NSAutoreleasePool *pool = [NSAutoreleasePool new];
+		NSDateFormatter *dateFormatter = [[[NSDateFormatter alloc] init] autorelease];
+		[dateFormatter setTimeZone:[NSTimeZone localTimeZone]];
+		[dateFormatter setDateFormat:@"yyyy-MM-dd'T'HH:mm'Z'"];
+		[dateFormatter dateFromString:[NSString stringWithCString:"2011-07-22T20:00Z" encoding:NSUTF8StringEncoding]];
+		[TXLGeometryCollection geometryFromWKT:[NSString stringWithCString:"POINT(20.40302705189357 30.08912723635675)" encoding:NSUTF8StringEncoding]];
+		[pool drain];
+	}
+	NSTimeInterval formatterTime = -[start timeIntervalSinceNow];
+	
+	start = [NSDate date];
+	for (NSUInteger i = 0; i < iterations; i++) {
+		NSAutoreleasePool *pool = [NSAutoreleasePool new];
+		[importer dateFromTimestamp:"2011-07-22T20:00Z"];
+		[TXLGeometryCollection geometryFromWKTCString:"POINT(20.40302705189357 30.08912723635675)"];
+		[pool drain];
+	}
+	NSTimeInterval directTime = -[start timeIntervalSinceNow];
+	
+	NSLog(@"Snapshot literals (%lu): date formatter and WKT string %f s, direct %f s", (unsigned long)iterations, formatterTime, directTime);
+	
+	// Compile all situations of the test data.
+	
+	NSArray *pathList = [[NSBundle mainBundle] pathsForResourcesOfType:@"n3" inDirectory:nil];
+	
+	start = [NSDate date];
+	for (NSString *path in pathList) {
+		NSError *error;
+		NSDictionary *result = [TXLSpatialSituationImporter compileSpatialSituationWithContentsOfFile:path
+																						   parameters:nil
+																							  options:nil
+																								error:&error];
+		GHAssertNotNil(result, @"Could not compile %@: %@", path, [error localizedDescription]);
+	}
+	NSLog(@"Compiled %lu spatial situations in %f s", (unsigned long)[pathList count], -[start timeIntervalSinceNow]);
+}
+
 @end
@@ -0,0 +1,208 @@
+//
+//  TXLSubscriptionIndexTest.m
+//  OpenTXL
+//
+//  Created by Tobias Kräntzer on 24.03.11.
+//  Copyright 2010 Fraunhofer ISST. All rights reserved.
+//
+//  This file is part of OpenTXL.
+//
+//  OpenTXL is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  OpenTXL is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with OpenTXL. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#import <GHUnit/GHUnit.h>
+
+#import "TXLDatabase.h"
+#import "TXLManager.h"
+#import "TXLQueryHandle.h"
+#import "TXLQuery.h"
+#import "TXLContext.h"
+#import "TXLSubscriptionIndex.h"
+
+#define SQL(x) {TXLDatabase *database = [[TXLManager sharedManager] database]; NSError *error; NSArray *result = [database executeSQL:x error:&error]; GHAssertNotNil(result, [error localizedDescription]);}
+
+@interface TXLSubscriptionIndexTest : GHAsyncTestCase {
+
+}
+
+- (TXLContext *)contextWithPath:(NSArray *)path;
+
+- (NSUInteger)registerQueryWithName:(NSString *)name
+                            context:(NSString *)context;
+
+- (NSSet *)primaryKeysOfQueries:(NSArray *)queries;
+
+- (NSSet *)queriesOfIndex:(TXLSubscriptionIndex *)index
+               forContext:(TXLContext *)ctx;
+
+- (NSSet *)queriesOfLinearScanForContext:(TXLContext *)ctx;
+
+@end
+
+@implementation TXLSubscriptionIndexTest
+
+#pragma mark -
+#pragma mark Set Up & Tear Down
+
+- (void)setUp {
+    for (NSString *name in [[[TXLManager sharedManager] database] tableNames]) {
+
+        // delete content for tables
+        if ([name hasPrefix:@"txl_context"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        if ([name hasPrefix:@"txl_statement"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        if ([name hasPrefix:@"txl_query"]) {
+            NSString *expr = [NSString stringWithFormat:@"DELETE FROM %@", name];
+            SQL(expr);
+        }
+
+        // delete tables
+        if ([name hasPrefix:@"txl_resultset"]) {
+            NSString *expr = [NSString stringWithFormat:@"DROP TABLE %@", name];
+            SQL(expr);
+        }
+    }
+
+    [TXLManager sharedManager].delegate = self;
+}
+
+- (void)tearDown {
+
+    if ([TXLManager sharedManager].processing) {
+        [self prepare];
+        [self waitForStatus:kGHUnitWaitStatusSuccess
+                    timeout:120.0];
+    }
+
+    [TXLManager sharedManager].delegate = nil;
+}
+
+#pragma mark -
+#pragma mark Processing
+
+- (void)didStartProcessing {
+    GHTestLog(@"Start Processing.");
+}
+
+- (void)didEndProcessing {
+    GHTestLog(@"End Processing.");
+    [self notify:kGHUnitWaitStatusSuccess];
+}
+
+#pragma mark -
+#pragma mark Helper
+
+- (TXLContext *)contextWithPath:(NSArray *)path {
+    NSError *error;
+    TXLContext *ctx = [[TXLManager sharedManager] contextForProtocol:@"txl"
+                                                                host:@"TXLSubscriptionIndexTest"
+                                                                path:path
+                                                               error:&error];
+    GHAssertNotNil(ctx, [error localizedDescription]);
+    return ctx;
+}
+
+- (NSUInteger)registerQueryWithName:(NSString *)name
+                            context:(NSString *)context {
+    NSError *error;
+    NSString *expression = [NSString stringWithFormat:@"SELECT ?s FROM <txl://TXLSubscriptionIndexTest/%@> WHERE { ?s ?p ?o . }", context];
+    TXLQueryHandle *qh = [[TXLManager sharedManager] registerQueryWithName:name
+                                                                expression:expression
+                                                                parameters:nil
+                                                                   options:nil
+                                                                     error:&error];
+    GHAssertNotNil(qh, [error localizedDescription]);
+    return qh.queryPrimaryKey;
+}
+
+- (NSSet *)primaryKeysOfQueries:(NSArray *)queries {
+    NSMutableSet *pks = [NSMutableSet set];
+    for (TXLQuery *query in queries) {
+        [pks addObject:[NSNumber numberWithUnsignedInteger:query.primaryKey]];
+    }
+    return pks;
+}
+
+- (NSSet *)queriesOfIndex:(TXLSubscriptionIndex *)index
+               forContext:(TXLContext *)ctx {
+    return [self primaryKeysOfQueries:[index queriesForContexts:[NSSet setWithObject:ctx]]];
+}
+
+- (NSSet *)queriesOfLinearScanForContext:(TXLContext *)ctx {
+    NSError *error;
+    NSArray *queries = [TXLQuery queriesForContexts:[NSSet setWithObject:ctx] error:&error];
+    GHAssertNotNil(queries, [error localizedDescription]);
+    return [self primaryKeysOfQueries:queries];
+}
+
+#pragma mark -
+#pragma mark Tests
+
+- (void)testQueriesForContexts {
+
+    NSNumber *q1 = [NSNumber numberWithUnsignedInteger:[self registerQueryWithName:@"TXLSubscriptionIndexTest_a" context:@"a"]];
+    NSNumber *q2 = [NSNumber numberWithUnsignedInteger:[self registerQueryWithName:@"TXLSubscriptionIndexTest_a_b" context:@"a/b"]];
+    NSNumber *q3 = [NSNumber numberWithUnsignedInteger:[self registerQueryWithName:@"TXLSubscriptionIndexTest_c" context:@"c"]];
+
+    TXLContext *a = [self contextWithPath:[NSArray arrayWithObject:@"a"]];
+    TXLContext *ab = [self contextWithPath:[NSArray arrayWithObjects:@"a", @"b", nil]];
+    TXLContext *abx = [self contextWithPath:[NSArray arrayWithObjects:@"a", @"b", @"x", nil]];
+    TXLContext *abc = [self contextWithPath:[NSArray arrayWithObjects:@"a", @"bc", nil]];
+    TXLContext *c = [self contextWithPath:[NSArray arrayWithObject:@"c"]];
+    TXLContext *d = [self contextWithPath:[NSArray arrayWithObject:@"d"]];
+
+    NSArray *contexts = [NSArray arrayWithObjects:a, ab, abx, abc, c, d, nil];
+
+    TXLSubscriptionIndex *index = [[[TXLSubscriptionIndex alloc] init] autorelease];
+
+    // exact path and prefix
+
+    GHAssertEqualObjects([self queriesOfIndex:index forContext:a], [NSSet setWithObject:q1], nil);
+    GHAssertEqualObjects([self queriesOfIndex:index forContext:ab], ([NSSet setWithObjects:q1, q2, nil]), nil);
+    GHAssertEqualObjects([self queriesOfIndex:index forContext:abx], ([NSSet setWithObjects:q1, q2, nil]), nil);
+    GHAssertEqualObjects([self queriesOfIndex:index forContext:abc], [NSSet setWithObject:q1], nil);
+    GHAssertEqualObjects([self queriesOfIndex:index forContext:c], [NSSet setWithObject:q3], nil);
+    GHAssertEqualObjects([self queriesOfIndex:index forContext:d], [NSSet set], nil);
+
+    // same result as the scan over all registered queries
+
+    for (TXLContext *ctx in contexts) {
+        GHAssertEqualObjects([self queriesOfIndex:index forContext:ctx],
+                             [self queriesOfLinearScanForContext:ctx],
+                             @"Context: %@", ctx);
+    }
+
+    // a removed query is not found anymore
+
+    [[TXLManager sharedManager] unregisterQueryWithName:@"TXLSubscriptionIndexTest_a_b"];
+    [index removeQuery:[TXLQuery queryWithPrimaryKey:[q2 unsignedIntegerValue]]];
+
+    GHAssertEqualObjects([self queriesOfIndex:index forContext:ab], [NSSet setWithObject:q1], nil);
+    GHAssertEqualObjects([self queriesOfIndex:index forContext:abx], [NSSet setWithObject:q1], nil);
+
+    for (TXLContext *ctx in contexts) {
+        GHAssertEqualObjects([self queriesOfIndex:index forContext:ctx],
+                             [self queriesOfLinearScanForContext:ctx],
+                             @"Context: %@", ctx);
+    }
+}
+
+@end